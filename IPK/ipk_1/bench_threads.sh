@@ -0,0 +1,61 @@
+#!/bin/sh
+# Scan throughput of ipk-l2l3-scan (hosts per second) by the number of scan threads (-t)
+#
+# Two network namespaces are connected by a veth pair. The target namespace has a local route for the whole scanned
+# subnet, so its kernel answers ARP and ICMP echo for every address and the result doesn't depend on real hosts.
+# Nothing outside the two namespaces is changed. Needs root, iproute2 and a built ./ipk-l2l3-scan.
+#
+# Usage: sudo ./bench_threads.sh [prefix length of the scanned subnet (default 16)] [thread counts (default 1 2 4 8)]
+# Every thread count is run RUNS times (default 3), the best run is reported.
+set -e
+
+PREFIX=${1:-16}
+[ $# -gt 0 ] && shift
+THREADS=${*:-1 2 4 8}
+RUNS=${RUNS:-3}
+SCANNER=${SCANNER:-./ipk-l2l3-scan}
+SCAN_NS=ipkbench-scan
+TARGET_NS=ipkbench-target
+SUBNET=10.100.0.0/$PREFIX
+
+cleanup()
+{
+    ip netns del $SCAN_NS 2>/dev/null || true
+    ip netns del $TARGET_NS 2>/dev/null || true
+}
+trap cleanup EXIT
+cleanup
+
+ip netns add $SCAN_NS
+ip netns add $TARGET_NS
+ip link add ipkb0 netns $SCAN_NS type veth peer name ipkb1 netns $TARGET_NS
+ip -n $SCAN_NS link set lo up
+ip -n $TARGET_NS link set lo up
+ip -n $SCAN_NS addr add 10.99.0.1/24 dev ipkb0
+ip -n $TARGET_NS addr add 10.99.0.2/24 dev ipkb1
+ip -n $SCAN_NS link set ipkb0 up
+ip -n $TARGET_NS link set ipkb1 up
+# The scanned subnet is local to the target, which answers ARP for all of it. The echo requests go through the target
+# as a gateway, so the kernel of the scanner resolves one neighbour instead of the whole subnet.
+ip -n $SCAN_NS route add $SUBNET via 10.99.0.2
+ip -n $TARGET_NS route add local $SUBNET dev lo
+HOSTS=$((1 << (32 - PREFIX)))
+
+echo "cpus: $(nproc), subnet: $SUBNET ($HOSTS addresses), best of $RUNS runs"
+echo "threads  seconds  hosts/s  answered"
+for t in $THREADS; do
+    best=""
+    for run in $(seq "$RUNS"); do
+        # A fresh neighbour table for every run
+        ip -n $SCAN_NS neigh flush dev ipkb0
+        start=$(date +%s.%N)
+        answered=$(ip netns exec $SCAN_NS "$SCANNER" -i ipkb0 -s $SUBNET -w 1000 -n 1 -t "$t" | grep -c "icmpv4 OK" || true)
+        end=$(date +%s.%N)
+        seconds=$(awk "BEGIN { print $end - $start }")
+        if [ -z "$best" ] || awk "BEGIN { exit !($seconds < $best) }"; then
+            best=$seconds
+            best_answered=$answered
+        fi
+    done
+    awk "BEGIN { printf \"%7d  %7.2f  %7.0f  %8d\\n\", $t, $best, $HOSTS / $best, $best_answered }"
+done
@@ -5,7 +5,6 @@
 #include <cstring>
 #include <unistd.h>
 #include <arpa/inet.h>
-#include <linux/if_packet.h>
 
 int create_arp_socket(const string &interface)
 {
@@ -38,16 +37,38 @@ int create_arp_socket(const string &interface)
     return sock;
 }
 
-void send_arp_request(int arp_sock, const string &target_ip, const string &iface_mac,
-                      const string &iface_ip, const ProgramOptions &options)
+bool join_arp_fanout(int sock, uint16_t group)
 {
-    ARPPacket pkt;
+    // Frames are spread round-robin, a reply can be handled by any thread (the host table is shared)
+    int fanout = group | (PACKET_FANOUT_LB << 16);
+    if (setsockopt(sock, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0)
+    {
+        perror("ARP fanout");
+        return false;
+    }
+    return true;
+}
+
+ARPTemplate make_arp_template(const NetworkInterface &iface)
+{
+    ARPTemplate arp{};
+    // Destination of the frame
+    /* SET: the address family to AF_PACKET (packet interface) IPv4
+            the protocol to ETH_P_ARP (ARP protocol)
+            interface index to the index of the specified interface
+            hardware address length to the length of a MAC address (6 bytes)
+    */
+    arp.address.sll_family = AF_PACKET;
+    arp.address.sll_protocol = htons(ETH_P_ARP);
+    arp.address.sll_ifindex = if_nametoindex(iface.name.c_str());
+    arp.address.sll_halen = ETH_ALEN;
 
+    ARPPacket &pkt = arp.frame;
     // Ethernet header
     // Set the destination MAC address to the broadcast address (FF:FF:FF:FF:FF:FF)
     memset(pkt.eth_hdr.ether_dhost, 0xFF, ETH_ALEN); // Broadcast
     // Parsing the interface MAC address string and populate the source MAC address in the Ethernet header
-    sscanf(iface_mac.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+    sscanf(iface.mac.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
            &pkt.eth_hdr.ether_shost[0], &pkt.eth_hdr.ether_shost[1],
            &pkt.eth_hdr.ether_shost[2], &pkt.eth_hdr.ether_shost[3],
            &pkt.eth_hdr.ether_shost[4], &pkt.eth_hdr.ether_shost[5]);
@@ -67,72 +88,69 @@ void send_arp_request(int arp_sock, const string &target_ip, const string &iface
     pkt.arp_pkt.arp_pln = 4;
     pkt.arp_pkt.arp_op = htons(ARPOP_REQUEST);
 
-    // Copy MAC and IP addresses
-    sscanf(iface_mac.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
-           &pkt.arp_pkt.arp_sha[0], &pkt.arp_pkt.arp_sha[1],
-           &pkt.arp_pkt.arp_sha[2], &pkt.arp_pkt.arp_sha[3],
-           &pkt.arp_pkt.arp_sha[4], &pkt.arp_pkt.arp_sha[5]);
-
+    // Sender MAC is the same as the Ethernet source
+    memcpy(pkt.arp_pkt.arp_sha, pkt.eth_hdr.ether_shost, ETH_ALEN);
     // Converting the interface IP address string to a binary IPv4 address and populate the sender protocol address (SPA)
-    inet_pton(AF_INET, iface_ip.c_str(), pkt.arp_pkt.arp_spa);
-    // Set the target hardware address (THA) to all zeros as we don't know it yet
-    memset(pkt.arp_pkt.arp_tha, 0, ETH_ALEN); // Target MAC unknown
-    // Convert the target IP address string to a binary IPv4 address and populate the target protocol address (TPA)
-    inet_pton(AF_INET, target_ip.c_str(), pkt.arp_pkt.arp_tpa);
-
-    // Send packet
-    /* SET: the address family to AF_PACKET (packet interface) IPv4
-            the protocol to ETH_P_ARP (ARP protocol)
-            interface index to the index of the specified interface
-            hardware address length to the length of a MAC address (6 bytes)
-    */
-    struct sockaddr_ll addr{};
-    addr.sll_family = AF_PACKET;
-    addr.sll_protocol = htons(ETH_P_ARP);
-    addr.sll_ifindex = if_nametoindex(options.interface.c_str());
-    addr.sll_halen = ETH_ALEN;
-
-    sendto(arp_sock, &pkt, sizeof(pkt), 0, (struct sockaddr *)&addr, sizeof(addr));
+    inet_pton(AF_INET, iface.ipv4.c_str(), pkt.arp_pkt.arp_spa);
+    // The target hardware address (THA) stays all zeros as we don't know it yet, the target IP is set per probe
+    return arp;
 }
 
-void process_arp_replies(int arp_sock, vector<ARPRequest> &requests)
+void queue_arp_request(SendBatch &batch, const ARPTemplate &arp, const IPAddress &target_ip)
 {
-    // Buffer to store the received packet data
-    unsigned char buffer[ETH_FRAME_LEN];
-    // Structure to store the source address information
-    struct sockaddr_ll src_addr;
-    /// Variable to store the length of the source address structure
-    socklen_t addr_len = sizeof(src_addr);
+    // The frame is copied into the batch buffer (sent later by sendmmsg), only the target changes
+    uint8_t *buffer = batch.add(sizeof(ARPPacket), &arp.address, sizeof(arp.address));
+    if (buffer == nullptr)
+        return;
+    memcpy(buffer, &arp.frame, sizeof(ARPPacket));
+    // Copy the binary target IPv4 address (network byte order) to the target protocol address (TPA)
+    in_addr target = to_in_addr(target_ip);
+    memcpy(reinterpret_cast<ARPPacket *>(buffer)->arp_pkt.arp_tpa, &target, sizeof(target));
+}
 
-    // Receive data from ARP socket
-    ssize_t len = recvfrom(arp_sock, buffer, sizeof(buffer), 0,
-                           (struct sockaddr *)&src_addr, &addr_len);
-    // if no data was received or the packet is smaller than the size of an ARP header, return
-    if (len < sizeof(struct ether_arp))
+/**
+ * @brief Process one received ARP frame
+ * @param buffer Received frame
+ * @param len Length of the frame
+ * @param stamp Kernel receive time of the frame (nullptr if missing)
+ * @param hosts Scan state of the target hosts
+ */
+static void handle_arp_reply(const uint8_t *buffer, size_t len, const timespec *stamp, HostTable &hosts)
+{
+    // if the packet is smaller than the size of an ARP frame, return
+    if (len < sizeof(struct ether_header) + sizeof(struct ether_arp))
         return;
     // Extract the ARP header from the received packet
-    struct ether_arp *arp = (struct ether_arp *)(buffer + sizeof(struct ether_header));
+    const struct ether_arp *arp = (const struct ether_arp *)(buffer + sizeof(struct ether_header));
     // Check if the received ARP operation is a reply
     if (ntohs(arp->arp_op) != ARPOP_REPLY)
         return;
 
-    // Buffer to store the string representation of the sender's IP address
-    char ip_str[INET_ADDRSTRLEN];
-    // Convert the binary IPv4 address to a human-readable string format
-    inet_ntop(AF_INET, arp->arp_spa, ip_str, sizeof(ip_str));
+    // Sender IPv4 address in binary form, used directly as the host table key
+    in_addr sender;
+    memcpy(&sender, arp->arp_spa, sizeof(sender));
+    IPAddress address;
+    address.value = ntohl(sender.s_addr);
 
-    // Iterate through the list of ARP requests
-    for (auto &req : requests)
+    HostState *host = hosts.find(address);
+    // Only a requested host which hasn't responded yet is updated
+    if (host != nullptr && (host->flags & HOST_L2_SENT) && hosts.mark_answered(*host, PROBE_ARP, hosts.received_at(stamp)))
     {
-        // If the IP address in the reply matches a requested IP and the request hasn't been responded to yet
-        if (req.host == ip_str && !req.responded)
-        {
-            char mac[18];
-            snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
-                     arp->arp_sha[0], arp->arp_sha[1], arp->arp_sha[2],
-                     arp->arp_sha[3], arp->arp_sha[4], arp->arp_sha[5]);
-            req.mac = mac;
-            req.responded = true;
-        }
+        memcpy(host->mac, arp->arp_sha, ETH_ALEN);
     }
-}
\ No newline at end of file
+}
+
+void process_arp_replies(int arp_sock, HostTable &hosts, ReceiveBatch &batch)
+{
+    // Receive frames by batches until the socket is drained
+    size_t count;
+    while ((count = batch.receive(arp_sock)) > 0)
+    {
+        for (size_t i = 0; i < count; i++)
+            handle_arp_reply(batch.data(i), batch.length(i), batch.timestamp(i), hosts);
+        // A partial batch means recvmmsg emptied the receive queue (EAGAIN doesn't have to be confirmed),
+        // a datagram arriving later produces a new edge in the event loop
+        if (count < IO_BATCH_SIZE)
+            break;
+    }
+}
@@ -0,0 +1,148 @@
+#include "include/batch_io.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// Ancillary data space of one datagram (only the receive timestamp is expected)
+static const size_t CONTROL_SIZE = CMSG_SPACE(sizeof(timespec));
+
+SendBatch::SendBatch()
+    : buffers(IO_BATCH_SIZE * IO_BUFFER_SIZE), addresses(IO_BATCH_SIZE), iovs(IO_BATCH_SIZE),
+      messages(IO_BATCH_SIZE), count(0)
+{
+    // Message headers point to the fixed buffers, only the lengths change per packet
+    for (size_t i = 0; i < IO_BATCH_SIZE; i++)
+    {
+        iovs[i].iov_base = &buffers[i * IO_BUFFER_SIZE];
+        memset(&messages[i], 0, sizeof(mmsghdr));
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &addresses[i];
+    }
+}
+
+uint8_t *SendBatch::add(size_t length, const void *address, socklen_t address_len)
+{
+    if (count >= IO_BATCH_SIZE || length > IO_BUFFER_SIZE)
+    {
+        return nullptr;
+    }
+    memcpy(&addresses[count], address, address_len);
+    messages[count].msg_hdr.msg_namelen = address_len;
+    iovs[count].iov_len = length;
+    // Not cleared, every probe overwrites the whole packet with its template
+    uint8_t *buffer = &buffers[count * IO_BUFFER_SIZE];
+    count++;
+    return buffer;
+}
+
+size_t SendBatch::size() const
+{
+    return count;
+}
+
+size_t SendBatch::flush(int sock)
+{
+    size_t sent = 0;
+    size_t position = 0;
+    while (position < count)
+    {
+        int rv = sendmmsg(sock, &messages[position], count - position, 0);
+        if (rv < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // sendmmsg fails only on the first packet of the call, skip it and send the rest.
+            // Hosts whose neighbour resolution failed (or is overloaded) just stay unanswered, they aren't reported.
+            if (errno != EHOSTUNREACH && errno != ENOBUFS)
+                perror("sendmmsg");
+            position++;
+            continue;
+        }
+        sent += rv;
+        position += rv;
+    }
+    count = 0;
+    return sent;
+}
+
+ReceiveBatch::ReceiveBatch()
+    : buffers(IO_BATCH_SIZE * IO_BUFFER_SIZE), addresses(IO_BATCH_SIZE), iovs(IO_BATCH_SIZE),
+      messages(IO_BATCH_SIZE), controls(IO_BATCH_SIZE * CONTROL_SIZE), stamps(IO_BATCH_SIZE),
+      has_stamp(IO_BATCH_SIZE, false)
+{
+    for (size_t i = 0; i < IO_BATCH_SIZE; i++)
+    {
+        iovs[i].iov_base = &buffers[i * IO_BUFFER_SIZE];
+        iovs[i].iov_len = IO_BUFFER_SIZE;
+        memset(&messages[i], 0, sizeof(mmsghdr));
+        messages[i].msg_hdr.msg_iov = &iovs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &addresses[i];
+        messages[i].msg_hdr.msg_control = &controls[i * CONTROL_SIZE];
+    }
+}
+
+size_t ReceiveBatch::receive(int sock)
+{
+    // The kernel overwrites the address and control lengths, reset them before every call
+    for (size_t i = 0; i < IO_BATCH_SIZE; i++)
+    {
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        messages[i].msg_hdr.msg_controllen = CONTROL_SIZE;
+    }
+    int rv;
+    do
+    {
+        // MSG_DONTWAIT, so a blocking socket (ARP) is drained the same way as the non-blocking ones
+        rv = recvmmsg(sock, messages.data(), IO_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    } while (rv < 0 && errno == EINTR);
+
+    if (rv < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            perror("recvmmsg");
+        }
+        return 0;
+    }
+
+    // Pick the receive timestamps out of the ancillary data
+    for (int i = 0; i < rv; i++)
+    {
+        has_stamp[i] = false;
+        msghdr &header = messages[i].msg_hdr;
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr; cmsg = CMSG_NXTHDR(&header, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                memcpy(&stamps[i], CMSG_DATA(cmsg), sizeof(timespec));
+                has_stamp[i] = true;
+            }
+        }
+    }
+    return static_cast<size_t>(rv);
+}
+
+const uint8_t *ReceiveBatch::data(size_t index) const
+{
+    return &buffers[index * IO_BUFFER_SIZE];
+}
+
+size_t ReceiveBatch::length(size_t index) const
+{
+    return messages[index].msg_len;
+}
+
+const sockaddr_storage &ReceiveBatch::address(size_t index) const
+{
+    return addresses[index];
+}
+
+const timespec *ReceiveBatch::timestamp(size_t index) const
+{
+    return has_stamp[index] ? &stamps[index] : nullptr;
+}
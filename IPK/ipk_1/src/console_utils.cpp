@@ -1,9 +1,15 @@
 #include "include/console_utils.h"
 #include "include/network_utils.h"
+#include <algorithm>
 #include <getopt.h>
 
 using namespace std;
 
+// Upper bound of the -t option
+static const int MAX_THREADS = 64;
+// Upper bound of the -n option, the attempt counter of a probe is one byte
+static const int MAX_RETRIES = 255;
+
 void print_interfaces(const vector<NetworkInterface> &interfaces)
 {
     cout << "Available Interfaces: " << endl;
@@ -20,6 +26,9 @@ void print_input_arguments(ProgramOptions options)
 {
     cout << "Selected Interface: " << (options.interface.empty() ? "None (list interfaces)" : options.interface) << endl;
     cout << "Timeout: " << options.timeout << " ms" << endl;
+    cout << "Rate: " << (options.rate > 0 ? to_string(options.rate) + " pps" : "unlimited") << endl;
+    cout << "Retries: " << options.retries << endl;
+    cout << "Threads: " << options.threads << endl;
     cout << "Subnets: " << endl;
     for (const string &subnet : options.subnets)
     {
@@ -27,11 +36,11 @@ void print_input_arguments(ProgramOptions options)
     }
 }
 
-void print_scanning_ranges(const vector<string>& subnets) {
+void print_scanning_ranges(const vector<AddressRange>& ranges) {
     cout << "Scanning ranges:\n";
-    for (const auto& subnet : subnets) {
-        auto hosts = expand_subnet(subnet);
-        cout << subnet << " " << hosts.size() << "\n";
+    for (const auto& range : ranges) {
+        // host count is computed from the bounds, hosts are not expanded
+        cout << range.cidr << " " << uint128_to_string(range_size(range)) << "\n";
     }
     cout << endl;
 }
@@ -45,10 +54,13 @@ ProgramOptions parse_arguments(int argc, char *argv[])
         {"interface", required_argument, 0, 'i'},
         {"wait", required_argument, 0, 'w'},
         {"subnets", required_argument, 0, 's'},
+        {"rate", required_argument, 0, 'r'},
+        {"retries", required_argument, 0, 'n'},
+        {"threads", required_argument, 0, 't'},
         {nullptr, 0, nullptr, 0}};
 
     int opt;
-    while ((opt = getopt_long(argc, argv, "i:w:s:", long_options, nullptr)) != -1)
+    while ((opt = getopt_long(argc, argv, "i:w:s:r:n:t:", long_options, nullptr)) != -1)
     {
         switch (opt)
         {
@@ -61,11 +73,33 @@ ProgramOptions parse_arguments(int argc, char *argv[])
         case 's':
             options.subnets.push_back(optarg);
             break;
+        case 'r':
+            options.rate = stoi(optarg);
+            break;
+        case 'n':
+            options.retries = stoi(optarg);
+            if (options.retries < 0)
+            {
+                cerr << "Invalid number of retries: " << optarg << endl;
+                exit(EXIT_FAILURE);
+            }
+            // A larger value would wrap the attempt counter and the probe would never give up
+            options.retries = min(options.retries, MAX_RETRIES);
+            break;
+        case 't':
+            // Each thread gets its own part of the 65536 echo identifiers, MAX_THREADS keeps the parts large
+            options.threads = min(max(stoi(optarg), 1), MAX_THREADS);
+            break;
         default:
-            cerr << "Usage: " << argv[0] << " [-i interface | --interface interface ] {-w timeout | --wait timeout} [-s ipv4-subnet | -s ipv6-subnet | --subnet ipv4-subnet | --subnet ipv6-subnet]" << endl;
+            cerr << "Usage: " << argv[0] << " [-i interface | --interface interface ] {-w timeout | --wait timeout} {-r pps | --rate pps} {-n retries | --retries retries} {-t threads | --threads threads} [-s ipv4-subnet | -s ipv6-subnet | --subnet ipv4-subnet | --subnet ipv6-subnet]" << endl;
             exit(EXIT_FAILURE);
         }
     }
+    // Every thread needs at least 1 pps of the rate, a share of 0 would mean unlimited
+    if (options.rate > 0)
+    {
+        options.threads = min(options.threads, options.rate);
+    }
     return options;
 }
 
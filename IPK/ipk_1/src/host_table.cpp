@@ -0,0 +1,223 @@
+#include "include/host_table.h"
+
+#include <algorithm>
+
+// Lower bound of the retransmission timeout (microseconds), LAN round trips are shorter than scheduling delays
+static const uint32_t MIN_RTO = 20000;
+
+// Host flags of one probe type
+struct ProbeFlags
+{
+    uint8_t sent;
+    uint8_t ok;
+    uint8_t retried;
+    uint8_t done;
+};
+
+/**
+ * @brief Flags of the probe type (ARP and NDP share the L2 flags, a host is either IPv4 or IPv6)
+ */
+static ProbeFlags probe_flags(ProbeType type)
+{
+    if (type == PROBE_ARP || type == PROBE_NDP)
+    {
+        return {HOST_L2_SENT, HOST_L2_OK, HOST_L2_RETRIED, HOST_L2_DONE};
+    }
+    return {HOST_ICMP_SENT, HOST_ICMP_OK, HOST_ICMP_RETRIED, HOST_ICMP_DONE};
+}
+
+/**
+ * @brief Last transmission time of the probe type
+ */
+static atomic<uint32_t> &sent_time(HostState &host, ProbeType type)
+{
+    return type == PROBE_ARP || type == PROBE_NDP ? host.l2_sent : host.icmp_sent;
+}
+
+/**
+ * @brief Round-trip time of the probe type
+ */
+static uint32_t &round_trip(HostState &host, ProbeType type)
+{
+    return type == PROBE_ARP || type == PROBE_NDP ? host.l2_rtt : host.icmp_rtt;
+}
+
+/**
+ * @brief Current CLOCK_REALTIME in microseconds (the clock of SO_TIMESTAMPNS)
+ */
+static int64_t realtime_usec()
+{
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+HostTable::HostTable(const vector<AddressRange> &ranges, uint32_t max_rto)
+    : start(chrono::steady_clock::now()),
+      realtime_start(realtime_usec()),
+      max_rtt(max_rto),
+      pending_probes(0),
+      estimators(4, RttEstimator(max_rto, min(MIN_RTO, max_rto), max_rto))
+{
+    // Collect IPv4 ranges sorted by the first address
+    vector<pair<uint32_t, uint32_t>> bounds;
+    for (const auto &range : ranges)
+    {
+        if (!range.is_ipv6 && !range.empty)
+        {
+            bounds.push_back({static_cast<uint32_t>(range.first), static_cast<uint32_t>(range.last)});
+        }
+    }
+    sort(bounds.begin(), bounds.end());
+
+    // Merge overlapping and adjacent ranges, so each address has exactly one slot
+    size_t offset = 0;
+    for (const auto &bound : bounds)
+    {
+        if (!ipv4_blocks.empty() && static_cast<uint64_t>(bound.first) <= static_cast<uint64_t>(ipv4_blocks.back().last) + 1)
+        {
+            IPv4Block &block = ipv4_blocks.back();
+            if (bound.second > block.last)
+            {
+                offset += bound.second - block.last;
+                block.last = bound.second;
+            }
+            continue;
+        }
+        ipv4_blocks.push_back({bound.first, bound.second, offset});
+        offset += static_cast<size_t>(bound.second - bound.first) + 1;
+    }
+    // HostState holds atomics (not movable), so the array is constructed at its final size
+    ipv4_hosts = vector<HostState>(offset);
+}
+
+HostState *HostTable::find(const IPAddress &address)
+{
+    if (address.is_ipv6)
+    {
+        auto it = ipv6_hosts.find(address.value);
+        return it == ipv6_hosts.end() ? nullptr : &it->second;
+    }
+
+    uint32_t ip = static_cast<uint32_t>(address.value);
+    // Last block starting at or before the address (there are only as many blocks as subnets)
+    auto it = upper_bound(ipv4_blocks.begin(), ipv4_blocks.end(), ip,
+                          [](uint32_t value, const IPv4Block &block)
+                          { return value < block.first; });
+    if (it == ipv4_blocks.begin())
+    {
+        return nullptr;
+    }
+    --it;
+    if (ip > it->last)
+    {
+        return nullptr;
+    }
+    return &ipv4_hosts[it->offset + (ip - it->first)];
+}
+
+HostState &HostTable::at(const IPAddress &address)
+{
+    if (address.is_ipv6)
+    {
+        return ipv6_hosts[address.value];
+    }
+    return *find(address);
+}
+
+uint32_t HostTable::now() const
+{
+    // Wraps after about 71 minutes, only differences of close times are used
+    return static_cast<uint32_t>(
+        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count());
+}
+
+uint32_t HostTable::rtt_clock() const
+{
+    // Wraps like the scan clock, only the difference of a transmission and its reply is used
+    return static_cast<uint32_t>(realtime_usec() - realtime_start);
+}
+
+uint32_t HostTable::received_at(const timespec *stamp) const
+{
+    if (stamp == nullptr)
+    {
+        return rtt_clock();
+    }
+    int64_t usec = static_cast<int64_t>(stamp->tv_sec) * 1000000 + stamp->tv_nsec / 1000;
+    return static_cast<uint32_t>(usec - realtime_start);
+}
+
+void HostTable::mark_sent(HostState &host, const Probe &probe)
+{
+    ProbeFlags flags = probe_flags(probe.type);
+    // The time is stored before the flag, a thread which sees the flag sees the time
+    // Send and receive times come from the same clock as the kernel receive timestamps
+    sent_time(host, probe.type).store(rtt_clock(), memory_order_relaxed);
+    uint8_t previous = host.flags.fetch_or(probe.attempt > 0 ? flags.sent | flags.retried : flags.sent);
+    // Overlapping subnets probe the same host twice, it is pending only once
+    if (!(previous & flags.sent))
+    {
+        pending_probes++;
+    }
+}
+
+void HostTable::mark_transmitted(HostState &host, ProbeType type, uint32_t sent)
+{
+    sent_time(host, type).store(sent, memory_order_relaxed);
+}
+
+bool HostTable::mark_answered(HostState &host, ProbeType type, uint32_t received)
+{
+    ProbeFlags flags = probe_flags(type);
+    // Only the thread which sets the flag records the reply
+    uint8_t previous = host.flags.fetch_or(flags.ok);
+    if (previous & flags.ok)
+    {
+        return false;
+    }
+    // A late reply after giving up was already removed from the pending probes
+    if (!(previous & flags.done))
+    {
+        pending_probes--;
+    }
+    // A system time step backwards during the flight of the probe puts the reply before the send time
+    int32_t rtt = static_cast<int32_t>(received - sent_time(host, type).load(memory_order_relaxed));
+    round_trip(host, type) = rtt > 0 ? static_cast<uint32_t>(rtt) : 0;
+    // The reply of a retransmitted probe may belong to any of its transmissions, so it isn't sampled,
+    // neither is an RTT the timeout would never wait for (a forward step, or a late reply after giving up)
+    if (!(previous & flags.retried) && rtt >= 0 && static_cast<uint32_t>(rtt) <= max_rtt)
+    {
+        lock_guard<mutex> lock(estimators_lock);
+        estimators[type].sample(round_trip(host, type));
+    }
+    return true;
+}
+
+void HostTable::give_up(HostState &host, ProbeType type)
+{
+    ProbeFlags flags = probe_flags(type);
+    // A reply handled by another thread at the same time wins, the probe leaves the pending ones only once
+    uint8_t previous = host.flags.fetch_or(flags.done);
+    if (!(previous & (flags.ok | flags.done)))
+    {
+        pending_probes--;
+    }
+}
+
+bool HostTable::is_settled(const HostState &host, ProbeType type)
+{
+    ProbeFlags flags = probe_flags(type);
+    return (host.flags & (flags.ok | flags.done)) != 0;
+}
+
+size_t HostTable::pending() const
+{
+    return pending_probes;
+}
+
+uint32_t HostTable::rto(ProbeType type) const
+{
+    lock_guard<mutex> lock(estimators_lock);
+    return estimators[type].rto();
+}
@@ -1,8 +1,55 @@
 #include "include/icmp.h"
 #include <arpa/inet.h>
 #include <netinet/ip_icmp.h>
+#include <linux/filter.h>
 #include <unistd.h>
-#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <random>
+
+// Identifier, sequence number and probe index in the echo request template (zero until a probe sets them)
+static const uint16_t TEMPLATE_WORDS[4] = {};
+
+EchoIdentity make_echo_identity()
+{
+    // Random instead of the process ID, so two scanners (or ping) don't share the identifier range
+    random_device random;
+    EchoIdentity identity;
+    identity.id_base = static_cast<uint16_t>(random());
+    identity.cookie = static_cast<uint32_t>(random());
+    return identity;
+}
+
+EchoIdentity split_echo_identity(const EchoIdentity &identity, size_t part, size_t parts)
+{
+    EchoIdentity split = identity;
+    split.id_count = identity.id_count / static_cast<uint32_t>(parts);
+    split.id_base = static_cast<uint16_t>(identity.id_base + part * split.id_count);
+    return split;
+}
+
+void echo_fields(const EchoIdentity &identity, uint32_t index, uint16_t &id, uint16_t &sequence)
+{
+    id = static_cast<uint16_t>(identity.id_base + (index >> 16));
+    sequence = static_cast<uint16_t>(index & 0xFFFF);
+}
+
+bool match_echo_reply(const EchoIdentity &identity, uint16_t id, uint16_t sequence, const uint8_t *payload, size_t len,
+                      uint32_t &index)
+{
+    // The payload is echoed back, it must hold our cookie and the probe index
+    if (len < sizeof(EchoPayload))
+        return false;
+    EchoPayload echoed;
+    memcpy(&echoed, payload, sizeof(echoed));
+    if (echoed.cookie != identity.cookie)
+        return false;
+    index = ntohl(echoed.index);
+    // Identifier and sequence number have to agree with the index
+    uint16_t expected_id, expected_sequence;
+    echo_fields(identity, index, expected_id, expected_sequence);
+    return id == expected_id && sequence == expected_sequence;
+}
 
 int create_icmp_socket()
 {
@@ -21,74 +68,129 @@ int create_icmp_socket()
     return sock;
 }
 
-void send_icmp_request(int sock, const string &host, uint16_t sequence)
+bool attach_echo_filter(int sock, const EchoIdentity &identity)
 {
-    // Structure to store the destination address information
-    sockaddr_in dest_addr{};
+    // The raw socket filter sees the packet from the IP header
+    sock_filter code[] = {
+        BPF_STMT(BPF_LDX | BPF_B | BPF_MSH, 0),                  // X = IP header length
+        BPF_STMT(BPF_LD | BPF_B | BPF_IND, 0),                   // A = ICMP type
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, ICMP_ECHOREPLY, 0, 5), // not an echo reply: drop
+        BPF_STMT(BPF_LD | BPF_H | BPF_IND, 4),                   // A = identifier
+        BPF_STMT(BPF_ALU | BPF_SUB | BPF_K, identity.id_base),   // A = (identifier - id_base) mod 2^16
+        BPF_STMT(BPF_ALU | BPF_AND | BPF_K, 0xFFFF),
+        BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, identity.id_count, 1, 0), // outside the range: drop
+        BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF),                   // accept the whole packet
+        BPF_STMT(BPF_RET | BPF_K, 0),                            // drop
+    };
+    sock_fprog program{static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+    if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) < 0)
+    {
+        perror("ICMP filter");
+        return false;
+    }
+    return true;
+}
+
+ICMPTemplate make_icmp_template(const EchoIdentity &identity)
+{
+    ICMPTemplate icmp{};
     // Set the address family to AF_INET (IPv4)
-    dest_addr.sin_family = AF_INET;
-    // Convert the target IP address string to a binary IPv4 address and populate the destination address structure
-    inet_pton(AF_INET, host.c_str(), &dest_addr.sin_addr);
-
-    // ICMP header
-    // Create an ICMP packet structure
-    icmphdr packet{};
-    packet.type = ICMP_ECHO;                   // Set the ICMP type to ECHO request
-    packet.code = 0;                           // Set the ICMP code to 0 (default)
-    packet.un.echo.id = htons(getpid());       // Set the ICMP identifier to the process ID
-    packet.un.echo.sequence = htons(sequence); // Set the ICMP sequence number to the provided sequence value
+    icmp.address.sin_family = AF_INET;
+
+    icmphdr &packet = *reinterpret_cast<icmphdr *>(icmp.packet);
+    packet.type = ICMP_ECHO; // Set the ICMP type to ECHO request
+    packet.code = 0;         // Set the ICMP code to 0 (default)
+    // Identifier, sequence number and probe index stay zero, only the cookie is in the payload
+    EchoPayload payload{identity.cookie, 0};
+    memcpy(icmp.packet + sizeof(icmphdr), &payload, sizeof(payload));
     packet.checksum = 0;
-    packet.checksum = compute_checksum_ipv4(&packet, sizeof(packet)); // showcase of checksum calculation (nowadays it is done by the kernel)
+    packet.checksum = compute_checksum_ipv4(icmp.packet, ECHO_REQUEST_SIZE); // showcase of checksum calculation (nowadays it is done by the kernel)
+    return icmp;
+}
 
-    // Send the ICMP echo request packet to the specified host
-    if (sendto(sock, &packet, sizeof(packet), 0,
-               (sockaddr *)&dest_addr, sizeof(dest_addr)) < 0)
-    {
-        perror(("sendto " + host).c_str());
+void queue_icmp_request(SendBatch &batch, const ICMPTemplate &icmp, const IPAddress &host,
+                        const EchoIdentity &identity, uint32_t index)
+{
+    sockaddr_in dest_addr = icmp.address;
+    // Binary target IPv4 address in network byte order
+    dest_addr.sin_addr = to_in_addr(host);
+
+    // The packet is copied into the batch buffer (sent later by sendmmsg)
+    uint8_t *buffer = batch.add(ECHO_REQUEST_SIZE, &dest_addr, sizeof(dest_addr));
+    if (buffer == nullptr)
         return;
-    }
+    memcpy(buffer, icmp.packet, ECHO_REQUEST_SIZE);
+    icmphdr &packet = *reinterpret_cast<icmphdr *>(buffer);
+    uint16_t id, sequence;
+    echo_fields(identity, index, id, sequence);
+    // Identifier, sequence number and probe index are patched as four 16-bit words, they were zero in the template
+    uint32_t index_field = htonl(index);
+    uint16_t words[4] = {htons(id), htons(sequence)};
+    memcpy(&words[2], &index_field, sizeof(index_field));
+    memcpy(&packet.un.echo, words, 2 * sizeof(uint16_t));
+    memcpy(buffer + sizeof(icmphdr) + offsetof(EchoPayload, index), &words[2], 2 * sizeof(uint16_t));
+    // The checksum is updated instead of recomputed over the whole packet
+    packet.checksum = update_checksum(packet.checksum, TEMPLATE_WORDS, words, 4);
 }
 
-void process_icmp_replies(int sock, vector<ICMPRequest> &requests)
+/**
+ * @brief Process one received ICMP packet
+ * @param buf Received packet (with the IP header)
+ * @param len Length of the packet
+ * @param recv_addr Source address of the packet
+ * @param stamp Kernel receive time of the packet (nullptr if missing)
+ * @param hosts Scan state of the target hosts
+ * @param identity Identity of this scanner instance
+ */
+static void handle_icmp_reply(const uint8_t *buf, size_t len, const sockaddr_in &recv_addr, const timespec *stamp,
+                              HostTable &hosts, const EchoIdentity &identity)
 {
-    // Buffer to store the received packet data
-    uint8_t buf[1024];
-    // Structure to store the source address information
-    sockaddr_in recv_addr{};
-    // Variable to store the length of the source address structure
-    socklen_t addr_len = sizeof(recv_addr);
-
-    // Receive data from ICMP socket
-    ssize_t len = recvfrom(sock, buf, sizeof(buf), 0, (sockaddr *)&recv_addr, &addr_len);
-    // If no data is received or error occurs, return
-    if (len <= 0)
+    // If the packet can't hold the IP header, return
+    if (len < sizeof(ip))
         return;
-
     // Casting the received buffer to an IP header structure to access the IP header fields
-    ip *ip_hdr = (ip *)buf;
+    const ip *ip_hdr = (const ip *)buf;
     // Calculating the start of the ICMP header within the received buffer, by skipping the IP header
     // ip_hl is the IP header length in 32-bit words, so we multiply by 4 to get bytes.
-    icmphdr *icmp_hdr = (icmphdr *)(buf + (ip_hdr->ip_hl << 2));
+    size_t ip_len = ip_hdr->ip_hl << 2;
+    if (len < ip_len + sizeof(icmphdr))
+        return;
+    const icmphdr *icmp_hdr = (const icmphdr *)(buf + ip_len);
 
     // Check if the received packet is an ICMP ECHO reply
     if (icmp_hdr->type != ICMP_ECHOREPLY)
         return;
 
-    // Convert the source IP address to a human-readable format
-    char ip_str[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &recv_addr.sin_addr, ip_str, sizeof(ip_str));
-    // Get the sequence number from the received ICMP reply (in host byte order)
-    uint16_t recv_seq = ntohs(icmp_hdr->un.echo.sequence);
-    // Find the corresponding ICMP request in the list of requests
-    auto it = find_if(requests.begin(), requests.end(),
-                      [recv_seq](const ICMPRequest &req)
-                      { return req.sequence_number == recv_seq; });
-    // If a matching request is found (it is not the end iterator)
-    if (it != requests.end())
+    // The reply must answer a request of this instance (cookie, identifier and sequence number)
+    uint32_t index;
+    const uint8_t *payload = buf + ip_len + sizeof(icmphdr);
+    if (!match_echo_reply(identity, ntohs(icmp_hdr->un.echo.id), ntohs(icmp_hdr->un.echo.sequence), payload,
+                          len - ip_len - sizeof(icmphdr), index))
+        return;
+
+    // Source address in binary form (host byte order) is the host table key
+    IPAddress address;
+    address.value = ntohl(recv_addr.sin_addr.s_addr);
+    HostState *host = hosts.find(address);
+    // The reply must come from the host the probe was sent to
+    if (host != nullptr && (host->flags & HOST_ICMP_SENT) && host->echo_index == index)
+    {
+        hosts.mark_answered(*host, PROBE_ICMP, hosts.received_at(stamp));
+    }
+}
+
+void process_icmp_replies(int sock, HostTable &hosts, ReceiveBatch &batch, const EchoIdentity &identity)
+{
+    // Receive packets by batches until the socket is drained
+    size_t count;
+    while ((count = batch.receive(sock)) > 0)
     {
-        // Calculating the round-trip time (RTT) by subtracting the sent time from the current time
-        auto rtt = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - it->sent_time);
-        // Remove the processed request from the vector
-        requests.erase(it);
+        for (size_t i = 0; i < count; i++)
+            handle_icmp_reply(batch.data(i), batch.length(i),
+                              reinterpret_cast<const sockaddr_in &>(batch.address(i)), batch.timestamp(i), hosts,
+                              identity);
+        // A partial batch means the receive queue was emptied
+        if (count < IO_BATCH_SIZE)
+            break;
     }
 }
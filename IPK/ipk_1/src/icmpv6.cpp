@@ -3,7 +3,8 @@
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <netinet/icmp6.h>
-#include <algorithm>
+#include <cstddef>
+#include <cstring>
 
 int create_icmpv6_socket()
 {
@@ -22,63 +23,86 @@ int create_icmpv6_socket()
     return sock;
 }
 
-void send_icmpv6_request(int sock, const string &host, uint16_t seq)
+ICMPv6Template make_icmpv6_template(const EchoIdentity &identity)
 {
-    // Structure to store the destination address information
-    struct sockaddr_in6 dest_addr{};
+    ICMPv6Template icmpv6{};
     // Set the address family to AF_INET6 (IPv6)
-    dest_addr.sin6_family = AF_INET6;
-    // Convert the target IP address string to a binary IPv6 address and populate the destination address structure
-    inet_pton(AF_INET6, host.c_str(), &dest_addr.sin6_addr);
+    icmpv6.address.sin6_family = AF_INET6;
 
-    // ICMPv6 header
-    // Create an ICMPv6 packet structure
-    icmp6_hdr packet{};
+    icmp6_hdr &packet = *reinterpret_cast<icmp6_hdr *>(icmpv6.packet);
     packet.icmp6_type = ICMP6_ECHO_REQUEST; // Set the ICMPv6 type to ECHO request
     packet.icmp6_code = 0;                  // Set the ICMPv6 code to 0 (default)
-    packet.icmp6_id = htons(getpid());      // Set the ICMPv6 identifier to the process ID
-    packet.icmp6_seq = htons(seq);          // Set the ICMPv6 sequence number to the provided sequence value
     packet.icmp6_cksum = 0;                 // Kernel fills it in
-    // Send the ICMPv6 echo request packet to the specified host
-    if (sendto(sock, &packet, sizeof(packet), 0, (sockaddr *)&dest_addr, sizeof(dest_addr)) < 0)
-    {
-        perror(("sendto " + host).c_str());
-        return;
-    }
+    // Payload identifying this scanner instance, the probe index is set per probe
+    EchoPayload payload{identity.cookie, 0};
+    memcpy(icmpv6.packet + sizeof(icmp6_hdr), &payload, sizeof(payload));
+    return icmpv6;
 }
 
-void process_icmpv6_replies(int sock, vector<ICMPRequest> &requests)
+void queue_icmpv6_request(SendBatch &batch, const ICMPv6Template &icmpv6, const IPAddress &host,
+                          const EchoIdentity &identity, uint32_t index)
 {
-    // Basically the same as process_icmp_replies, but for ICMPv6
-    // Buffer to store the received packet data
-    uint8_t buf[1024];
-    // Structure to store the source address information
-    sockaddr_in6 src_addr{};
-    // Variable to store the length of the source address structure
-    socklen_t addr_len = sizeof(src_addr);
-    // Receive data from ICMPv6 socket
-    ssize_t len = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *)&src_addr, &addr_len);
-    if (len < static_cast<ssize_t>(sizeof(icmp6_hdr)))
+    sockaddr_in6 dest_addr = icmpv6.address;
+    // Binary target IPv6 address in network byte order
+    dest_addr.sin6_addr = to_in6_addr(host);
+
+    // The packet is copied into the batch buffer (sent later by sendmmsg)
+    uint8_t *buffer = batch.add(ECHO_REQUEST_SIZE, &dest_addr, sizeof(dest_addr));
+    if (buffer == nullptr)
         return;
+    memcpy(buffer, icmpv6.packet, ECHO_REQUEST_SIZE);
+    icmp6_hdr &packet = *reinterpret_cast<icmp6_hdr *>(buffer);
+    uint16_t id, seq;
+    echo_fields(identity, index, id, seq);
+    packet.icmp6_id = htons(id);   // Set the ICMPv6 identifier derived from the probe index
+    packet.icmp6_seq = htons(seq); // Set the ICMPv6 sequence number derived from the probe index
+    uint32_t index_field = htonl(index);
+    memcpy(buffer + sizeof(icmp6_hdr) + offsetof(EchoPayload, index), &index_field, sizeof(index_field));
+}
+
+/**
+ * @brief Process one received ICMPv6 packet
+ * @param buf Received packet (raw ICMPv6 sockets don't include the IPv6 header)
+ * @param len Length of the packet
+ * @param src_addr Source address of the packet
+ * @param stamp Kernel receive time of the packet (nullptr if missing)
+ * @param hosts Scan state of the target hosts
+ * @param identity Identity of this scanner instance
+ */
+static void handle_icmpv6_reply(const uint8_t *buf, size_t len, const sockaddr_in6 &src_addr, const timespec *stamp,
+                                HostTable &hosts, const EchoIdentity &identity)
+{
     // Ensure packet is large enough
-    icmp6_hdr *icmp6 = reinterpret_cast<icmp6_hdr *>(buf);
+    if (len < sizeof(icmp6_hdr))
+        return;
+    const icmp6_hdr *icmp6 = reinterpret_cast<const icmp6_hdr *>(buf);
     // Check if the received packet is an ICMPv6 ECHO reply
     if (icmp6->icmp6_type != ICMP6_ECHO_REPLY)
         return;
-    // Convert the source IP address to a human-readable format
-    char ip_str[INET6_ADDRSTRLEN];
-    inet_ntop(AF_INET6, &src_addr.sin6_addr, ip_str, sizeof(ip_str));
-    // Extract the sequence number from the ICMPv6 packet
-    uint16_t seq = ntohs(icmp6->icmp6_seq);
-    // Find the corresponding ICMPv6 request in the list of requests
-    auto it = find_if(requests.begin(), requests.end(),
-                      [seq, &ip_str](const ICMPRequest &r)
-                      {
-                          return r.sequence_number == seq && r.host == ip_str;
-                      });
+    // The reply must answer a request of this instance (cookie, identifier and sequence number)
+    uint32_t index;
+    if (!match_echo_reply(identity, ntohs(icmp6->icmp6_id), ntohs(icmp6->icmp6_seq), buf + sizeof(icmp6_hdr),
+                          len - sizeof(icmp6_hdr), index))
+        return;
+    // Find the probed host by its binary source address and check the probe index sent to it
+    HostState *host = hosts.find(from_in6_addr(src_addr.sin6_addr));
+    if (host != nullptr && (host->flags & HOST_ICMP_SENT) && host->echo_index == index)
+    {
+        hosts.mark_answered(*host, PROBE_ICMPV6, hosts.received_at(stamp));
+    }
+}
 
-    if (it != requests.end())
+void process_icmpv6_replies(int sock, HostTable &hosts, ReceiveBatch &batch, const EchoIdentity &identity)
+{
+    // Basically the same as process_icmp_replies, but for ICMPv6
+    size_t count;
+    while ((count = batch.receive(sock)) > 0)
     {
-        requests.erase(it);
+        for (size_t i = 0; i < count; i++)
+            handle_icmpv6_reply(batch.data(i), batch.length(i),
+                                reinterpret_cast<const sockaddr_in6 &>(batch.address(i)), batch.timestamp(i), hosts,
+                                identity);
+        if (count < IO_BATCH_SIZE)
+            break;
     }
 }
@@ -2,8 +2,11 @@
 
 #define ARP_H
 
+#include "batch_io.h"
 #include "console_utils.h"
+#include "host_table.h"
 
+#include <linux/if_packet.h>
 #include <net/ethernet.h>
 #include <netinet/if_ether.h>
 #include <chrono>
@@ -18,12 +21,11 @@ struct ARPPacket
     struct ether_arp arp_pkt;    // ARP header
 };
 
-struct ARPRequest
+// ARP request of the scanning interface built once, a probe only sets the target address
+struct ARPTemplate
 {
-    string host;                                // IP address
-    chrono::steady_clock::time_point sent_time; // Time when the request was sent
-    bool responded = false;                     // Whether a response was received
-    string mac;                                 // MAC address of the host
+    ARPPacket frame;     // broadcast request with the interface MAC and IPv4 address, target zeroed
+    sockaddr_ll address; // destination of the frame (interface index, ARP protocol)
 };
 
 /**
@@ -34,20 +36,35 @@ struct ARPRequest
 int create_arp_socket(const string &interface);
 
 /**
- * @brief Send an ARP request to the target IP address
- * @param arp_sock File descriptor of the ARP socket
- * @param target_ip IP address to send the request to
- * @param iface_mac MAC address of the interface
- * @param iface_ip IP address of the interface
- * @param options Program options
+ * @brief Add the ARP socket to a PACKET_FANOUT group, each received frame is delivered to one socket of the group
+ * Used by the scan threads, so every ARP reply is parsed once instead of once per thread.
+ * @param sock File descriptor of the ARP socket
+ * @param group Fanout group ID (the same for all sockets of one scan)
+ * @return False if the socket couldn't join the group
+ */
+bool join_arp_fanout(int sock, uint16_t group);
+
+/**
+ * @brief Build the ARP request template of the interface (MAC and IP strings are parsed only here)
+ * @param iface Scanning interface
+ * @return Template for queue_arp_request
+ */
+ARPTemplate make_arp_template(const NetworkInterface &iface);
+
+/**
+ * @brief Build an ARP request to the target IP address in the send batch of the ARP socket
+ * @param batch Send batch of the ARP socket
+ * @param arp Template of the interface
+ * @param target_ip IPv4 address to send the request to
  */
-void send_arp_request(int arp_sock, const string &target_ip, const string &iface_mac, const string &iface_ip, const ProgramOptions &options);
+void queue_arp_request(SendBatch &batch, const ARPTemplate &arp, const IPAddress &target_ip);
 
 /**
- * @brief Process ARP replies received on the ARP socket
+ * @brief Process all ARP replies waiting on the ARP socket (received by recvmmsg until the socket is drained)
  * @param arp_sock File descriptor of the ARP socket
- * @param requests Vector of ARP requests
+ * @param hosts Scan state of the target hosts
+ * @param batch Receive buffers
  */
-void process_arp_replies(int arp_sock, vector<ARPRequest> &requests);
+void process_arp_replies(int arp_sock, HostTable &hosts, ReceiveBatch &batch);
 
 #endif // ARP_H
\ No newline at end of file
@@ -0,0 +1,107 @@
+#ifndef BATCH_IO_H
+
+#define BATCH_IO_H
+
+#include <sys/socket.h>
+#include <ctime>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Maximum number of datagrams passed to one sendmmsg / recvmmsg call
+const size_t IO_BATCH_SIZE = 64;
+// Size of one preallocated packet buffer (fits a whole Ethernet frame)
+const size_t IO_BUFFER_SIZE = 1536;
+
+/**
+ * @brief Preallocated outgoing packets of one socket, sent together by one sendmmsg call
+ * Probes are copied from their templates directly into the batch buffers, nothing is allocated per packet.
+ */
+class SendBatch
+{
+public:
+    SendBatch();
+
+    /**
+     * @brief Reserve the buffer of the next packet
+     * @param length Length of the packet (at most IO_BUFFER_SIZE)
+     * @param address Destination address (copied into the batch)
+     * @param address_len Length of the destination address
+     * @return Buffer where the whole packet is written (not cleared), nullptr when the batch is full
+     */
+    uint8_t *add(size_t length, const void *address, socklen_t address_len);
+
+    /**
+     * @brief Number of queued packets
+     */
+    size_t size() const;
+
+    /**
+     * @brief Send all queued packets and empty the batch
+     * A packet which fails to send is skipped, the rest of the batch is still sent.
+     * @param sock Socket to send on
+     * @return Number of packets sent
+     */
+    size_t flush(int sock);
+
+private:
+    vector<uint8_t> buffers;            // IO_BATCH_SIZE packet buffers
+    vector<sockaddr_storage> addresses; // destination of each packet
+    vector<iovec> iovs;                 // one iovec per packet
+    vector<mmsghdr> messages;           // sendmmsg vector
+    size_t count;                       // number of queued packets
+};
+
+/**
+ * @brief Preallocated buffers for receiving up to IO_BATCH_SIZE datagrams by one recvmmsg call
+ */
+class ReceiveBatch
+{
+public:
+    ReceiveBatch();
+
+    /**
+     * @brief Receive the datagrams waiting on the socket without blocking
+     * @param sock Socket to read from
+     * @return Number of received datagrams, 0 when the socket is drained (EAGAIN) or on error
+     */
+    size_t receive(int sock);
+
+    /**
+     * @brief Data of a received datagram
+     * @param index Index of the datagram (less than the value returned by receive)
+     */
+    const uint8_t *data(size_t index) const;
+
+    /**
+     * @brief Length of a received datagram
+     * @param index Index of the datagram
+     */
+    size_t length(size_t index) const;
+
+    /**
+     * @brief Source address of a received datagram
+     * @param index Index of the datagram
+     */
+    const sockaddr_storage &address(size_t index) const;
+
+    /**
+     * @brief Kernel receive time of a datagram (SO_TIMESTAMPNS has to be enabled on the socket)
+     * @param index Index of the datagram
+     * @return Receive time (CLOCK_REALTIME), nullptr if the datagram carries no timestamp
+     */
+    const timespec *timestamp(size_t index) const;
+
+private:
+    vector<uint8_t> buffers;            // IO_BATCH_SIZE receive buffers
+    vector<sockaddr_storage> addresses; // source of each datagram
+    vector<iovec> iovs;                 // one iovec per datagram
+    vector<mmsghdr> messages;           // recvmmsg vector
+    vector<uint8_t> controls;           // ancillary data buffer of each datagram
+    vector<timespec> stamps;            // receive time of each datagram
+    vector<bool> has_stamp;             // datagram carried SCM_TIMESTAMPNS
+};
+
+#endif // BATCH_IO_H
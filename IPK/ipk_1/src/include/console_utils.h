@@ -13,7 +13,10 @@ using namespace std;
 struct ProgramOptions
 {
     string interface = "";  // -i Network interface (default: empty)
-    int timeout = 5000;     // -w Timeout in milliseconds (default: 5000)
+    int timeout = 5000;     // -w Maximum wait for a reply to one probe in milliseconds (default: 5000)
+    int rate = 0;           // -r Send rate in packets per second (default: 0 = unlimited)
+    int retries = 2;        // -n Retransmissions of an unanswered probe (default: 2)
+    int threads = 1;        // -t Number of scan threads (default: 1)
     vector<string> subnets; // -s List of subnets to scan
 };
 
@@ -32,9 +35,9 @@ void print_input_arguments(ProgramOptions options);
 
 /**
  * @brief Print the scanning ranges
- * @param subnets List of subnets
+ * @param ranges List of parsed subnets
  */
-void print_scanning_ranges(const vector<string>& subnets);
+void print_scanning_ranges(const vector<AddressRange>& ranges);
 
 
 /**
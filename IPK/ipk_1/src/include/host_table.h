@@ -0,0 +1,180 @@
+#ifndef HOST_TABLE_H
+
+#define HOST_TABLE_H
+
+#include "network_utils.h"
+#include "scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Flags of HostState
+enum HostFlags : uint8_t
+{
+    HOST_L2_SENT = 0x01,   // ARP / NDP request was sent
+    HOST_L2_OK = 0x02,     // ARP / NDP reply was received
+    HOST_ICMP_SENT = 0x04, // ICMP / ICMPv6 echo request was sent
+    HOST_ICMP_OK = 0x08,   // ICMP / ICMPv6 echo reply was received
+    HOST_L2_RETRIED = 0x10,   // ARP / NDP request was retransmitted (no RTT sample is taken)
+    HOST_ICMP_RETRIED = 0x20, // ICMP / ICMPv6 echo request was retransmitted
+    HOST_L2_DONE = 0x40,      // ARP / NDP retries ran out without a reply
+    HOST_ICMP_DONE = 0x80,    // ICMP / ICMPv6 retries ran out without a reply
+};
+
+// Compact scan state of one target host
+// A reply may be handled by another scan thread than the one which sent the probe, so the fields written by the
+// sender are atomic. MAC and RTT are written only by the thread which set the OK flag and read after the scan.
+struct HostState
+{
+    atomic<uint8_t> flags{0};       // HostFlags
+    uint8_t mac[6] = {};            // MAC address from the ARP / NDP reply
+    atomic<uint32_t> echo_index{0}; // probe index of the echo request sent to the host (see EchoIdentity)
+    atomic<uint32_t> l2_sent{0};    // last ARP / NDP transmission (microseconds of the RTT clock)
+    atomic<uint32_t> icmp_sent{0};  // last echo request transmission (microseconds of the RTT clock)
+    uint32_t l2_rtt = 0;            // ARP / NDP round-trip time in microseconds (valid with HOST_L2_OK)
+    uint32_t icmp_rtt = 0;          // echo round-trip time in microseconds (valid with HOST_ICMP_OK)
+};
+
+// Hash of a 128-bit IPv6 address (the two halves are mixed, the low half alone is often sequential)
+struct Uint128Hash
+{
+    size_t operator()(uint128 value) const
+    {
+        uint64_t low = static_cast<uint64_t>(value);
+        uint64_t high = static_cast<uint64_t>(value >> 64);
+        return static_cast<size_t>((low ^ (high * 0x9E3779B97F4A7C15ULL)) * 0xBF58476D1CE4E5B9ULL);
+    }
+};
+
+/**
+ * @brief Scan state of all target hosts indexed by binary address
+ * IPv4 hosts are stored in one array indexed directly by the position of the address inside its range,
+ * IPv6 hosts in a hash table (IPv6 ranges are too large to preallocate). Lookup is O(1) per reply.
+ * The IPv4 state is shared by all scan threads without locks (flags are set by atomic fetch_or, exactly one thread
+ * sees a probe become answered or given up). The IPv6 table is not synchronized, it is used by one thread only.
+ */
+class HostTable
+{
+public:
+    /**
+     * @brief Preallocate the IPv4 state of all ranges (overlapping IPv4 subnets share the state)
+     * @param ranges Scanned address ranges
+     * @param max_rto Upper bound of the retransmission timeout in microseconds, also used before the first RTT sample
+     */
+    HostTable(const vector<AddressRange> &ranges, uint32_t max_rto);
+
+    /**
+     * @brief Find the state of a target host
+     * @param address Host address
+     * @return Host state, nullptr if the address is not scanned (or no IPv6 probe was sent to it yet)
+     */
+    HostState *find(const IPAddress &address);
+
+    /**
+     * @brief State of a target host, IPv6 entries are created on the first access
+     * @param address Host address (must belong to one of the ranges)
+     * @return Host state
+     */
+    HostState &at(const IPAddress &address);
+
+    /**
+     * @brief Current time of the scan clock (steady, used for retransmission deadlines)
+     * @return Microseconds since the table was created
+     */
+    uint32_t now() const;
+
+    /**
+     * @brief Convert a kernel receive timestamp to the RTT clock
+     * The RTT clock is CLOCK_REALTIME like the kernel timestamps, so a step or slew of the system time between
+     * the start of the scan and a reply does not change the RTT (only one during the flight of the probe does).
+     * @param stamp Receive time (CLOCK_REALTIME), nullptr when the datagram had none
+     * @return Microseconds of CLOCK_REALTIME since the table was created (the current time without a timestamp)
+     */
+    uint32_t received_at(const timespec *stamp) const;
+
+    /**
+     * @brief Record a transmission of a probe (the first one makes the probe pending)
+     * The send time is provisionally the current time, mark_transmitted replaces it once the probe's batch is sent.
+     * @param host State of the probed host
+     * @param probe Sent probe
+     */
+    void mark_sent(HostState &host, const Probe &probe);
+
+    /**
+     * @brief Record the time a queued probe was handed to the kernel (after the sendmmsg of its batch returned)
+     * A reply handled by another thread before this call is measured from the provisional time of mark_sent.
+     * @param host State of the probed host
+     * @param type Type of the sent probe
+     * @param sent RTT clock after the send call (see rtt_clock)
+     */
+    void mark_transmitted(HostState &host, ProbeType type, uint32_t sent);
+
+    /**
+     * @brief Current time of the RTT clock (microseconds of CLOCK_REALTIME since the table was created)
+     */
+    uint32_t rtt_clock() const;
+
+    /**
+     * @brief Record a matched reply and its round-trip time, a probe which was not retransmitted gives an RTT sample
+     * The RTT of a retransmitted probe is measured from its last transmission. An RTT outside of 0 to max_rto
+     * (a system time step during the flight of the probe, or a reply after giving up) is not sampled.
+     * @param host State of the host which replied
+     * @param type Type of the answered probe
+     * @param received RTT clock of the reply (see received_at)
+     * @return False if the probe was already answered
+     */
+    bool mark_answered(HostState &host, ProbeType type, uint32_t received);
+
+    /**
+     * @brief Stop waiting for a probe whose retries ran out (a late reply is still accepted)
+     * @param host State of the probed host
+     * @param type Type of the probe
+     */
+    void give_up(HostState &host, ProbeType type);
+
+    /**
+     * @brief Check if a probe was answered or given up
+     * @param host State of the probed host
+     * @param type Type of the probe
+     */
+    static bool is_settled(const HostState &host, ProbeType type);
+
+    /**
+     * @brief Number of sent probes which are neither answered nor given up
+     */
+    size_t pending() const;
+
+    /**
+     * @brief Retransmission timeout estimated from the replies to probes of one type
+     * @param type Probe type (ARP / NDP / ICMP / ICMPv6 replies have different delays)
+     * @return Timeout in microseconds
+     */
+    uint32_t rto(ProbeType type) const;
+
+private:
+    // Merged IPv4 range with its offset in the state array
+    struct IPv4Block
+    {
+        uint32_t first;
+        uint32_t last;
+        size_t offset;
+    };
+
+    vector<IPv4Block> ipv4_blocks;                        // sorted by first address, non-overlapping
+    vector<HostState> ipv4_hosts;                         // direct-indexed IPv4 state
+    unordered_map<uint128, HostState, Uint128Hash> ipv6_hosts; // IPv6 state by address
+    chrono::steady_clock::time_point start;                    // start of the scan clock
+    int64_t realtime_start;                                    // CLOCK_REALTIME at the start (microseconds)
+    uint32_t max_rtt;                                          // longest RTT sample accepted by the estimators
+    atomic<size_t> pending_probes;                             // sent, not answered, not given up
+    vector<RttEstimator> estimators;                           // one per ProbeType
+    mutable mutex estimators_lock;                             // samples may come from several threads
+};
+
+#endif // HOST_TABLE_H
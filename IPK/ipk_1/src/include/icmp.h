@@ -2,20 +2,81 @@
 
 #define ICMP_H
 
+#include "batch_io.h"
 #include "network_utils.h"
-#include <chrono>
+#include "host_table.h"
+
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
 
 using namespace std;
 
-// Structure representing an ICMP request
-struct ICMPRequest
+// Identity of this scanner instance in echo requests (ICMP and ICMPv6 count their probes separately)
+struct EchoIdentity
+{
+    uint16_t id_base = 0;        // echo identifier of the first 65536 probes, +1 for every next 65536
+    uint32_t id_count = 0x10000; // identifiers from id_base which belong to this identity
+    uint32_t cookie = 0;         // random value carried in the payload of every echo request
+    uint32_t next_ipv4 = 0;      // index of the next ICMP echo request
+    uint32_t next_ipv6 = 0;      // index of the next ICMPv6 echo request
+};
+
+// Payload of an echo request, the reply carries it back unchanged
+struct EchoPayload
 {
-    string host;                                // Targer Host - IP address
-    uint16_t sequence_number;                   // Sequence number of tracking replies
-    chrono::steady_clock::time_point sent_time; // Time when the request was sent
-    bool is_ipv6 = false;                       // Whether the request is for IPv6
+    uint32_t cookie; // EchoIdentity::cookie
+    uint32_t index;  // probe index (network byte order)
 };
 
+// Length of an echo request (ICMP or ICMPv6 header, both 8 bytes, and the payload)
+const size_t ECHO_REQUEST_SIZE = sizeof(icmphdr) + sizeof(EchoPayload);
+
+// ICMP echo request built once, a probe sets the identifier, sequence number and index and updates the checksum
+struct ICMPTemplate
+{
+    uint8_t packet[ECHO_REQUEST_SIZE]; // request with the cookie, the per-probe fields zeroed and their checksum
+    sockaddr_in address;               // destination (the address is set per probe)
+};
+
+/**
+ * @brief Create a random identity of this scanner instance
+ * @return Identity with both probe counters at zero
+ */
+EchoIdentity make_echo_identity();
+
+/**
+ * @brief Identity of one scan thread, the identifiers of the scanner are split into equal disjoint parts
+ * @param identity Identity of the scanner instance
+ * @param part Index of the scan thread
+ * @param parts Number of scan threads (at most 65536)
+ * @return Identity with the same cookie and its own identifier range
+ */
+EchoIdentity split_echo_identity(const EchoIdentity &identity, size_t part, size_t parts);
+
+/**
+ * @brief Echo identifier and sequence number of a probe
+ * The 32-bit probe index is split into the identifier (id_base + high half) and the sequence number (low half),
+ * so more than 65535 probes never reuse an identifier / sequence pair.
+ * @param identity Identity of this scanner instance
+ * @param index Probe index
+ * @param id Output identifier (host byte order)
+ * @param sequence Output sequence number (host byte order)
+ */
+void echo_fields(const EchoIdentity &identity, uint32_t index, uint16_t &id, uint16_t &sequence);
+
+/**
+ * @brief Check that an echo reply answers a request of this scanner instance
+ * @param identity Identity of this scanner instance
+ * @param id Identifier of the reply (host byte order)
+ * @param sequence Sequence number of the reply (host byte order)
+ * @param payload Payload of the reply
+ * @param len Length of the payload
+ * @param index Output probe index of the request
+ * @return False if the cookie, identifier or sequence number doesn't belong to this instance
+ */
+bool match_echo_reply(const EchoIdentity &identity, uint16_t id, uint16_t sequence, const uint8_t *payload, size_t len,
+                      uint32_t &index);
+
 /**
  * @brief Create an ICMP socket
  * @return File descriptor of the ICMP socket
@@ -23,18 +84,40 @@ struct ICMPRequest
 int create_icmp_socket();
 
 /**
- * @brief Send an ICMP request to the target IP address
+ * @brief Let only the echo replies to one identity through a raw ICMP socket (classic BPF on the identifier)
+ * Every raw ICMP socket gets a copy of every ICMP packet, the filter drops the replies of other scan threads
+ * (and of other programs) in the kernel.
  * @param sock File descriptor of the ICMP socket
- * @param host IP address to send the request to
- * @param sequence ICMP sequence number
+ * @param identity Identity whose identifier range is accepted
+ * @return False if the filter couldn't be attached (the replies are then matched in user space only)
+ */
+bool attach_echo_filter(int sock, const EchoIdentity &identity);
+
+/**
+ * @brief Build the ICMP echo request template of the scanner instance
+ * @param identity Identity of the scanner instance (only the cookie is used, it is the same in all scan threads)
+ * @return Template for queue_icmp_request
+ */
+ICMPTemplate make_icmp_template(const EchoIdentity &identity);
+
+/**
+ * @brief Build an ICMP echo request to the target IP address in the send batch of the ICMP socket
+ * @param batch Send batch of the ICMP socket
+ * @param icmp Template of the scanner instance
+ * @param host IPv4 address to send the request to
+ * @param identity Identity of the scan thread
+ * @param index Probe index (identifier, sequence number and payload are derived from it)
  */
-void send_icmp_request(int sock, const string &host, uint16_t sequence);
+void queue_icmp_request(SendBatch &batch, const ICMPTemplate &icmp, const IPAddress &host,
+                        const EchoIdentity &identity, uint32_t index);
 
 /**
- * @brief Process ICMP replies received on the ICMP socket
+ * @brief Process all ICMP replies waiting on the ICMP socket (received by recvmmsg until the socket is drained)
  * @param sock File descriptor of the ICMP socket
- * @param requests Vector of ICMP requests
+ * @param hosts Scan state of the target hosts
+ * @param batch Receive buffers
+ * @param identity Identity of this scanner instance (replies to other programs are ignored)
  */
-void process_icmp_replies(int sock, vector<ICMPRequest> &requests);
+void process_icmp_replies(int sock, HostTable &hosts, ReceiveBatch &batch, const EchoIdentity &identity);
 
 #endif // ICMP_H
\ No newline at end of file
@@ -2,7 +2,14 @@
 
 #define ICMPV6_H
 
-#include "icmp.h" // import ICMPRequest
+#include "icmp.h" // import HostTable
+
+// ICMPv6 echo request built once, a probe sets the identifier, sequence number and index (the kernel computes the checksum)
+struct ICMPv6Template
+{
+    uint8_t packet[ECHO_REQUEST_SIZE]; // request with the cookie, the per-probe fields zeroed
+    sockaddr_in6 address;              // destination (the address is set per probe)
+};
 
 /**
  * @brief Create an ICMPv6 socket
@@ -11,18 +18,30 @@
 int create_icmpv6_socket();
 
 /**
- * @brief Send an ICMPv6 request to the target IP address
- * @param sock File descriptor of the ICMPv6 socket
- * @param host IP address to send the request to
- * @param seq ICMP sequence number
+ * @brief Build the ICMPv6 echo request template of the scanner instance
+ * @param identity Identity of the scanner instance (only the cookie is used)
+ * @return Template for queue_icmpv6_request
+ */
+ICMPv6Template make_icmpv6_template(const EchoIdentity &identity);
+
+/**
+ * @brief Build an ICMPv6 echo request to the target IP address in the send batch of the ICMPv6 socket
+ * @param batch Send batch of the ICMPv6 socket
+ * @param icmpv6 Template of the scanner instance
+ * @param host IPv6 address to send the request to
+ * @param identity Identity of the scan thread
+ * @param index Probe index (counted separately from ICMP)
  */
-void send_icmpv6_request(int sock, const string &host, uint16_t seq);
+void queue_icmpv6_request(SendBatch &batch, const ICMPv6Template &icmpv6, const IPAddress &host,
+                          const EchoIdentity &identity, uint32_t index);
 
 /**
- * @brief Process ICMPv6 replies received on the ICMPv6 socket
+ * @brief Process all ICMPv6 replies waiting on the ICMPv6 socket (received by recvmmsg until the socket is drained)
  * @param sock File descriptor of the ICMPv6 socket
- * @param requests Vector of ICMPv6 requests
+ * @param hosts Scan state of the target hosts
+ * @param batch Receive buffers
+ * @param identity Identity of this scanner instance (replies to other programs are ignored)
  */
-void process_icmpv6_replies(int sock, vector<ICMPRequest> &requests);
+void process_icmpv6_replies(int sock, HostTable &hosts, ReceiveBatch &batch, const EchoIdentity &identity);
 
 #endif // ICMPV6_H
\ No newline at end of file
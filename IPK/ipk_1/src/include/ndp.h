@@ -2,21 +2,24 @@
 
 #define NDP_H
 
+#include "batch_io.h"
 #include "console_utils.h"
+#include "host_table.h"
 
+#include <netinet/icmp6.h>
 #include <chrono>
 #include <string>
 
 using namespace std;
 
+// Length of a neighbor solicitation: ICMPv6 header, target address and the source link-layer option
+const size_t NDP_REQUEST_SIZE = sizeof(icmp6_hdr) + 16 + 8;
 
-// Structure for NDP requests (IPv6 equivalent of ARP)
-struct NDPRequest
+// Neighbor solicitation of the scanning interface built once, a probe only sets the target address
+struct NDPTemplate
 {
-    string host;                                // IP address
-    chrono::steady_clock::time_point sent_time; // Time when the request was sent
-    bool responded = false;                     // Whether a response was received
-    string mac;                                 // MAC address of the host
+    uint8_t message[NDP_REQUEST_SIZE]; // solicitation with the interface MAC option, target zeroed
+    sockaddr_in6 address;              // destination (the address is set per probe)
 };
 
 /**
@@ -26,20 +29,26 @@ struct NDPRequest
 int create_ndp_socket();
 
 /**
- * @brief Send an NDP request to the target IP address
- * @param sock File descriptor of the NDP socket
- * @param target_ip IP address to send the request to
- * @param iface_mac MAC address of the interface
- * @param iface_ip IP address of the interface
- * @param options Program options
+ * @brief Build the neighbor solicitation template of the interface (the MAC string is parsed only here)
+ * @param iface Scanning interface
+ * @return Template for queue_ndp_request
+ */
+NDPTemplate make_ndp_template(const NetworkInterface &iface);
+
+/**
+ * @brief Build an NDP neighbor solicitation for the target IP address in the send batch of the NDP socket
+ * @param batch Send batch of the NDP socket
+ * @param ndp Template of the interface
+ * @param target_ip IPv6 address to send the request to
  */
-void send_ndp_request(int sock, const string &target_ip, const string &iface_mac, const string &iface_ip, const ProgramOptions &options);
+void queue_ndp_request(SendBatch &batch, const NDPTemplate &ndp, const IPAddress &target_ip);
 
 /**
- * @brief Process NDP replies received on the NDP socket
+ * @brief Process all NDP replies waiting on the NDP socket (received by recvmmsg until the socket is drained)
  * @param sock File descriptor of the NDP socket
- * @param requests Vector of NDP requests
+ * @param hosts Scan state of the target hosts
+ * @param batch Receive buffers
  */
-void process_ndp_replies(int sock, vector<NDPRequest> &requests);
+void process_ndp_replies(int sock, HostTable &hosts, ReceiveBatch &batch);
 
 #endif // NDP_H
\ No newline at end of file
@@ -5,9 +5,54 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <netinet/in.h>
 
 using namespace std;
 
+// 128-bit unsigned integer used for IPv6 address arithmetic (IPv4 uses only the low 32 bits)
+typedef unsigned __int128 uint128;
+
+// Binary IP address (IPv4 in host byte order in the low 32 bits, IPv6 as a 128-bit number)
+struct IPAddress
+{
+    bool is_ipv6 = false;
+    uint128 value = 0;
+};
+
+// Inclusive range of host addresses of one subnet, iterated lazily by AddressCursor
+struct AddressRange
+{
+    string cidr;          // Subnet as given on the command line
+    bool is_ipv6 = false; // Address family of the range
+    bool empty = true;    // True for invalid subnets and subnets without usable hosts
+    uint128 first = 0;    // First host address
+    uint128 last = 0;     // Last host address
+};
+
+// Cursor over an AddressRange, keeps only the current position (O(1) memory per range)
+class AddressCursor
+{
+public:
+    /**
+     * @brief Create a cursor positioned before the first host of the range
+     * @param range Range to iterate
+     */
+    explicit AddressCursor(const AddressRange &range);
+
+    /**
+     * @brief Move to the next host address
+     * @param address Output address
+     * @return False when the range is exhausted
+     */
+    bool next(IPAddress &address);
+
+private:
+    bool is_ipv6;
+    bool done;
+    uint128 current;
+    uint128 last;
+};
+
 // Structure representing a network interface
 struct NetworkInterface
 {
@@ -32,6 +77,16 @@ bool is_valid_interface(const string &iface_name, const vector<NetworkInterface>
  */
 uint16_t compute_checksum_ipv4(void *buf, int len);
 
+/**
+ * @brief Update an Internet checksum after 16-bit words of the packet changed (RFC 1624, eqn. 3)
+ * @param checksum Checksum of the packet with the old words
+ * @param old_words Previous values of the words (as stored in the packet)
+ * @param new_words New values of the words (as stored in the packet)
+ * @param count Number of changed words
+ * @return Checksum of the packet with the new words
+ */
+uint16_t update_checksum(uint16_t checksum, const uint16_t *old_words, const uint16_t *new_words, size_t count);
+
 /**
  * @brief get the vecotr of active network interfaces
  * @return vector of active network interfaces
@@ -39,10 +94,52 @@ uint16_t compute_checksum_ipv4(void *buf, int len);
 vector<NetworkInterface> get_active_interfaces();
 
 /**
- * @brief Expand a CIDR notation subnet to a list(vector) of IP addresses
+ * @brief Parse a CIDR notation subnet into a range of host addresses (no address is materialised)
  * @param cidr CIDR notation subnet
- * @return List(vector) of IP addresses in the subnet
+ * @return Range of host addresses, empty if the subnet is invalid
+ */
+AddressRange parse_subnet(const string &cidr);
+
+/**
+ * @brief Number of host addresses in a range
+ * @param range Address range
+ * @return Number of hosts (0 for an empty range)
+ */
+uint128 range_size(const AddressRange &range);
+
+/**
+ * @brief Convert a 128-bit number to its decimal representation
+ * @param value Number to convert
+ * @return Decimal string
+ */
+string uint128_to_string(uint128 value);
+
+/**
+ * @brief Convert a binary IPv4 address to the socket representation
+ * @param address IPv4 address
+ * @return Address in network byte order
+ */
+in_addr to_in_addr(const IPAddress &address);
+
+/**
+ * @brief Convert a binary IPv6 address to the socket representation
+ * @param address IPv6 address
+ * @return Address in network byte order
+ */
+in6_addr to_in6_addr(const IPAddress &address);
+
+/**
+ * @brief Convert a socket IPv6 address to the binary representation
+ * @param addr Address in network byte order
+ * @return IPv6 address
+ */
+IPAddress from_in6_addr(const in6_addr &addr);
+
+/**
+ * @brief Convert a binary address to a human readable string (only used for output)
+ * @param address IPv4 or IPv6 address
+ * @return Address string
  */
-vector<string> expand_subnet(const string &cidr);
+string address_to_string(const IPAddress &address);
 
 #endif // NETWORK_UTILS_H
\ No newline at end of file
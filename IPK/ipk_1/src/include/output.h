@@ -7,17 +7,11 @@
 #include "ndp.h"
 
 /**
- * @brief Print the output of the program
- * @param ipv4_hosts List of IPv4 hosts
- * @param ipv6_hosts List of IPv6 hosts
- * @param arp_requests List of ARP requests
- * @param icmp_requests List of ICMP requests
- * @param ndp_requests List of NDP requests
- * @param iface_mac MAC address of the interface
- * @param iface_ipv4 IPv4 address of the interface
- * @param iface_ipv6 IPv6 address of the interface
+ * @brief Print the output of the program (result and round-trip times of every host, then an RTT summary)
+ * @param ranges Scanned address ranges (IPv4 hosts are printed first, then IPv6 hosts)
+ * @param hosts Scan state of the target hosts
+ * @param iface Scanning interface (MAC, IPv4 and IPv6 address)
  */
-void print_output(vector<string> &ipv4_hosts, vector<string> &ipv6_hosts, vector<ARPRequest> &arp_requests, vector<ICMPRequest> &icmp_requests, vector<NDPRequest> &ndp_requests,
-                  NetworkInterface &iface);
+void print_output(const vector<AddressRange> &ranges, HostTable &hosts, NetworkInterface &iface);
 
 #endif // OUTPUT_H
\ No newline at end of file
@@ -6,20 +6,94 @@
 #include "icmp.h"
 #include "icmpv6.h"
 #include "ndp.h"
+#include "scheduler.h"
+
+#include <atomic>
+
+// Sockets used by the scan
+struct ScanSockets
+{
+    int arp;    // ARP raw packet socket
+    int icmp;   // ICMP socket
+    int icmpv6; // ICMPv6 socket
+    int ndp;    // NDP (ICMPv6) socket
+};
+
+// Part of the scan handled by one thread
+struct ScanWorker
+{
+    ScanSockets sockets;         // sockets of the thread (NDP and ICMPv6 are -1 except in the first thread)
+    vector<AddressRange> ranges; // targets of the thread (see split_ranges)
+    EchoIdentity echo;           // identity of the thread's echo requests (see split_echo_identity)
+};
+
+// Probe templates of the scan, built once before the scan threads start and only read by them
+struct ProbeTemplates
+{
+    ARPTemplate arp;
+    NDPTemplate ndp;
+    ICMPTemplate icmp;
+    ICMPv6Template icmpv6;
+};
+
+// Outgoing batches of the scan, one per socket (sendmmsg sends to a single socket)
+struct SendBatches
+{
+    SendBatch arp;
+    SendBatch icmp;
+    SendBatch icmpv6;
+    SendBatch ndp;
+};
+
+/**
+ * @brief Build the probe templates (the interface strings are parsed only here)
+ * @param iface Scanning interface
+ * @param echo Identity of the scanner instance
+ * @return Templates of all probe types
+ */
+ProbeTemplates make_probe_templates(const NetworkInterface &iface, const EchoIdentity &echo);
+
+/**
+ * @brief Build one probe in the send batch of its socket and record the transmission in the host table
+ * @param batches Send batches of the scan
+ * @param probe Probe to send
+ * @param hosts Scan state of the target hosts
+ * @param templates Probe templates of the scan
+ * @param echo Identity of the scanner, its probe counters advance with first echo requests (retransmissions reuse
+ *             the host's probe index)
+ * @return State of the probed host, its send time is recorded by HostTable::mark_transmitted after the batch is sent
+ */
+HostState &queue_probe(SendBatches &batches, const Probe &probe, HostTable &hosts, const ProbeTemplates &templates,
+                 EchoIdentity &echo);
+
+/**
+ * @brief Send the probes of one scan thread paced by the token bucket and process replies in the same loop
+ * Sending is interleaved with draining the receive sockets, so replies are read while the scan is still sending
+ * and socket buffers don't overflow on large ranges. Probes are sent by sendmmsg (one call per socket and batch),
+ * replies are read by recvmmsg until the socket is drained.
+ * Every probe has its own deadline: a probe without a reply within the retransmission timeout (estimated from the
+ * RTT of the probe type, at most the -w timeout) is sent again up to 'retries' times. The scan ends as soon as
+ * every probe is answered or out of retries.
+ * A thread which finished its own probes keeps reading until all threads are finished, its sockets may receive
+ * replies to the probes of the others (ARP fanout).
+ * @param worker Sockets, targets and echo identity of the thread
+ * @param hosts Scan state of all target hosts (shared by the threads)
+ * @param templates Probe templates of the scan
+ * @param options Program options (rate, retries)
+ * @param sending Number of threads which still have probes to generate
+ */
+void run_scan(ScanWorker &worker, HostTable &hosts, const ProbeTemplates &templates, const ProgramOptions &options,
+              atomic<size_t> &sending);
 
 /**
- * @brief Poll the sockets for incoming packets
- * @param arp_sock File descriptor of the ARP socket
- * @param icmp_sock File descriptor of the ICMP socket
- * @param icmpv6_sock File descriptor of the ICMPv6 socket
- * @param ndp_sock File descriptor of the NDP socket
- * @param arp_requests Vector of ARP requests
- * @param icmp_requests Vector of ICMP requests
- * @param ndp_requests Vector of NDP requests
- * @param timeout Timeout in milliseconds
+ * @brief Run the scan threads and wait until all of them finish (the first one runs on the calling thread)
+ * The -r rate is divided between the threads.
+ * @param workers Scan threads
+ * @param hosts Scan state of all target hosts
+ * @param templates Probe templates of the scan
+ * @param options Program options
  */
-void poll_sockets(int arp_sock, int icmp_sock, int icmpv6_sock, int ndp_sock,
-                  vector<ARPRequest> &arp_requests, vector<ICMPRequest> &icmp_requests,
-                  vector<NDPRequest> &ndp_requests, int timeout);
+void run_workers(vector<ScanWorker> &workers, HostTable &hosts, const ProbeTemplates &templates,
+                 const ProgramOptions &options);
 
-#endif // POLLING_H
\ No newline at end of file
+#endif // POLLING_H
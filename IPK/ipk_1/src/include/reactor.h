@@ -0,0 +1,60 @@
+#ifndef REACTOR_H
+
+#define REACTOR_H
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Edge-triggered epoll event loop with one timer
+ * Sockets are registered once with a read handler. The handler is called once per readiness edge,
+ * so it must read the socket until EAGAIN. Deadlines are kept in a timerfd, which is watched by the same epoll.
+ */
+class Reactor
+{
+public:
+    /**
+     * @brief Create the epoll instance and the timer (check is_valid afterwards)
+     */
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor &) = delete;
+    Reactor &operator=(const Reactor &) = delete;
+
+    /**
+     * @brief Check if the epoll instance and the timer were created
+     */
+    bool is_valid() const;
+
+    /**
+     * @brief Register a non-blocking socket for reading
+     * @param fd Socket (must be non-blocking, it is drained by the handler)
+     * @param on_readable Called when new data arrives on the socket
+     * @return False if the socket couldn't be registered
+     */
+    bool watch(int fd, function<void()> on_readable);
+
+    /**
+     * @brief Arm the timer, a previously armed timer is replaced
+     * @param delay Time until the timer expires (zero expires immediately)
+     */
+    void schedule(chrono::microseconds delay);
+
+    /**
+     * @brief Wait until a socket is readable or the timer expires and call the handlers of all ready sockets
+     * @param block False only handles the sockets which are ready now and returns immediately
+     * @return False on an epoll error
+     */
+    bool dispatch(bool block = true);
+
+private:
+    int epoll_fd;                      // epoll instance
+    int timer_fd;                      // one-shot deadline timer
+    vector<function<void()>> handlers; // read handlers indexed by the epoll event data
+};
+
+#endif // REACTOR_H
@@ -0,0 +1,155 @@
+#ifndef SCHEDULER_H
+
+#define SCHEDULER_H
+
+#include "network_utils.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Kind of probe sent to a host
+enum ProbeType
+{
+    PROBE_ARP,
+    PROBE_NDP,
+    PROBE_ICMP,
+    PROBE_ICMPV6,
+};
+
+// One probe waiting to be sent
+struct Probe
+{
+    ProbeType type;
+    IPAddress address;
+    uint8_t attempt = 0; // 0 for the first transmission, then the retry number
+};
+
+/**
+ * @brief Lazy queue of all probes of a scan
+ * Probes are generated in the order ARP (IPv4 hosts), NDP (IPv6 hosts), ICMP (IPv4 hosts), ICMPv6 (IPv6 hosts),
+ * only the current phase, range and cursor are stored.
+ */
+class ProbeQueue
+{
+public:
+    /**
+     * @brief Create a queue over the scanned ranges
+     * @param ranges Scanned address ranges (must outlive the queue)
+     */
+    explicit ProbeQueue(const vector<AddressRange> &ranges);
+
+    /**
+     * @brief Take the next probe
+     * @param probe Output probe
+     * @return False when all probes were taken
+     */
+    bool next(Probe &probe);
+
+    /**
+     * @brief Check if all probes were taken
+     */
+    bool empty() const;
+
+private:
+    /**
+     * @brief Move to the next range (and phase) which has a host of the current phase's family
+     */
+    void advance();
+
+    const vector<AddressRange> &ranges;
+    int phase;            // index of ProbeType, 4 when finished
+    size_t range_index;   // range of the current phase
+    AddressCursor cursor; // position in the current range
+    bool has_next;        // probe stored in 'pending' is valid
+    Probe pending;        // next probe (taken one step ahead, so empty() is exact)
+};
+
+/**
+ * @brief Split the scanned ranges between scan threads
+ * IPv4 hosts are cut into contiguous parts of (nearly) equal size, one per thread. IPv6 ranges all go to the first
+ * part, the IPv6 host table is used by a single thread.
+ * @param ranges Scanned address ranges
+ * @param parts Number of scan threads
+ * @return Ranges of each thread
+ */
+vector<vector<AddressRange>> split_ranges(const vector<AddressRange> &ranges, size_t parts);
+
+/**
+ * @brief Token bucket limiting the send rate
+ * Tokens are refilled continuously at 'rate' per second up to 'burst', one token pays for one probe.
+ */
+class TokenBucket
+{
+public:
+    /**
+     * @brief Create a full bucket
+     * @param rate Packets per second (0 = unlimited)
+     * @param burst Maximum number of probes sent at once
+     */
+    TokenBucket(int rate, size_t burst);
+
+    /**
+     * @brief Take up to 'wanted' tokens
+     * @param now Current time
+     * @return Number of probes which may be sent now
+     */
+    size_t take(size_t wanted, chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Time until the next token is available
+     * @param now Current time
+     * @return Zero if a token is available (always zero when unlimited)
+     */
+    chrono::microseconds wait_time(chrono::steady_clock::time_point now);
+
+private:
+    /**
+     * @brief Add tokens for the time elapsed since the last refill
+     */
+    void refill(chrono::steady_clock::time_point now);
+
+    double rate;
+    double burst;
+    double tokens;
+    chrono::steady_clock::time_point last_refill;
+};
+
+/**
+ * @brief Retransmission timeout estimated from RTT samples (SRTT / RTTVAR as in RFC 6298)
+ * All times are in microseconds.
+ */
+class RttEstimator
+{
+public:
+    /**
+     * @brief Create an estimator without samples
+     * @param initial_rto Timeout used until the first sample
+     * @param min_rto Lower bound of the timeout
+     * @param max_rto Upper bound of the timeout
+     */
+    RttEstimator(uint32_t initial_rto, uint32_t min_rto, uint32_t max_rto);
+
+    /**
+     * @brief Add a round-trip time measured on a probe which was not retransmitted (Karn's algorithm)
+     * @param rtt Measured round-trip time
+     */
+    void sample(uint32_t rtt);
+
+    /**
+     * @brief Current retransmission timeout
+     */
+    uint32_t rto() const;
+
+private:
+    bool has_sample;
+    double srtt;   // smoothed round-trip time
+    double rttvar; // round-trip time variation
+    uint32_t current;
+    uint32_t min_rto;
+    uint32_t max_rto;
+};
+
+#endif // SCHEDULER_H
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <netinet/in.h>
 #include <fcntl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 int main(int argc, char *argv[])
@@ -18,7 +19,14 @@ int main(int argc, char *argv[])
     ProgramOptions options = parse_arguments(argc, argv);
     // Print input arguments or default values (useful for debugging)
     // print_input_arguments(options);
-    print_scanning_ranges(options.subnets);
+
+    // Parse subnets into address ranges, hosts are generated lazily while sending and printing
+    vector<AddressRange> ranges;
+    for (const auto &subnet : options.subnets)
+    {
+        ranges.push_back(parse_subnet(subnet));
+    }
+    print_scanning_ranges(ranges);
 
     // Get active network interfaces
     vector<NetworkInterface> interfaces = get_active_interfaces();
@@ -32,44 +40,55 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
-    // split subnets into IPv4 and IPv6 lists
-    vector<string> ipv4_hosts, ipv6_hosts;
-    // Expand subnets into individual host addresses
-    for (const auto &subnet : options.subnets)
-    {
-        auto hosts = expand_subnet(subnet);
-        for (const auto &host : hosts)
-        {
-            if (host.find(':') == string::npos)
-            {
-                ipv4_hosts.push_back(host);
-            }
-            else
-            {
-                ipv6_hosts.push_back(host);
-            }
-        }
-    }
+    // Scan threads (-t): the IPv4 hosts are split between them, each thread has its own ARP and ICMP socket
+    size_t thread_count = static_cast<size_t>(options.threads);
+    vector<vector<AddressRange>> parts = split_ranges(ranges, thread_count);
+    EchoIdentity echo = make_echo_identity();
+    vector<ScanWorker> workers(thread_count);
 
     // Create sockets
-    // IPv4
-    int arp_sock = create_arp_socket(options.interface);
-    int icmp_sock = create_icmp_socket();
-    // IPv6
+    // IPv6 (only the first thread scans IPv6)
     int ndp_sock = create_ndp_socket();
     int icmpv6_sock = create_icmpv6_socket();
-
-    // check if sockets were created successfully
-    if (icmp_sock < 0 || icmpv6_sock < 0 || ndp_sock < 0 || arp_sock < 0)
+    // ARP sockets of all threads share one fanout group, each reply is received by one thread
+    uint16_t fanout_group = static_cast<uint16_t>(getpid());
+    for (size_t i = 0; i < thread_count; i++)
     {
-        print_socket_error(arp_sock, icmp_sock, ndp_sock, icmpv6_sock);
-        return EXIT_FAILURE;
+        ScanWorker &worker = workers[i];
+        worker.ranges = parts[i];
+        worker.echo = split_echo_identity(echo, i, thread_count);
+        // IPv4
+        int arp_sock = create_arp_socket(options.interface);
+        int icmp_sock = create_icmp_socket();
+        worker.sockets = {arp_sock, icmp_sock, i == 0 ? icmpv6_sock : -1, i == 0 ? ndp_sock : -1};
+
+        // check if sockets were created successfully
+        if (icmp_sock < 0 || icmpv6_sock < 0 || ndp_sock < 0 || arp_sock < 0)
+        {
+            print_socket_error(arp_sock, icmp_sock, ndp_sock, icmpv6_sock);
+            return EXIT_FAILURE;
+        }
+        // the ICMP socket of a thread only receives the replies to its own echo requests
+        attach_echo_filter(icmp_sock, worker.echo);
+        if (thread_count > 1 && !join_arp_fanout(arp_sock, fanout_group))
+        {
+            return EXIT_FAILURE;
+        }
     }
 
-    // configure sockets (non-blocking, TTL/hop-limit)
-    fcntl(icmp_sock, F_SETFL, O_NONBLOCK);
-    fcntl(icmpv6_sock, F_SETFL, O_NONBLOCK);
-    fcntl(ndp_sock, F_SETFL, O_NONBLOCK);
+    // configure sockets (non-blocking, TTL/hop-limit), the edge-triggered event loop reads each socket until EAGAIN
+    // kernel receive timestamps, so the RTT doesn't include the wakeup of the scanner
+    int enable = 1;
+    for (const auto &worker : workers)
+    {
+        for (int sock : {worker.sockets.arp, worker.sockets.icmp, worker.sockets.icmpv6, worker.sockets.ndp})
+        {
+            if (sock < 0)
+                continue;
+            fcntl(sock, F_SETFL, O_NONBLOCK);
+            setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+        }
+    }
 
     NetworkInterface selected_interface;
 
@@ -82,46 +101,23 @@ int main(int argc, char *argv[])
             break;
         }
     }
-    // Vectors to store the requests senf for each protocol
-    vector<ARPRequest> arp_requests;
-    vector<NDPRequest> ndp_requests;
-    vector<ICMPRequest> icmp_requests;
+    // Scan state of every target host indexed by binary address, -w bounds the wait for one reply
+    HostTable hosts(ranges, static_cast<uint32_t>(options.timeout) * 1000);
 
-    uint16_t sequence = 1;
-
-    // send ARP requests
-    for (const auto &host : ipv4_hosts)
-    {
-        send_arp_request(arp_sock, host, selected_interface.mac, selected_interface.ipv4, options);
-        arp_requests.push_back({host, chrono::steady_clock::now()});
-    }
-    // send NDP requests
-    for (const auto &host : ipv6_hosts)
-    {
-        send_ndp_request(ndp_sock, host, selected_interface.mac, selected_interface.ipv6, options);
-        ndp_requests.push_back({host, chrono::steady_clock::now()});
-    }
-    // send ICMP requests
-    for (const auto &host : ipv4_hosts)
-    {
-        send_icmp_request(icmp_sock, host, sequence);
-        icmp_requests.push_back({host, sequence++, chrono::steady_clock::now(), false});
-    }
-    // send ICMPv6 requests
-    for (const auto &host : ipv6_hosts)
-    {
-        send_icmpv6_request(icmpv6_sock, host, sequence);
-        icmp_requests.push_back({host, sequence++, chrono::steady_clock::now(), true});
-    }
-    // Main polling loop
-    // Wait for replies from the network using the poll_sockets function
-    poll_sockets(arp_sock, icmp_sock, icmpv6_sock, ndp_sock, arp_requests, icmp_requests, ndp_requests, options.timeout);
+    // Main loop: probes are generated lazily from the ranges and paced by the token bucket (-r),
+    // replies are processed between the sends, unanswered probes are retransmitted (-n) until all are settled
+    // Probes are copied from templates built once for the interface, only the target fields are patched per probe
+    ProbeTemplates templates = make_probe_templates(selected_interface, echo);
+    run_workers(workers, hosts, templates, options);
 
     // Output results
-    print_output(ipv4_hosts, ipv6_hosts, arp_requests, icmp_requests, ndp_requests, selected_interface);
+    print_output(ranges, hosts, selected_interface);
 
-    close(arp_sock);
-    close(icmp_sock);
+    for (const auto &worker : workers)
+    {
+        close(worker.sockets.arp);
+        close(worker.sockets.icmp);
+    }
     close(icmpv6_sock);
     close(ndp_sock);
 
@@ -2,6 +2,7 @@
 
 #include <arpa/inet.h> // #include <netinet/in.h this is inside
 #include <netinet/icmp6.h>
+#include <cstring>
 
 int create_ndp_socket()
 {
@@ -20,60 +21,71 @@ int create_ndp_socket()
     return sock;
 }
 
-void send_ndp_request(int sock, const string &target_ip, const string &iface_mac,
-                      const string &iface_ip, const ProgramOptions &options)
+NDPTemplate make_ndp_template(const NetworkInterface &iface)
 {
+    NDPTemplate ndp{};
     // NDP is ICMPv6 based, so it uses very similiar structure
-    struct sockaddr_in6 dest_addr{};
-    dest_addr.sin6_family = AF_INET6;
-    inet_pton(AF_INET6, target_ip.c_str(), &dest_addr.sin6_addr);
-
-    uint8_t packet[sizeof(icmp6_hdr) + 24]; // 8 (ICMP header) + 16 (IPv6 address) + 8 (L2 option)
-    icmp6_hdr *icmp6 = reinterpret_cast<icmp6_hdr *>(packet);
-    memset(icmp6, 0, sizeof(icmp6_hdr));
+    ndp.address.sin6_family = AF_INET6;
 
+    icmp6_hdr *icmp6 = reinterpret_cast<icmp6_hdr *>(ndp.message);
     icmp6->icmp6_type = ND_NEIGHBOR_SOLICIT; // Neighbor Solicitation(request)
     icmp6->icmp6_code = 0;
-    *reinterpret_cast<uint32_t *>(icmp6->icmp6_data8) = 0;
-
-    // Target address
-    inet_pton(AF_INET6, target_ip.c_str(), icmp6->icmp6_data8 + 4); // 4 bytes offset for reserved
+    // Reserved field and target address stay zero, the target is set per probe
 
     // Source link-layer option
-    uint8_t *opt = packet + sizeof(icmp6_hdr);
+    uint8_t *opt = ndp.message + sizeof(icmp6_hdr) + 16;
     opt[0] = 1; // Type
     opt[1] = 1; // Length
 
-    sscanf(iface_mac.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+    sscanf(iface.mac.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
            &opt[2], &opt[3], &opt[4], &opt[5], &opt[6], &opt[7]);
 
     // Fill it by kernel
     icmp6->icmp6_cksum = 0;
-    // send packet
-    sendto(sock, packet, sizeof(packet), 0, (sockaddr *)&dest_addr, sizeof(dest_addr));
+    return ndp;
 }
 
-void process_ndp_replies(int sock, vector<NDPRequest> &requests)
+void queue_ndp_request(SendBatch &batch, const NDPTemplate &ndp, const IPAddress &target_ip)
 {
-    uint8_t buf[1024];
-    sockaddr_in6 src_addr{};
-    socklen_t addr_len = sizeof(src_addr);
+    sockaddr_in6 dest_addr = ndp.address;
+    dest_addr.sin6_addr = to_in6_addr(target_ip);
+
+    // The message is copied into the batch buffer, only the target address changes
+    uint8_t *packet = batch.add(NDP_REQUEST_SIZE, &dest_addr, sizeof(dest_addr));
+    if (packet == nullptr)
+        return;
+    memcpy(packet, ndp.message, NDP_REQUEST_SIZE);
+    // Target address
+    memcpy(packet + sizeof(icmp6_hdr), &dest_addr.sin6_addr, sizeof(in6_addr));
+}
 
-    ssize_t len = recvfrom(sock, buf, sizeof(buf), 0, (sockaddr *)&src_addr, &addr_len);
-    if (len < static_cast<ssize_t>(sizeof(icmp6_hdr)))
+/**
+ * @brief Process one received NDP packet
+ * @param buf Received ICMPv6 packet
+ * @param len Length of the packet
+ * @param src_addr Source address of the packet
+ * @param stamp Kernel receive time of the packet (nullptr if missing)
+ * @param hosts Scan state of the target hosts
+ */
+static void handle_ndp_reply(const uint8_t *buf, size_t len, const sockaddr_in6 &src_addr, const timespec *stamp,
+                             HostTable &hosts)
+{
+    if (len < sizeof(icmp6_hdr))
         return; // Ensure packet is large enough
 
-    icmp6_hdr *icmp6 = reinterpret_cast<icmp6_hdr *>(buf);
+    const icmp6_hdr *icmp6 = reinterpret_cast<const icmp6_hdr *>(buf);
     if (icmp6->icmp6_type != ND_NEIGHBOR_ADVERT)
         return;
 
-    char ip_str[INET6_ADDRSTRLEN];
-    inet_ntop(AF_INET6, &src_addr.sin6_addr, ip_str, sizeof(ip_str));
+    // Only a requested host which hasn't responded yet is updated
+    HostState *host = hosts.find(from_in6_addr(src_addr.sin6_addr));
+    if (host == nullptr || !(host->flags & HOST_L2_SENT) || !hosts.mark_answered(*host, PROBE_NDP, hosts.received_at(stamp)))
+        return;
 
     // process target link-layer address option
     // Start parsing options after ICMPv6 header (8 bytes) + Reserved (4 bytes) + Target Address (16 bytes)
-    uint8_t *opt = buf + sizeof(icmp6_hdr) + 16;
-    uint8_t *end = buf + len;
+    const uint8_t *opt = buf + sizeof(icmp6_hdr) + 16;
+    const uint8_t *end = buf + len;
 
     while (opt < end)
     {
@@ -90,34 +102,26 @@ void process_ndp_replies(int sock, vector<NDPRequest> &requests)
             if (length < 8)
                 break; // Ensure the option is large enough
 
-            char mac[18];
-            snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
-                     opt[2], opt[3], opt[4], opt[5], opt[6], opt[7]);
-
-            for (auto &req : requests)
-            {
-                if (req.host == ip_str && !req.responded)
-                {
-                    req.mac = mac;
-                    req.responded = true;
-                }
-            }
+            memcpy(host->mac, opt + 2, 6);
             break; // We found the MAC, no need to check further
         }
 
         // Move to the next option
         opt += length;
     }
+    // Without the target link-layer option the host is still reachable, the MAC stays zero
+}
 
-    for (auto &req : requests)
+void process_ndp_replies(int sock, HostTable &hosts, ReceiveBatch &batch)
+{
+    // Receive packets by batches until the socket is drained
+    size_t count;
+    while ((count = batch.receive(sock)) > 0)
     {
-        if (req.host == ip_str && !req.responded)
-        {
-            char mac[18];
-            snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x",
-                     opt[2], opt[3], opt[4], opt[5], opt[6], opt[7]);
-            req.mac = mac;
-            req.responded = true;
-        }
+        for (size_t i = 0; i < count; i++)
+            handle_ndp_reply(batch.data(i), batch.length(i),
+                             reinterpret_cast<const sockaddr_in6 &>(batch.address(i)), batch.timestamp(i), hosts);
+        if (count < IO_BATCH_SIZE)
+            break;
     }
 }
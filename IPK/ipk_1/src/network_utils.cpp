@@ -3,7 +3,6 @@
 #include <arpa/inet.h> // #include <netinet/in.h this is inside
 #include <linux/if_packet.h>
 #include <iostream>
-#include <bitset>
 
 using namespace std;
 
@@ -120,14 +119,54 @@ uint16_t compute_checksum_ipv4(void *buf, int len)
     return ~sum;
 }
 
-vector<string> expand_subnet(const string &cidr)
+uint16_t update_checksum(uint16_t checksum, const uint16_t *old_words, const uint16_t *new_words, size_t count)
 {
+    // HC' = ~(~HC + ~m + m') for all changed words, the carries are folded back once at the end
+    uint32_t sum = static_cast<uint16_t>(~checksum);
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += static_cast<uint16_t>(~old_words[i]) + new_words[i];
+    }
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+AddressCursor::AddressCursor(const AddressRange &range)
+    : is_ipv6(range.is_ipv6), done(range.empty), current(range.first), last(range.last)
+{
+}
+
+bool AddressCursor::next(IPAddress &address)
+{
+    if (done)
+    {
+        return false;
+    }
+    address.is_ipv6 = is_ipv6;
+    address.value = current;
+    // The last address is checked before incrementing, so a range ending at the top of the address space does not wrap
+    if (current == last)
+    {
+        done = true;
+    }
+    else
+    {
+        current++;
+    }
+    return true;
+}
+
+AddressRange parse_subnet(const string &cidr)
+{
+    AddressRange range;
+    range.cidr = cidr;
     size_t slash_pos = cidr.find('/');
 
     if (slash_pos == string::npos)
     {
         cerr << "Invalid CIDR format: " << cidr << endl;
-        return {};
+        return range;
     }
     // Extracting base IP from CIDR notation
     string base_ip = cidr.substr(0, slash_pos);
@@ -140,7 +179,7 @@ vector<string> expand_subnet(const string &cidr)
     catch (const exception &e)
     {
         cerr << "Invalid prefix: " << cidr.substr(slash_pos + 1) << endl;
-        return {};
+        return range;
     }
 
     // IPv4 handling
@@ -150,126 +189,130 @@ vector<string> expand_subnet(const string &cidr)
         if (inet_pton(AF_INET, base_ip.c_str(), &net_ip) != 1)
         {
             cerr << "Invalid IPv4 address: " << base_ip << endl;
-            return {};
+            return range;
         }
 
         if (prefix < 0 || prefix > 32)
         {
             cerr << "Invalid IPv4 prefix: " << prefix << endl;
-            return {};
+            return range;
         }
         // Convert network byte order to host byte order
         uint32_t net_addr = ntohl(net_ip.s_addr);
-        // Computing subnet mas based on prefix length
-        uint32_t mask = (0xFFFFFFFF << (32 - prefix)) & 0xFFFFFFFF;
-        // First usable host in the subnet
-        uint32_t first_host = (net_addr & mask) + 1;
-        // Last usable host in the subnet
-        uint32_t last_host = (net_addr | ~mask) - 1;
+        // Computing subnet mask based on prefix length (shifting by 32 is undefined, so /0 is handled separately)
+        uint32_t mask = prefix == 0 ? 0 : 0xFFFFFFFF << (32 - prefix);
+        // First usable host in the subnet (network address excluded)
+        uint64_t first_host = static_cast<uint64_t>(net_addr & mask) + 1;
+        // Last usable host in the subnet (broadcast address excluded)
+        uint64_t last_host = static_cast<uint64_t>(net_addr | ~mask) - 1;
 
-        vector<string> hosts;
-        for (uint32_t ip = first_host; ip <= last_host; ip++)
-        {
-            struct in_addr addr;
-            // Converting back to network byte order
-            addr.s_addr = htonl(ip);
-            char ip_str[INET_ADDRSTRLEN];
-            // Convert binary IP to human readable format
-            inet_ntop(AF_INET, &addr, ip_str, sizeof(ip_str));
-            // Add this IP to lists of hosts
-            hosts.push_back(ip_str);
-        }
-        return hosts;
+        range.first = first_host;
+        range.last = last_host;
+        // /31 and /32 have no usable hosts
+        range.empty = first_host > last_host;
+        return range;
     }
+
     // IPv6 handling
-    else
+    struct in6_addr net_ip;
+    // Check if the provided base IP address is a valid IPv6 address
+    if (inet_pton(AF_INET6, base_ip.c_str(), &net_ip) != 1)
     {
-        // Handle IPv6 subnets similarly using bit manipulation
-        struct in6_addr net_ip;
-        // Check if the provided base IP address is a valid IPv6 address
-        if (inet_pton(AF_INET6, base_ip.c_str(), &net_ip) != 1)
-        {
-            // If inet_pton fails, it means the IP address is not a valid IPv6 format
-            cerr << "Invalid IP address: " << base_ip << endl;
-            return {}; // return empty vector to indicate failure
-        }
-        // Check if the provided prefix length is within the valid range for IPv6 (0 to 128)
-        if (prefix < 0 || prefix > 128)
-        {
-            cerr << "Invalid IPv6 prefix length: " << prefix << endl;
-            return {};
-        }
-        // Convert the IPv6 address to a bitset for easier manipulation
-        bitset<128> net_bits;
-        for (int i = 0; i < 16; i++)
-        {
-            for (int j = 0; j < 8; j++)
-            {
-                // Extract each bit from the byte and set it in the bitset.
-                // The bitset is indexed from the least significant bit (index 0) to the most significant (index 127).
-                // We iterate through the bytes (i from 0 to 15) and then through the bits within each byte (j from 0 to 7).
-                // The formula (15 - i) * 8 + j calculates the correct bit position in the 128-bit bitset.
-                net_bits[(15 - i) * 8 + j] = (net_ip.s6_addr[i] >> (7 - j)) & 1;
-            }
-        }
+        // If inet_pton fails, it means the IP address is not a valid IPv6 format
+        cerr << "Invalid IP address: " << base_ip << endl;
+        return range;
+    }
+    // Check if the provided prefix length is within the valid range for IPv6 (0 to 128)
+    if (prefix < 0 || prefix > 128)
+    {
+        cerr << "Invalid IPv6 prefix length: " << prefix << endl;
+        return range;
+    }
+    uint128 net_addr = from_in6_addr(net_ip).value;
+    // Mask with the first 'prefix' bits set (shifting by 128 is undefined, so /0 is handled separately)
+    uint128 mask = prefix == 0 ? 0 : ~static_cast<uint128>(0) << (128 - prefix);
+    // IPv6 has no broadcast, every address of the subnet is scanned
+    range.is_ipv6 = true;
+    range.first = net_addr & mask;
+    range.last = net_addr | ~mask;
+    range.empty = false;
+    return range;
+}
+
+uint128 range_size(const AddressRange &range)
+{
+    if (range.empty)
+    {
+        return 0;
+    }
+    // The whole IPv6 space (/0) has 2^128 addresses, which does not fit, so it saturates
+    if (range.last - range.first == ~static_cast<uint128>(0))
+    {
+        return range.last - range.first;
+    }
+    return range.last - range.first + 1;
+}
 
-        // Computing the network range
+string uint128_to_string(uint128 value)
+{
+    if (value == 0)
+    {
+        return "0";
+    }
+    string digits;
+    while (value > 0)
+    {
+        digits.insert(digits.begin(), static_cast<char>('0' + static_cast<int>(value % 10)));
+        value /= 10;
+    }
+    return digits;
+}
 
-        /* Create a bitmask to isolate the network portion of the IP address.
-            ~bitset(0) creates a bitset with all bits set to 1.
-            << (128 - prefix) shifts this bitset to the left by (128 - prefix) positions,
-            effectively creating a mask where the first 'prefix' bits are 1 and the rest are 0. */
-        bitset<128> mask = (~bitset<128>(0)) << (128 - prefix);
-        /*Calculate the network start address by performing a bitwise AND operation between the network IP (in bits) and the mask.
-            This keeps only the network bits and sets the host bits to 0.*/
-        bitset<128> net_start = net_bits & mask;
-        /* Calculate the network end address by performing a bitwise OR operation between the network IP (in bits) and the inverse of the mask.
-            The inverse of the mask has the first 'prefix' bits as 0 and the rest as 1.
-            ORing with this effectively sets all the host bits to 1. */
-        bitset<128> net_end = net_bits | ~mask;
-        // Vector to store the generated host IP addresses
-        vector<string> hosts;
-        // Initialize a bitset 'current' with the network start address. This will be incremented to generate each host IP.
-        bitset<128> current = net_start;
+in_addr to_in_addr(const IPAddress &address)
+{
+    in_addr addr;
+    // Converting back to network byte order
+    addr.s_addr = htonl(static_cast<uint32_t>(address.value));
+    return addr;
+}
 
-        // Loop to iterate through all the host addresses within the subnet
-        while (true)
-        {
-            // Structure to hold the IPv6 address for the current iteration
-            struct in6_addr addr = {};
-            for (int i = 0; i < 16; ++i)
-            {
-                uint8_t byte = 0;
-                for (int j = 0; j < 8; ++j)
-                {
-                    // Extract each bit from the bitset and set the corresponding bit in the byte.
-                    byte |= current[(15 - i) * 8 + j] << (7 - j);
-                }
-                addr.s6_addr[i] = byte;
-            }
-            // Buffer to store the string representation of the IPv6 address
-            char ip_str[INET6_ADDRSTRLEN];
-            // Convert the binary IPv6 address to a human-readable string format
-            inet_ntop(AF_INET6, &addr, ip_str, sizeof(ip_str));
-            // Add the generated IP address string to the vector of hosts
-            hosts.push_back(ip_str);
+in6_addr to_in6_addr(const IPAddress &address)
+{
+    in6_addr addr;
+    uint128 value = address.value;
+    // Most significant byte first (network byte order)
+    for (int i = 15; i >= 0; i--)
+    {
+        addr.s6_addr[i] = static_cast<uint8_t>(value);
+        value >>= 8;
+    }
+    return addr;
+}
 
-            // Check if the current IP address is equal to the network end address.
-            // If it is, we have reached the end of the subnet.
-            if (current == net_end)
-            {
-                break;
-            }
+IPAddress from_in6_addr(const in6_addr &addr)
+{
+    IPAddress address;
+    address.is_ipv6 = true;
+    for (int i = 0; i < 16; i++)
+    {
+        address.value = (address.value << 8) | addr.s6_addr[i];
+    }
+    return address;
+}
 
-            // Increment the current IP address to get the next one in the subnet
-            bool carry = true;
-            for (int i = 0; i < 128 && carry; ++i)
-            {
-                bool prev = current[i];
-                current[i] = prev ^ carry; // Toggle the bit if there's a carry
-                carry = prev && carry;     // Carry remains true only if both prev and carry are true
-            }
-        }
-        return hosts; // return the vector of generated host IP addresses
+string address_to_string(const IPAddress &address)
+{
+    // Buffer large enough for both families
+    char ip_str[INET6_ADDRSTRLEN];
+    if (address.is_ipv6)
+    {
+        in6_addr addr = to_in6_addr(address);
+        inet_ntop(AF_INET6, &addr, ip_str, sizeof(ip_str));
+    }
+    else
+    {
+        in_addr addr = to_in_addr(address);
+        inet_ntop(AF_INET, &addr, ip_str, sizeof(ip_str));
     }
+    return ip_str;
 }
@@ -1,5 +1,7 @@
 #include "include/output.h"
 #include <algorithm>
+#include <arpa/inet.h>
+#include <cmath>
 //circular import//circular import
 
 /**
@@ -13,62 +15,141 @@ string correct_mac(const string& mac) {
     return mac_copy;
 }
 
-void print_output(vector<string>& ipv4_hosts, vector<string>& ipv6_hosts, vector<ARPRequest>& arp_requests, 
-        vector<ICMPRequest>& icmp_requests, vector<NDPRequest>& ndp_requests, NetworkInterface& iface){
-    for (const auto& host : ipv4_hosts) {
-        // ARP status
-        string arp_status = "FAIL";
-        string mac = "";
-        
-        if (host == iface.ipv4) {
-            arp_status = "OK";
-            mac = " (" + correct_mac(iface.mac) + ")";
-        } else {
-            auto arp_it = find_if(arp_requests.begin(), arp_requests.end(),
-                [&](const ARPRequest& r) { return r.host == host; });
-            
-            if (arp_it != arp_requests.end() && arp_it->responded) {
-                arp_status = "OK";
-                mac = " (" + correct_mac(arp_it->mac) + ")";
-            }
-        }
+/**
+ * @brief Format a binary MAC address with '-' separators
+ * @param mac MAC address
+ * @return Formatted MAC address
+ */
+static string format_mac(const uint8_t mac[6]) {
+    char text[18];
+    snprintf(text, sizeof(text), "%02x-%02x-%02x-%02x-%02x-%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    return text;
+}
 
-        // ICMP status
-        string icmp_status = "FAIL";
-        auto icmp_it = find_if(icmp_requests.begin(), icmp_requests.end(),
-            [&](const ICMPRequest& r) { return r.host == host && !r.is_ipv6; });
-        
-        if (icmp_it == icmp_requests.end()) {
-            icmp_status = "OK";
+/**
+ * @brief Binary address of the interface, used to recognise the scanner's own address without string comparison
+ * @param text Interface address string (empty if the interface has none)
+ * @param is_ipv6 Address family
+ * @param out Binary address
+ * @return True if the interface has an address of the family
+ */
+static bool parse_interface_address(const string& text, bool is_ipv6, IPAddress& out) {
+    if (is_ipv6) {
+        in6_addr addr;
+        if (inet_pton(AF_INET6, text.c_str(), &addr) != 1) {
+            return false;
         }
+        out = from_in6_addr(addr);
+        return true;
+    }
+    in_addr addr;
+    if (inet_pton(AF_INET, text.c_str(), &addr) != 1) {
+        return false;
+    }
+    out.is_ipv6 = false;
+    out.value = ntohl(addr.s_addr);
+    return true;
+}
 
-        cout << host << " arp " << arp_status << mac 
-            << ", icmpv4 " << icmp_status << endl;
+/**
+ * @brief Format a round-trip time in milliseconds
+ * @param usec Round-trip time in microseconds
+ * @return Formatted time (e.g. "0.123 ms")
+ */
+static string format_rtt(uint32_t usec) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.3f ms", usec / 1000.0);
+    return text;
+}
+
+/**
+ * @brief Print the result line of one host and collect its round-trip times
+ * @param address Host address
+ * @param host Host state (nullptr if no probe was sent to it)
+ * @param own True if the address belongs to the scanning interface
+ * @param iface Scanning interface
+ * @param rtts Round-trip times by ProbeType (appended)
+ */
+static void print_host(const IPAddress& address, const HostState* host, bool own, NetworkInterface& iface,
+                       vector<uint32_t> rtts[4]) {
+    // L2 status (ARP / NDP), the own address is always reachable (and has no RTT)
+    string l2_status = "FAIL";
+    string mac = "";
+    string l2_rtt = "";
+    if (own) {
+        l2_status = "OK";
+        mac = " (" + correct_mac(iface.mac) + ")";
+    } else if (host != nullptr && (host->flags & HOST_L2_OK)) {
+        l2_status = "OK";
+        mac = " (" + format_mac(host->mac) + ")";
+        l2_rtt = " " + format_rtt(host->l2_rtt);
+        rtts[address.is_ipv6 ? PROBE_NDP : PROBE_ARP].push_back(host->l2_rtt);
     }
-    for(const auto& host: ipv6_hosts){
-        // NDP status
-        string ndp_status = "FAIL";
-        string mac = "";
-        if(host == iface.ipv6){
-            ndp_status = "OK";
-            mac = " (" + correct_mac(iface.mac) + ")";
-        } else {
-            auto ndp_it = find_if(ndp_requests.begin(), ndp_requests.end(),
-                [&](const NDPRequest& r) { return r.host == host && r.responded; });
-            if (ndp_it != ndp_requests.end()) {
-                ndp_status = "OK";
-                mac = " (" + correct_mac(ndp_it->mac) + ")";
-            }
+
+    // ICMP status
+    string icmp_status = "FAIL";
+    if (host != nullptr && (host->flags & HOST_ICMP_OK)) {
+        icmp_status = "OK " + format_rtt(host->icmp_rtt);
+        rtts[address.is_ipv6 ? PROBE_ICMPV6 : PROBE_ICMP].push_back(host->icmp_rtt);
+    }
+
+    cout << address_to_string(address) << (address.is_ipv6 ? " ndp " : " arp ") << l2_status << mac << l2_rtt
+        << (address.is_ipv6 ? ", icmpv6 " : ", icmpv4 ") << icmp_status << "\n";
+}
+
+/**
+ * @brief Print min / avg / p50 / p99 / max of the round-trip times of each probe type which got replies
+ * @param rtts Round-trip times by ProbeType in microseconds (sorted in place)
+ */
+static void print_rtt_summary(vector<uint32_t> rtts[4]) {
+    static const char* names[] = {"arp", "ndp", "icmpv4", "icmpv6"};
+    bool header = false;
+    for (int type = 0; type < 4; type++) {
+        vector<uint32_t>& values = rtts[type];
+        if (values.empty()) {
+            continue;
         }
-        // ICMPv6 status
-        string icmp_status = "FAIL";
-        auto icmp_it = find_if(icmp_requests.begin(), icmp_requests.end(),
-            [&](const ICMPRequest& r) { return r.host == host && r.is_ipv6; });
-        if (icmp_it == icmp_requests.end()) {
-            icmp_status = "OK";
+        if (!header) {
+            cout << "\nRTT [ms]     min      avg      p50      p99      max  replies\n";
+            header = true;
         }
+        sort(values.begin(), values.end());
+        double sum = 0;
+        for (uint32_t value : values) {
+            sum += value;
+        }
+        // nearest-rank percentile
+        auto percentile = [&](double p) {
+            size_t rank = static_cast<size_t>(ceil(p / 100 * values.size()));
+            return values[rank > 0 ? rank - 1 : 0] / 1000.0;
+        };
+        char line[128];
+        snprintf(line, sizeof(line), "%-8s %8.3f %8.3f %8.3f %8.3f %8.3f %8zu", names[type], values.front() / 1000.0,
+                 sum / values.size() / 1000.0, percentile(50), percentile(99), values.back() / 1000.0, values.size());
+        cout << line << "\n";
+    }
+    cout << flush;
+}
+
+void print_output(const vector<AddressRange>& ranges, HostTable& hosts, NetworkInterface& iface){
+    IPAddress own_ipv4, own_ipv6;
+    bool has_ipv4 = parse_interface_address(iface.ipv4, false, own_ipv4);
+    bool has_ipv6 = parse_interface_address(iface.ipv6, true, own_ipv6);
 
-        cout << host << " ndp " << ndp_status << mac 
-            << ", icmpv6 " << icmp_status << endl;
+    // hosts are regenerated from the ranges, each one is a single lookup in the host table
+    IPAddress address;
+    vector<uint32_t> rtts[4];
+    for (const auto& range : ranges) {
+        AddressCursor cursor(range);
+        while (!range.is_ipv6 && cursor.next(address)) {
+            print_host(address, hosts.find(address), has_ipv4 && address.value == own_ipv4.value, iface, rtts);
+        }
+    }
+    for (const auto& range : ranges) {
+        AddressCursor cursor(range);
+        while (range.is_ipv6 && cursor.next(address)) {
+            print_host(address, hosts.find(address), has_ipv6 && address.value == own_ipv6.value, iface, rtts);
+        }
     }
+    print_rtt_summary(rtts);
 }
\ No newline at end of file
@@ -1,59 +1,277 @@
 #include "include/polling.h"
+#include "include/reactor.h"
 #include <algorithm>
+#include <deque>
+#include <thread>
 
-void poll_sockets(int arp_sock, int icmp_sock, int icmpv6_sock, int ndp_sock,
-                  vector<ARPRequest> &arp_requests, vector<ICMPRequest> &icmp_requests,
-                  vector<NDPRequest> &ndp_requests, int timeout)
+// Maximum number of probes sent before the receive sockets are checked again (one sendmmsg per socket)
+static const size_t SEND_BATCH = IO_BATCH_SIZE;
+
+// Wakeup period of a thread which only waits for the other threads to finish (microseconds)
+static const int64_t IDLE_WAKEUP = 1000;
+
+// Probe sent and waiting for its reply or its retransmission timeout
+struct SentProbe
+{
+    Probe probe;
+    uint32_t sent; // scan clock of the transmission
+};
+
+ProbeTemplates make_probe_templates(const NetworkInterface &iface, const EchoIdentity &echo)
+{
+    return {make_arp_template(iface), make_ndp_template(iface), make_icmp_template(echo), make_icmpv6_template(echo)};
+}
+
+HostState &queue_probe(SendBatches &batches, const Probe &probe, HostTable &hosts, const ProbeTemplates &templates,
+                 EchoIdentity &echo)
+{
+    HostState &host = hosts.at(probe.address);
+    // A retransmitted echo request keeps its probe index, so a late reply to any transmission matches.
+    // ICMP and ICMPv6 count separately, each has 2^32 probe indexes.
+    if (probe.type == PROBE_ICMP && probe.attempt == 0)
+    {
+        host.echo_index = echo.next_ipv4++;
+    }
+    else if (probe.type == PROBE_ICMPV6 && probe.attempt == 0)
+    {
+        host.echo_index = echo.next_ipv6++;
+    }
+    switch (probe.type)
+    {
+    case PROBE_ARP:
+        queue_arp_request(batches.arp, templates.arp, probe.address);
+        break;
+    case PROBE_NDP:
+        queue_ndp_request(batches.ndp, templates.ndp, probe.address);
+        break;
+    case PROBE_ICMP:
+        queue_icmp_request(batches.icmp, templates.icmp, probe.address, echo, host.echo_index);
+        break;
+    case PROBE_ICMPV6:
+        queue_icmpv6_request(batches.icmpv6, templates.icmpv6, probe.address, echo, host.echo_index);
+        break;
+    }
+    hosts.mark_sent(host, probe);
+    return host;
+}
+
+/**
+ * @brief Send the queued probes of one type by one sendmmsg and record their transmission time
+ * The clock is read right before and after sendmmsg, and each probe gets the time of its position in the batch, so
+ * neither the time spent building the batch nor the time the kernel spent on the probes before it is in its RTT.
+ * (A reply on the loopback or a fast LAN is timestamped while sendmmsg still runs, so the time after the call would be
+ * later than the reply.)
+ * @param batch Send batch of the probe type
+ * @param sock Socket of the probe type
+ * @param queued Hosts whose probes are in the batch, in the order of the batch (cleared)
+ * @param type Probe type of the batch
+ * @param hosts Scan state of the target hosts
+ */
+static void flush_probes(SendBatch &batch, int sock, vector<HostState *> &queued, ProbeType type, HostTable &hosts)
+{
+    if (batch.size() == 0)
+        return;
+    uint32_t before = hosts.rtt_clock();
+    batch.flush(sock);
+    uint64_t duration = hosts.rtt_clock() - before;
+    for (size_t i = 0; i < queued.size(); i++)
+    {
+        hosts.mark_transmitted(*queued[i], type, before + static_cast<uint32_t>(duration * i / queued.size()));
+    }
+    queued.clear();
+}
+
+/**
+ * @brief Handle the probes whose retransmission timeout expired
+ * Answered probes are dropped, the others are retransmitted while retries are left, otherwise given up.
+ * @param in_flight Sent probes of one type in the order of transmission (so also in the order of expiry)
+ * @param retransmits Output queue of probes to send again
+ * @param hosts Scan state of the target hosts
+ * @param retries Maximum number of retransmissions of one probe
+ * @param now Current scan clock
+ */
+static void expire_probes(deque<SentProbe> &in_flight, deque<Probe> &retransmits, HostTable &hosts, int retries,
+                          uint32_t now)
 {
-    // Set of file descriptors to monitor for readability
-    fd_set read_fds;
-    // Record the starting time for the timeout calculation
-    auto start = chrono::steady_clock::now();
+    while (!in_flight.empty())
+    {
+        const SentProbe &oldest = in_flight.front();
+        HostState *host = hosts.find(oldest.probe.address);
+        if (host != nullptr && !HostTable::is_settled(*host, oldest.probe.type))
+        {
+            if (now - oldest.sent < hosts.rto(oldest.probe.type))
+            {
+                break; // the oldest probe still has time, so do all younger ones
+            }
+            if (oldest.probe.attempt < retries)
+            {
+                Probe retry = oldest.probe;
+                retry.attempt++;
+                retransmits.push_back(retry);
+            }
+            else
+            {
+                hosts.give_up(*host, oldest.probe.type);
+            }
+        }
+        in_flight.pop_front();
+    }
+}
+
+void run_scan(ScanWorker &worker, HostTable &hosts, const ProbeTemplates &templates, const ProgramOptions &options,
+              atomic<size_t> &sending)
+{
+    const ScanSockets &sockets = worker.sockets;
+    EchoIdentity &echo = worker.echo;
+    ProbeQueue probes(worker.ranges);
+    bool generating = true; // counted in 'sending'
+
+    // A burst is at most 10 ms worth of probes (and at most one batch)
+    size_t burst = options.rate > 0 ? min<size_t>(SEND_BATCH, max(1, options.rate / 100)) : SEND_BATCH;
+    TokenBucket bucket(options.rate, burst);
+    // Packet buffers, allocated once for the whole scan
+    SendBatches batches;
+    ReceiveBatch received;
+    // Sent probes per ProbeType (each type has its own timeout) and probes waiting for retransmission
+    deque<SentProbe> in_flight[4];
+    deque<Probe> retransmits;
+    // Hosts of the probes in the send batches per ProbeType, their send time is set once the batch is sent
+    vector<HostState *> queued[4];
+
+    // The sockets are registered once, each ready socket is drained by its reply handler
+    Reactor reactor;
+    bool watching = reactor.is_valid() &&
+        reactor.watch(sockets.arp, [&]() { process_arp_replies(sockets.arp, hosts, received); }) &&
+        reactor.watch(sockets.icmp, [&]() { process_icmp_replies(sockets.icmp, hosts, received, echo); });
+    // Only the thread with the IPv6 ranges has the IPv6 sockets
+    if (watching && sockets.ndp >= 0)
+    {
+        watching = reactor.watch(sockets.ndp, [&]() { process_ndp_replies(sockets.ndp, hosts, received); }) &&
+                   reactor.watch(sockets.icmpv6, [&]() { process_icmpv6_replies(sockets.icmpv6, hosts, received, echo); });
+    }
+    if (!watching)
+    {
+        sending--;
+        return;
+    }
 
     while (true)
     {
-        // Initialize the set of file descriptors to be empty
-        FD_ZERO(&read_fds);
-        // add each socket to the set
-        FD_SET(arp_sock, &read_fds);
-        FD_SET(icmp_sock, &read_fds);
-        FD_SET(icmpv6_sock, &read_fds);
-        FD_SET(ndp_sock, &read_fds);
-        // structure to specify the timeout for all the select calls
-        timeval tv{};
-        // Current time
-        auto now = chrono::steady_clock::now();
-        int remaining = timeout - chrono::duration_cast<chrono::milliseconds>(now - start).count();
-        if (remaining <= 0)
-        {
-            break; // Exiting loop due to timeout
-        }
-
-        tv.tv_sec = remaining / 1000;           // seconds
-        tv.tv_usec = (remaining % 1000) * 1000; // microseconds
-        // Determine the maximum file descriptor value
-        int max_fd = max({arp_sock, icmp_sock, icmpv6_sock, ndp_sock}) + 1;
-        // Call the select system call to wait for activity on any of the specified sockets
-        int rv = select(max_fd, &read_fds, nullptr, nullptr, &tv);
-        if (rv < 0)
-        {
-            // If an error occurred (e.g., interrupted by a signal), print an error message
-            perror("select");
+        uint32_t now = hosts.now();
+        for (auto &queue : in_flight)
+        {
+            expire_probes(queue, retransmits, hosts, options.retries, now);
+        }
+
+        // Everything is sent (by all threads) and every probe is answered or out of retries
+        if (probes.empty() && retransmits.empty() && hosts.pending() == 0 && sending == 0)
+        {
             break;
         }
-        else if (rv == 0)
+
+        // Send what the bucket allows (retransmissions first), then go back to reading replies
+        if (!probes.empty() || !retransmits.empty())
+        {
+            size_t allowed = bucket.take(SEND_BATCH, chrono::steady_clock::now());
+            Probe probe;
+            for (size_t sent = 0; sent < allowed;)
+            {
+                if (!retransmits.empty())
+                {
+                    probe = retransmits.front();
+                    retransmits.pop_front();
+                    // Answered while waiting for its turn
+                    HostState *host = hosts.find(probe.address);
+                    if (host == nullptr || HostTable::is_settled(*host, probe.type))
+                        continue;
+                }
+                else if (!probes.next(probe))
+                {
+                    break;
+                }
+                queued[probe.type].push_back(&queue_probe(batches, probe, hosts, templates, echo));
+                in_flight[probe.type].push_back({probe, hosts.now()});
+                sent++;
+            }
+            // One sendmmsg per socket which has queued probes
+            flush_probes(batches.arp, sockets.arp, queued[PROBE_ARP], PROBE_ARP, hosts);
+            flush_probes(batches.ndp, sockets.ndp, queued[PROBE_NDP], PROBE_NDP, hosts);
+            flush_probes(batches.icmp, sockets.icmp, queued[PROBE_ICMP], PROBE_ICMP, hosts);
+            flush_probes(batches.icmpv6, sockets.icmpv6, queued[PROBE_ICMPV6], PROBE_ICMPV6, hosts);
+        }
+        // The last probe of the thread is pending now, so the other threads can't see the scan as finished
+        if (generating && probes.empty())
+        {
+            generating = false;
+            sending--;
+        }
+
+        // Wake up when the next token is available or the oldest probe of a type times out
+        chrono::microseconds wait = chrono::microseconds::max();
+        if (!probes.empty() || !retransmits.empty())
+        {
+            wait = bucket.wait_time(chrono::steady_clock::now());
+        }
+        now = hosts.now();
+        for (int type = 0; type < 4; type++)
+        {
+            if (!in_flight[type].empty())
+            {
+                uint32_t elapsed = now - in_flight[type].front().sent;
+                uint32_t rto = hosts.rto(static_cast<ProbeType>(type));
+                wait = min(wait, chrono::microseconds(elapsed < rto ? rto - elapsed : 0));
+            }
+        }
+        if (wait == chrono::microseconds::max())
+        {
+            // Nothing to send and nothing in flight, the probes of the other threads are still being answered
+            wait = chrono::microseconds(IDLE_WAKEUP);
+        }
+
+        // A token or a timeout is already due: only handle the sockets which are ready now, don't sleep
+        if (wait.count() == 0)
         {
-            break; // Timeout
+            if (!reactor.dispatch(false))
+                break;
+            continue;
         }
 
-        // Process responses based on which sockets are ready for reading
-        if (FD_ISSET(arp_sock, &read_fds))
-            process_arp_replies(arp_sock, arp_requests);
-        if (FD_ISSET(ndp_sock, &read_fds))
-            process_ndp_replies(ndp_sock, ndp_requests);
-        if (FD_ISSET(icmp_sock, &read_fds))
-            process_icmp_replies(icmp_sock, icmp_requests);
-        if (FD_ISSET(icmpv6_sock, &read_fds))
-            process_icmpv6_replies(icmpv6_sock, icmp_requests);
+        // Replies are processed by the handlers as they arrive until the timer expires
+        reactor.schedule(wait);
+        if (!reactor.dispatch())
+        {
+            break;
+        }
+    }
+    if (generating)
+    {
+        sending--;
+    }
+}
+
+void run_workers(vector<ScanWorker> &workers, HostTable &hosts, const ProbeTemplates &templates,
+                 const ProgramOptions &options)
+{
+    // The rate limit applies to the whole scan: every thread gets an equal share, the first ones one pps more
+    // until the shares add up to -r (parse_arguments keeps the thread count at most the rate, so no share is 0)
+    vector<ProgramOptions> worker_options(workers.size(), options);
+    if (options.rate > 0)
+    {
+        int count = static_cast<int>(workers.size());
+        for (int i = 0; i < count; i++)
+        {
+            worker_options[i].rate = options.rate / count + (i < options.rate % count ? 1 : 0);
+        }
+    }
+    atomic<size_t> sending(workers.size());
+    vector<thread> threads;
+    for (size_t i = 1; i < workers.size(); i++)
+    {
+        threads.emplace_back([&, i]() { run_scan(workers[i], hosts, templates, worker_options[i], sending); });
+    }
+    run_scan(workers[0], hosts, templates, worker_options[0], sending);
+    for (auto &t : threads)
+    {
+        t.join();
     }
 }
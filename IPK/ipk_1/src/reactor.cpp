@@ -0,0 +1,113 @@
+#include "include/reactor.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Event data of the timer (sockets use their index in 'handlers')
+static const uint32_t TIMER_EVENT = UINT32_MAX;
+// Maximum number of events returned by one epoll_wait
+static const int MAX_EVENTS = 16;
+
+Reactor::Reactor() : epoll_fd(-1), timer_fd(-1)
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0)
+    {
+        perror("epoll_create1");
+        return;
+    }
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0)
+    {
+        perror("timerfd_create");
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u32 = TIMER_EVENT;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event) < 0)
+    {
+        perror("epoll_ctl timer");
+        close(timer_fd);
+        timer_fd = -1;
+    }
+}
+
+Reactor::~Reactor()
+{
+    if (timer_fd >= 0)
+        close(timer_fd);
+    if (epoll_fd >= 0)
+        close(epoll_fd);
+}
+
+bool Reactor::is_valid() const
+{
+    return epoll_fd >= 0 && timer_fd >= 0;
+}
+
+bool Reactor::watch(int fd, function<void()> on_readable)
+{
+    // Registered once, edge-triggered: no fd set is rebuilt per wakeup
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u32 = static_cast<uint32_t>(handlers.size());
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        perror("epoll_ctl");
+        return false;
+    }
+    handlers.push_back(move(on_readable));
+    // Data which arrived before the registration doesn't produce an edge, read it now
+    handlers.back()();
+    return true;
+}
+
+void Reactor::schedule(chrono::microseconds delay)
+{
+    itimerspec spec{};
+    // A zero it_value would disarm the timer, the shortest delay is 1 ns
+    int64_t nanoseconds = delay.count() > 0 ? delay.count() * 1000 : 1;
+    spec.it_value.tv_sec = nanoseconds / 1000000000;
+    spec.it_value.tv_nsec = nanoseconds % 1000000000;
+    if (timerfd_settime(timer_fd, 0, &spec, nullptr) < 0)
+    {
+        perror("timerfd_settime");
+    }
+}
+
+bool Reactor::dispatch(bool block)
+{
+    epoll_event events[MAX_EVENTS];
+    int count;
+    do
+    {
+        // No epoll timeout when blocking, deadlines come from the timer
+        count = epoll_wait(epoll_fd, events, MAX_EVENTS, block ? -1 : 0);
+    } while (count < 0 && errno == EINTR);
+
+    if (count < 0)
+    {
+        perror("epoll_wait");
+        return false;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (events[i].data.u32 == TIMER_EVENT)
+        {
+            // Reset the expiration counter, the caller checks its deadlines after dispatch
+            uint64_t expirations;
+            if (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+                perror("timerfd read");
+            continue;
+        }
+        // Each ready socket is drained by its handler
+        handlers[events[i].data.u32]();
+    }
+    return true;
+}
@@ -0,0 +1,176 @@
+#include "include/scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Address family of each probe phase (ARP, NDP, ICMP, ICMPv6)
+static const bool PHASE_IS_IPV6[] = {false, true, false, true};
+static const int PHASE_COUNT = 4;
+
+ProbeQueue::ProbeQueue(const vector<AddressRange> &ranges)
+    : ranges(ranges), phase(0), range_index(0), cursor(AddressRange()), has_next(false)
+{
+    if (!ranges.empty())
+    {
+        cursor = AddressCursor(ranges[0]);
+    }
+    advance();
+}
+
+void ProbeQueue::advance()
+{
+    has_next = false;
+    while (phase < PHASE_COUNT)
+    {
+        // Current range belongs to the phase's family and still has a host
+        if (range_index < ranges.size() && ranges[range_index].is_ipv6 == PHASE_IS_IPV6[phase] &&
+            cursor.next(pending.address))
+        {
+            pending.type = static_cast<ProbeType>(phase);
+            has_next = true;
+            return;
+        }
+        // Next range, or the first range of the next phase
+        if (++range_index >= ranges.size())
+        {
+            range_index = 0;
+            phase++;
+        }
+        if (range_index < ranges.size())
+        {
+            cursor = AddressCursor(ranges[range_index]);
+        }
+    }
+}
+
+bool ProbeQueue::next(Probe &probe)
+{
+    if (!has_next)
+    {
+        return false;
+    }
+    probe = pending;
+    advance();
+    return true;
+}
+
+bool ProbeQueue::empty() const
+{
+    return !has_next;
+}
+
+vector<vector<AddressRange>> split_ranges(const vector<AddressRange> &ranges, size_t parts)
+{
+    vector<vector<AddressRange>> split(max<size_t>(parts, 1));
+    uint64_t total = 0;
+    for (const auto &range : ranges)
+    {
+        if (!range.is_ipv6 && !range.empty)
+            total += static_cast<uint64_t>(range.last - range.first) + 1;
+    }
+    uint64_t share = (total + split.size() - 1) / split.size();
+
+    size_t part = 0;
+    uint64_t filled = 0; // hosts already given to the current part
+    for (const auto &range : ranges)
+    {
+        if (range.empty)
+            continue;
+        if (range.is_ipv6)
+        {
+            split[0].push_back(range);
+            continue;
+        }
+        // A range may be cut between two parts, each piece is scanned as its own range
+        uint128 first = range.first;
+        while (first <= range.last)
+        {
+            uint64_t left = static_cast<uint64_t>(range.last - first) + 1;
+            uint64_t take = part + 1 < split.size() ? min(left, share - filled) : left;
+            AddressRange piece = range;
+            piece.first = first;
+            piece.last = first + take - 1;
+            split[part].push_back(piece);
+            first += take;
+            filled += take;
+            if (filled >= share && part + 1 < split.size())
+            {
+                part++;
+                filled = 0;
+            }
+        }
+    }
+    return split;
+}
+
+TokenBucket::TokenBucket(int rate, size_t burst)
+    : rate(rate), burst(static_cast<double>(max<size_t>(burst, 1))), tokens(this->burst),
+      last_refill(chrono::steady_clock::now())
+{
+}
+
+void TokenBucket::refill(chrono::steady_clock::time_point now)
+{
+    double elapsed = chrono::duration<double>(now - last_refill).count();
+    last_refill = now;
+    tokens = min(burst, tokens + elapsed * rate);
+}
+
+size_t TokenBucket::take(size_t wanted, chrono::steady_clock::time_point now)
+{
+    // Unlimited rate, only the batch size applies
+    if (rate <= 0)
+    {
+        return wanted;
+    }
+    refill(now);
+    size_t available = static_cast<size_t>(tokens);
+    size_t taken = min(wanted, available);
+    tokens -= static_cast<double>(taken);
+    return taken;
+}
+
+chrono::microseconds TokenBucket::wait_time(chrono::steady_clock::time_point now)
+{
+    if (rate <= 0)
+    {
+        return chrono::microseconds(0);
+    }
+    refill(now);
+    if (tokens >= 1)
+    {
+        return chrono::microseconds(0);
+    }
+    // Rounded up, so the wakeup does not come before the token
+    return chrono::microseconds(static_cast<int64_t>(ceil((1 - tokens) / rate * 1e6)));
+}
+
+RttEstimator::RttEstimator(uint32_t initial_rto, uint32_t min_rto, uint32_t max_rto)
+    : has_sample(false), srtt(0), rttvar(0), current(min(max(initial_rto, min_rto), max_rto)),
+      min_rto(min_rto), max_rto(max_rto)
+{
+}
+
+void RttEstimator::sample(uint32_t rtt)
+{
+    double r = static_cast<double>(rtt);
+    if (!has_sample)
+    {
+        srtt = r;
+        rttvar = r / 2;
+        has_sample = true;
+    }
+    else
+    {
+        // RTTVAR is updated with the old SRTT, alpha = 1/8, beta = 1/4
+        rttvar = 0.75 * rttvar + 0.25 * fabs(srtt - r);
+        srtt = 0.875 * srtt + 0.125 * r;
+    }
+    double rto = srtt + 4 * rttvar;
+    current = static_cast<uint32_t>(min(max(rto, static_cast<double>(min_rto)), static_cast<double>(max_rto)));
+}
+
+uint32_t RttEstimator::rto() const
+{
+    return current;
+}
@@ -0,0 +1,657 @@
+/**
+    @file archive.cpp
+    @brief Implementácia archívu najväčších tokov za jednotlivé intervaly
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/archive.h"
+#include "include/filter.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+static const char ARCHIVE_MAGIC[8] = {'I', 'S', 'A', 'T', 'O', 'P', 'A', 'R'};
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+// horná hranica veľkosti bloku pri čítaní (poškodená hlavička nesmie spôsobiť obrovskú alokáciu)
+static const uint32_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+/**
+    @brief Aktuálny čas (unix mikrosekundy)
+ */
+static int64_t now_usec() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+    @brief Zápis čísla ako varint (7 bitov na bajt, najvyšší bit označuje pokračovanie)
+ */
+static void put_varint(vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+    @brief Čítanie varint čísla
+    @return false ak číslo presahuje koniec bufferu alebo 64 bitov
+ */
+static bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p == end) {
+            return false;
+        }
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+    @brief Rozdiel so znamienkom ako číslo bez znamienka (malé záporné aj kladné rozdiely majú krátky varint)
+ */
+static uint64_t zigzag(uint64_t current, uint64_t previous) {
+    int64_t delta = static_cast<int64_t>(current - previous);
+    return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+}
+
+static uint64_t unzigzag(uint64_t value, uint64_t previous) {
+    return previous + ((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/**
+    @brief Kontrolný súčet FNV-1a
+ */
+static uint32_t fnv1a(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+    @brief IPv4 adresa ako 32-bitové číslo (poradie bajtov siete)
+ */
+static uint64_t ipv4_value(const uint8_t* addr) {
+    return (static_cast<uint64_t>(addr[0]) << 24) | (addr[1] << 16) | (addr[2] << 8) | addr[3];
+}
+
+/**
+    @brief Zakódovanie riadkov bloku po stĺpcoch
+ */
+static void encode_rows(const vector<ArchiveRow>& rows, vector<uint8_t>& out) {
+    for (const ArchiveRow& row : rows) {
+        out.push_back(row.key.family);
+    }
+    for (const ArchiveRow& row : rows) {
+        out.push_back(row.key.proto);
+    }
+    for (const ArchiveRow& row : rows) {
+        out.push_back(row.flags);
+    }
+    for (const ArchiveRow& row : rows) {
+        put_varint(out, row.key.src_port);
+    }
+    for (const ArchiveRow& row : rows) {
+        put_varint(out, row.key.dst_port);
+    }
+    for (bool src : {true, false}) {
+        uint64_t previous = 0;
+        for (const ArchiveRow& row : rows) {
+            const uint8_t* addr = src ? row.key.src : row.key.dst;
+            if (row.key.family == 4) {
+                put_varint(out, zigzag(ipv4_value(addr), previous));
+                previous = ipv4_value(addr);
+            }
+            else {
+                out.insert(out.end(), addr, addr + 16);
+            }
+        }
+    }
+    for (uint64_t ArchiveRow::*column : {&ArchiveRow::rx_bytes, &ArchiveRow::tx_bytes, &ArchiveRow::rx_packets, &ArchiveRow::tx_packets}) {
+        uint64_t previous = 0;
+        for (const ArchiveRow& row : rows) {
+            put_varint(out, zigzag(row.*column, previous));
+            previous = row.*column;
+        }
+    }
+}
+
+/**
+    @brief Dekódovanie stĺpcov bloku
+    @return false ak stĺpce nezodpovedajú počtu riadkov
+ */
+static bool decode_rows(const uint8_t* p, const uint8_t* end, uint32_t count, vector<ArchiveRow>& rows) {
+    if (static_cast<size_t>(end - p) < static_cast<size_t>(count) * 3) {
+        return false;
+    }
+    rows.assign(count, ArchiveRow());
+    for (ArchiveRow& row : rows) {
+        row.key.family = *p++;
+        if (row.key.family != 4 && row.key.family != 6) {
+            return false;
+        }
+    }
+    for (ArchiveRow& row : rows) {
+        row.key.proto = *p++;
+    }
+    for (ArchiveRow& row : rows) {
+        row.flags = *p++;
+    }
+    uint64_t value;
+    for (bool src : {true, false}) {
+        for (ArchiveRow& row : rows) {
+            if (!get_varint(p, end, value) || value > UINT16_MAX) {
+                return false;
+            }
+            (src ? row.key.src_port : row.key.dst_port) = static_cast<uint16_t>(value);
+        }
+    }
+    for (bool src : {true, false}) {
+        uint64_t previous = 0;
+        for (ArchiveRow& row : rows) {
+            uint8_t* addr = src ? row.key.src : row.key.dst;
+            if (row.key.family == 4) {
+                if (!get_varint(p, end, value)) {
+                    return false;
+                }
+                previous = unzigzag(value, previous) & 0xFFFFFFFF;
+                addr[0] = static_cast<uint8_t>(previous >> 24);
+                addr[1] = static_cast<uint8_t>(previous >> 16);
+                addr[2] = static_cast<uint8_t>(previous >> 8);
+                addr[3] = static_cast<uint8_t>(previous);
+            }
+            else {
+                if (end - p < 16) {
+                    return false;
+                }
+                memcpy(addr, p, 16);
+                p += 16;
+            }
+        }
+    }
+    for (uint64_t ArchiveRow::*column : {&ArchiveRow::rx_bytes, &ArchiveRow::tx_bytes, &ArchiveRow::rx_packets, &ArchiveRow::tx_packets}) {
+        uint64_t previous = 0;
+        for (ArchiveRow& row : rows) {
+            if (!get_varint(p, end, value)) {
+                return false;
+            }
+            row.*column = previous = unzigzag(value, previous);
+        }
+    }
+    return p == end;
+}
+
+/**
+    @brief Načítanie a overenie bloku na pozícii offset
+    @param payload buffer pre stĺpce bloku
+    @return false ak blok nie je celý alebo nesedí kontrolný súčet
+ */
+static bool read_block(int fd, uint64_t offset, uint64_t file_size, ArchiveBlockHeader& header, vector<uint8_t>& payload) {
+    if (offset + sizeof(header) > file_size
+        || pread(fd, &header, sizeof(header), static_cast<off_t>(offset)) != static_cast<ssize_t>(sizeof(header))) {
+        return false;
+    }
+    if (header.magic != ARCHIVE_BLOCK_MAGIC || header.size > MAX_BLOCK_SIZE || offset + sizeof(header) + header.size > file_size) {
+        return false;
+    }
+    payload.resize(header.size);
+    if (header.size != 0 && pread(fd, payload.data(), header.size, static_cast<off_t>(offset + sizeof(header))) != static_cast<ssize_t>(header.size)) {
+        return false;
+    }
+    return fnv1a(payload.data(), payload.size()) == header.checksum;
+}
+
+/**
+    @brief Overenie hlavičky existujúceho archívu
+ */
+static void check_file_header(int fd, const string& path) {
+    ArchiveFileHeader header;
+    if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || memcmp(header.magic, ARCHIVE_MAGIC, 8) != 0) {
+        throw runtime_error("File " + path + " is not an isa-top archive");
+    }
+    if (header.byte_order != BYTE_ORDER_MARK || header.version != ARCHIVE_VERSION) {
+        throw runtime_error("Archive " + path + " has an incompatible format");
+    }
+}
+
+/**
+    @brief Načítanie indexu; platí iba začiatok so vzostupnými pozíciami blokov v rámci archívu
+ */
+static vector<ArchiveIndexEntry> load_index(int fd, uint64_t file_size) {
+    vector<ArchiveIndexEntry> index;
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        return index;
+    }
+    index.resize(static_cast<size_t>(st.st_size) / sizeof(ArchiveIndexEntry));
+    ssize_t bytes = pread(fd, index.data(), index.size() * sizeof(ArchiveIndexEntry), 0);
+    index.resize(bytes > 0 ? static_cast<size_t>(bytes) / sizeof(ArchiveIndexEntry) : 0);
+    uint64_t previous = 0;
+    for (size_t i = 0; i < index.size(); i++) {
+        if (index[i].offset < sizeof(ArchiveFileHeader) || (i > 0 && index[i].offset <= previous)
+            || index[i].offset + sizeof(ArchiveBlockHeader) > file_size) {
+            index.resize(i);
+            break;
+        }
+        previous = index[i].offset;
+    }
+    return index;
+}
+
+/**
+    @brief Doplnenie indexu prechodom blokov od pozície offset
+    @return pozícia za posledným platným blokom
+ */
+static uint64_t scan_blocks(int fd, uint64_t offset, uint64_t file_size, vector<ArchiveIndexEntry>& index) {
+    ArchiveBlockHeader header;
+    vector<uint8_t> payload;
+    while (read_block(fd, offset, file_size, header, payload)) {
+        index.push_back(ArchiveIndexEntry{header.start_usec, offset});
+        offset += sizeof(header) + header.size;
+    }
+    return offset;
+}
+
+/**
+    @brief Otvorenie alebo vytvorenie archívu
+ */
+ArchiveWriter::ArchiveWriter(const string& path) : fd_(-1), index_fd_(-1), size_(0), blocks_(0) {
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw runtime_error("Cannot open archive " + path + ": " + strerror(errno));
+    }
+    // do archívu smie zapisovať iba jeden proces
+    if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        close(fd_);
+        throw runtime_error("Archive " + path + " is used by another process");
+    }
+    index_fd_ = open((path + ".idx").c_str(), O_RDWR | O_CREAT, 0644);
+    if (index_fd_ < 0) {
+        close(fd_);
+        throw runtime_error("Cannot open archive index " + path + ".idx: " + strerror(errno));
+    }
+
+    struct stat st;
+    fstat(fd_, &st);
+    uint64_t file_size = static_cast<uint64_t>(st.st_size);
+    if (file_size == 0) {
+        ArchiveFileHeader header;
+        memcpy(header.magic, ARCHIVE_MAGIC, 8);
+        header.version = ARCHIVE_VERSION;
+        header.byte_order = BYTE_ORDER_MARK;
+        if (pwrite(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            close(fd_);
+            close(index_fd_);
+            throw runtime_error("Cannot write archive " + path + ": " + strerror(errno));
+        }
+        file_size = sizeof(header);
+    }
+    else {
+        try {
+            check_file_header(fd_, path);
+        } catch (...) {
+            close(fd_);
+            close(index_fd_);
+            throw;
+        }
+    }
+
+    // posledný indexovaný blok sa overí znova, bloky za ním (zápis indexu nedobehol) sa doindexujú
+    vector<ArchiveIndexEntry> index = load_index(index_fd_, file_size);
+    uint64_t offset = sizeof(ArchiveFileHeader);
+    if (!index.empty()) {
+        offset = index.back().offset;
+        index.pop_back();
+    }
+    size_t valid = index.size();
+    size_ = scan_blocks(fd_, offset, file_size, index);
+    // neúplný blok na konci (pád počas zápisu) sa odstráni
+    if (size_ < file_size && ftruncate(fd_, static_cast<off_t>(size_)) != 0) {
+        throw runtime_error("Cannot truncate archive " + path + ": " + strerror(errno));
+    }
+    if (ftruncate(index_fd_, static_cast<off_t>(valid * sizeof(ArchiveIndexEntry))) != 0
+        || pwrite(index_fd_, index.data() + valid, (index.size() - valid) * sizeof(ArchiveIndexEntry),
+                  static_cast<off_t>(valid * sizeof(ArchiveIndexEntry))) < 0) {
+        throw runtime_error("Cannot write archive index " + path + ".idx: " + strerror(errno));
+    }
+    blocks_ = index.size();
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    close(index_fd_);
+    close(fd_);
+}
+
+/**
+    @brief Pripísanie bloku na koniec archívu a položky do indexu
+ */
+bool ArchiveWriter::append(ArchiveBlock& block) {
+    sort(block.rows.begin(), block.rows.end(), [](const ArchiveRow& a, const ArchiveRow& b) {
+        return a.rx_bytes + a.tx_bytes > b.rx_bytes + b.tx_bytes;
+    });
+    buffer_.assign(sizeof(ArchiveBlockHeader), 0);
+    encode_rows(block.rows, buffer_);
+
+    ArchiveBlockHeader header;
+    header.magic = ARCHIVE_BLOCK_MAGIC;
+    header.size = static_cast<uint32_t>(buffer_.size() - sizeof(header));
+    header.start_usec = block.start_usec;
+    header.end_usec = block.end_usec;
+    header.rows = static_cast<uint32_t>(block.rows.size());
+    header.checksum = fnv1a(buffer_.data() + sizeof(header), header.size);
+    memcpy(buffer_.data(), &header, sizeof(header));
+
+    // blok sa zapíše pred indexom, index sa pri otvorení doplní, ak jeho zápis nedobehne
+    if (pwrite(fd_, buffer_.data(), buffer_.size(), static_cast<off_t>(size_)) != static_cast<ssize_t>(buffer_.size())) {
+        return false;
+    }
+    ArchiveIndexEntry entry{block.start_usec, size_};
+    size_ += buffer_.size();
+    if (pwrite(index_fd_, &entry, sizeof(entry), static_cast<off_t>(blocks_ * sizeof(entry))) != static_cast<ssize_t>(sizeof(entry))) {
+        return false;
+    }
+    blocks_++;
+    return true;
+}
+
+/**
+    @brief Počet blokov v archíve
+ */
+size_t ArchiveWriter::blocks() const {
+    return blocks_;
+}
+
+/**
+    @brief Veľkosť archívu v bajtoch
+ */
+uint64_t ArchiveWriter::size() const {
+    return size_;
+}
+
+/**
+    @brief Otvorenie archívu na čítanie
+ */
+ArchiveReader::ArchiveReader(const string& path) : fd_(-1), size_(0) {
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw runtime_error("Cannot open archive " + path + ": " + strerror(errno));
+    }
+    try {
+        check_file_header(fd_, path);
+    } catch (...) {
+        close(fd_);
+        throw;
+    }
+    struct stat st;
+    fstat(fd_, &st);
+    size_ = static_cast<uint64_t>(st.st_size);
+
+    int index_fd = open((path + ".idx").c_str(), O_RDONLY);
+    index_ = load_index(index_fd, size_);
+    if (index_fd >= 0) {
+        close(index_fd);
+    }
+    // bloky bez položky v indexe (index chýba alebo ho zapisovač ešte nedoplnil) sa nájdu prechodom
+    uint64_t offset = sizeof(ArchiveFileHeader);
+    if (!index_.empty()) {
+        ArchiveBlockHeader header;
+        vector<uint8_t> payload;
+        offset = index_.back().offset;
+        if (!read_block(fd_, offset, size_, header, payload)) {
+            return;
+        }
+        offset += sizeof(header) + header.size;
+    }
+    scan_blocks(fd_, offset, size_, index_);
+}
+
+ArchiveReader::~ArchiveReader() {
+    close(fd_);
+}
+
+/**
+    @brief Prechod blokmi, ktoré zasahujú do intervalu [from_usec, to_usec)
+ */
+size_t ArchiveReader::scan(int64_t from_usec, int64_t to_usec, const function<void(const ArchiveBlock&)>& callback) {
+    auto it = lower_bound(index_.begin(), index_.end(), from_usec, [](const ArchiveIndexEntry& entry, int64_t value) {
+        return entry.start_usec < value;
+    });
+    // predchádzajúci blok môže začínať pred from_usec a končiť až za ním
+    if (it != index_.begin()) {
+        --it;
+    }
+    size_t read = 0;
+    ArchiveBlockHeader header;
+    vector<uint8_t> payload;
+    ArchiveBlock block;
+    for (; it != index_.end() && it->start_usec < to_usec; ++it) {
+        if (!read_block(fd_, it->offset, size_, header, payload)
+            || !decode_rows(payload.data(), payload.data() + payload.size(), header.rows, block.rows)) {
+            continue; // poškodený blok sa preskočí
+        }
+        read++;
+        if (header.end_usec <= from_usec) {
+            continue;
+        }
+        block.start_usec = header.start_usec;
+        block.end_usec = header.end_usec;
+        callback(block);
+    }
+    return read;
+}
+
+/**
+    @brief Počet blokov v indexe
+ */
+size_t ArchiveReader::blocks() const {
+    return index_.size();
+}
+
+/**
+    @brief Konštruktor, otvorí archív
+ */
+FlowArchiver::FlowArchiver(ViewPublisher& views, const ArchiveConfig& config)
+    : views_(views), config_(config), writer_(config.path), interval_start_(now_usec()), running_(false) {
+    // toky obnovené z tabuľky (--table) sa do prvého intervalu započítajú iba prírastkami
+    for (const FlowRecord& record : views_.latest()->records) {
+        previous_[record.key] = ArchiveRow{record.key, 0, record.rx_bytes, record.tx_bytes, record.rx_packets, record.tx_packets};
+    }
+}
+
+FlowArchiver::~FlowArchiver() {
+    stop();
+}
+
+/**
+    @brief Spustenie vlákna archivácie
+ */
+void FlowArchiver::start() {
+    lock_guard<mutex> lock(run_mtx_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = thread(&FlowArchiver::run_loop, this);
+}
+
+/**
+    @brief Zastavenie vlákna, rozpracovaný interval sa zapíše
+ */
+void FlowArchiver::stop() {
+    {
+        lock_guard<mutex> lock(run_mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    archive_once(now_usec());
+}
+
+/**
+    @brief Slučka vlákna archivácie
+ */
+void FlowArchiver::run_loop() {
+    unique_lock<mutex> lock(run_mtx_);
+    auto deadline = chrono::steady_clock::now() + config_.interval;
+    while (running_) {
+        // čaká sa na pevné hranice intervalov, trvanie zápisu sa nenačítava
+        if (cv_.wait_until(lock, deadline, [this] { return !running_; })) {
+            break;
+        }
+        deadline += config_.interval;
+        lock.unlock();
+        archive_once(now_usec());
+        lock.lock();
+    }
+}
+
+/**
+    @brief Uzavretie intervalu končiaceho v now_usec
+ */
+size_t FlowArchiver::archive_once(int64_t now) {
+    // záznamy z posledného publikovaného pohľadu, zámok Stats sa nedrží vôbec
+    shared_ptr<const StatsView> view = views_.latest();
+    uint64_t scale = view->sample_rate;
+
+    ArchiveBlock block{interval_start_, now, {}};
+    unordered_map<FlowKey, ArchiveRow, FlowKeyHash, FlowKeyEqual> current;
+    current.reserve(view->records.size());
+    for (const FlowRecord& record : view->records) {
+        ArchiveRow& previous = current[record.key];
+        auto it = previous_.find(record.key);
+        // tok odstránený z plnej tabuľky a vložený znova má počítadlá opäť od nuly
+        if (it != previous_.end() && record.rx_packets >= it->second.rx_packets && record.tx_packets >= it->second.tx_packets) {
+            previous = it->second;
+        }
+        ArchiveRow row{record.key, static_cast<uint8_t>(record.flags & FLOW_NO_PORTS),
+                       (record.rx_bytes - previous.rx_bytes) * scale, (record.tx_bytes - previous.tx_bytes) * scale,
+                       (record.rx_packets - previous.rx_packets) * scale, (record.tx_packets - previous.tx_packets) * scale};
+        previous.rx_bytes = record.rx_bytes;
+        previous.tx_bytes = record.tx_bytes;
+        previous.rx_packets = record.rx_packets;
+        previous.tx_packets = record.tx_packets;
+        if (row.rx_packets + row.tx_packets == 0) {
+            continue; // v tomto intervale bez paketov
+        }
+        if (config_.min_bytes == 0 || row.rx_bytes + row.tx_bytes >= config_.min_bytes) {
+            block.rows.push_back(row);
+        }
+    }
+    // toky, ktoré už v tabuľke nie sú, sa zabudnú
+    previous_.swap(current);
+    if (config_.min_bytes == 0 && block.rows.size() > config_.top) {
+        nth_element(block.rows.begin(), block.rows.begin() + config_.top, block.rows.end(), [](const ArchiveRow& a, const ArchiveRow& b) {
+            return a.rx_bytes + a.tx_bytes > b.rx_bytes + b.tx_bytes;
+        });
+        block.rows.resize(config_.top);
+    }
+
+    // prázdny interval sa tiež zapíše, aby sa dalo odlíšiť obdobie bez prevádzky od obdobia bez archivácie
+    writer_.append(block);
+    interval_start_ = now;
+    return block.rows.size();
+}
+
+/**
+    @brief Počet zapísaných blokov
+ */
+size_t FlowArchiver::blocks() const {
+    return writer_.blocks();
+}
+
+/**
+    @brief Najväčšie toky v časovom rozsahu archívu (režim --query)
+ */
+size_t query_archive(const string& path, int64_t from_usec, int64_t to_usec, char sort_option, size_t count, ostream& out,
+                     const FlowFilter* filter) {
+    ArchiveReader reader(path);
+    // súčty podľa toku, binárny kľúč slúži ako kľúč mapy
+    unordered_map<string, FlowRecord> flows;
+    int64_t first = 0, last = 0;
+    size_t read = reader.scan(from_usec, to_usec, [&](const ArchiveBlock& block) {
+        first = first == 0 ? block.start_usec : first;
+        last = block.end_usec;
+        for (const ArchiveRow& row : block.rows) {
+            string key(reinterpret_cast<const char*>(&row.key), sizeof(row.key));
+            auto it = flows.find(key);
+            if (it == flows.end()) {
+                FlowRecord record;
+                memset(&record, 0, sizeof(record));
+                record.key = row.key;
+                record.flags = row.flags;
+                record.first_seen = block.start_usec;
+                it = flows.emplace(key, record).first;
+            }
+            FlowRecord& record = it->second;
+            record.rx_bytes += row.rx_bytes;
+            record.tx_bytes += row.tx_bytes;
+            record.rx_packets += row.rx_packets;
+            record.tx_packets += row.tx_packets;
+            record.last_seen = block.end_usec;
+        }
+    });
+
+    out << "Archive: " << path << ", " << read << " of " << reader.blocks() << " intervals read";
+    if (first != 0) {
+        out << ", " << format_timestamp(first) << " - " << format_timestamp(last);
+    }
+    out << "\n";
+    // výpis zdieľa zoradenie, filter a formát s --inspect (dočasná tabuľka v pamäti)
+    FlowTable table(max<size_t>(flows.size() * 2, 16));
+    for (const auto& [key, flow] : flows) {
+        FlowRecord* record = table.find_or_insert(flow.key);
+        if (record != nullptr) {
+            FlowKey stored = record->key;
+            *record = flow;
+            record->key = stored;
+            record->used = 1;
+        }
+    }
+    print_top_flows(table, sort_option, count, out, filter);
+    return read;
+}
+
+/**
+    @brief Čas pre --from/--to
+ */
+int64_t parse_archive_time(const string& text, int64_t now) {
+    if (text.size() >= 3 && text[0] == '-' && strchr("smhd", text.back()) != nullptr
+        && text.find_first_not_of("0123456789", 1) == text.size() - 1 && text.size() <= 12) {
+        static const int64_t units[] = {1, 60, 3600, 86400};
+        int64_t unit = units[strchr("smhd", text.back()) - "smhd"];
+        return now - stoll(text.substr(1, text.size() - 2)) * unit * 1000000;
+    }
+    if (!text.empty() && text.size() <= 12 && text.find_first_not_of("0123456789") == string::npos) {
+        return stoll(text) * 1000000;
+    }
+    static const char* formats[] = {"%Y-%m-%d %H:%M:%S", "%Y-%m-%dT%H:%M:%S", "%Y-%m-%d %H:%M", "%Y-%m-%dT%H:%M", "%Y-%m-%d"};
+    for (const char* format : formats) {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        const char* end = strptime(text.c_str(), format, &tm);
+        if (end != nullptr && *end == '\0') {
+            tm.tm_isdst = -1; // letný čas podľa dátumu
+            return static_cast<int64_t>(mktime(&tm)) * 1000000;
+        }
+    }
+    throw invalid_argument("Invalid time '" + text + "'. Use unix seconds, 'YYYY-MM-DD HH:MM[:SS]' or '-<n>s|m|h|d'.");
+}
+//====END OF archive.cpp ======
@@ -5,23 +5,36 @@
 */
 #include "include/display.h"
 #include "include/stats.h"
+#include "include/parser.h"
+#include "include/sampler.h"
 #include <ncurses.h>
+#include <netinet/in.h>
 #include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
 
+// šírka stĺpca so stavom TCP (RTT handshaku, retransmisie/segmenty mimo poradia)
+static constexpr int COL_WIDTH_TCP = 18;
+
 
 /**
     @brief Konštruktor triedy Display 
     @param stats referencia na objekt triedy Stats
+    @param views publikované pohľady na štatistiky (zdroj všetkých zobrazených hodnôt)
     @param sort_option zvolená možnosť zoradenia
     @param refresh_interval interval obnovovania obrazovky
     @param running flag pre indikáciu, či je zobrazovací loop spustený
+    @param resolve_names true ak sa majú adresy prekladať na mená už pri štarte
+    @param dumper zapisovač paketov najväčších tokov (nullptr ak je vypnutý)
+    @param dump_top počet najväčších tokov, ktorých pakety sa zapisujú
 */
-Display::Display(Stats& stats, char sort_option, int refresh_interval, bool running)
-    : stats_(stats), sort_option_(sort_option), refresh_interval_(refresh_interval), running_(running) {
+Display::Display(Stats& stats, ViewPublisher& views, char sort_option, int refresh_interval, bool running, bool resolve_names,
+                 PcapDumper* dumper, size_t dump_top)
+    : stats_(stats), views_(views), sort_option_(sort_option), refresh_interval_(refresh_interval), running_(running),
+      dumper_(dumper), dump_top_(dump_top) {
+    resolver_.set_enabled(resolve_names);
 }
 
 /**
@@ -50,6 +63,11 @@ void Display::run() {
     curs_set(FALSE);
     // Povolenie čítania funkčných klávesov
     nodelay(stdscr, TRUE); //umožňuje používať getch() bez blokovania
+    // šípky na výber riadku
+    keypad(stdscr, TRUE);
+
+    // Priraďovanie tokov procesom beží na pozadí
+    processes_.start();
 
     // Spustenie zobrazovacieho loop v samostatnom vlákne;
     display_thread_ = thread(&Display::display_loop, this);
@@ -64,6 +82,7 @@ void Display::stop() {
 
         display_thread_.join();
     }
+    processes_.stop();
     // End ncurses mode
     endwin();}
 
@@ -101,21 +120,39 @@ string format_packets(double packets) {
 }
 
 /**
-    @brief Rozdelí reťazec podľa zadaného oddeľovača
-    @param str reťazec na rozdelenie
-    @param delimiter oddeľovač
-    @return vektor reťazcov
+    @brief formátovanie času v mikrosekundách na ľudsky čitateľný formát
+    @param usec čas v mikrosekundách
+    @return formátovaný reťazec
  */
-vector<string> split(const string& str, char delimiter) {
-    vector<string> tokens;
-    stringstream ss(str);
-    string token;
-    while (getline(ss, token, delimiter)) {
-        tokens.push_back(token);
-    }
-    return tokens;
+string format_duration(uint64_t usec) {
+    ostringstream oss;
+    if (usec >= 1000000) {
+        oss << fixed << setprecision(1) << usec / 1e6 << " s";
+    }
+    else if (usec >= 1000) {
+        oss << fixed << setprecision(1) << usec / 1e3 << " ms";
+    }
+    else {
+        oss << usec << " us";
+    }
+    return oss.str();
 }
 
+/**
+    @brief Označenie odhadnutej hodnoty pri vzorkovaní ("~hodnota ±x%", x je 95 % interval spoľahlivosti)
+    @param text formátovaná hodnota
+    @param value odhad
+    @param variance rozptyl odhadu (0 ak sa nevzorkuje, hodnota sa vráti bez zmeny)
+    @return formátovaný reťazec
+ */
+string format_estimate(const string& text, double value, double variance) {
+    if (variance <= 0 || value <= 0) {
+        return text;
+    }
+    ostringstream oss;
+    oss << "~" << text << " ±" << fixed << setprecision(0) << confidence_95(variance) / value * 100 << "%";
+    return oss.str();
+}
 
 /**
     @brief Nepretržite zobrazuje štatistiku siete v slučke, kým sa nezastaví alebo neukončí vstupom používateľa.
@@ -130,16 +167,46 @@ void Display::display_loop() {
 
     while (running_) {
         clear();
-        if (check_exit()) {
+        if (handle_input()) {
             running_ = false;
             break; 
         }
 
-        display_header(col_width_src, col_width_dst, col_width_proto, col_width_rx, col_width_tx);
+        // výber tokov na zapisovanie sa obnovuje s každým vykreslením
+        if (dumper_ != nullptr) {
+            stats_.mark_top_flows(dumper_->enabled() ? dump_top_ : 0, sort_option_);
+        }
+
+        const auto& connections = get_sorted_connections();
+        // pri vzorkovaní sú všetky hodnoty odhady
+        uint32_t sample_rate = frame_view_->sample_rate;
+        if (sample_rate > 1) {
+            mvprintw(1, 0, "Sampled 1-in-%u: ~ marks estimates, ± is the 95%% confidence interval", sample_rate);
+        }
+        // výber zostáva v rozsahu zobrazených riadkov
+        selected_ = max(0, min(selected_, min(static_cast<int>(connections.size()), 10) - 1));
 
-        auto connections = get_sorted_connections();
+        if (view_ == VIEW_PROCESSES) {
+            display_processes(connections);
+        }
+        else if (view_ == VIEW_NETWORKS) {
+            display_networks();
+        }
+        else {
+            display_header(col_width_src, col_width_dst, col_width_proto, col_width_rx, col_width_tx);
+            display_connections(connections, col_width_src, col_width_dst, col_width_proto, col_width_rx, col_width_tx);
+            display_histograms(connections);
+            display_detail();
+        }
 
-        display_connections(connections, col_width_src, col_width_dst, col_width_proto, col_width_rx, col_width_tx);
+        // stav filtra v poslednom riadku
+        const auto& filter = frame_view_->filter;
+        if (!filter_error_.empty()) {
+            mvprintw(LINES - 1, 0, "%s", filter_error_.c_str());
+        }
+        else if (filter) {
+            mvprintw(LINES - 1, 0, "Filter: %s  ('/' to change, empty to clear)", filter->text().c_str());
+        }
 
         refresh();
         this_thread::sleep_for(chrono::seconds(refresh_interval_));
@@ -147,16 +214,110 @@ void Display::display_loop() {
 }
 
 /**
-    @brief Kontrola vstupu používateľa
+    @brief Spracovanie vstupu používateľa ('q' ukončenie, 'r' prepnutie prekladu adries na mená, 'v' prepnutie pohľadu,
+    'n' pohľad podľa sietí, '/' zadanie filtra, 'd' prepnutie zapisovania paketov, šípky výber riadku,
+    Enter sledovanie vybraného toku)
     @return true ak používateľ stlačil klávesu 'q', inak false
  */
-bool Display::check_exit() {
+bool Display::handle_input() {
     int ch = getch();
+    if (ch == KEY_UP && selected_ > 0) {
+        selected_--;
+    }
+    else if (ch == KEY_DOWN) {
+        selected_++; // ohraničí sa pri vykreslení podľa počtu riadkov
+    }
+    else if (ch == 'r') {
+        resolver_.toggle();
+    }
+    else if (ch == 'v') {
+        view_ = view_ == VIEW_FLOWS ? VIEW_PROCESSES : VIEW_FLOWS;
+    }
+    else if (ch == 'n') {
+        view_ = view_ == VIEW_NETWORKS ? VIEW_FLOWS : VIEW_NETWORKS;
+    }
+    else if (ch == 'd' && dumper_ != nullptr) {
+        dumper_->toggle();
+    }
+    else if (ch == '/') {
+        edit_filter();
+    }
+    else if ((ch == '\n' || ch == KEY_ENTER) && view_ == VIEW_FLOWS) {
+        toggle_watch();
+    }
     return ch == 'q';
 }
 
 /**
-    @brief Zobrazí hlavičku tabuľky 
+    @brief Zapnutie sledovania vybraného toku, alebo jeho vypnutie, ak je vybraný sledovaný tok
+ */
+void Display::toggle_watch() {
+    bool same = watching_ && selected_key_ == watched_;
+    if (watching_) {
+        stats_.unwatch(watched_);
+        watching_ = false;
+    }
+    if (!same && !selected_key_.src.empty() && stats_.watch(selected_key_)) {
+        watched_ = selected_key_;
+        watching_ = true;
+    }
+}
+
+/**
+    @brief Načítanie filtrovacieho výrazu v poslednom riadku obrazovky (prázdny výraz filter zruší)
+ */
+void Display::edit_filter() {
+    char buf[256] = {0};
+    mvprintw(LINES - 1, 0, "Filter: ");
+    clrtoeol();
+    // počas písania sa čaká na vstup a zobrazuje kurzor
+    echo();
+    curs_set(TRUE);
+    nodelay(stdscr, FALSE);
+    getnstr(buf, sizeof(buf) - 1);
+    noecho();
+    curs_set(FALSE);
+    nodelay(stdscr, TRUE);
+
+    string text(buf);
+    try {
+        stats_.set_filter(text.find_first_not_of(' ') == string::npos ? nullptr : make_shared<const FlowFilter>(text));
+        filter_error_.clear();
+        selected_ = 0;
+        // nový filter sa prejaví hneď, nie až pri ďalšom periodickom publikovaní
+        views_.publish();
+    } catch (const invalid_argument& e) {
+        filter_error_ = e.what(); // predchádzajúci filter zostáva
+    }
+}
+
+/**
+    @brief Textová reprezentácia koncového bodu s menom hostiteľa namiesto adresy, ak je už preložené
+    @param endpoint koncový bod vo formáte "IP:port" (IPv6 v tvare "[IP]:port")
+    @return koncový bod vo formáte "meno:port" alebo pôvodný reťazec
+ */
+string Display::display_endpoint(const string& endpoint) {
+    if (!resolver_.enabled()) {
+        return endpoint;
+    }
+    size_t port_pos = endpoint.rfind(':');
+    if (port_pos == string::npos) {
+        return endpoint;
+    }
+    string ip = endpoint.substr(0, port_pos);
+    if (!ip.empty() && ip.front() == '[' && ip.back() == ']') {
+        ip = ip.substr(1, ip.size() - 2);
+    }
+    // preklad prebieha na pozadí, kým nie je hotový, zobrazí sa adresa
+    string name = resolver_.lookup(ip);
+    if (name.empty()) {
+        return endpoint;
+    }
+    return name + endpoint.substr(port_pos);
+}
+
+/**
+    @brief Zobrazí hlavičku tabuľky a počet tokov v tabuľke spolu s počtom zahodených nových tokov
     @param col_width_src šírka stĺpca pre zdrojovú IP adresu
     @param col_width_dst šírka stĺpca pre cieľovú IP adresu
     @param col_width_proto šírka stĺpca pre protokol
@@ -172,6 +333,7 @@ void Display::display_header(int col_width_src, int col_width_dst, int col_width
             col_width_proto, "Proto",
             col_width_rx, "Rx (b/s)",
             col_width_tx, "Tx (b/s)");
+        printw(" %-*s Process", COL_WIDTH_TCP, "RTT retx/ooo");
     }
     // Zobrazenie hlavičky tabuľky v packetoch
     else if (sort_option_ == 'p') {
@@ -181,55 +343,21 @@ void Display::display_header(int col_width_src, int col_width_dst, int col_width
             col_width_proto, "Proto",
             col_width_rx, "Rx (p/s)",
             col_width_tx, "Tx (p/s)");
+        printw(" %-*s Process", COL_WIDTH_TCP, "RTT retx/ooo");
     }
+    // nové toky, ktoré sa nezmestili do plnej tabuľky, chýbajú vo všetkých pohľadoch
+    printw("   Flows: %zu, dropped: %llu", frame_view_->flow_count, static_cast<unsigned long long>(frame_view_->dropped_flows));
 }
 
 
 /**
-    @brief Získa zoradený zoznam pripojení podľa zvoleného kritéria
-    @return zoradený zoznam pripojení
+    @brief Získa zoradený zoznam pripojení podľa zvoleného kritéria z posledného publikovaného pohľadu
+    Smery tokov sú v pohľade už zlúčené a zoradené, berie sa iba referencia bez zámku štatistík.
+    @return zoradený zoznam pripojení (platný do ďalšieho volania)
  */
-vector<pair<ConnectionKey, ConnectionStats>> Display::get_sorted_connections() {
-    auto snapshot = stats_.get_stats_snapshot();
-    unordered_map<string, ConnectionStats> merged_connections;
-
-    // Merge revezného toku dát
-    for (const auto& [key, stats] : snapshot) {
-        // Vytvorenie kombinovaného kľúča (nezávisle od smeru)
-        string merged_key = key.src < key.dst 
-                            ? key.src + "|" + key.dst + "|" + key.proto 
-                            : key.dst + "|" + key.src + "|" + key.proto;
-
-        if (merged_connections.find(merged_key) == merged_connections.end()) {
-            merged_connections[merged_key] = stats;
-        } else {
-            merged_connections[merged_key].rx_bytes += stats.rx_bytes;
-            merged_connections[merged_key].tx_bytes += stats.tx_bytes;
-            merged_connections[merged_key].rx_packets += stats.rx_packets;
-            merged_connections[merged_key].tx_packets += stats.tx_packets;
-        }
-    }
-
-    // Konverzia mapy na vektor pre zoradenie
-    vector<pair<ConnectionKey, ConnectionStats>> connections;
-    for (const auto& [merged_key, stats] : merged_connections) {
-        auto parts = split(merged_key, '|'); 
-        ConnectionKey combined_key{parts[0], parts[1], parts[2]};
-        connections.emplace_back(combined_key, stats);
-    }
-
-    // Sort connections based on selected criteria
-    if (sort_option_ == 'b') {
-        sort(connections.begin(), connections.end(), [](const pair<ConnectionKey, ConnectionStats>& a, const pair<ConnectionKey, ConnectionStats>& b) {
-            return a.second.rx_bytes + a.second.tx_bytes > b.second.rx_bytes + b.second.tx_bytes;
-        });
-    } else if (sort_option_ == 'p') {
-        sort(connections.begin(), connections.end(), [](const pair<ConnectionKey, ConnectionStats>& a, const pair<ConnectionKey, ConnectionStats>& b) {
-            return a.second.rx_packets + a.second.tx_packets > b.second.rx_packets + b.second.tx_packets;
-        });
-    }
-
-    return connections;
+const vector<pair<ConnectionKey, ConnectionStats>>& Display::get_sorted_connections() {
+    frame_view_ = views_.latest();
+    return frame_view_->flows(sort_option_);
 }
 
 /**
@@ -240,27 +368,230 @@ void Display::display_connections(const vector<pair<ConnectionKey, ConnectionSta
     
     for (int count = 0; count < min(static_cast<int>(connections.size()), max_display_count); ++count) {
         const auto& [key, stats] = connections[count];
+        if (count == selected_) {
+            attron(A_REVERSE);
+            selected_key_ = key;
+        }
         
         double rx_bps = stats.rx_bytes / refresh_interval_;
         double rx_pps = stats.rx_packets / refresh_interval_;
         double tx_bps = stats.tx_bytes / refresh_interval_;
         double tx_pps = stats.tx_packets / refresh_interval_;
 
+        // prekladajú sa iba adresy zobrazených riadkov
+        string src = display_endpoint(key.src).substr(0, col_width_src);
+        string dst = display_endpoint(key.dst).substr(0, col_width_dst);
+
         if (sort_option_ == 'b') {
             mvprintw(2 + count, 0, "%-*s %-*s %-*s %-*s %-*s",
-                col_width_src, key.src.c_str(),
-                col_width_dst, key.dst.c_str(),
+                col_width_src, src.c_str(),
+                col_width_dst, dst.c_str(),
                 col_width_proto, key.proto.c_str(),
-                col_width_rx, format_bytes(rx_bps).c_str(),
-                col_width_tx, format_bytes(tx_bps).c_str());
+                col_width_rx, format_estimate(format_bytes(rx_bps), stats.rx_bytes, stats.rx_bytes_var).c_str(),
+                col_width_tx, format_estimate(format_bytes(tx_bps), stats.tx_bytes, stats.tx_bytes_var).c_str());
         } else if (sort_option_ == 'p') {
             mvprintw(2 + count, 0, "%-*s %-*s %-*s %-*s %-*s",
-                col_width_src, key.src.c_str(),
-                col_width_dst, key.dst.c_str(),
+                col_width_src, src.c_str(),
+                col_width_dst, dst.c_str(),
                 col_width_proto, key.proto.c_str(),
-                col_width_rx, format_packets(rx_pps).c_str(),
-                col_width_tx, format_packets(tx_pps).c_str());
+                col_width_rx, format_estimate(format_packets(rx_pps), stats.rx_packets, stats.rx_packets_var).c_str(),
+                col_width_tx, format_estimate(format_packets(tx_pps), stats.tx_packets, stats.tx_packets_var).c_str());
+        }
+
+        // RTT handshaku a počty retransmisií / segmentov mimo poradia (iba TCP)
+        TcpSummary tcp;
+        string tcp_text = "-";
+        if (frame_view_->tcp_stats(key, tcp)) {
+            tcp_text = (tcp.rtt_usec != 0 ? format_duration(tcp.rtt_usec) : string("?")) + " "
+                       + to_string(tcp.retransmissions) + "/" + to_string(tcp.out_of_order);
+        }
+        printw(" %-*s", COL_WIDTH_TCP, tcp_text.c_str());
+
+        ProcessInfo process;
+        if (find_process(key, process)) {
+            printw(" %d/%s", process.pid, process.comm.c_str());
         }
+        attroff(A_REVERSE);
+    }
+}
+
+/**
+    @brief Zobrazí percentily veľkostí paketov a medzipaketových časov vybraného toku pod tabuľkou
+    @param connections zoradený zoznam pripojení
+ */
+void Display::display_histograms(const vector<pair<ConnectionKey, ConnectionStats>>& connections) {
+    const int max_display_count = 10;
+    if (selected_ >= static_cast<int>(connections.size())) {
+        return;
+    }
+
+    FlowHistograms hist;
+    if (!frame_view_->histograms(connections[selected_].first, hist)) {
+        return;
+    }
+    string size_line = "Size p50/p90/p99: " + to_string(histogram_percentile(hist.size, SIZE_BUCKETS, 50)) + "/"
+                       + to_string(histogram_percentile(hist.size, SIZE_BUCKETS, 90)) + "/"
+                       + to_string(histogram_percentile(hist.size, SIZE_BUCKETS, 99)) + " B";
+    string iat_line = "Gap p50/p90/p99: " + format_duration(histogram_percentile(hist.iat, IAT_BUCKETS, 50)) + "/"
+                      + format_duration(histogram_percentile(hist.iat, IAT_BUCKETS, 90)) + "/"
+                      + format_duration(histogram_percentile(hist.iat, IAT_BUCKETS, 99));
+    mvprintw(3 + max_display_count, 0, "%s   %s", size_line.c_str(), iat_line.c_str());
+}
+
+/**
+    @brief Zobrazí podrobnosti sledovaného toku (časy, príznaky TCP, história rýchlosti) pod tabuľkou
+ */
+void Display::display_detail() {
+    const int max_display_count = 10;
+    const int row = 5 + max_display_count;
+    const size_t history = 40;
+    if (!watching_) {
+        mvprintw(row, 0, "Enter: watch the selected flow (rate history, TCP flags)");
+        return;
+    }
+
+    mvprintw(row, 0, "Watching %s <-> %s %s  (Enter on it to stop)", display_endpoint(watched_.src).c_str(),
+             display_endpoint(watched_.dst).c_str(), watched_.proto.c_str());
+    FlowDetail detail;
+    if (!frame_view_->flow_detail(watched_, detail)) {
+        return;
+    }
+    mvprintw(row + 1, 0, "First seen %s  Last seen %s  Since watched: %llu packets, %s",
+             format_timestamp(detail.first_seen).c_str(), format_timestamp(detail.last_seen).c_str(),
+             static_cast<unsigned long long>(detail.packets), format_bytes(static_cast<double>(detail.bytes)).c_str());
+    if (watched_.proto == "tcp") {
+        mvprintw(row + 2, 0, "TCP flags seen: %s  (SYN %u, FIN %u, RST %u)", tcp_flags_text(detail.tcp_flags).c_str(),
+                 detail.syn, detail.fin, detail.rst);
+    }
+
+    // história končí aktuálnou sekundou, pri prehrávaní súboru alebo generátore poslednou sekundou toku
+    int64_t now = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+    int64_t last = detail.last_seen / 1000000;
+    int64_t end = now - last >= 0 && now - last < static_cast<int64_t>(WATCH_HISTORY) ? now : last;
+    vector<uint64_t> rates = detail_rates(detail, end, history);
+    uint64_t peak = *max_element(rates.begin(), rates.end());
+    static const char levels[] = " .:-=+*#%@";
+    string spark;
+    for (uint64_t rate : rates) {
+        spark += levels[peak == 0 ? 0 : (rate * 9 + peak - 1) / peak];
+    }
+    mvprintw(row + 3, 0, "Packets/s, last %zu s: [%s] now %llu, peak %llu", history, spark.c_str(),
+             static_cast<unsigned long long>(rates.back()), static_cast<unsigned long long>(peak));
+}
+
+/**
+    @brief Nájde proces vlastniaci tok podľa lokálneho koncového bodu (zdrojového alebo cieľového)
+    @param key kľúč pripojenia
+    @param out nájdený proces
+    @return true ak bol proces nájdený
+ */
+bool Display::find_process(const ConnectionKey& key, ProcessInfo& out) {
+    uint8_t proto;
+    if (key.proto == "tcp") {
+        proto = IPPROTO_TCP;
+    } else if (key.proto == "udp") {
+        proto = IPPROTO_UDP;
+    } else {
+        return false; // sokety bez portov sa procesom nepriraďujú
+    }
+
+    // smer toku sa pri zlúčení stráca, skúsi sa zdrojový aj cieľový koncový bod
+    for (const string* endpoint : {&key.src, &key.dst}) {
+        uint8_t family, addr[16];
+        uint16_t port;
+        if (parse_endpoint(*endpoint, family, addr, port) && processes_.lookup(family, proto, addr, port, out)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+    @brief Zobrazí štatistiky agregované podľa procesov vlastniacich toky
+    @param connections zoradený zoznam pripojení
+ */
+void Display::display_processes(const vector<pair<ConnectionKey, ConnectionStats>>& connections) {
+    const int max_display_count = 10;
+
+    struct ProcessRow {
+        ProcessInfo process;
+        ConnectionStats stats;
+        int flows;
+    };
+    unordered_map<int, ProcessRow> rows;
+
+    // agregácia tokov podľa procesu, toky bez vlastníka sa spočítajú pod PID 0
+    for (const auto& [key, stats] : connections) {
+        ProcessInfo process;
+        if (!find_process(key, process)) {
+            process = ProcessInfo{0, "(unknown)"};
+        }
+        auto it = rows.find(process.pid);
+        if (it == rows.end()) {
+            rows[process.pid] = ProcessRow{process, stats, 1};
+            continue;
+        }
+        it->second.stats.rx_bytes += stats.rx_bytes;
+        it->second.stats.tx_bytes += stats.tx_bytes;
+        it->second.stats.rx_packets += stats.rx_packets;
+        it->second.stats.tx_packets += stats.tx_packets;
+        it->second.stats.rx_bytes_var += stats.rx_bytes_var;
+        it->second.stats.tx_bytes_var += stats.tx_bytes_var;
+        it->second.stats.rx_packets_var += stats.rx_packets_var;
+        it->second.stats.tx_packets_var += stats.tx_packets_var;
+        it->second.flows++;
+    }
+
+    vector<ProcessRow> sorted;
+    for (const auto& [pid, row] : rows) {
+        sorted.push_back(row);
+    }
+    bool by_bytes = sort_option_ == 'b';
+    sort(sorted.begin(), sorted.end(), [by_bytes](const ProcessRow& a, const ProcessRow& b) {
+        if (by_bytes) {
+            return a.stats.rx_bytes + a.stats.tx_bytes > b.stats.rx_bytes + b.stats.tx_bytes;
+        }
+        return a.stats.rx_packets + a.stats.tx_packets > b.stats.rx_packets + b.stats.tx_packets;
+    });
+
+    mvprintw(0, 0, "%-8s %-20s %-8s %-15s %-15s", "PID", "Command", "Flows",
+             by_bytes ? "Rx (b/s)" : "Rx (p/s)", by_bytes ? "Tx (b/s)" : "Tx (p/s)");
+
+    for (int count = 0; count < min(static_cast<int>(sorted.size()), max_display_count); ++count) {
+        const ProcessRow& row = sorted[count];
+        string rx = by_bytes ? format_estimate(format_bytes(row.stats.rx_bytes / refresh_interval_), row.stats.rx_bytes, row.stats.rx_bytes_var)
+                             : format_estimate(format_packets(row.stats.rx_packets / refresh_interval_), row.stats.rx_packets, row.stats.rx_packets_var);
+        string tx = by_bytes ? format_estimate(format_bytes(row.stats.tx_bytes / refresh_interval_), row.stats.tx_bytes, row.stats.tx_bytes_var)
+                             : format_estimate(format_packets(row.stats.tx_packets / refresh_interval_), row.stats.tx_packets, row.stats.tx_packets_var);
+        mvprintw(2 + count, 0, "%-8d %-20s %-8d %-15s %-15s", row.process.pid,
+                 row.process.comm.substr(0, 20).c_str(), row.flows, rx.c_str(), tx.c_str());
+    }
+}
+
+/**
+    @brief Zobrazí štatistiky agregované podľa dvojíc pomenovaných sietí (zdrojová sieť, cieľová sieť)
+ */
+void Display::display_networks() {
+    const int max_display_count = 10;
+    // pohľad vzal display_loop pri get_sorted_connections
+    const vector<pair<ConnectionKey, ConnectionStats>>& pairs = frame_view_->networks(sort_option_);
+    bool by_bytes = sort_option_ == 'b';
+
+    mvprintw(0, 0, "%-24s %-24s %-15s %-15s", "Src network", "Dst network",
+             by_bytes ? "Rx (b/s)" : "Rx (p/s)", by_bytes ? "Tx (b/s)" : "Tx (p/s)");
+    if (pairs.empty()) {
+        mvprintw(2, 0, "No networks loaded (use --networks <file>)");
+        return;
+    }
+
+    for (int count = 0; count < min(static_cast<int>(pairs.size()), max_display_count); ++count) {
+        const auto& [key, stats] = pairs[count];
+        string rx = by_bytes ? format_estimate(format_bytes(stats.rx_bytes / refresh_interval_), stats.rx_bytes, stats.rx_bytes_var)
+                             : format_estimate(format_packets(stats.rx_packets / refresh_interval_), stats.rx_packets, stats.rx_packets_var);
+        string tx = by_bytes ? format_estimate(format_bytes(stats.tx_bytes / refresh_interval_), stats.tx_bytes, stats.tx_bytes_var)
+                             : format_estimate(format_packets(stats.tx_packets / refresh_interval_), stats.tx_packets, stats.tx_packets_var);
+        mvprintw(2 + count, 0, "%-24s %-24s %-15s %-15s", key.src.substr(0, 24).c_str(), key.dst.substr(0, 24).c_str(),
+                 rx.c_str(), tx.c_str());
     }
 }
 //====END OF display.cpp ======
@@ -0,0 +1,238 @@
+/**
+    @file dumper.cpp
+    @brief Implementácia triedy PcapDumper, ktorá zapisuje vybrané pakety do rotujúcej sady pcap súborov
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/dumper.h"
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+    @brief Hlavička pcap súboru (formát libpcap 2.4, mikrosekundové časy)
+ */
+struct PcapFileHeader {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+/**
+    @brief Hlavička jedného záznamu v pcap súbore
+ */
+struct PcapRecordHeader {
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t caplen;
+    uint32_t len;
+};
+
+/**
+    @brief Konštruktor triedy PcapDumper, spustí vlákno zapisovača
+ */
+PcapDumper::PcapDumper(const string& prefix, int linktype, uint32_t snaplen, size_t file_count,
+                       size_t file_size, size_t buffer_size, size_t buffer_count)
+    : prefix_(prefix), linktype_(linktype), snaplen_(snaplen), file_count_(file_count > 0 ? file_count : 1),
+      file_size_(file_size), buffer_size_(buffer_size), fd_(-1), file_index_(0), file_bytes_(0),
+      writing_(0), stopping_(false), enabled_(true), packets_(0), dropped_(0) {
+    // buffery sa alokujú raz, zachytávacie vlákno ich iba vymieňa
+    current_.reserve(buffer_size_);
+    for (size_t i = 1; i < max(buffer_count, static_cast<size_t>(2)); i++) {
+        free_.emplace_back();
+        free_.back().reserve(buffer_size_);
+    }
+
+    // prvý súbor sa otvorí hneď, aby sa chyba prejavila pri štarte
+    file_index_ = file_count_ - 1;
+    open_next_file();
+    thread_ = thread(&PcapDumper::writer_loop, this);
+}
+
+/**
+    @brief Deštruktor, zapíše zostávajúce pakety a ukončí vlákno zapisovača
+ */
+PcapDumper::~PcapDumper() {
+    {
+        lock_guard<mutex> lock(mtx_);
+        hand_off();
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+/**
+    @brief Názov súboru s daným indexom v rotácii
+ */
+string PcapDumper::file_name(size_t index) const {
+    return prefix_ + "." + to_string(index) + ".pcap";
+}
+
+/**
+    @brief Otvorenie ďalšieho súboru v rotácii a zápis hlavičky pcap
+ */
+void PcapDumper::open_next_file() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    file_index_ = (file_index_ + 1) % file_count_;
+    string name = file_name(file_index_);
+    fd_ = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw runtime_error("Cannot open dump file " + name + ": " + strerror(errno));
+    }
+    PcapFileHeader header{0xa1b2c3d4, 2, 4, 0, 0, snaplen_, static_cast<uint32_t>(linktype_)};
+    file_bytes_ = write(fd_, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) ? sizeof(header) : 0;
+}
+
+/**
+    @brief Pridanie paketu do buffera (volá zachytávacie vlákno, neblokuje na disku)
+ */
+bool PcapDumper::enqueue(uint32_t ts_sec, uint32_t ts_usec, uint32_t caplen, uint32_t len, const u_char* data) {
+    size_t needed = sizeof(PcapRecordHeader) + caplen;
+    if (needed > buffer_size_) {
+        caplen = static_cast<uint32_t>(buffer_size_ - sizeof(PcapRecordHeader));
+        needed = buffer_size_;
+    }
+
+    lock_guard<mutex> lock(mtx_);
+    if (current_.size() + needed > buffer_size_) {
+        if (free_.empty()) {
+            dropped_++; // zapisovač nestíha
+            return false;
+        }
+        hand_off();
+    }
+
+    PcapRecordHeader header{ts_sec, ts_usec, caplen, len};
+    const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&header);
+    current_.insert(current_.end(), header_bytes, header_bytes + sizeof(header));
+    current_.insert(current_.end(), data, data + caplen);
+    packets_++;
+    return true;
+}
+
+/**
+    @brief Presun aktuálneho buffera do fronty na zápis (volá sa pod zámkom)
+ */
+void PcapDumper::hand_off() {
+    // bez voľného buffera zostávajú dáta v aktuálnom, počet bufferov sa nezvyšuje
+    if (current_.empty() || free_.empty()) {
+        return;
+    }
+    full_.push_back(move(current_));
+    current_ = move(free_.front());
+    free_.pop_front();
+    cv_.notify_one();
+}
+
+/**
+    @brief Odovzdanie aktuálneho buffera zapisovaču a čakanie na zápis všetkých bufferov
+ */
+void PcapDumper::flush() {
+    unique_lock<mutex> lock(mtx_);
+    while (!current_.empty()) {
+        hand_off();
+        done_cv_.wait(lock, [this] { return full_.empty() && writing_ == 0; });
+    }
+}
+
+/**
+    @brief Slučka vlákna zapisovača
+ */
+void PcapDumper::writer_loop() {
+    unique_lock<mutex> lock(mtx_);
+    while (true) {
+        // čiastočne naplnený buffer sa zapíše aspoň raz za sekundu
+        if (!cv_.wait_for(lock, chrono::seconds(1), [this] { return stopping_ || !full_.empty(); })) {
+            hand_off();
+        }
+        while (!full_.empty()) {
+            vector<uint8_t> buffer = move(full_.front());
+            full_.pop_front();
+            writing_++;
+
+            lock.unlock();
+            write_buffer(buffer);
+            buffer.clear();
+            lock.lock();
+
+            writing_--;
+            free_.push_back(move(buffer));
+        }
+        if (stopping_) {
+            // zvyšok aktuálneho buffera pri ukončení
+            write_buffer(current_);
+            current_.clear();
+            done_cv_.notify_all();
+            return;
+        }
+        done_cv_.notify_all();
+    }
+}
+
+/**
+    @brief Zápis buffera do aktuálneho súboru, prípadne otvorenie ďalšieho (iba vlákno zapisovača)
+ */
+void PcapDumper::write_buffer(const vector<uint8_t>& buffer) {
+    if (fd_ < 0) {
+        return;
+    }
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+        ssize_t written = write(fd_, buffer.data() + offset, buffer.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            cerr << "Error writing dump file " << file_name(file_index_) << ": " << strerror(errno) << endl;
+            return;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    file_bytes_ += buffer.size();
+    if (file_bytes_ >= file_size_) {
+        try {
+            open_next_file();
+        }
+        catch (const exception& e) {
+            cerr << e.what() << endl;
+            fd_ = -1;
+        }
+    }
+}
+
+void PcapDumper::set_enabled(bool enabled) {
+    enabled_ = enabled;
+}
+
+void PcapDumper::toggle() {
+    enabled_ = !enabled_;
+}
+
+bool PcapDumper::enabled() const {
+    return enabled_;
+}
+
+uint64_t PcapDumper::packets() const {
+    return packets_;
+}
+
+uint64_t PcapDumper::dropped() const {
+    return dropped_;
+}
+//====END OF dumper.cpp ======
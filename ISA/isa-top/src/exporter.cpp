@@ -0,0 +1,438 @@
+/**
+    @file exporter.cpp
+    @brief Implementácia triedy FlowExporter, ktorá exportuje toky z tabuľky tokov vo formáte IPFIX alebo NetFlow v9
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/exporter.h"
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <algorithm>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/**
+    @brief Informačný prvok šablóny (číslo, dĺžka poľa a číslo podniku, 0 pre prvky IANA)
+ */
+struct TemplateField {
+    uint16_t id;
+    uint16_t length;
+    uint32_t enterprise;
+};
+
+// IPFIX: sourceIPv4Address, destinationIPv4Address, sourceTransportPort, destinationTransportPort, protocolIdentifier,
+// octetDeltaCount, packetDeltaCount, flowStartMilliseconds, flowEndMilliseconds, flowEndReason
+// a podnikové prvky s percentilmi histogramov (ExportPercentileField)
+static const TemplateField IPFIX_IPV4_FIELDS[] = {
+    {8, 4, 0}, {12, 4, 0}, {7, 2, 0}, {11, 2, 0}, {4, 1, 0}, {1, 8, 0}, {2, 8, 0}, {152, 8, 0}, {153, 8, 0}, {136, 1, 0},
+    {FIELD_SIZE_P50, 2, EXPORT_ENTERPRISE}, {FIELD_SIZE_P99, 2, EXPORT_ENTERPRISE},
+    {FIELD_IAT_P50, 4, EXPORT_ENTERPRISE}, {FIELD_IAT_P99, 4, EXPORT_ENTERPRISE}
+};
+static const TemplateField IPFIX_IPV6_FIELDS[] = {
+    {27, 16, 0}, {28, 16, 0}, {7, 2, 0}, {11, 2, 0}, {4, 1, 0}, {1, 8, 0}, {2, 8, 0}, {152, 8, 0}, {153, 8, 0}, {136, 1, 0},
+    {FIELD_SIZE_P50, 2, EXPORT_ENTERPRISE}, {FIELD_SIZE_P99, 2, EXPORT_ENTERPRISE},
+    {FIELD_IAT_P50, 4, EXPORT_ENTERPRISE}, {FIELD_IAT_P99, 4, EXPORT_ENTERPRISE}
+};
+// NetFlow v9: časy sú FIRST_SWITCHED a LAST_SWITCHED v milisekundách od sysUptime, dôvod ukončenia sa neprenáša
+// (v9 nepozná podnikové prvky, percentily histogramov sa v ňom neexportujú)
+static const TemplateField V9_IPV4_FIELDS[] = {
+    {8, 4, 0}, {12, 4, 0}, {7, 2, 0}, {11, 2, 0}, {4, 1, 0}, {1, 8, 0}, {2, 8, 0}, {22, 4, 0}, {21, 4, 0}
+};
+static const TemplateField V9_IPV6_FIELDS[] = {
+    {27, 16, 0}, {28, 16, 0}, {7, 2, 0}, {11, 2, 0}, {4, 1, 0}, {1, 8, 0}, {2, 8, 0}, {22, 4, 0}, {21, 4, 0}
+};
+
+static const size_t IPFIX_HEADER_SIZE = 16;
+static const size_t V9_HEADER_SIZE = 20;
+
+/**
+    @brief Zápis čísel v sieťovom poradí bajtov na koniec buffera
+ */
+static void put8(vector<uint8_t>& buf, uint8_t value) {
+    buf.push_back(value);
+}
+
+static void put16(vector<uint8_t>& buf, uint16_t value) {
+    buf.push_back(static_cast<uint8_t>(value >> 8));
+    buf.push_back(static_cast<uint8_t>(value));
+}
+
+static void put32(vector<uint8_t>& buf, uint32_t value) {
+    put16(buf, static_cast<uint16_t>(value >> 16));
+    put16(buf, static_cast<uint16_t>(value));
+}
+
+static void put64(vector<uint8_t>& buf, uint64_t value) {
+    put32(buf, static_cast<uint32_t>(value >> 32));
+    put32(buf, static_cast<uint32_t>(value));
+}
+
+/**
+    @brief Prepis 16-bitového čísla na danej pozícii
+ */
+static void set16(vector<uint8_t>& buf, size_t pos, uint16_t value) {
+    buf[pos] = static_cast<uint8_t>(value >> 8);
+    buf[pos + 1] = static_cast<uint8_t>(value);
+}
+
+static void set32(vector<uint8_t>& buf, size_t pos, uint32_t value) {
+    set16(buf, pos, static_cast<uint16_t>(value >> 16));
+    set16(buf, pos + 2, static_cast<uint16_t>(value));
+}
+
+/**
+    @brief Spracovanie formátu "host:port" ("[IPv6]:port" pre IPv6 adresu)
+ */
+bool split_host_port(const string& value, string& host, string& port) {
+    size_t colon;
+    if (!value.empty() && value.front() == '[') {
+        size_t close = value.find(']');
+        if (close == string::npos || close + 1 >= value.size() || value[close + 1] != ':') {
+            return false;
+        }
+        host = value.substr(1, close - 1);
+        colon = close + 1;
+    }
+    else {
+        colon = value.rfind(':');
+        if (colon == string::npos || value.find(':') != colon) {
+            return false;
+        }
+        host = value.substr(0, colon);
+    }
+    port = value.substr(colon + 1);
+    return !host.empty() && !port.empty() && port.find_first_not_of("0123456789") == string::npos;
+}
+
+/**
+    @brief Konštruktor triedy FlowExporter, otvorí soket ku kolektoru
+ */
+FlowExporter::FlowExporter(ViewPublisher& views, const ExportConfig& config)
+    : views_(views), config_(config), fd_(-1), pass_(0), set_start_(0), set_id_(0), message_records_(0),
+      message_data_records_(0), message_time_(0), last_templates_(0), sequence_(0),
+      exported_records_(0), sent_datagrams_(0), send_errors_(0), running_(false) {
+    string host, port;
+    if (!split_host_port(config_.collector, host, port)) {
+        throw invalid_argument("Invalid collector address '" + config_.collector + "', expected host:port.");
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* result;
+    int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        throw runtime_error("Cannot resolve collector " + host + ": " + gai_strerror(rc));
+    }
+    for (struct addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+        // neblokujúci soket, export nikdy nečaká na sieť
+        fd_ = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK, ai->ai_protocol);
+        if (fd_ < 0) {
+            continue;
+        }
+        if (connect(fd_, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd_);
+        fd_ = -1;
+    }
+    freeaddrinfo(result);
+    if (fd_ < 0) {
+        throw runtime_error("Cannot open socket to collector " + config_.collector + ": " + strerror(errno));
+    }
+
+    boot_usec_ = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    message_.reserve(config_.max_datagram);
+}
+
+/**
+    @brief Deštruktor, zastaví vlákno exportu
+ */
+FlowExporter::~FlowExporter() {
+    stop();
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+/**
+    @brief Spustenie vlákna exportu
+ */
+void FlowExporter::start() {
+    lock_guard<mutex> lock(run_mtx_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = thread(&FlowExporter::run_loop, this);
+}
+
+/**
+    @brief Zastavenie vlákna exportu, neodoslané prírastky sa exportujú s dôvodom END_FORCED
+ */
+void FlowExporter::stop() {
+    {
+        lock_guard<mutex> lock(run_mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    int64_t now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    export_once(now, true);
+}
+
+/**
+    @brief Slučka vlákna exportu
+ */
+void FlowExporter::run_loop() {
+    unique_lock<mutex> lock(run_mtx_);
+    while (running_) {
+        lock.unlock();
+        export_once(chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count());
+        lock.lock();
+        cv_.wait_for(lock, chrono::seconds(1), [this] { return !running_; });
+    }
+}
+
+/**
+    @brief Jeden prechod exportu
+ */
+void FlowExporter::export_once(int64_t now_usec, bool force) {
+    const int64_t active = chrono::duration_cast<chrono::microseconds>(config_.active_timeout).count();
+    const int64_t inactive = chrono::duration_cast<chrono::microseconds>(config_.inactive_timeout).count();
+
+    // záznamy z posledného publikovaného pohľadu, zámok Stats sa nedrží vôbec
+    shared_ptr<const StatsView> view = views_.latest();
+    // pri vzorkovaní sa exportujú odhady (prírastky vynásobené N)
+    uint64_t scale = view->sample_rate;
+
+    pass_++;
+    for (const FlowRecord& record : view->records) {
+        uint64_t bytes = record.rx_bytes + record.tx_bytes;
+        uint64_t packets = record.rx_packets + record.tx_packets;
+
+        auto it = states_.find(record.key);
+        if (it == states_.end() || it->second.first_seen != record.first_seen) {
+            // nový tok, alebo tok, ktorý sa z plnej tabuľky odstránil a začal znova od nuly
+            it = states_.insert_or_assign(record.key, ExportState{0, 0, record.first_seen, record.first_seen, record.first_seen, 0}).first;
+        }
+        ExportState& state = it->second;
+        state.pass = pass_;
+        if (packets <= state.packets) {
+            continue; // od posledného exportu bez nových paketov
+        }
+        if (state.start == 0) {
+            // prvé pozorovanie po ukončení toku pre neaktivitu
+            state.start = record.last_seen;
+        }
+
+        uint8_t reason;
+        if (force) {
+            reason = END_FORCED;
+        }
+        else if (now_usec - record.last_seen >= inactive) {
+            reason = END_IDLE_TIMEOUT;
+        }
+        else if (now_usec - state.last_export >= active) {
+            reason = END_ACTIVE_TIMEOUT;
+        }
+        else {
+            continue;
+        }
+
+        add_record(record, (bytes - state.bytes) * scale, (packets - state.packets) * scale, state.start, record.last_seen, reason, now_usec);
+        state.bytes = bytes;
+        state.packets = packets;
+        state.last_export = now_usec;
+        // po aktívnom limite tok pokračuje, po neaktivite sa začiatok určí pri ďalšom pakete
+        state.start = reason == END_ACTIVE_TIMEOUT ? now_usec : 0;
+    }
+    // stavy tokov, ktoré už v tabuľke nie sú (odstránené ako nečinné)
+    for (auto it = states_.begin(); it != states_.end();) {
+        it = it->second.pass == pass_ ? next(it) : states_.erase(it);
+    }
+
+    if (!message_.empty()) {
+        send_message();
+    }
+}
+
+/**
+    @brief Začiatok novej správy (hlavička sa doplní pri odoslaní)
+ */
+void FlowExporter::begin_message(int64_t now_usec) {
+    message_.assign(config_.protocol == EXPORT_IPFIX ? IPFIX_HEADER_SIZE : V9_HEADER_SIZE, 0);
+    set_start_ = 0;
+    set_id_ = 0;
+    message_records_ = 0;
+    message_data_records_ = 0;
+    message_time_ = now_usec;
+
+    // cez UDP sa šablóny posielajú na začiatku a potom periodicky
+    int64_t refresh = chrono::duration_cast<chrono::microseconds>(config_.template_refresh).count();
+    if (last_templates_ == 0 || now_usec - last_templates_ >= refresh) {
+        add_templates();
+        last_templates_ = now_usec;
+    }
+}
+
+/**
+    @brief Pridanie šablón do správy
+ */
+void FlowExporter::add_templates() {
+    bool ipfix = config_.protocol == EXPORT_IPFIX;
+    size_t set_start = message_.size();
+    put16(message_, ipfix ? 2 : 0); // id sady so šablónami
+    put16(message_, 0);             // dĺžka sa doplní
+
+    auto add = [this](uint16_t id, const TemplateField* fields, size_t count) {
+        put16(message_, id);
+        put16(message_, static_cast<uint16_t>(count));
+        for (size_t i = 0; i < count; i++) {
+            if (fields[i].enterprise != 0) {
+                // nastavený najvyšší bit čísla prvku, za dĺžkou nasleduje číslo podniku
+                put16(message_, fields[i].id | 0x8000);
+                put16(message_, fields[i].length);
+                put32(message_, fields[i].enterprise);
+                continue;
+            }
+            put16(message_, fields[i].id);
+            put16(message_, fields[i].length);
+        }
+        message_records_++;
+    };
+    if (ipfix) {
+        add(TEMPLATE_IPV4, IPFIX_IPV4_FIELDS, sizeof(IPFIX_IPV4_FIELDS) / sizeof(TemplateField));
+        add(TEMPLATE_IPV6, IPFIX_IPV6_FIELDS, sizeof(IPFIX_IPV6_FIELDS) / sizeof(TemplateField));
+    }
+    else {
+        add(TEMPLATE_IPV4, V9_IPV4_FIELDS, sizeof(V9_IPV4_FIELDS) / sizeof(TemplateField));
+        add(TEMPLATE_IPV6, V9_IPV6_FIELDS, sizeof(V9_IPV6_FIELDS) / sizeof(TemplateField));
+    }
+    set16(message_, set_start + 2, static_cast<uint16_t>(message_.size() - set_start));
+}
+
+/**
+    @brief Pridanie dátového záznamu, pri zaplnení sa správa odošle
+ */
+void FlowExporter::add_record(const FlowRecord& record, uint64_t bytes, uint64_t packets, int64_t start_usec, int64_t end_usec,
+                              uint8_t reason, int64_t now_usec) {
+    const FlowKey& key = record.key;
+    bool ipfix = config_.protocol == EXPORT_IPFIX;
+    uint16_t template_id = key.family == 6 ? TEMPLATE_IPV6 : TEMPLATE_IPV4;
+    size_t addr_len = key.family == 6 ? 16 : 4;
+    size_t record_size = 2 * addr_len + 2 + 2 + 1 + 8 + 8 + (ipfix ? 8 + 8 + 1 + 2 + 2 + 4 + 4 : 4 + 4);
+
+    if (message_.empty()) {
+        begin_message(now_usec);
+    }
+    // nová sada potrebuje aj hlavičku sady, v9 navyše až 3 bajty zarovnania
+    size_t needed = record_size + (set_id_ != template_id ? 4 : 0) + (ipfix ? 0 : 3);
+    if (message_.size() + needed > config_.max_datagram && message_data_records_ > 0) {
+        send_message();
+        begin_message(now_usec);
+    }
+    if (set_id_ != template_id) {
+        close_set();
+        set_start_ = message_.size();
+        set_id_ = template_id;
+        put16(message_, template_id);
+        put16(message_, 0);
+    }
+
+    message_.insert(message_.end(), key.src, key.src + addr_len);
+    message_.insert(message_.end(), key.dst, key.dst + addr_len);
+    put16(message_, key.src_port);
+    put16(message_, key.dst_port);
+    put8(message_, key.proto);
+    put64(message_, bytes);
+    put64(message_, packets);
+    if (ipfix) {
+        put64(message_, static_cast<uint64_t>(start_usec / 1000));
+        put64(message_, static_cast<uint64_t>(end_usec / 1000));
+        put8(message_, reason);
+        // percentily z histogramov celého smeru toku (nie iba exportovaného prírastku)
+        put16(message_, static_cast<uint16_t>(histogram_percentile(record.size_hist, SIZE_BUCKETS, 50)));
+        put16(message_, static_cast<uint16_t>(histogram_percentile(record.size_hist, SIZE_BUCKETS, 99)));
+        put32(message_, static_cast<uint32_t>(histogram_percentile(record.iat_hist, IAT_BUCKETS, 50)));
+        put32(message_, static_cast<uint32_t>(histogram_percentile(record.iat_hist, IAT_BUCKETS, 99)));
+    }
+    else {
+        // časy pred spustením exportéra (obnovená tabuľka) sa orežú na nulu
+        put32(message_, static_cast<uint32_t>(max<int64_t>(0, start_usec - boot_usec_) / 1000));
+        put32(message_, static_cast<uint32_t>(max<int64_t>(0, end_usec - boot_usec_) / 1000));
+    }
+    message_records_++;
+    message_data_records_++;
+}
+
+/**
+    @brief Uzavretie otvorenej sady (dĺžka, zarovnanie pre NetFlow v9)
+ */
+void FlowExporter::close_set() {
+    if (set_start_ == 0) {
+        return;
+    }
+    if (config_.protocol == EXPORT_NETFLOW_V9) {
+        while ((message_.size() - set_start_) % 4 != 0) {
+            put8(message_, 0);
+        }
+    }
+    set16(message_, set_start_ + 2, static_cast<uint16_t>(message_.size() - set_start_));
+    set_start_ = 0;
+    set_id_ = 0;
+}
+
+/**
+    @brief Doplnenie hlavičky a odoslanie správy
+ */
+void FlowExporter::send_message() {
+    close_set();
+    uint32_t export_secs = static_cast<uint32_t>(message_time_ / 1000000);
+    if (config_.protocol == EXPORT_IPFIX) {
+        set16(message_, 0, 10);
+        set16(message_, 2, static_cast<uint16_t>(message_.size()));
+        set32(message_, 4, export_secs);
+        set32(message_, 8, sequence_);      // počet dátových záznamov odoslaných pred touto správou
+        set32(message_, 12, config_.domain_id);
+        sequence_ += message_data_records_;
+    }
+    else {
+        set16(message_, 0, 9);
+        set16(message_, 2, message_records_);
+        set32(message_, 4, static_cast<uint32_t>(max<int64_t>(0, message_time_ - boot_usec_) / 1000));
+        set32(message_, 8, export_secs);
+        set32(message_, 12, sequence_);     // poradové číslo správy
+        set32(message_, 16, config_.domain_id);
+        sequence_++;
+    }
+
+    if (send(fd_, message_.data(), message_.size(), 0) == static_cast<ssize_t>(message_.size())) {
+        sent_datagrams_++;
+        exported_records_ += message_data_records_;
+    }
+    else {
+        send_errors_++;
+    }
+    message_.clear();
+}
+
+uint64_t FlowExporter::exported_records() const {
+    return exported_records_;
+}
+
+uint64_t FlowExporter::sent_datagrams() const {
+    return sent_datagrams_;
+}
+
+uint64_t FlowExporter::send_errors() const {
+    return send_errors_;
+}
+//====END OF exporter.cpp ======
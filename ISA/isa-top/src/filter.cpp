@@ -0,0 +1,354 @@
+/**
+    @file filter.cpp
+    @brief Implementácia triedy FlowFilter (preklad filtrovacích výrazov a ich vyhodnotenie nad záznamami tokov)
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/filter.h"
+#include <stdexcept>
+#include <cstring>
+#include <cctype>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+/**
+    @brief Preklad výrazu
+ */
+FlowFilter::FlowFilter(const string& expression) : text_(expression) {
+    tokenize(expression);
+    if (tokens_.empty()) {
+        return; // prázdny program prepustí všetko
+    }
+    parse_or();
+    if (pos_ < tokens_.size()) {
+        fail("unexpected '" + peek() + "'");
+    }
+}
+
+/**
+    @brief Pôvodný text výrazu
+ */
+const string& FlowFilter::text() const {
+    return text_;
+}
+
+/**
+    @brief Rozdelenie výrazu na tokeny
+ */
+void FlowFilter::tokenize(const string& expression) {
+    static const char* operators[] = {"&&", "||", "!=", "<=", ">=", "=", "<", ">", "!", "(", ")"};
+    size_t i = 0;
+    while (i < expression.size()) {
+        if (isspace(static_cast<unsigned char>(expression[i]))) {
+            i++;
+            continue;
+        }
+        bool matched = false;
+        for (const char* op : operators) {
+            size_t len = strlen(op);
+            if (expression.compare(i, len, op) == 0) {
+                tokens_.emplace_back(op, i);
+                i += len;
+                matched = true;
+                break;
+            }
+        }
+        if (matched) {
+            continue;
+        }
+        // slovo, číslo, adresa s prefixom alebo rozsah portov
+        size_t start = i;
+        while (i < expression.size() && !isspace(static_cast<unsigned char>(expression[i]))
+               && strchr("()=<>!&|", expression[i]) == nullptr) {
+            i++;
+        }
+        if (i == start) {
+            pos_ = tokens_.size();
+            tokens_.emplace_back(string(1, expression[i]), i);
+            fail("unexpected character '" + string(1, expression[i]) + "'");
+        }
+        tokens_.emplace_back(expression.substr(start, i - start), start);
+    }
+}
+
+/**
+    @brief Aktuálny token (prázdny na konci výrazu)
+ */
+const string& FlowFilter::peek() const {
+    static const string end;
+    return pos_ < tokens_.size() ? tokens_[pos_].first : end;
+}
+
+/**
+    @brief Prevzatie aktuálneho tokenu
+ */
+string FlowFilter::next(const char* expected) {
+    if (pos_ >= tokens_.size()) {
+        fail(string("expected ") + expected);
+    }
+    return tokens_[pos_++].first;
+}
+
+/**
+    @brief Výnimka s pozíciou aktuálneho tokenu
+ */
+void FlowFilter::fail(const string& message) const {
+    size_t position = pos_ < tokens_.size() ? tokens_[pos_].second : text_.size();
+    throw invalid_argument("Invalid filter at position " + to_string(position + 1) + ": " + message + ".");
+}
+
+/**
+    @brief výraz := and-výraz { "or" and-výraz }
+ */
+void FlowFilter::parse_or() {
+    vector<size_t> jumps;
+    parse_and();
+    while (peek() == "or" || peek() == "||") {
+        pos_++;
+        // akumulátor je true, zvyšok sa preskočí
+        jumps.push_back(program_.size());
+        program_.push_back(Instruction{OP_JUMP_IF_TRUE, SIDE_ANY, CMP_EQ, 0, 0, false, 0, 0, 0, {}});
+        parse_and();
+    }
+    for (size_t jump : jumps) {
+        program_[jump].target = static_cast<uint32_t>(program_.size());
+    }
+}
+
+/**
+    @brief and-výraz := not-výraz { ["and"] not-výraz }
+ */
+void FlowFilter::parse_and() {
+    vector<size_t> jumps;
+    parse_not();
+    while (true) {
+        const string& token = peek();
+        if (token.empty() || token == ")" || token == "or" || token == "||") {
+            break;
+        }
+        if (token == "and" || token == "&&") {
+            pos_++;
+        }
+        // akumulátor je false, zvyšok sa preskočí
+        jumps.push_back(program_.size());
+        program_.push_back(Instruction{OP_JUMP_IF_FALSE, SIDE_ANY, CMP_EQ, 0, 0, false, 0, 0, 0, {}});
+        parse_not();
+    }
+    for (size_t jump : jumps) {
+        program_[jump].target = static_cast<uint32_t>(program_.size());
+    }
+}
+
+/**
+    @brief not-výraz := "not" not-výraz | "(" výraz ")" | test
+ */
+void FlowFilter::parse_not() {
+    const string& token = peek();
+    if (token == "not" || token == "!") {
+        pos_++;
+        parse_not();
+        program_.push_back(Instruction{OP_NOT, SIDE_ANY, CMP_EQ, 0, 0, false, 0, 0, 0, {}});
+        return;
+    }
+    if (token == "(") {
+        pos_++;
+        parse_or();
+        if (peek() != ")") {
+            fail("expected ')'");
+        }
+        pos_++;
+        return;
+    }
+    parse_test();
+}
+
+/**
+    @brief Číslo bez znamienka s najviac max
+ */
+static bool parse_number(const string& text, uint64_t max, uint64_t& out) {
+    if (text.empty() || text.size() > 19 || text.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
+    out = stoull(text);
+    return out <= max;
+}
+
+/**
+    @brief Jednotlivé testy nad poľami záznamu
+ */
+void FlowFilter::parse_test() {
+    Instruction ins{OP_PROTO, SIDE_ANY, CMP_EQ, 0, 0, false, 0, 0, 0, {}};
+    string word = next("a filter expression");
+    if (word == "src" || word == "dst") {
+        ins.side = word == "src" ? SIDE_SRC : SIDE_DST;
+        word = next("'host', 'net' or 'port'");
+        if (word != "host" && word != "net" && word != "port") {
+            pos_--;
+            fail("expected 'host', 'net' or 'port' after '" + string(ins.side == SIDE_SRC ? "src" : "dst") + "'");
+        }
+    }
+    // "port=443" aj "port 443"
+    bool keyword = word == "host" || word == "net" || word == "port" || word == "proto";
+    if (keyword && peek() == "=") {
+        pos_++;
+    }
+
+    if (word == "host" || word == "net") {
+        string value = next("an address");
+        size_t slash = value.find('/');
+        string address = value.substr(0, slash);
+        if (inet_pton(AF_INET, address.c_str(), ins.addr) == 1) {
+            ins.family = 4;
+        }
+        else if (inet_pton(AF_INET6, address.c_str(), ins.addr) == 1) {
+            ins.family = 6;
+        }
+        else {
+            pos_--;
+            fail("invalid address '" + address + "'");
+        }
+        uint64_t length = ins.family == 4 ? 32 : 128;
+        if (slash != string::npos && !parse_number(value.substr(slash + 1), length, length)) {
+            pos_--;
+            fail("invalid prefix length in '" + value + "'");
+        }
+        ins.op = OP_HOST;
+        ins.length = static_cast<uint8_t>(length);
+        // bity za prefixom sa vynulujú, porovnáva sa potom iba maskovaný posledný bajt
+        for (unsigned bit = ins.length; bit < 128; bit++) {
+            ins.addr[bit / 8] &= static_cast<uint8_t>(~(0x80 >> (bit % 8)));
+        }
+    }
+    else if (word == "port") {
+        string value = next("a port");
+        size_t dash = value.find('-');
+        ins.op = OP_PORT;
+        bool valid = parse_number(value.substr(0, dash), 65535, ins.value);
+        ins.value2 = ins.value;
+        if (valid && dash != string::npos) {
+            valid = parse_number(value.substr(dash + 1), 65535, ins.value2) && ins.value <= ins.value2;
+        }
+        if (!valid) {
+            pos_--;
+            fail("invalid port '" + value + "'");
+        }
+    }
+    else if (word == "proto" || word == "tcp" || word == "udp" || word == "icmp" || word == "icmpv6" ||
+             word == "sctp" || word == "udplite") {
+        string value = word == "proto" ? next("a protocol") : word;
+        ins.op = OP_PROTO;
+        if (proto_number(value) != IPPROTO_RAW) {
+            ins.value = proto_number(value);
+        }
+        else if (!parse_number(value, 255, ins.value)) {
+            pos_--;
+            fail("unknown protocol '" + value + "'");
+        }
+    }
+    else if (word == "ip" || word == "ip6") {
+        ins.op = OP_FAMILY;
+        ins.value = word == "ip" ? 4 : 6;
+    }
+    else if (word == "bytes" || word == "packets") {
+        static const char* comparisons[] = {"=", "!=", "<", "<=", ">", ">="};
+        string cmp = next("a comparison");
+        ins.op = OP_COUNTER;
+        ins.packets = word == "packets";
+        bool found = false;
+        for (size_t i = 0; i < sizeof(comparisons) / sizeof(comparisons[0]); i++) {
+            if (cmp == comparisons[i]) {
+                ins.cmp = static_cast<Cmp>(i);
+                found = true;
+            }
+        }
+        if (!found) {
+            pos_--;
+            fail("expected a comparison after '" + word + "'");
+        }
+        // voliteľná prípona k, M, G (násobky 1000)
+        string value = next("a number");
+        uint64_t multiplier = 1;
+        if (!value.empty() && strchr("kMG", value.back()) != nullptr) {
+            multiplier = value.back() == 'k' ? 1000ULL : value.back() == 'M' ? 1000000ULL : 1000000000ULL;
+            value.pop_back();
+        }
+        if (!parse_number(value, UINT64_MAX / multiplier, ins.value)) {
+            pos_--;
+            fail("invalid number '" + value + "'");
+        }
+        ins.value *= multiplier;
+    }
+    else {
+        pos_--;
+        fail("unknown keyword '" + word + "'");
+    }
+    program_.push_back(ins);
+}
+
+/**
+    @brief Test adresy alebo prefixu
+ */
+bool FlowFilter::match_host(const Instruction& ins, const FlowKey& key) const {
+    if (key.family != ins.family) {
+        return false;
+    }
+    size_t bytes = ins.length / 8;
+    uint8_t mask = static_cast<uint8_t>(0xFF00 >> (ins.length % 8));
+    auto in_prefix = [&](const uint8_t* addr) {
+        return memcmp(addr, ins.addr, bytes) == 0 && (mask == 0 || (addr[bytes] & mask) == ins.addr[bytes]);
+    };
+    return (ins.side != SIDE_DST && in_prefix(key.src)) || (ins.side != SIDE_SRC && in_prefix(key.dst));
+}
+
+/**
+    @brief Vyhodnotenie filtra pre jeden smer toku
+ */
+bool FlowFilter::matches(const FlowRecord& record, uint64_t scale) const {
+    const FlowKey& key = record.key;
+    bool acc = true;
+    for (size_t pc = 0; pc < program_.size(); pc++) {
+        const Instruction& ins = program_[pc];
+        switch (ins.op) {
+            case OP_PROTO:
+                acc = key.proto == ins.value;
+                break;
+            case OP_FAMILY:
+                acc = key.family == ins.value;
+                break;
+            case OP_PORT:
+                acc = !(record.flags & FLOW_NO_PORTS)
+                      && ((ins.side != SIDE_DST && key.src_port >= ins.value && key.src_port <= ins.value2)
+                          || (ins.side != SIDE_SRC && key.dst_port >= ins.value && key.dst_port <= ins.value2));
+                break;
+            case OP_HOST:
+                acc = match_host(ins, key);
+                break;
+            case OP_COUNTER: {
+                uint64_t counter = (ins.packets ? record.rx_packets + record.tx_packets : record.rx_bytes + record.tx_bytes) * scale;
+                switch (ins.cmp) {
+                    case CMP_EQ: acc = counter == ins.value; break;
+                    case CMP_NE: acc = counter != ins.value; break;
+                    case CMP_LT: acc = counter < ins.value; break;
+                    case CMP_LE: acc = counter <= ins.value; break;
+                    case CMP_GT: acc = counter > ins.value; break;
+                    case CMP_GE: acc = counter >= ins.value; break;
+                }
+                break;
+            }
+            case OP_NOT:
+                acc = !acc;
+                break;
+            case OP_JUMP_IF_FALSE:
+                if (!acc) {
+                    pc = ins.target - 1;
+                }
+                break;
+            case OP_JUMP_IF_TRUE:
+                if (acc) {
+                    pc = ins.target - 1;
+                }
+                break;
+        }
+    }
+    return acc;
+}
+//====END OF filter.cpp ======
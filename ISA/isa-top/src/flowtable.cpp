@@ -0,0 +1,415 @@
+/**
+    @file flowtable.cpp
+    @brief Implementácia tabuľky tokov s pevným binárnym formátom (v pamäti alebo v mapovanom súbore)
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/flowtable.h"
+#include "include/filter.h"
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+static const char FLOW_TABLE_MAGIC[8] = {'I', 'S', 'A', 'T', 'O', 'P', 'F', 'T'};
+static const uint32_t FLOW_TABLE_BYTE_ORDER = 0x01020304;
+
+/**
+    @brief Zaokrúhlenie počtu slotov nahor na mocninu 2
+ */
+static size_t round_capacity(size_t capacity) {
+    size_t rounded = 16;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+/**
+    @brief Veľkosť mapovania pre daný počet slotov
+ */
+static size_t table_bytes(size_t capacity) {
+    return sizeof(FlowTableHeader) + capacity * sizeof(FlowRecord);
+}
+
+/**
+    @brief Tabuľka v anonymnej pamäti
+ */
+FlowTable::FlowTable(size_t capacity)
+    : base_(nullptr), mapped_size_(0), header_(nullptr), records_(nullptr), mask_(0), fd_(-1),
+      read_only_(false), reattached_(false), was_clean_(true), expire_cursor_(0) {
+    capacity = round_capacity(capacity);
+    mapped_size_ = table_bytes(capacity);
+    base_ = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base_ == MAP_FAILED) {
+        throw runtime_error("Cannot allocate flow table: " + string(strerror(errno)));
+    }
+    init_header(capacity);
+}
+
+/**
+    @brief Tabuľka v namapovanom súbore; existujúci súbor sa pripojí, inak sa vytvorí
+ */
+FlowTable::FlowTable(const string& path, size_t capacity, bool read_only)
+    : base_(nullptr), mapped_size_(0), header_(nullptr), records_(nullptr), mask_(0), fd_(-1),
+      read_only_(read_only), reattached_(false), was_clean_(true), expire_cursor_(0) {
+    fd_ = open(path.c_str(), read_only ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw runtime_error("Cannot open flow table " + path + ": " + strerror(errno));
+    }
+    // do tabuľky smie zapisovať iba jeden proces
+    if (!read_only && flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        close(fd_);
+        throw runtime_error("Flow table " + path + " is used by another process");
+    }
+
+    struct stat st;
+    fstat(fd_, &st);
+    size_t file_size = static_cast<size_t>(st.st_size);
+
+    if (file_size == 0) {
+        if (read_only) {
+            close(fd_);
+            throw runtime_error("Flow table " + path + " is empty");
+        }
+        // nový súbor
+        capacity = round_capacity(capacity);
+        mapped_size_ = table_bytes(capacity);
+        if (ftruncate(fd_, static_cast<off_t>(mapped_size_)) != 0) {
+            close(fd_);
+            throw runtime_error("Cannot resize flow table " + path + ": " + strerror(errno));
+        }
+    }
+    else {
+        // pred mapovaním celého súboru sa overí hlavička
+        FlowTableHeader header;
+        if (file_size < sizeof(header) || pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+            || memcmp(header.magic, FLOW_TABLE_MAGIC, sizeof(FLOW_TABLE_MAGIC)) != 0) {
+            close(fd_);
+            throw runtime_error(path + " is not an isa-top flow table");
+        }
+        if (header.byte_order != FLOW_TABLE_BYTE_ORDER || header.version != FLOW_TABLE_VERSION
+            || header.header_size != sizeof(FlowTableHeader) || header.record_size != sizeof(FlowRecord)) {
+            close(fd_);
+            throw runtime_error("Flow table " + path + " has unsupported version " + to_string(header.version));
+        }
+        if (header.capacity == 0 || (header.capacity & (header.capacity - 1)) != 0
+            || file_size < table_bytes(header.capacity)) {
+            close(fd_);
+            throw runtime_error("Flow table " + path + " is truncated or corrupted");
+        }
+        mapped_size_ = table_bytes(header.capacity);
+        reattached_ = true;
+        was_clean_ = header.clean == 1;
+    }
+
+    base_ = mmap(nullptr, mapped_size_, read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base_ == MAP_FAILED) {
+        close(fd_);
+        throw runtime_error("Cannot map flow table " + path + ": " + strerror(errno));
+    }
+
+    if (reattached_) {
+        header_ = static_cast<FlowTableHeader*>(base_);
+        records_ = reinterpret_cast<FlowRecord*>(static_cast<char*>(base_) + sizeof(FlowTableHeader));
+        mask_ = header_->capacity - 1;
+    }
+    else {
+        init_header(capacity);
+    }
+    if (!read_only) {
+        // pri páde zostane príznak nulový
+        header_->clean = 0;
+    }
+}
+
+/**
+    @brief Deštruktor, označí tabuľku ako korektne zatvorenú a uvoľní mapovanie
+ */
+FlowTable::~FlowTable() {
+    if (base_ != nullptr && base_ != MAP_FAILED) {
+        if (fd_ >= 0 && !read_only_) {
+            header_->clean = 1;
+            msync(base_, mapped_size_, MS_SYNC);
+        }
+        munmap(base_, mapped_size_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+/**
+    @brief Inicializácia hlavičky novej tabuľky
+ */
+void FlowTable::init_header(size_t capacity) {
+    header_ = static_cast<FlowTableHeader*>(base_);
+    records_ = reinterpret_cast<FlowRecord*>(static_cast<char*>(base_) + sizeof(FlowTableHeader));
+    mask_ = capacity - 1;
+
+    memset(header_, 0, sizeof(FlowTableHeader));
+    memcpy(header_->magic, FLOW_TABLE_MAGIC, sizeof(FLOW_TABLE_MAGIC));
+    header_->version = FLOW_TABLE_VERSION;
+    header_->byte_order = FLOW_TABLE_BYTE_ORDER;
+    header_->header_size = sizeof(FlowTableHeader);
+    header_->record_size = sizeof(FlowRecord);
+    header_->capacity = capacity;
+    header_->created = static_cast<int64_t>(time(nullptr));
+}
+
+/**
+    @brief Hash kľúča toku (FNV-1a cez jeho bajty)
+ */
+size_t FlowKeyHash::operator()(const FlowKey& key) const {
+    // FlowKey nemá výplň a nepoužité bajty adries sú nulové
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&key);
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof(FlowKey); i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+    @brief Porovnanie kľúčov tokov po bajtoch
+ */
+bool FlowKeyEqual::operator()(const FlowKey& a, const FlowKey& b) const {
+    return memcmp(&a, &b, sizeof(FlowKey)) == 0;
+}
+
+/**
+    @brief Index slotu pre kľúč alebo prvého voľného slotu v jeho reťazci (lineárne skúšanie)
+ */
+size_t FlowTable::probe(const FlowKey& key) const {
+    size_t index = FlowKeyHash()(key) & mask_;
+    while (records_[index].used && memcmp(&records_[index].key, &key, sizeof(FlowKey)) != 0) {
+        index = (index + 1) & mask_;
+    }
+    return index;
+}
+
+/**
+    @brief Nájdenie záznamu toku, prípadne jeho vloženie
+ */
+FlowRecord* FlowTable::find_or_insert(const FlowKey& key, int64_t now_usec) {
+    // tabuľka sa plní najviac na 3/4, aby reťazce skúšania zostali krátke a vždy existoval voľný slot
+    if (header_->count >= (mask_ + 1) / 4 * 3) {
+        size_t index = probe(key);
+        if (records_[index].used) {
+            return &records_[index];
+        }
+        // iba ohraničený úsek tabuľky, ďalšie vloženie pokračuje za ním
+        if (now_usec == 0 || expire_step(now_usec - FLOW_IDLE_TIMEOUT_USEC, FLOW_EXPIRE_BATCH) == 0) {
+            header_->dropped++;
+            return nullptr;
+        }
+    }
+
+    size_t index = probe(key);
+    FlowRecord& record = records_[index];
+    if (!record.used) {
+        memset(&record, 0, sizeof(record));
+        record.key = key;
+        record.used = 1;
+        header_->count++;
+    }
+    return &record;
+}
+
+/**
+    @brief Uvoľnenie slotu a posun nasledujúcich záznamov reťazca do medzery (backward-shift)
+ */
+void FlowTable::erase(size_t index) {
+    size_t hole = index;
+    size_t next = (hole + 1) & mask_;
+    while (records_[next].used) {
+        // záznam sa smie posunúť iba dozadu, nie pred svoj domovský slot
+        size_t home = FlowKeyHash()(records_[next].key) & mask_;
+        if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+            memcpy(&records_[hole], &records_[next], sizeof(FlowRecord));
+            hole = next;
+        }
+        next = (next + 1) & mask_;
+    }
+    records_[hole].used = 0;
+    header_->count--;
+}
+
+/**
+    @brief Odstránenie nesledovaných záznamov, ktorých posledný paket je starší ako idle_before
+ */
+size_t FlowTable::expire(int64_t idle_before) {
+    // prechod začína za voľným slotom: žiadny reťazec ním neprechádza, takže erase posúva
+    // do aktuálneho slotu iba záznamy zo slotov, ktoré prechod ešte len navštívi
+    size_t start = 0;
+    while (records_[start].used) {
+        start++;
+    }
+    size_t removed = 0;
+    for (size_t step = 1; step <= mask_; step++) {
+        size_t index = (start + step) & mask_;
+        while (records_[index].used && records_[index].last_seen < idle_before && !(records_[index].flags & FLOW_WATCH)) {
+            erase(index);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+/**
+    @brief Odstránenie nesledovaných nečinných záznamov v ďalších slotoch od kurzora
+ */
+size_t FlowTable::expire_step(int64_t idle_before, size_t slots) {
+    // erase posúva záznamy iba do medzery na aktuálnom slote alebo za ním, nikdy pred kurzor,
+    // preto stačí aktuálny slot po odstránení skontrolovať znova
+    size_t removed = 0;
+    for (size_t step = 0; step < slots && step <= mask_; step++) {
+        size_t index = expire_cursor_;
+        while (records_[index].used && records_[index].last_seen < idle_before && !(records_[index].flags & FLOW_WATCH)) {
+            erase(index);
+            removed++;
+        }
+        expire_cursor_ = (index + 1) & mask_;
+    }
+    return removed;
+}
+
+/**
+    @brief Nájdenie záznamu toku
+ */
+const FlowRecord* FlowTable::find(const FlowKey& key) const {
+    size_t index = probe(key);
+    return records_[index].used ? &records_[index] : nullptr;
+}
+
+FlowRecord* FlowTable::find(const FlowKey& key) {
+    size_t index = probe(key);
+    return records_[index].used ? &records_[index] : nullptr;
+}
+
+size_t FlowTable::capacity() const {
+    return mask_ + 1;
+}
+
+size_t FlowTable::size() const {
+    return header_->count;
+}
+
+uint64_t FlowTable::dropped() const {
+    return header_->dropped;
+}
+
+uint32_t FlowTable::sample_rate() const {
+    return header_->sample_rate > 1 ? header_->sample_rate : 1;
+}
+
+void FlowTable::set_sample_rate(uint32_t rate) {
+    header_->sample_rate = rate;
+}
+
+const FlowRecord& FlowTable::slot(size_t index) const {
+    return records_[index];
+}
+
+FlowRecord& FlowTable::slot(size_t index) {
+    return records_[index];
+}
+
+bool FlowTable::reattached() const {
+    return reattached_;
+}
+
+bool FlowTable::was_clean() const {
+    return was_clean_;
+}
+
+/**
+    @brief Asynchrónny zápis zmenených stránok do súboru
+ */
+void FlowTable::sync() {
+    if (fd_ >= 0 && !read_only_) {
+        msync(base_, mapped_size_, MS_ASYNC);
+    }
+}
+
+/**
+    @brief Kľúč opačného smeru toku (vymenené adresy a porty)
+ */
+FlowKey reverse_key(const FlowKey& key) {
+    FlowKey reversed = key;
+    reversed.src_port = key.dst_port;
+    reversed.dst_port = key.src_port;
+    memcpy(reversed.src, key.dst, sizeof(key.dst));
+    memcpy(reversed.dst, key.src, sizeof(key.src));
+    return reversed;
+}
+
+/**
+    @brief Čas vo formáte "YYYY-MM-DD HH:MM:SS" v miestnom čase ("-" pre 0)
+ */
+string format_timestamp(int64_t usec) {
+    if (usec == 0) {
+        return "-";
+    }
+    time_t sec = static_cast<time_t>(usec / 1000000);
+    struct tm tm;
+    localtime_r(&sec, &tm);
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    return buf;
+}
+
+/**
+    @brief Výpis najväčších tokov z tabuľky (režim --inspect)
+ */
+void print_top_flows(const FlowTable& table, char sort_option, size_t count, ostream& out, const FlowFilter* filter) {
+    vector<const FlowRecord*> records;
+    for (size_t i = 0; i < table.capacity(); i++) {
+        if (table.slot(i).used && (filter == nullptr || filter->matches(table.slot(i), table.sample_rate()))) {
+            records.push_back(&table.slot(i));
+        }
+    }
+
+    bool by_bytes = sort_option != 'p';
+    sort(records.begin(), records.end(), [by_bytes](const FlowRecord* a, const FlowRecord* b) {
+        if (by_bytes) {
+            return a->rx_bytes + a->tx_bytes > b->rx_bytes + b->tx_bytes;
+        }
+        return a->rx_packets + a->tx_packets > b->rx_packets + b->tx_packets;
+    });
+
+    // pri vzorkovaní sa vypisujú odhady (počítadlá vynásobené N)
+    uint64_t scale = table.sample_rate();
+    out << "Flows: " << table.size() << "/" << table.capacity() << ", dropped: " << table.dropped()
+        << (table.was_clean() ? "" : " (not closed cleanly)");
+    if (scale > 1) {
+        out << ", sampled 1-in-" << scale << " (estimated counts)";
+    }
+    if (filter != nullptr && !filter->text().empty()) {
+        out << ", filter: " << filter->text();
+    }
+    out << "\n";
+    out << left << setw(46) << "Src IP:port" << " " << setw(46) << "Dst IP:port" << " " << setw(7) << "Proto"
+        << " " << setw(12) << "Rx bytes" << " " << setw(12) << "Tx bytes" << " " << setw(10) << "Rx pkts"
+        << " " << setw(10) << "Tx pkts" << " " << setw(19) << "First seen" << " " << "Last seen" << "\n";
+
+    for (size_t i = 0; i < min(count, records.size()); i++) {
+        const FlowRecord& r = *records[i];
+        const FlowKey& k = r.key;
+        string src = r.flags & FLOW_NO_PORTS ? format_address(k.family, k.src) : format_endpoint(k.family, k.proto, k.src, k.src_port);
+        string dst = r.flags & FLOW_NO_PORTS ? format_address(k.family, k.dst) : format_endpoint(k.family, k.proto, k.dst, k.dst_port);
+        out << left << setw(46) << src << " " << setw(46) << dst << " " << setw(7) << proto_name(k.proto)
+            << " " << setw(12) << r.rx_bytes * scale << " " << setw(12) << r.tx_bytes * scale << " " << setw(10) << r.rx_packets * scale
+            << " " << setw(10) << r.tx_packets * scale << " " << setw(19) << format_timestamp(r.first_seen) << " "
+            << format_timestamp(r.last_seen) << "\n";
+    }
+}
+//====END OF flowtable.cpp ======
@@ -0,0 +1,31 @@
+/**
+    @file histogram.cpp
+    @brief Implementácia pomocných funkcií log-lineárnych histogramov
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/histogram.h"
+
+/**
+    @brief Najmenšia hodnota patriaca do bucketu
+ */
+uint64_t histogram_bucket_low(size_t index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    unsigned msb = static_cast<unsigned>(index / HISTOGRAM_SUB_BUCKETS) + HISTOGRAM_SUB_BITS - 1;
+    uint64_t sub = index % HISTOGRAM_SUB_BUCKETS;
+    return (HISTOGRAM_SUB_BUCKETS + sub) << (msb - HISTOGRAM_SUB_BITS);
+}
+
+/**
+    @brief Reprezentatívna hodnota bucketu (stred jeho rozsahu)
+ */
+uint64_t histogram_bucket_value(size_t index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    unsigned msb = static_cast<unsigned>(index / HISTOGRAM_SUB_BUCKETS) + HISTOGRAM_SUB_BITS - 1;
+    uint64_t width = 1ULL << (msb - HISTOGRAM_SUB_BITS);
+    return histogram_bucket_low(index) + width / 2;
+}
+//====END OF histogram.cpp ======
@@ -0,0 +1,244 @@
+/**
+    @file archive.h
+    @brief Hlavičkový súbor archívu najväčších tokov za jednotlivé intervaly (zápis na pozadí a dotazy podľa času)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <ostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include "statsview.h"
+
+using namespace std;
+
+/**
+    @brief Verzia formátu archívu, mení sa pri každej nekompatibilnej zmene
+ */
+const uint32_t ARCHIVE_VERSION = 1;
+
+/**
+    @brief Hlavička súboru archívu
+ */
+struct ArchiveFileHeader {
+    char magic[8];          // "ISATOPAR"
+    uint32_t version;       // ARCHIVE_VERSION
+    uint32_t byte_order;    // 0x01020304 v poradí bajtov zapisujúceho hostiteľa
+};
+
+/**
+    @brief Hlavička bloku jedného intervalu, za ňou nasleduje size bajtov stĺpcov
+ */
+struct ArchiveBlockHeader {
+    uint32_t magic;         // ARCHIVE_BLOCK_MAGIC
+    uint32_t size;          // veľkosť komprimovaných stĺpcov v bajtoch
+    int64_t start_usec;     // začiatok intervalu (unix mikrosekundy)
+    int64_t end_usec;       // koniec intervalu
+    uint32_t rows;          // počet tokov
+    uint32_t checksum;      // FNV-1a stĺpcov (odhalí neúplne zapísaný blok)
+};
+
+/**
+    @brief Položka indexu (súbor <archív>.idx), jedna pre každý blok
+ */
+struct ArchiveIndexEntry {
+    int64_t start_usec;     // začiatok intervalu bloku
+    uint64_t offset;        // pozícia hlavičky bloku v archíve
+};
+
+const uint32_t ARCHIVE_BLOCK_MAGIC = 0x42415349;   // "ISAB"
+
+static_assert(sizeof(ArchiveFileHeader) == 16, "ArchiveFileHeader layout changed, bump ARCHIVE_VERSION");
+static_assert(sizeof(ArchiveBlockHeader) == 32, "ArchiveBlockHeader layout changed, bump ARCHIVE_VERSION");
+
+/**
+    @brief Tok v jednom intervale (prírastky počítadiel za interval, pri vzorkovaní už vynásobené N)
+ */
+struct ArchiveRow {
+    FlowKey key;
+    uint8_t flags;          // iba FLOW_NO_PORTS
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t rx_packets;
+    uint64_t tx_packets;
+};
+
+/**
+    @brief Jeden interval archívu
+ */
+struct ArchiveBlock {
+    int64_t start_usec;
+    int64_t end_usec;
+    vector<ArchiveRow> rows;
+};
+
+/**
+    @brief Zápis blokov na koniec archívu a jeho indexu
+    Riadky bloku sa ukladajú po stĺpcoch: rodina, protokol a príznaky ako bajty, porty ako varint, IPv4 adresy
+    ako varint rozdielu od predchádzajúcej adresy v stĺpci (zigzag), IPv6 adresy priamo a počítadlá ako varint
+    rozdielu od predchádzajúceho riadku (zigzag). Riadky sú zoradené podľa bajtov zostupne, takže rozdiely sú malé.
+    Pri otvorení sa index porovná s archívom: chýbajúce položky sa doplnia a neúplný posledný blok sa odstráni.
+ */
+class ArchiveWriter {
+    public:
+        /**
+        @brief Otvorenie alebo vytvorenie archívu
+        @param path cesta k archívu (index je v súbore path + ".idx")
+        @throws runtime_error ak súbor nejde otvoriť alebo nemá platný formát
+         */
+        explicit ArchiveWriter(const string& path);
+        ~ArchiveWriter();
+
+        ArchiveWriter(const ArchiveWriter&) = delete;
+        ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+        /**
+        @brief Pripísanie bloku na koniec archívu a položky do indexu
+        @param block interval (riadky sa zoradia podľa bajtov)
+        @return false ak zápis zlyhal
+         */
+        bool append(ArchiveBlock& block);
+        /**
+        @brief Počet blokov v archíve
+         */
+        size_t blocks() const;
+        /**
+        @brief Veľkosť archívu v bajtoch
+         */
+        uint64_t size() const;
+
+    private:
+        int fd_;
+        int index_fd_;
+        uint64_t size_;
+        size_t blocks_;
+        vector<uint8_t> buffer_;
+};
+
+/**
+    @brief Čítanie archívu podľa indexu
+ */
+class ArchiveReader {
+    public:
+        /**
+        @brief Otvorenie archívu na čítanie, index sa načíta celý (16 bajtov na interval)
+        @param path cesta k archívu
+        @throws runtime_error ak súbor nejde otvoriť alebo nemá platný formát
+         */
+        explicit ArchiveReader(const string& path);
+        ~ArchiveReader();
+
+        ArchiveReader(const ArchiveReader&) = delete;
+        ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+        /**
+        @brief Prechod blokmi, ktoré zasahujú do intervalu [from_usec, to_usec); prvý blok sa nájde binárnym vyhľadaním v indexe
+        @param callback volá sa pre každý blok v časovom poradí
+        @return počet prečítaných blokov
+         */
+        size_t scan(int64_t from_usec, int64_t to_usec, const function<void(const ArchiveBlock&)>& callback);
+        /**
+        @brief Počet blokov v indexe
+         */
+        size_t blocks() const;
+
+    private:
+        int fd_;
+        uint64_t size_;
+        vector<ArchiveIndexEntry> index_;
+};
+
+/**
+    @brief Nastavenia archivácie
+ */
+struct ArchiveConfig {
+    string path;
+    chrono::seconds interval{60};   // dĺžka intervalu
+    size_t top = 100;               // počet najväčších tokov (podľa bajtov) za interval
+    uint64_t min_bytes = 0;         // ak nie je 0, archivujú sa všetky toky s aspoň toľkými bajtmi za interval namiesto top
+};
+
+/**
+    @brief Archivácia najväčších tokov za každý interval vo vlákne na pozadí
+    Vlákno na konci každého intervalu vezme záznamy tabuľky z posledného publikovaného pohľadu (ako export), vypočíta prírastky
+    od predchádzajúceho intervalu a vybrané toky pripíše do archívu; zámok Stats pritom nedrží.
+ */
+class FlowArchiver {
+    public:
+        /**
+        @brief Konštruktor, otvorí archív; počítadlá tokov z posledného pohľadu sa berú ako východiskový stav
+        @throws runtime_error ak archív nejde otvoriť
+         */
+        FlowArchiver(ViewPublisher& views, const ArchiveConfig& config);
+        ~FlowArchiver();
+
+        FlowArchiver(const FlowArchiver&) = delete;
+        FlowArchiver& operator=(const FlowArchiver&) = delete;
+
+        /**
+        @brief Spustenie vlákna archivácie
+         */
+        void start();
+        /**
+        @brief Zastavenie vlákna, rozpracovaný interval sa zapíše
+         */
+        void stop();
+        /**
+        @brief Uzavretie intervalu končiaceho v now_usec (volá ho vlákno archivácie, verejné kvôli testom)
+        @return počet archivovaných tokov
+         */
+        size_t archive_once(int64_t now_usec);
+        /**
+        @brief Počet zapísaných blokov
+         */
+        size_t blocks() const;
+
+    private:
+        /**
+        @brief Slučka vlákna archivácie
+         */
+        void run_loop();
+
+        ViewPublisher& views_;
+        ArchiveConfig config_;
+        ArchiveWriter writer_;
+        int64_t interval_start_;
+        unordered_map<FlowKey, ArchiveRow, FlowKeyHash, FlowKeyEqual> previous_;  // počítadlá tokov na konci predchádzajúceho intervalu
+
+        thread thread_;
+        mutex run_mtx_;
+        condition_variable cv_;
+        bool running_;
+};
+
+/**
+    @brief Najväčšie toky v časovom rozsahu archívu (režim --query), prírastky z intervalov sa sčítajú podľa toku
+    @param path cesta k archívu
+    @param from_usec začiatok rozsahu (unix mikrosekundy)
+    @param to_usec koniec rozsahu
+    @param sort_option 'b' podľa bajtov, 'p' podľa paketov
+    @param count maximálny počet vypísaných tokov
+    @param out výstupný prúd
+    @param filter vypíšu sa iba toky vyhovujúce filtru (nullptr bez filtrovania)
+    @return počet prečítaných blokov
+ */
+size_t query_archive(const string& path, int64_t from_usec, int64_t to_usec, char sort_option, size_t count, ostream& out,
+                     const FlowFilter* filter = nullptr);
+
+/**
+    @brief Čas pre --from/--to: unix sekundy, "YYYY-MM-DD HH:MM[:SS]" (aj s 'T') v miestnom čase alebo "-<n>s|m|h|d" pred now_usec
+    @return čas v unix mikrosekundách
+    @throws invalid_argument ak čas nemá platný tvar
+ */
+int64_t parse_archive_time(const string& text, int64_t now_usec);
+
+#endif
+//====END OF archive.h ======
@@ -7,6 +7,10 @@
 #define DISPLAY_H
 
 #include "stats.h"
+#include "statsview.h"
+#include "resolver.h"
+#include "procmap.h"
+#include "dumper.h"
 #include <thread>
 #include <atomic>
 #include <vector>
@@ -21,11 +25,16 @@ class Display {
         /**
         @brief Konštruktor triedy Display 
         @param stats referencia na objekt triedy Stats
+        @param views publikované pohľady na štatistiky (zdroj všetkých zobrazených hodnôt)
         @param sort_option zvolená možnosť zoradenia
         @param refresh_interval interval obnovovania obrazovky
         @param running flag pre indikáciu, či je zobrazovací loop spustený
+        @param resolve_names true ak sa majú adresy prekladať na mená už pri štarte
+        @param dumper zapisovač paketov najväčších tokov (nullptr ak je vypnutý)
+        @param dump_top počet najväčších tokov, ktorých pakety sa zapisujú
         */
-        Display(Stats& stats, char sort_option, int refresh_interval, bool running);
+        Display(Stats& stats, ViewPublisher& views, char sort_option, int refresh_interval, bool running, bool resolve_names = false,
+                PcapDumper* dumper = nullptr, size_t dump_top = 5);
         /**
         @brief Deštruktor triedy Display
          */
@@ -42,10 +51,22 @@ class Display {
 
     private:
         /**
-        @brief Kontrola vstupu používateľa
+        @brief Spracovanie vstupu používateľa ('q' ukončenie, 'r' prepnutie prekladu adries na mená, 'v' prepnutie pohľadu,
+        'n' pohľad podľa sietí, '/' zadanie filtra, 'd' prepnutie zapisovania paketov, šípky výber riadku,
+        Enter sledovanie vybraného toku)
         @return true ak používateľ stlačil klávesu 'q', inak false
         */
-        bool check_exit();
+        bool handle_input();
+        /**
+        @brief Načítanie filtrovacieho výrazu v poslednom riadku obrazovky (prázdny výraz filter zruší)
+        */
+        void edit_filter();
+        /**
+        @brief Textová reprezentácia koncového bodu s menom hostiteľa namiesto adresy, ak je už preložené
+        @param endpoint koncový bod vo formáte "IP:port"
+        @return koncový bod vo formáte "meno:port" alebo pôvodný reťazec
+        */
+        string display_endpoint(const string& endpoint);
 
         /**
         @brief Zobrazí hlavičku tabuľky 
@@ -57,22 +78,59 @@ class Display {
         */
         void display_header(int col_width_src, int col_width_dst, int col_width_proto, int col_width_rx, int col_width_tx);
         /**
-        @brief Získa zoradený zoznam pripojení podľa zvoleného kritéria
-        @return zoradený zoznam pripojení
+        @brief Získa zoradený zoznam pripojení podľa zvoleného kritéria z posledného publikovaného pohľadu
+        @return zoradený zoznam pripojení (platný do ďalšieho volania)
         */
-        vector<pair<ConnectionKey, ConnectionStats>> get_sorted_connections();
+        const vector<pair<ConnectionKey, ConnectionStats>>& get_sorted_connections();
         /**
         @brief Zobrazí jednotlivé štatistky pripojení v formátovaných stĺpcoch
         */
         void display_connections(const vector<pair<ConnectionKey, ConnectionStats>>& connections, int col_width_src, int col_width_dst, int col_width_proto, int col_width_rx, int col_width_tx);
         /**
+        @brief Zobrazí percentily veľkostí paketov a medzipaketových časov vybraného toku pod tabuľkou
+        @param connections zoradený zoznam pripojení
+        */
+        void display_histograms(const vector<pair<ConnectionKey, ConnectionStats>>& connections);
+        /**
+        @brief Zapnutie sledovania vybraného toku, alebo jeho vypnutie, ak je vybraný sledovaný tok
+        */
+        void toggle_watch();
+        /**
+        @brief Zobrazí podrobnosti sledovaného toku (časy, príznaky TCP, história rýchlosti) pod tabuľkou
+        */
+        void display_detail();
+        /**
+        @brief Zobrazí štatistiky agregované podľa procesov vlastniacich toky
+        @param connections zoradený zoznam pripojení
+        */
+        void display_processes(const vector<pair<ConnectionKey, ConnectionStats>>& connections);
+        /**
+        @brief Zobrazí štatistiky agregované podľa dvojíc pomenovaných sietí (zdrojová sieť, cieľová sieť)
+         */
+        void display_networks();
+        /**
+        @brief Nájde proces vlastniaci tok podľa lokálneho koncového bodu (zdrojového alebo cieľového)
+        @param key kľúč pripojenia
+        @param out nájdený proces
+        @return true ak bol proces nájdený
+        */
+        bool find_process(const ConnectionKey& key, ProcessInfo& out);
+        /**
         @brief Nepretržite zobrazuje štatistiku siete v slučke, kým sa nezastaví alebo neukončí vstupom používateľa.
         */
         void display_loop();
         /**
-        @brief Referencia na objekt triedy Stats
+        @brief Referencia na objekt triedy Stats (iba zmeny: filter, sledovanie tokov, výber tokov na zapisovanie)
         */
         Stats& stats_;
+        /**
+        @brief Publikované pohľady na štatistiky
+         */
+        ViewPublisher& views_;
+        /**
+        @brief Pohľad vykresľovaného snímku (drží sa, kým sa nevezme novší)
+         */
+        shared_ptr<const StatsView> frame_view_;
         // Sort option for displaying network statistics
         /**
         @brief Zvolená možnosť zoradenia
@@ -90,6 +148,46 @@ class Display {
         @brief Vlákno pre zobrazovací loop
          */
         thread display_thread_;
+        /**
+        @brief Asynchrónny preklad zobrazených adries na mená
+         */
+        Resolver resolver_;
+        /**
+        @brief Priradenie tokov procesom (obnovuje sa na pozadí)
+         */
+        ProcessMap processes_;
+        /**
+        @brief Zobrazený pohľad (toky, procesy alebo dvojice sietí)
+         */
+        enum View { VIEW_FLOWS, VIEW_PROCESSES, VIEW_NETWORKS } view_ = VIEW_FLOWS;
+        /**
+        @brief Zapisovač paketov najväčších tokov (nullptr ak je vypnutý)
+         */
+        PcapDumper* dumper_;
+        /**
+        @brief Počet najväčších tokov, ktorých pakety sa zapisujú
+         */
+        size_t dump_top_;
+        /**
+        @brief Index vybraného riadku tabuľky tokov
+         */
+        int selected_ = 0;
+        /**
+        @brief Kľúč toku vo vybranom riadku pri poslednom vykreslení
+         */
+        ConnectionKey selected_key_;
+        /**
+        @brief Sledovaný tok (podrobnosti zbiera Stats iba preň)
+         */
+        ConnectionKey watched_;
+        /**
+        @brief true ak je niektorý tok sledovaný
+         */
+        bool watching_ = false;
+        /**
+        @brief Chybové hlásenie naposledy zadaného filtra (prázdne ak bol platný)
+         */
+        string filter_error_;
 
 };
 #endif 
@@ -0,0 +1,141 @@
+/**
+    @file dumper.h
+    @brief Hlavičkový súbor triedy PcapDumper, ktorá zapisuje vybrané pakety do rotujúcej sady pcap súborov
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef DUMPER_H
+#define DUMPER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <sys/types.h>
+
+using namespace std;
+
+/**
+    @brief Trieda zapisujúca pakety do rotujúcej sady pcap súborov v samostatnom vlákne
+    Zachytávacie vlákno iba skopíruje paket do aktuálneho buffera; plné buffery zapisuje vlákno zapisovača
+    jedným volaním write. Ak zapisovač nestíha a nie je voľný buffer, paket sa zahodí a započíta.
+    Súbory sa striedajú po prekročení veľkosti (kontroluje sa po zapísaní celého buffera),
+    po poslednom súbore sa prepisuje prvý.
+ */
+class PcapDumper {
+    public:
+        /**
+        @brief Konštruktor triedy PcapDumper, spustí vlákno zapisovača
+        @param prefix predpona súborov (vzniknú súbory <prefix>.0.pcap až <prefix>.<file_count-1>.pcap)
+        @param linktype typ linkovej vrstvy do hlavičky súboru (hodnota pcap_datalink)
+        @param snaplen maximálna dĺžka zachyteného paketu
+        @param file_count počet súborov v rotácii
+        @param file_size veľkosť súboru v bajtoch, po ktorej sa prejde na ďalší
+        @param buffer_size veľkosť jedného buffera v bajtoch
+        @param buffer_count počet bufferov
+         */
+        PcapDumper(const string& prefix, int linktype, uint32_t snaplen, size_t file_count = 4,
+                   size_t file_size = 16 * 1024 * 1024, size_t buffer_size = 1024 * 1024, size_t buffer_count = 4);
+        /**
+        @brief Deštruktor, zapíše zostávajúce pakety a ukončí vlákno zapisovača
+         */
+        ~PcapDumper();
+
+        PcapDumper(const PcapDumper&) = delete;
+        PcapDumper& operator=(const PcapDumper&) = delete;
+
+        /**
+        @brief Pridanie paketu do buffera (volá zachytávacie vlákno, neblokuje na disku)
+        @param ts_sec čas zachytenia, sekundy
+        @param ts_usec čas zachytenia, mikrosekundy
+        @param caplen počet zachytených bajtov
+        @param len pôvodná dĺžka paketu
+        @param data zachytené dáta
+        @return false ak bol paket zahodený
+         */
+        bool enqueue(uint32_t ts_sec, uint32_t ts_usec, uint32_t caplen, uint32_t len, const u_char* data);
+        /**
+        @brief Odovzdanie aktuálneho buffera zapisovaču a čakanie na zápis všetkých bufferov
+         */
+        void flush();
+
+        /**
+        @brief Zapnutie alebo vypnutie zapisovania (vypnutý zapisovač neoznačuje toky)
+         */
+        void set_enabled(bool enabled);
+        /**
+        @brief Prepnutie zapisovania
+         */
+        void toggle();
+        /**
+        @brief Stav zapisovania
+         */
+        bool enabled() const;
+        /**
+        @brief Počet paketov prijatých do bufferov
+         */
+        uint64_t packets() const;
+        /**
+        @brief Počet paketov zahodených pre plné buffery
+         */
+        uint64_t dropped() const;
+        /**
+        @brief Názov súboru s daným indexom v rotácii
+         */
+        string file_name(size_t index) const;
+
+    private:
+        /**
+        @brief Slučka vlákna zapisovača
+         */
+        void writer_loop();
+        /**
+        @brief Zápis buffera do aktuálneho súboru, prípadne otvorenie ďalšieho (iba vlákno zapisovača)
+         */
+        void write_buffer(const vector<uint8_t>& buffer);
+        /**
+        @brief Otvorenie ďalšieho súboru v rotácii a zápis hlavičky pcap
+         */
+        void open_next_file();
+        /**
+        @brief Presun aktuálneho buffera do fronty na zápis (volá sa pod zámkom)
+         */
+        void hand_off();
+
+        string prefix_;
+        int linktype_;
+        uint32_t snaplen_;
+        size_t file_count_;
+        size_t file_size_;
+        size_t buffer_size_;
+
+        /**
+        @brief Stav vlákna zapisovača
+         */
+        int fd_;
+        size_t file_index_;
+        size_t file_bytes_;
+
+        /**
+        @brief Buffery: plnený, plné čakajúce na zápis a voľné (chránené zámkom)
+         */
+        vector<uint8_t> current_;
+        deque<vector<uint8_t>> full_;
+        deque<vector<uint8_t>> free_;
+        size_t writing_;
+        mutex mtx_;
+        condition_variable cv_;
+        condition_variable done_cv_;
+        bool stopping_;
+        thread thread_;
+
+        atomic<bool> enabled_;
+        atomic<uint64_t> packets_;
+        atomic<uint64_t> dropped_;
+};
+
+#endif
+//====END OF dumper.h ======
@@ -0,0 +1,202 @@
+/**
+    @file exporter.h
+    @brief Hlavičkový súbor triedy FlowExporter, ktorá exportuje toky z tabuľky tokov vo formáte IPFIX alebo NetFlow v9
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "statsview.h"
+
+using namespace std;
+
+/**
+    @brief Formát exportu
+ */
+enum ExportProtocol {
+    EXPORT_IPFIX,       // IPFIX (RFC 7011), verzia 10
+    EXPORT_NETFLOW_V9   // NetFlow v9 (RFC 3954)
+};
+
+/**
+    @brief Dôvod ukončenia toku (IPFIX flowEndReason)
+ */
+enum FlowEndReason : uint8_t {
+    END_IDLE_TIMEOUT = 1,
+    END_ACTIVE_TIMEOUT = 2,
+    END_FORCED = 4
+};
+
+/**
+    @brief Identifikátory šablón
+ */
+const uint16_t TEMPLATE_IPV4 = 256;
+const uint16_t TEMPLATE_IPV6 = 257;
+
+/**
+    @brief Číslo podniku pre vlastné informačné prvky IPFIX (32473 je podľa RFC 5612 vyhradené pre dokumentáciu a príklady)
+ */
+const uint32_t EXPORT_ENTERPRISE = 32473;
+
+/**
+    @brief Vlastné informačné prvky IPFIX s percentilmi histogramov toku
+ */
+enum ExportPercentileField : uint16_t {
+    FIELD_SIZE_P50 = 1,     // medián veľkosti paketu (bajty, unsigned16)
+    FIELD_SIZE_P99 = 2,     // 99. percentil veľkosti paketu (bajty, unsigned16)
+    FIELD_IAT_P50 = 3,      // medián medzipaketového času (mikrosekundy, unsigned32)
+    FIELD_IAT_P99 = 4       // 99. percentil medzipaketového času (mikrosekundy, unsigned32)
+};
+
+/**
+    @brief Nastavenia exportu
+ */
+struct ExportConfig {
+    string collector;                               // "host:port" alebo "[IPv6]:port"
+    ExportProtocol protocol = EXPORT_IPFIX;
+    chrono::seconds active_timeout{60};             // perióda exportu dlhotrvajúcich tokov
+    chrono::seconds inactive_timeout{15};           // tok bez paketov sa po tomto čase exportuje ako ukončený
+    chrono::seconds template_refresh{60};           // perióda opakovaného odoslania šablón (UDP)
+    uint32_t domain_id = 0;                         // observation domain / source id
+    size_t max_datagram = 1400;                     // maximálna veľkosť UDP datagramu
+};
+
+/**
+    @brief Spracovanie formátu "host:port" ("[IPv6]:port" pre IPv6 adresu)
+    @param value vstupný reťazec
+    @param host výsledný hostiteľ
+    @param port výsledný port
+    @return true ak je formát platný
+ */
+bool split_host_port(const string& value, string& host, string& port);
+
+/**
+    @brief Trieda exportujúca toky z tabuľky tokov cez UDP
+    Vlákno exportu raz za sekundu prejde záznamy tabuľky z posledného publikovaného pohľadu (bez zámku Stats) a exportuje prírastky
+    tokov, ktoré prekročili aktívny alebo neaktívny časový limit. Záznamy sa balia do datagramov
+    do veľkosti max_datagram. Soket je neblokujúci, datagram, ktorý sa nedá odoslať, sa zahodí.
+ */
+class FlowExporter {
+    public:
+        /**
+        @brief Konštruktor triedy FlowExporter, otvorí soket ku kolektoru
+        @param views publikované pohľady na štatistiky (záznamy tabuľky tokov sa čítajú z posledného pohľadu)
+        @param config nastavenia exportu
+        @throws runtime_error ak kolektor nie je možné preložiť alebo soket otvoriť
+         */
+        FlowExporter(ViewPublisher& views, const ExportConfig& config);
+        /**
+        @brief Deštruktor, zastaví vlákno exportu
+         */
+        ~FlowExporter();
+
+        FlowExporter(const FlowExporter&) = delete;
+        FlowExporter& operator=(const FlowExporter&) = delete;
+
+        /**
+        @brief Spustenie vlákna exportu
+         */
+        void start();
+        /**
+        @brief Zastavenie vlákna exportu, neodoslané prírastky sa exportujú s dôvodom END_FORCED
+         */
+        void stop();
+        /**
+        @brief Jeden prechod exportu (volá ho vlákno exportu, verejné kvôli testom)
+        @param now_usec aktuálny čas (unix mikrosekundy)
+        @param force exportovať všetky neodoslané prírastky bez ohľadu na časové limity
+         */
+        void export_once(int64_t now_usec, bool force = false);
+
+        /**
+        @brief Počet exportovaných dátových záznamov
+         */
+        uint64_t exported_records() const;
+        /**
+        @brief Počet odoslaných datagramov
+         */
+        uint64_t sent_datagrams() const;
+        /**
+        @brief Počet datagramov, ktoré sa nepodarilo odoslať
+         */
+        uint64_t send_errors() const;
+
+    private:
+        /**
+        @brief Stav exportu jedného toku (podľa kľúča toku, záznamy sa v tabuľke presúvajú)
+         */
+        struct ExportState {
+            uint64_t bytes;         // už exportované bajty
+            uint64_t packets;       // už exportované pakety
+            int64_t last_export;    // čas posledného exportu (unix mikrosekundy)
+            int64_t start;          // začiatok neexportovaného úseku toku
+            int64_t first_seen;     // prvý paket záznamu, iná hodnota znamená, že tok bol z tabuľky odstránený a vložený znova
+            uint64_t pass;          // posledný prechod, v ktorom bol tok v tabuľke
+        };
+
+        /**
+        @brief Začiatok novej správy (hlavička sa doplní pri odoslaní)
+         */
+        void begin_message(int64_t now_usec);
+        /**
+        @brief Pridanie šablón do správy
+         */
+        void add_templates();
+        /**
+        @brief Pridanie dátového záznamu, pri zaplnení sa správa odošle
+         */
+        void add_record(const FlowRecord& record, uint64_t bytes, uint64_t packets, int64_t start_usec, int64_t end_usec,
+                        uint8_t reason, int64_t now_usec);
+        /**
+        @brief Uzavretie otvorenej sady (dĺžka, zarovnanie pre NetFlow v9)
+         */
+        void close_set();
+        /**
+        @brief Doplnenie hlavičky a odoslanie správy
+         */
+        void send_message();
+        /**
+        @brief Slučka vlákna exportu
+         */
+        void run_loop();
+
+        ViewPublisher& views_;
+        ExportConfig config_;
+        int fd_;
+        int64_t boot_usec_;             // čas spustenia exportéra (sysUptime pre NetFlow v9)
+
+        /**
+        @brief Dáta používané iba vláknom exportu
+         */
+        unordered_map<FlowKey, ExportState, FlowKeyHash, FlowKeyEqual> states_;
+        uint64_t pass_;                 // počet prechodov exportu (stavy tokov odstránených z tabuľky sa zahodia)
+        vector<uint8_t> message_;
+        size_t set_start_;              // pozícia otvorenej sady v správe (0 ak žiadna nie je otvorená)
+        uint16_t set_id_;
+        uint16_t message_records_;      // počet záznamov v správe (pre NetFlow v9 vrátane šablón)
+        uint16_t message_data_records_;
+        int64_t message_time_;
+        int64_t last_templates_;        // čas posledného odoslania šablón
+        uint32_t sequence_;
+
+        atomic<uint64_t> exported_records_;
+        atomic<uint64_t> sent_datagrams_;
+        atomic<uint64_t> send_errors_;
+
+        thread thread_;
+        mutex run_mtx_;
+        condition_variable cv_;
+        bool running_;
+};
+
+#endif
+//====END OF exporter.h ======
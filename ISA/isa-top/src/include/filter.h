@@ -0,0 +1,129 @@
+/**
+    @file filter.h
+    @brief Hlavičkový súbor triedy FlowFilter, ktorá prekladá filtrovacie výrazy na predikát nad záznamami tabuľky tokov
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "flowtable.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+    @brief Filter tokov zadaný výrazom, napr. "proto=tcp and port 443 and host 10.0.0.0/8"
+    Výraz sa pri vytvorení raz preloží na postupnosť inštrukcií s jedným akumulátorom; "and" a "or" sa
+    prekladajú na podmienené skoky (skrátené vyhodnotenie), testy porovnávajú priamo binárne polia záznamu
+    (číslo protokolu, porty, adresy s maskou, počítadlá), takže sa pri filtrovaní nič neformátuje.
+
+    Gramatika:
+        výraz     := and-výraz { "or" and-výraz }
+        and-výraz := not-výraz { ["and"] not-výraz }
+        not-výraz := "not" not-výraz | "(" výraz ")" | test
+        test      := [ "src" | "dst" ] ( "host" | "net" ) <adresa>[/<dĺžka>]
+                   | [ "src" | "dst" ] "port" <port>[-<port>]
+                   | "proto" ["="] ( tcp | udp | icmp | icmpv6 | sctp | udplite | <číslo> )
+                   | tcp | udp | icmp | icmpv6 | sctp | udplite
+                   | ( "ip" | "ip6" )
+                   | ( "bytes" | "packets" ) ( "=" | "!=" | "<" | "<=" | ">" | ">=" ) <číslo>[k|M|G]
+    Medzi kľúčovým slovom a hodnotou môže byť medzera aj "=" ("port=443"), "&&", "||" a "!" sú skratky.
+ */
+class FlowFilter {
+    public:
+        /**
+        @brief Preklad výrazu
+        @param expression filtrovací výraz (prázdny výraz prepustí všetky toky)
+        @throws invalid_argument ak výraz nemá platný tvar (správa obsahuje pozíciu chyby)
+         */
+        explicit FlowFilter(const string& expression);
+
+        /**
+        @brief Vyhodnotenie filtra pre jeden smer toku
+        @param record záznam tabuľky tokov
+        @param scale násobok počítadiel pri vzorkovaní 1 z N (testy bytes/packets porovnávajú odhady)
+        @return true ak záznam vyhovuje výrazu
+         */
+        bool matches(const FlowRecord& record, uint64_t scale = 1) const;
+        /**
+        @brief Pôvodný text výrazu
+         */
+        const string& text() const;
+
+    private:
+        /**
+        @brief Operácia inštrukcie
+         */
+        enum Op : uint8_t {
+            OP_PROTO,           // acc = proto == value
+            OP_FAMILY,          // acc = family == value
+            OP_PORT,            // acc = port v rozsahu [value, value2]
+            OP_HOST,            // acc = adresa v prefixe addr/length
+            OP_COUNTER,         // acc = počítadlo (cmp) value
+            OP_NOT,             // acc = !acc
+            OP_JUMP_IF_FALSE,   // ak !acc, pokračuje sa inštrukciou target
+            OP_JUMP_IF_TRUE     // ak acc, pokračuje sa inštrukciou target
+        };
+        /**
+        @brief Ktoré koncové body test porovnáva
+         */
+        enum Side : uint8_t { SIDE_ANY, SIDE_SRC, SIDE_DST };
+        /**
+        @brief Porovnanie počítadla
+         */
+        enum Cmp : uint8_t { CMP_EQ, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE };
+
+        /**
+        @brief Inštrukcia preloženého filtra
+         */
+        struct Instruction {
+            Op op;
+            Side side;
+            Cmp cmp;
+            uint8_t family;         // rodina adresy pre OP_HOST
+            uint8_t length;         // dĺžka prefixu v bitoch pre OP_HOST
+            bool packets;           // OP_COUNTER: pakety namiesto bajtov
+            uint32_t target;        // cieľ skoku
+            uint64_t value;         // hodnota porovnania (OP_PORT: dolná hranica)
+            uint64_t value2;        // OP_PORT: horná hranica
+            uint8_t addr[16];       // OP_HOST: adresa prefixu s vynulovanými bitmi za prefixom
+        };
+
+        /**
+        @brief Rozdelenie výrazu na tokeny (slová, čísla, adresy, operátory a zátvorky)
+         */
+        void tokenize(const string& expression);
+        /**
+        @brief Preklad časti výrazu (rekurzívny zostup podľa gramatiky)
+         */
+        void parse_or();
+        void parse_and();
+        void parse_not();
+        void parse_test();
+        /**
+        @brief Aktuálny token (prázdny na konci výrazu)
+         */
+        const string& peek() const;
+        /**
+        @brief Prevzatie aktuálneho tokenu
+         */
+        string next(const char* expected);
+        /**
+        @brief Výnimka s pozíciou aktuálneho tokenu
+         */
+        [[noreturn]] void fail(const string& message) const;
+        /**
+        @brief Test adresy alebo prefixu
+         */
+        bool match_host(const Instruction& ins, const FlowKey& key) const;
+
+        string text_;
+        vector<Instruction> program_;
+        vector<pair<string, size_t>> tokens_;   // token a jeho pozícia vo výraze
+        size_t pos_ = 0;
+};
+
+#endif
+//====END OF filter.h ======
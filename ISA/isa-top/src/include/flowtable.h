@@ -0,0 +1,254 @@
+/**
+    @file flowtable.h
+    @brief Hlavičkový súbor tabuľky tokov s pevným binárnym formátom (v pamäti alebo v mapovanom súbore)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef FLOWTABLE_H
+#define FLOWTABLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <ostream>
+#include "parser.h"
+#include "histogram.h"
+#include "tcpstate.h"
+
+class FlowFilter;
+
+using namespace std;
+
+/**
+    @brief Verzia formátu súboru, zvyšuje sa pri každej zmene rozloženia hlavičky alebo záznamu
+ */
+const uint32_t FLOW_TABLE_VERSION = 2;
+/**
+    @brief Predvolený počet slotov tabuľky (mocnina 2)
+ */
+const size_t FLOW_TABLE_DEFAULT_CAPACITY = 65536;
+/**
+    @brief Najväčší počet slotov (--table-size), 2^24 slotov zaberá 7,5 GB
+ */
+const size_t FLOW_TABLE_MAX_CAPACITY = size_t(1) << 24;
+/**
+    @brief Nečinnosť, po ktorej sa záznam z plnej tabuľky odstráni (mikrosekundy)
+    Je dlhšia ako predvolený interval archívu aj neaktívny limit exportu, posledné prírastky toku sú už spracované.
+ */
+const int64_t FLOW_IDLE_TIMEOUT_USEC = 120 * 1000000LL;
+/**
+    @brief Počet slotov, ktoré pri hľadaní nečinných záznamov prejde jedno vloženie do plnej tabuľky
+ */
+const size_t FLOW_EXPIRE_BATCH = 64;
+
+/**
+    @brief Príznaky záznamu toku
+ */
+enum FlowFlags : uint8_t {
+    FLOW_NO_PORTS = 0x01,   // koncové body boli zadané bez portov (zobrazujú sa iba adresy)
+    FLOW_DUMP = 0x02,       // pakety toku sa zapisujú do pcap súborov (PcapDumper)
+    FLOW_NETS = 0x04,       // src_net a dst_net sú platné pre aktuálny zoznam sietí
+    FLOW_WATCH = 0x08       // tok je sledovaný, podrobnosti sú vo vedľajšej tabuľke Stats (nie v zázname)
+};
+
+/**
+    @brief Hlavička tabuľky (prvých 64 bajtov súboru)
+ */
+struct FlowTableHeader {
+    char magic[8];          // "ISATOPFT"
+    uint32_t version;       // FLOW_TABLE_VERSION
+    uint32_t byte_order;    // 0x01020304 v poradí bajtov zapisujúceho hostiteľa
+    uint32_t header_size;   // sizeof(FlowTableHeader)
+    uint32_t record_size;   // sizeof(FlowRecord)
+    uint64_t capacity;      // počet slotov
+    uint64_t count;         // počet obsadených slotov
+    uint64_t dropped;       // počet nových tokov, ktoré sa do plnej tabuľky nezmestili ani po odstránení nečinných
+    int64_t created;        // čas vytvorenia (unix sekundy)
+    uint32_t clean;         // 1 ak bola tabuľka korektne zatvorená
+    uint32_t sample_rate;   // vzorkovanie 1 z N, počítadlá obsahujú iba vybrané pakety (0 alebo 1 bez vzorkovania)
+};
+
+/**
+    @brief Záznam jedného toku (jeden slot tabuľky s otvoreným adresovaním)
+ */
+struct FlowRecord {
+    FlowKey key;            // binárna 5-tica (38 bajtov)
+    uint8_t used;           // 1 ak je slot obsadený, zapisuje sa ako posledný
+    uint8_t flags;          // FlowFlags
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t rx_packets;
+    uint64_t tx_packets;
+    int64_t first_seen;     // čas prvého paketu (unix mikrosekundy)
+    int64_t last_seen;      // čas posledného paketu (unix mikrosekundy)
+    uint16_t size_hist[SIZE_BUCKETS];   // histogram veľkostí paketov (bajty)
+    uint16_t iat_hist[IAT_BUCKETS];     // histogram medzipaketových časov (mikrosekundy)
+    TcpState tcp;           // stav TCP tohto smeru (nulový pre iné protokoly)
+    uint16_t src_net;       // pomenovaná sieť zdrojovej adresy (NetworkMap), platné s FLOW_NETS
+    uint16_t dst_net;       // pomenovaná sieť cieľovej adresy
+    uint8_t reserved[12];   // rezerva pre ďalšie polia bez zmeny veľkosti záznamu
+};
+
+static_assert(sizeof(FlowTableHeader) == 64, "FlowTableHeader layout changed, bump FLOW_TABLE_VERSION");
+static_assert(sizeof(FlowRecord) == 448, "FlowRecord layout changed, bump FLOW_TABLE_VERSION");
+
+/**
+    @brief Hash kľúča toku (FNV-1a cez jeho bajty), používa ho tabuľka aj mapy stavov podľa toku
+ */
+struct FlowKeyHash {
+    size_t operator()(const FlowKey& key) const;
+};
+
+/**
+    @brief Porovnanie kľúčov tokov po bajtoch
+ */
+struct FlowKeyEqual {
+    bool operator()(const FlowKey& a, const FlowKey& b) const;
+};
+
+/**
+    @brief Tabuľka tokov s otvoreným adresovaním nad súvislým poľom záznamov
+    Pamäť je buď anonymná, alebo namapovaný súbor, ku ktorému sa program po reštarte pripojí bez načítavania.
+    Tabuľka sa nezväčšuje. Ak je plná, odstránia sa nečinné záznamy a nasledujúce záznamy ich reťazcov sa posunú
+    bližšie k domovskému slotu, index slotu preto nie je trvalý identifikátor toku (stavy mimo tabuľky sa vedú podľa kľúča).
+    Ak sa miesto neuvoľní, nové toky sa iba spočítajú v hlavičke.
+    Trieda nie je synchronizovaná, zamykanie zabezpečuje volajúci (Stats).
+ */
+class FlowTable {
+    public:
+        /**
+        @brief Tabuľka v anonymnej pamäti
+        @param capacity požadovaný počet slotov (zaokrúhli sa na mocninu 2)
+         */
+        explicit FlowTable(size_t capacity = FLOW_TABLE_DEFAULT_CAPACITY);
+        /**
+        @brief Tabuľka v namapovanom súbore; existujúci súbor sa pripojí, inak sa vytvorí
+        @param path cesta k súboru
+        @param capacity počet slotov pri vytváraní (pri pripojení sa použije hodnota zo súboru)
+        @param read_only otvorenie iba na čítanie (súbor musí existovať)
+        @throws runtime_error ak súbor nemá platný formát alebo ho používa iný proces
+         */
+        FlowTable(const string& path, size_t capacity, bool read_only = false);
+        /**
+        @brief Deštruktor, označí tabuľku ako korektne zatvorenú a uvoľní mapovanie
+         */
+        ~FlowTable();
+
+        FlowTable(const FlowTable&) = delete;
+        FlowTable& operator=(const FlowTable&) = delete;
+
+        /**
+        @brief Nájdenie záznamu toku, prípadne jeho vloženie
+        Ak je tabuľka plná, odstránia sa záznamy nečinné dlhšie ako FLOW_IDLE_TIMEOUT_USEC v ďalších FLOW_EXPIRE_BATCH
+        slotoch od kurzora; kurzor postupne obíde celú tabuľku a práca jedného vloženia je ohraničená bez ohľadu na kapacitu.
+        Vloženie môže presunúť iné záznamy, staré ukazovatele neplatia.
+        @param key kľúč toku
+        @param now_usec čas paketu (unix mikrosekundy), 0 bez odstraňovania nečinných záznamov
+        @return záznam alebo nullptr, ak je tabuľka plná
+         */
+        FlowRecord* find_or_insert(const FlowKey& key, int64_t now_usec = 0);
+        /**
+        @brief Nájdenie záznamu toku
+        @return záznam alebo nullptr
+         */
+        const FlowRecord* find(const FlowKey& key) const;
+        FlowRecord* find(const FlowKey& key);
+
+        /**
+        @brief Odstránenie nesledovaných záznamov (bez FLOW_WATCH), ktorých posledný paket je starší ako idle_before
+        Medzera po zázname sa zaplní posunom nasledujúcich záznamov reťazca (backward-shift), takže vyhľadávanie
+        nepotrebuje náhrobky a obsadenosť naozaj klesne.
+        @param idle_before hranica nečinnosti (unix mikrosekundy)
+        @return počet odstránených záznamov
+         */
+        size_t expire(int64_t idle_before);
+
+        /**
+        @brief Počet slotov
+         */
+        size_t capacity() const;
+        /**
+        @brief Počet obsadených slotov
+         */
+        size_t size() const;
+        /**
+        @brief Počet tokov, ktoré sa nezmestili
+         */
+        uint64_t dropped() const;
+        /**
+        @brief Slot na danom indexe (na prechádzanie tabuľky, treba kontrolovať príznak used)
+         */
+        const FlowRecord& slot(size_t index) const;
+        FlowRecord& slot(size_t index);
+        /**
+        @brief Vzorkovanie, s ktorým boli počítadlá zaznamenané (1 bez vzorkovania)
+         */
+        uint32_t sample_rate() const;
+        void set_sample_rate(uint32_t rate);
+        /**
+        @brief true ak bola tabuľka pripojená z existujúceho súboru
+         */
+        bool reattached() const;
+        /**
+        @brief true ak bola pripojená tabuľka naposledy korektne zatvorená (false napr. po páde)
+         */
+        bool was_clean() const;
+        /**
+        @brief Asynchrónny zápis zmenených stránok do súboru
+         */
+        void sync();
+
+    private:
+        /**
+        @brief Index slotu pre kľúč alebo prvého voľného slotu v jeho reťazci
+         */
+        size_t probe(const FlowKey& key) const;
+        /**
+        @brief Uvoľnenie slotu a posun nasledujúcich záznamov reťazca do medzery
+         */
+        void erase(size_t index);
+        /**
+        @brief Odstránenie nesledovaných nečinných záznamov v ďalších `slots` slotoch od kurzora (postupné expire)
+        @return počet odstránených záznamov
+         */
+        size_t expire_step(int64_t idle_before, size_t slots);
+        /**
+        @brief Inicializácia hlavičky novej tabuľky
+         */
+        void init_header(size_t capacity);
+
+        void* base_;
+        size_t mapped_size_;
+        FlowTableHeader* header_;
+        FlowRecord* records_;
+        size_t mask_;
+        int fd_;
+        bool read_only_;
+        bool reattached_;
+        bool was_clean_;
+        size_t expire_cursor_;  // slot, ktorým pokračuje postupné odstraňovanie nečinných záznamov
+};
+
+/**
+    @brief Kľúč opačného smeru toku (vymenené adresy a porty)
+ */
+FlowKey reverse_key(const FlowKey& key);
+
+/**
+    @brief Čas vo formáte "YYYY-MM-DD HH:MM:SS" v miestnom čase
+    @param usec unix mikrosekundy
+    @return formátovaný čas, "-" pre 0
+ */
+string format_timestamp(int64_t usec);
+
+/**
+    @brief Výpis najväčších tokov z tabuľky (režim --inspect)
+    @param table tabuľka tokov
+    @param sort_option 'b' podľa bajtov, 'p' podľa paketov
+    @param count maximálny počet vypísaných tokov
+    @param out výstupný prúd
+    @param filter vypíšu sa iba toky vyhovujúce filtru (nullptr bez filtrovania)
+ */
+void print_top_flows(const FlowTable& table, char sort_option, size_t count, ostream& out, const FlowFilter* filter = nullptr);
+
+#endif
+//====END OF flowtable.h ======
@@ -0,0 +1,124 @@
+/**
+    @file histogram.h
+    @brief Kompaktné log-lineárne histogramy (veľkosť paketov a medzipaketové časy) uložené priamo v zázname toku
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+    Hodnoty 0..3 majú vlastný bucket, každá ďalšia mocnina 2 je rozdelená na 4 rovnaké časti
+    (2 významné bity ako v HDR histograme), relatívna chyba hodnoty bucketu je najviac 12.5 %.
+ */
+const unsigned HISTOGRAM_SUB_BITS = 2;
+const unsigned HISTOGRAM_SUB_BUCKETS = 1u << HISTOGRAM_SUB_BITS;
+
+/**
+    @brief Počet bucketov pre veľkosť paketu (0 až 65535 bajtov)
+ */
+const size_t SIZE_BUCKETS = 60;
+/**
+    @brief Počet bucketov pre medzipaketový čas v mikrosekundách (0 až 2^24 µs, väčšie hodnoty idú do posledného)
+ */
+const size_t IAT_BUCKETS = 92;
+
+/**
+    @brief Index bucketu pre hodnotu (bez ohraničenia počtom bucketov)
+ */
+inline size_t histogram_bucket(uint64_t value) {
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+    return (msb - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS
+           + ((value >> (msb - HISTOGRAM_SUB_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+
+/**
+    @brief Pripočítanie hodnoty do histogramu s 16-bitovými počítadlami
+    Pri naplnení počítadla sa všetky počítadlá histogramu vydelia dvomi, tvar rozdelenia (a percentily) sa zachová.
+    @param counts počítadlá
+    @param buckets počet bucketov (hodnoty za posledným bucketom sa započítajú doň)
+    @param value hodnota
+ */
+inline void histogram_record(uint16_t* counts, size_t buckets, uint64_t value) {
+    size_t index = histogram_bucket(value);
+    if (index >= buckets) {
+        index = buckets - 1;
+    }
+    if (++counts[index] == UINT16_MAX) {
+        for (size_t i = 0; i < buckets; i++) {
+            counts[i] >>= 1;
+        }
+    }
+}
+
+/**
+    @brief Najmenšia hodnota patriaca do bucketu
+ */
+uint64_t histogram_bucket_low(size_t index);
+
+/**
+    @brief Reprezentatívna hodnota bucketu (stred jeho rozsahu)
+ */
+uint64_t histogram_bucket_value(size_t index);
+
+/**
+    @brief Percentil z histogramu
+    @param counts počítadlá
+    @param buckets počet bucketov
+    @param percentile percentil v rozsahu 0 až 100
+    @return reprezentatívna hodnota bucketu, v ktorom leží percentil (0 pre prázdny histogram)
+ */
+template <typename T>
+uint64_t histogram_percentile(const T* counts, size_t buckets, double percentile) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < buckets; i++) {
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // poradie hľadanej hodnoty (1..total)
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total) + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return histogram_bucket_value(i);
+        }
+    }
+    return histogram_bucket_value(buckets - 1);
+}
+
+/**
+    @brief Priemerný štvorec hodnôt histogramu (z reprezentatívnych hodnôt bucketov)
+    @return 0 pre prázdny histogram
+ */
+template <typename T>
+double histogram_mean_square(const T* counts, size_t buckets) {
+    double total = 0, sum = 0;
+    for (size_t i = 0; i < buckets; i++) {
+        double value = static_cast<double>(histogram_bucket_value(i));
+        total += counts[i];
+        sum += counts[i] * value * value;
+    }
+    return total > 0 ? sum / total : 0;
+}
+
+/**
+    @brief Histogramy toku sčítané z oboch smerov (pre zobrazenie)
+ */
+struct FlowHistograms {
+    uint32_t size[SIZE_BUCKETS];
+    uint32_t iat[IAT_BUCKETS];
+};
+
+#endif
+//====END OF histogram.h ======
@@ -0,0 +1,93 @@
+/**
+    @file networks.h
+    @brief Hlavičkový súbor triedy NetworkMap, ktorá priraďuje adresy pomenovaným sieťam (najdlhšia zhoda prefixu)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef NETWORKS_H
+#define NETWORKS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <istream>
+
+using namespace std;
+
+/**
+    @brief Identifikátor siete, ktorá nezodpovedá žiadnemu prefixu
+ */
+const uint16_t NETWORK_UNKNOWN = 0;
+
+/**
+    @brief Priradenie IPv4/IPv6 adries pomenovaným sieťam podľa zoznamu prefixov
+    Prefixy sú uložené vo viacbitovom trie s krokom 8 bitov (rozšírenie prefixov na celé bajty),
+    vyhľadanie IPv4 adresy prejde najviac 4 uzly, IPv6 najviac 16 uzlov. Každá položka uzla nesie
+    najdlhší prefix, ktorý ju pokrýva na danej úrovni, takže pri prechode stačí pamätať si poslednú zhodu.
+ */
+class NetworkMap {
+    public:
+        NetworkMap();
+
+        /**
+        @brief Načítanie zoznamu zo súboru, riadok má tvar "<prefix>/<dĺžka> <názov>", '#' začína komentár
+        @param path cesta k súboru
+        @throws runtime_error ak súbor nejde otvoriť alebo riadok nemá platný formát
+         */
+        void load(const string& path);
+        /**
+        @brief Načítanie zoznamu z prúdu (formát ako pri load)
+        @param in vstupný prúd
+        @param source názov zdroja do chybových hlásení
+         */
+        void load(istream& in, const string& source);
+        /**
+        @brief Pridanie prefixu
+        @param family 4 alebo 6
+        @param addr adresa prefixu v sieťovom poradí bajtov
+        @param length dĺžka prefixu v bitoch
+        @param name názov siete (rovnaký názov zdieľa identifikátor)
+         */
+        void add(uint8_t family, const uint8_t* addr, unsigned length, const string& name);
+
+        /**
+        @brief Vyhľadanie siete s najdlhším prefixom obsahujúcim adresu
+        @param family 4 alebo 6
+        @param addr adresa v sieťovom poradí bajtov
+        @return identifikátor siete alebo NETWORK_UNKNOWN
+         */
+        uint16_t lookup(uint8_t family, const uint8_t* addr) const;
+        /**
+        @brief Názov siete podľa identifikátora
+         */
+        const string& name(uint16_t id) const;
+        /**
+        @brief Počet pridaných prefixov
+         */
+        size_t prefixes() const;
+
+    private:
+        /**
+        @brief Položka uzla: najdlhší prefix končiaci na tejto úrovni a potomok pre ďalší bajt adresy
+         */
+        struct Entry {
+            uint32_t child;     // index potomka v nodes_, 0 ak neexistuje
+            uint16_t id;        // sieť najdlhšieho prefixu pokrývajúceho položku na tejto úrovni
+            uint8_t length;     // dĺžka tohto prefixu (na porovnanie pri prekrývaní)
+        };
+        struct Node {
+            Entry entries[256];
+        };
+
+        /**
+        @brief Identifikátor siete podľa názvu (vytvorí nový)
+         */
+        uint16_t name_id(const string& name);
+
+        vector<Node> nodes_;        // 0 je koreň IPv4, 1 koreň IPv6
+        vector<string> names_;      // 0 je "(unknown)"
+        uint16_t default_id_[2];    // sieť prefixu s dĺžkou 0 pre IPv4 a IPv6
+        size_t prefixes_;
+};
+
+#endif
+//====END OF networks.h ======
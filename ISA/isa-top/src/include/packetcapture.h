@@ -1,34 +1,33 @@
 /**
-    @file packetcapture.cpp
-    @brief Hlavičkový súbor triedy PacketCapture, ktorá je zodpovedná za zachytávanie paketov zo sieťového rozhrania
+    @file packetcapture.h
+    @brief Hlavičkový súbor triedy PacketCapture, ktorá je zodpovedná za spracovanie paketov zo zdroja paketov
     @author Peter Stahl (xstahl01)
 */
 
 #ifndef PACKETCAPTURE_H
 #define PACKETCAPTURE_H
 
-#include <pcap.h>
+#include <vector>
+#include <memory>
 #include "stats.h"
+#include "parser.h"
+#include "dumper.h"
+#include "sampler.h"
+#include "packetsource.h"
 
 using namespace std;
 
 
-// Definícia štruktúry hlavičky Ethernet pre analýzu paketov.
-struct ether_header {
-    u_int8_t ether_dhost[6];
-    u_int8_t ether_shost[6];
-    u_int16_t ether_type;
-};
-
-// Trieda PacketCapture zodpovedná za zachytávanie paketov zo sieťového rozhrania.
+// Trieda PacketCapture zodpovedná za spracovanie paketov zo zdroja (rozhranie, súbor pcap, generátor).
 class PacketCapture {
     public:
         /**
         @brief Konštruktor triedy PacketCapture
-        @param interface názov sieťového rozhrania
+        @param source zdroj paketov (PacketCapture ho vlastní)
         @param stats referencia na objekt triedy Stats
+        @throws runtime_error ak typ linkovej vrstvy zdroja nie je podporovaný
         */
-        PacketCapture(const string& interface, Stats& stats);
+        PacketCapture(unique_ptr<PacketSource> source, Stats& stats);
         /**
         @brief Destruktor triedy PacketCapture
         */
@@ -41,29 +40,70 @@ class PacketCapture {
         @brief Metóda na zastavenie zachytávania paketov
         */ 
         void stop_capture();
-        
-
+        /**
+        @brief Nastavenie zapisovača paketov označených tokov (nullptr vypne zapisovanie)
+        */
+        void set_dumper(PcapDumper* dumper);
+        /**
+        @brief Zapnutie vzorkovania 1 z N (volá sa pred spustením zachytávania)
+        Náhodné vzorkovanie sa najprv skúsi ako filter BPF v jadre, inak sa pakety vyberajú v packet_handler.
+        @param rate N
+        @param mode spôsob vzorkovania
+        @return true ak vzorkovanie prebieha v jadre
+        */
+        bool set_sampling(uint32_t rate, SampleMode mode);
+        /**
+        @brief Typ linkovej vrstvy zdroja (hodnota DLT_*)
+        */
+        int datalink() const;
+        /**
+        @brief Maximálna dĺžka zachyteného paketu
+        */
+        uint32_t snaplen() const;
+        /**
+        @brief Počítadlá zdroja (prijaté a zahodené pakety)
+        */
+        SourceStats source_stats() const;
 
     private:
         /**
         @brief Metóda na spracovanie zachyteného paketu
-        @param user pointer na objekt triedy Stats
-        @param header pointer na hlavičku paketu
+        @param user pointer na objekt triedy PacketCapture
+        @param header hlavička paketu
         @param packet pointer na zachytený paket
         */
-        static void packet_handler(u_char *user, const struct pcap_pkthdr *header, const u_char *packet);
+        static void packet_handler(void* user, const PacketHeader& header, const u_char* packet);
         /**
-        @brief Názov sieťového rozhrania
+        @brief Overenie, či adresa patrí lokálnemu rozhraniu
+        @param family 4 alebo 6
+        @param addr adresa v sieťovom poradí bajtov
+        @return true ak je adresa lokálna
         */
-        string interface_;
+        bool is_local(uint8_t family, const uint8_t* addr) const;
+        /**
+        @brief Zdroj paketov
+        */
+        unique_ptr<PacketSource> source_;
         /**
         @brief Referencia na objekt triedy Stats
         */
         Stats& stats_;
         /**
-        @brief Handler pre zachytávanie paketov
+        @brief Dekódovacia funkcia zvolená podľa typu linkovej vrstvy pri otvorení zariadenia
+         */
+        DecodeFn decoder_;
+        /**
+        @brief Adresy sledovaného rozhrania (pri rozhraní "any" adresy všetkých rozhraní, prázdne ak smer nie je známy)
+         */
+        vector<LocalAddress> local_addresses_;
+        /**
+        @brief Zapisovač paketov tokov s príznakom FLOW_DUMP (nullptr ak je vypnutý)
+         */
+        PcapDumper* dumper_;
+        /**
+        @brief Výber paketov pri vzorkovaní v programe (pri vzorkovaní v jadre prepúšťa všetko)
          */
-        pcap_t* handle_;
+        Sampler sampler_;
 
 };
 
@@ -0,0 +1,174 @@
+/**
+    @file packetsource.h
+    @brief Hlavičkový súbor rozhrania zdrojov paketov (živé zachytávanie, súbor pcap, syntetický generátor)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef PACKETSOURCE_H
+#define PACKETSOURCE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <sys/types.h>
+
+using namespace std;
+
+/**
+    @brief Lokálna adresa rozhrania v binárnom tvare (na určenie smeru paketu)
+ */
+struct LocalAddress {
+    uint8_t family;
+    uint8_t addr[16];
+};
+
+/**
+    @brief Hlavička paketu odovzdávaná zo zdroja (nezávislá od libpcap)
+ */
+struct PacketHeader {
+    int64_t ts_usec;    // čas zachytenia (unix mikrosekundy)
+    uint32_t caplen;    // počet zachytených bajtov
+    uint32_t len;       // pôvodná dĺžka paketu
+};
+
+/**
+    @brief Funkcia volaná zdrojom pre každý paket
+    @param user ukazovateľ odovzdaný do PacketSource::run
+    @param header hlavička paketu
+    @param data zachytené bajty (platné iba počas volania)
+ */
+typedef void (*PacketCallback)(void* user, const PacketHeader& header, const u_char* data);
+
+/**
+    @brief Počítadlá zdroja paketov
+ */
+struct SourceStats {
+    uint64_t received;  // počet paketov odovzdaných programu
+    uint64_t dropped;   // počet paketov zahodených jadrom alebo rozhraním (0 ak ich zdroj nepozná)
+};
+
+/**
+    @brief Zdroj paketov pre PacketCapture
+    Zdroj dodáva pakety v tvare linkovej vrstvy datalink(), PacketCapture ich dekóduje a započíta do štatistík.
+ */
+class PacketSource {
+    public:
+        virtual ~PacketSource() {}
+
+        /**
+        @brief Odovzdávanie paketov, kým sa nezavolá stop() alebo zdroj neskončí (koniec súboru, limit paketov)
+        @param callback funkcia volaná pre každý paket
+        @param user ukazovateľ odovzdaný funkcii
+         */
+        virtual void run(PacketCallback callback, void* user) = 0;
+        /**
+        @brief Ukončenie run() (volá sa z iného vlákna)
+         */
+        virtual void stop() = 0;
+        /**
+        @brief Typ linkovej vrstvy paketov (hodnota DLT_*, pozri LinkType)
+         */
+        virtual int datalink() const = 0;
+        /**
+        @brief Maximálna dĺžka zachyteného paketu
+         */
+        virtual uint32_t snaplen() const = 0;
+        /**
+        @brief Soket zdroja na pripojenie filtra BPF (-1 ak zdroj soket nemá)
+         */
+        virtual int fd() const {
+            return -1;
+        }
+        /**
+        @brief Lokálne adresy na určenie smeru paketu (prázdne ak smer nie je známy)
+         */
+        virtual const vector<LocalAddress>& local_addresses() const = 0;
+        /**
+        @brief Počítadlá prijatých a zahodených paketov
+         */
+        virtual SourceStats stats() const = 0;
+};
+
+/**
+    @brief Scenár syntetickej prevádzky
+ */
+enum Scenario {
+    SCENARIO_SMALL,     // veľa malých tokov s malými paketmi (IPv4, TCP a UDP)
+    SCENARIO_ELEPHANTS, // niekoľko tokov s paketmi plnej veľkosti
+    SCENARIO_CHURN,     // každý paket je SYN nového toku (ako SYN flood), tabuľka sa rýchlo zaplní
+    SCENARIO_MIXED      // IPv4 a IPv6, TCP, UDP a ICMP, väčšina bajtov v niekoľkých veľkých tokoch
+};
+
+/**
+    @brief Nastavenia syntetického generátora
+ */
+struct SyntheticConfig {
+    Scenario scenario = SCENARIO_MIXED;
+    uint64_t packets = 0;   // počet paketov, 0 = až do stop()
+    uint32_t flows = 0;     // počet súbežných tokov, 0 = predvolený počet scenára
+    uint64_t seed = 1;      // počiatočný stav generátora (rovnaký seed = rovnaké pakety)
+};
+
+/**
+    @brief Nastavenia generátora z textu "<scenár>[,packets=<n>][,flows=<n>][,seed=<n>]"
+    Scenáre: small, elephants, churn, mixed.
+    @throws invalid_argument ak text nemá platný tvar
+ */
+SyntheticConfig parse_synthetic(const string& text);
+
+/**
+    @brief Syntetický zdroj ethernetových rámcov pre záťažové testy bez oprávnení a sieťového rozhrania
+    Pakety sa skladajú do jedného bufferu (zachytávajú sa iba hlavičky, dĺžka paketu je v hlavičke),
+    generátor je deterministický (xorshift64 zo seedu) a čas paketov začína pevne a rastie o 1 µs,
+    takže rovnaké nastavenie dá vždy rovnakú postupnosť. Lokálne adresy sú 192.0.2.1 a 2001:2::1,
+    vzdialené adresy tokov sú z rozsahov pre meranie výkonu 198.18.0.0/15 a 2001:2::/48.
+ */
+class SyntheticSource : public PacketSource {
+    public:
+        explicit SyntheticSource(const SyntheticConfig& config);
+
+        void run(PacketCallback callback, void* user) override;
+        void stop() override;
+        int datalink() const override;
+        uint32_t snaplen() const override;
+        const vector<LocalAddress>& local_addresses() const override;
+        SourceStats stats() const override;
+
+        /**
+        @brief Zostavenie ďalšieho paketu do bufferu (verejné kvôli testom)
+        @param header hlavička paketu
+        @return ukazovateľ na zachytené bajty
+         */
+        const u_char* next(PacketHeader& header);
+
+    private:
+        /**
+        @brief Ďalšie pseudonáhodné číslo
+         */
+        uint64_t random();
+        /**
+        @brief Zápis rámca toku flow do bufferu
+        @param flow identifikátor toku (určuje adresy, porty a protokol)
+        @param proto IPPROTO_TCP, IPPROTO_UDP alebo ICMP podľa rodiny
+        @param family 4 alebo 6
+        @param size dĺžka paketu na linke
+        @param tx true ak paket odosiela lokálna adresa
+        @param tcp_flags príznaky TCP
+        @return počet zachytených bajtov (hlavičky)
+         */
+        uint32_t build(uint64_t flow, uint8_t proto, uint8_t family, uint32_t size, bool tx, uint8_t tcp_flags);
+
+        SyntheticConfig config_;
+        uint32_t flows_;
+        uint64_t state_;
+        uint64_t generated_;
+        uint32_t seq_;
+        int64_t ts_usec_;
+        vector<LocalAddress> local_;
+        u_char buffer_[128];
+        atomic<bool> stopping_;
+        atomic<uint64_t> received_;
+};
+
+#endif
+//====END OF packetsource.h ======
@@ -0,0 +1,161 @@
+/**
+    @file parser.h
+    @brief Hlavičkový súbor parsera hlavičiek zachytených paketov (linková, sieťová a transportná vrstva)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+using namespace std;
+
+/**
+    @brief Typy linkovej vrstvy (hodnoty DLT_* z libpcap), ktoré parser podporuje
+    Hodnoty sú definované lokálne, aby parser nezávisel od hlavičiek libpcap a dal sa testovať samostatne.
+ */
+enum LinkType {
+    LINK_NULL = 0,          // BSD loopback, rodina adries v poradí bajtov hostiteľa
+    LINK_EN10MB = 1,        // Ethernet
+    LINK_RAW = 12,          // surový IP paket (DLT_RAW na Linuxe)
+    LINK_RAW_ALT = 14,      // surový IP paket (DLT_RAW na OpenBSD)
+    LINK_RAW_LINKTYPE = 101,// surový IP paket (LINKTYPE_RAW zo súborov pcap)
+    LINK_LOOP = 108,        // OpenBSD loopback, rodina adries v sieťovom poradí bajtov
+    LINK_LINUX_SLL = 113,   // Linux cooked capture v1 (rozhranie "any")
+    LINK_IPV4 = 228,        // surový IPv4 paket
+    LINK_IPV6 = 229,        // surový IPv6 paket
+    LINK_LINUX_SLL2 = 276   // Linux cooked capture v2
+};
+
+/**
+    @brief Smer paketu, ak ho linková vrstva priamo poskytuje (Linux cooked capture)
+ */
+enum PacketDirection : int8_t {
+    DIR_UNKNOWN = -1,
+    DIR_INCOMING = 0,
+    DIR_OUTGOING = 1
+};
+
+/**
+    @brief Binárny kľúč toku (5-tica), naplnený priamo z hlavičiek paketu
+ */
+struct FlowKey {
+    uint8_t family;     // 4 pre IPv4, 6 pre IPv6
+    uint8_t proto;      // číslo protokolu IPPROTO_*
+    uint16_t src_port;  // zdrojový port v poradí bajtov hostiteľa (0 ak protokol porty nemá)
+    uint16_t dst_port;  // cieľový port v poradí bajtov hostiteľa
+    uint8_t src[16];    // zdrojová adresa (IPv4 zaberá prvé 4 bajty, zvyšok je nulový)
+    uint8_t dst[16];    // cieľová adresa
+};
+
+/**
+    @brief Výsledok parsovania paketu
+    Ukazovatele smerujú priamo do bufferu zachyteného paketu, nič sa nekopíruje.
+ */
+struct PacketInfo {
+    FlowKey key;
+    const u_char* l3;       // začiatok IP hlavičky
+    const u_char* l4;       // začiatok transportnej hlavičky (nullptr pri fragmentoch)
+    uint32_t l4_caplen;     // počet zachytených bajtov od začiatku transportnej hlavičky
+    uint32_t l4_len;        // dĺžka transportnej časti podľa IP hlavičky
+    uint16_t vlan_id;       // VLAN ID vonkajšieho tagu (0 ak paket nie je tagovaný)
+    uint8_t vlan_depth;     // počet VLAN tagov (802.1Q / 802.1ad)
+    uint8_t tcp_flags;      // príznaky TCP (0 pre iné protokoly)
+    uint32_t tcp_seq;       // sekvenčné číslo TCP
+    uint32_t tcp_ack;       // potvrdzovacie číslo TCP
+    uint32_t tcp_payload;   // dĺžka dát TCP segmentu podľa IP hlavičky (bez TCP hlavičky)
+    PacketDirection direction;
+};
+
+/**
+    @brief Funkcia dekódujúca paket pre konkrétny typ linkovej vrstvy
+    @param data ukazovateľ na začiatok zachytených dát
+    @param caplen počet zachytených bajtov
+    @param out výsledok parsovania
+    @return true ak paket obsahuje IPv4/IPv6 hlavičku, ktorú sa podarilo spracovať
+ */
+typedef bool (*DecodeFn)(const u_char* data, uint32_t caplen, PacketInfo& out);
+
+/**
+    @brief Výber dekódovacej funkcie podľa typu linkovej vrstvy (volá sa raz pri otvorení zariadenia)
+    @param datalink hodnota vrátená z pcap_datalink
+    @return dekódovacia funkcia alebo nullptr, ak typ nie je podporovaný
+ */
+DecodeFn select_decoder(int datalink);
+
+/**
+    @brief Dekódovanie Ethernet rámca vrátane 802.1Q a 802.1ad (QinQ) tagov
+ */
+bool decode_ethernet(const u_char* data, uint32_t caplen, PacketInfo& out);
+/**
+    @brief Dekódovanie Linux cooked capture v1 (SLL)
+ */
+bool decode_linux_sll(const u_char* data, uint32_t caplen, PacketInfo& out);
+/**
+    @brief Dekódovanie Linux cooked capture v2 (SLL2)
+ */
+bool decode_linux_sll2(const u_char* data, uint32_t caplen, PacketInfo& out);
+/**
+    @brief Dekódovanie BSD loopback hlavičky (DLT_NULL)
+ */
+bool decode_null(const u_char* data, uint32_t caplen, PacketInfo& out);
+/**
+    @brief Dekódovanie OpenBSD loopback hlavičky (DLT_LOOP)
+ */
+bool decode_loop(const u_char* data, uint32_t caplen, PacketInfo& out);
+/**
+    @brief Dekódovanie surového IP paketu (verzia sa určí z prvého bajtu)
+ */
+bool decode_raw(const u_char* data, uint32_t caplen, PacketInfo& out);
+
+/**
+    @brief true ak parser pre protokol číta porty do kľúča toku (TCP, UDP, UDP-Lite, SCTP)
+ */
+bool has_ports(uint8_t proto);
+
+/**
+    @brief Názov protokolu pre zobrazenie
+    @param proto číslo protokolu IPPROTO_*
+    @return "tcp", "udp", "icmp", "icmpv6", "sctp", "udplite" alebo "other"
+ */
+string proto_name(uint8_t proto);
+
+/**
+    @brief Číslo protokolu podľa názvu (opak proto_name)
+    @param name "tcp", "udp", "icmp", "icmpv6", "sctp" alebo "udplite"
+    @return číslo protokolu IPPROTO_*, pre iné názvy IPPROTO_RAW
+ */
+uint8_t proto_number(const string& name);
+
+/**
+    @brief Textová reprezentácia IP adresy z kľúča toku
+    @param family 4 alebo 6
+    @param addr adresa v sieťovom poradí bajtov
+    @return adresa vo formáte inet_ntop
+ */
+string format_address(uint8_t family, const uint8_t* addr);
+
+/**
+    @brief Textová reprezentácia koncového bodu vo formáte "IP:port" ("IP:-" pre protokoly bez portov)
+    @param family 4 alebo 6
+    @param proto číslo protokolu
+    @param addr adresa v sieťovom poradí bajtov
+    @param port port v poradí bajtov hostiteľa
+    @return formátovaný reťazec (IPv6 adresa je v hranatých zátvorkách)
+ */
+string format_endpoint(uint8_t family, uint8_t proto, const uint8_t* addr, uint16_t port);
+
+/**
+    @brief Spracovanie koncového bodu vo formáte "IP:port", "[IPv6]:port", "IP:-" alebo "IP" (opak format_endpoint)
+    @param endpoint textová reprezentácia koncového bodu
+    @param family výsledná rodina adries (4 alebo 6)
+    @param addr výsledná adresa (16 bajtov, IPv4 zaberá prvé 4)
+    @param port výsledný port (0 ak chýba)
+    @return true ak sa koncový bod podarilo spracovať
+ */
+bool parse_endpoint(const string& endpoint, uint8_t& family, uint8_t* addr, uint16_t& port);
+
+#endif
+//====END OF parser.h ======
@@ -0,0 +1,92 @@
+/**
+    @file pcapsource.h
+    @brief Hlavičkový súbor zdrojov paketov nad libpcap (živé rozhranie a súbor pcap)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef PCAPSOURCE_H
+#define PCAPSOURCE_H
+
+#include <pcap.h>
+#include "packetsource.h"
+
+using namespace std;
+
+/**
+    @brief Funkcia na získanie IP adries zadaného rozhrania
+    @param interface názov rozhrania ("any" pre všetky rozhrania)
+    @return IPv4 a IPv6 adresy rozhrania v binárnom tvare
+    @throws invalid_argument ak rozhranie nemá žiadnu adresu
+ */
+vector<LocalAddress> get_local_addresses(const string& interface);
+
+/**
+    @brief Spoločná časť zdrojov nad otvoreným pcap_t (prevzatie handlera, slučka, počítadlá)
+ */
+class PcapSource : public PacketSource {
+    public:
+        ~PcapSource() override;
+
+        PcapSource(const PcapSource&) = delete;
+        PcapSource& operator=(const PcapSource&) = delete;
+
+        void run(PacketCallback callback, void* user) override;
+        void stop() override;
+        int datalink() const override;
+        uint32_t snaplen() const override;
+        int fd() const override;
+        const vector<LocalAddress>& local_addresses() const override;
+        SourceStats stats() const override;
+
+    protected:
+        PcapSource();
+
+        /**
+        @brief Prevod hlavičky libpcap a volanie callbacku zdroja
+         */
+        static void pcap_handler_fn(u_char* user, const struct pcap_pkthdr* header, const u_char* packet);
+
+        pcap_t* handle_;
+        vector<LocalAddress> local_addresses_;
+        PacketCallback callback_;
+        void* user_;
+        atomic<uint64_t> received_;
+};
+
+/**
+    @brief Živé zachytávanie zo sieťového rozhrania (pcap_open_live)
+ */
+class LivePcapSource : public PcapSource {
+    public:
+        /**
+        @brief Otvorenie rozhrania, jeho adresy určujú smer paketov
+        @param interface názov rozhrania ("any" pre všetky rozhrania)
+        @throws invalid_argument ak rozhranie nemá adresu
+        @throws runtime_error ak rozhranie nejde otvoriť
+         */
+        explicit LivePcapSource(const string& interface);
+};
+
+/**
+    @brief Prehratie súboru pcap maximálnou rýchlosťou (pcap_open_offline)
+    Lokálne adresy zachytávajúceho hostiteľa súbor neobsahuje, zadávajú sa (--local). Bez nich PacketCapture každý paket
+    počíta ako odoslaný jeho zdrojovou adresou (okrem cooked capture, ktorý smer pozná).
+ */
+class PcapFileSource : public PcapSource {
+    public:
+        /**
+        @brief Otvorenie súboru
+        @param path cesta k súboru pcap
+        @param local lokálne IPv4 a IPv6 adresy v textovom tvare, určujú smer paketov
+        @throws invalid_argument ak adresa nie je platná
+        @throws runtime_error ak súbor nejde otvoriť
+         */
+        explicit PcapFileSource(const string& path, const vector<string>& local = {});
+        /**
+        @brief Súbor nemá soket, pcap_fileno by vrátil deskriptor súboru a filter BPF by sa naň pripojiť nedal
+        @return -1, náhodné vzorkovanie preto beží v programe
+         */
+        int fd() const override;
+};
+
+#endif
+//====END OF pcapsource.h ======
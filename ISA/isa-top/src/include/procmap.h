@@ -0,0 +1,150 @@
+/**
+    @file procmap.h
+    @brief Hlavičkový súbor triedy ProcessMap, ktorá priraďuje sieťové sokety procesom podľa /proc
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef PROCMAP_H
+#define PROCMAP_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+/**
+    @brief Informácie o procese vlastniacom soket
+ */
+struct ProcessInfo {
+    int pid = 0;
+    string comm;    // názov príkazu z /proc/<pid>/comm
+};
+
+/**
+    @brief Lokálny koncový bod soketu (kľúč pre vyhľadanie soketu)
+ */
+struct SocketKey {
+    uint8_t family;     // 4 alebo 6
+    uint8_t proto;      // IPPROTO_TCP alebo IPPROTO_UDP
+    uint16_t port;      // lokálny port v poradí bajtov hostiteľa
+    uint8_t addr[16];   // lokálna adresa v sieťovom poradí bajtov
+
+    bool operator==(const SocketKey& other) const;
+};
+
+/**
+    @brief Hash funkcia pre SocketKey
+ */
+namespace std {
+    template <>
+    struct hash<SocketKey> {
+        size_t operator()(const SocketKey& k) const;
+    };
+}
+
+/**
+    @brief Spracovanie jedného riadku z /proc/net/{tcp,udp,tcp6,udp6}
+    @param line riadok súboru (hlavička sa odmietne)
+    @param family 4 alebo 6 podľa súboru
+    @param proto IPPROTO_TCP alebo IPPROTO_UDP podľa súboru
+    @param key výsledný lokálny koncový bod
+    @param inode číslo inode soketu
+    @return true ak sa riadok podarilo spracovať
+ */
+bool parse_proc_net_line(const string& line, uint8_t family, uint8_t proto, SocketKey& key, unsigned long& inode);
+
+/**
+    @brief Trieda priraďujúca toky procesom
+    Vlákno na pozadí periodicky načíta tabuľky soketov a inkrementálne prehľadáva /proc/<pid>/fd:
+    nové procesy sa prehľadajú vždy, známe procesy iba vtedy, keď sa objaví soket bez vlastníka,
+    a to najprv tie, ktoré už sokety vlastnili, kým sa nové sokety nenájdu.
+ */
+class ProcessMap {
+    public:
+        /**
+        @brief Konštruktor triedy ProcessMap
+        @param proc_root koreň súborového systému proc (v testoch náhradný adresár)
+        @param interval perióda obnovovania na pozadí
+         */
+        ProcessMap(const string& proc_root = "/proc", chrono::milliseconds interval = chrono::milliseconds(2000));
+        /**
+        @brief Deštruktor triedy ProcessMap, zastaví vlákno na pozadí
+         */
+        ~ProcessMap();
+        /**
+        @brief Spustenie obnovovania na pozadí
+         */
+        void start();
+        /**
+        @brief Zastavenie obnovovania na pozadí
+         */
+        void stop();
+        /**
+        @brief Jeden inkrementálny prechod obnovenia (volá ho vlákno na pozadí, verejné kvôli testom)
+         */
+        void refresh();
+        /**
+        @brief Vyhľadanie procesu podľa lokálneho koncového bodu (presná adresa, potom wildcard adresa)
+        @param family 4 alebo 6
+        @param proto IPPROTO_TCP alebo IPPROTO_UDP
+        @param addr lokálna adresa v sieťovom poradí bajtov
+        @param port lokálny port
+        @param out nájdený proces
+        @return true ak bol proces nájdený
+         */
+        bool lookup(uint8_t family, uint8_t proto, const uint8_t* addr, uint16_t port, ProcessInfo& out);
+        /**
+        @brief Počet prehľadaných adresárov /proc/<pid>/fd od spustenia (na overenie inkrementálnosti)
+         */
+        size_t scanned_pids();
+
+    private:
+        /**
+        @brief Načítanie tabuliek soketov z /proc/net
+        @return mapa lokálny koncový bod -> inode
+         */
+        unordered_map<SocketKey, unsigned long> read_socket_tables();
+        /**
+        @brief Prehľadanie deskriptorov procesu a zápis jeho soketov do inode_owner_
+        @param pid identifikátor procesu
+        @param wanted hľadané sokety, nájdené sa z množiny odstránia (nullptr ak sa nič nehľadá)
+        @return false ak proces už neexistuje
+         */
+        bool scan_pid(int pid, unordered_set<unsigned long>* wanted = nullptr);
+        /**
+        @brief Slučka vlákna na pozadí
+         */
+        void run_loop();
+
+        string proc_root_;
+        chrono::milliseconds interval_;
+
+        /**
+        @brief Dáta používané iba vláknom obnovovania
+         */
+        unordered_map<unsigned long, int> inode_owner_;     // inode -> pid
+        unordered_map<int, string> known_pids_;             // pid -> názov príkazu
+        unordered_set<unsigned long> unresolved_;           // sokety bez nájdeného vlastníka z minulého prechodu
+        unordered_set<int> socket_owners_;                  // procesy, v ktorých sa už našiel soket
+        atomic<size_t> scanned_pids_;
+
+        /**
+        @brief Publikovaná mapa pre vyhľadávanie (chránená zámkom)
+         */
+        unordered_map<SocketKey, ProcessInfo> sockets_;
+        mutex mtx_;
+
+        thread thread_;
+        mutex run_mtx_;
+        condition_variable cv_;
+        bool running_;
+};
+
+#endif
+//====END OF procmap.h ======
@@ -0,0 +1,125 @@
+/**
+    @file resolver.h
+    @brief Hlavičkový súbor triedy Resolver, ktorá asynchrónne prekladá IP adresy na mená (reverse DNS)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <string>
+#include <list>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+/**
+    @brief Reverzný preklad adresy pomocou getnameinfo (rešpektuje /etc/hosts aj lokálny resolver)
+    @param ip IPv4 alebo IPv6 adresa v textovom tvare
+    @return meno hostiteľa alebo prázdny reťazec, ak preklad zlyhal
+ */
+string reverse_lookup(const string& ip);
+
+/**
+    @brief Trieda prekladu adries na mená s pracovnými vláknami a ohraničenou LRU cache
+    Volanie lookup nikdy neblokuje: vráti meno z cache alebo zaradí adresu do fronty a vráti prázdny reťazec.
+ */
+class Resolver {
+    public:
+        /**
+        @brief Funkcia vykonávajúca samotný preklad (dá sa nahradiť v testoch)
+         */
+        using ResolveFn = function<string(const string&)>;
+
+        /**
+        @brief Konštruktor triedy Resolver
+        @param capacity maximálny počet záznamov v cache
+        @param workers počet pracovných vlákien
+        @param positive_ttl platnosť úspešného prekladu
+        @param negative_ttl platnosť neúspešného prekladu
+        @param resolve funkcia vykonávajúca preklad
+         */
+        Resolver(size_t capacity = 1024, int workers = 2,
+                 chrono::seconds positive_ttl = chrono::seconds(600),
+                 chrono::seconds negative_ttl = chrono::seconds(60),
+                 ResolveFn resolve = reverse_lookup);
+        /**
+        @brief Deštruktor triedy Resolver, zastaví a počká na pracovné vlákna
+         */
+        ~Resolver();
+
+        /**
+        @brief Získanie mena pre adresu bez blokovania
+        @param ip adresa v textovom tvare
+        @return meno hostiteľa, alebo prázdny reťazec ak ešte nie je preložené, preklad zlyhal alebo je preklad vypnutý
+         */
+        string lookup(const string& ip);
+        /**
+        @brief Zapnutie alebo vypnutie prekladu
+         */
+        void set_enabled(bool enabled);
+        /**
+        @brief Prepnutie prekladu (zapnutý/vypnutý)
+         */
+        void toggle();
+        /**
+        @brief Stav prekladu
+        @return true ak je preklad zapnutý
+         */
+        bool enabled() const;
+        /**
+        @brief Počet záznamov v cache (vrátane čakajúcich na preklad)
+         */
+        size_t size();
+
+    private:
+        /**
+        @brief Záznam v cache
+         */
+        struct Entry {
+            string name;                            // meno hostiteľa (prázdne pri neúspešnom preklade)
+            chrono::steady_clock::time_point expires; // čas expirácie záznamu
+            bool pending;                           // adresa čaká vo fronte na preklad
+            list<string>::iterator lru_it;          // pozícia v LRU zozname
+        };
+
+        /**
+        @brief Slučka pracovného vlákna
+         */
+        void worker_loop();
+        /**
+        @brief Odstránenie najdlhšie nepoužitých záznamov nad kapacitu (volá sa pod zámkom)
+         */
+        void evict();
+
+        size_t capacity_;
+        chrono::seconds positive_ttl_;
+        chrono::seconds negative_ttl_;
+        ResolveFn resolve_;
+
+        /**
+        @brief Cache adresa -> záznam a LRU zoznam (najnovšie na začiatku)
+         */
+        unordered_map<string, Entry> cache_;
+        list<string> lru_;
+        /**
+        @brief Fronta adries čakajúcich na preklad
+         */
+        deque<string> queue_;
+
+        mutex mtx_;
+        condition_variable cv_;
+        bool stopping_;
+        atomic<bool> enabled_;
+        vector<thread> workers_;
+};
+
+#endif
+//====END OF resolver.h ======
@@ -0,0 +1,85 @@
+/**
+    @file sampler.h
+    @brief Vzorkovanie paketov 1 z N (deterministické v programe alebo náhodné filtrom BPF v jadre)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <cstdint>
+#include <cmath>
+
+/**
+    @brief Spôsob vzorkovania
+ */
+enum SampleMode {
+    SAMPLE_COUNT,   // každý N-tý paket (počítadlo v programe)
+    SAMPLE_RANDOM   // každý paket s pravdepodobnosťou 1/N (filter v jadre, inak generátor v programe)
+};
+
+/**
+    @brief Rozhodovanie o vzorkovaní jednotlivých paketov v programe
+ */
+class Sampler {
+    public:
+        /**
+        @brief Konštruktor triedy Sampler
+        @param rate N, 0 alebo 1 vypne vzorkovanie
+        @param mode spôsob vzorkovania
+        @param seed počiatočný stav generátora (pre SAMPLE_RANDOM, nesmie byť 0)
+         */
+        explicit Sampler(uint32_t rate = 1, SampleMode mode = SAMPLE_COUNT, uint64_t seed = 0x9E3779B97F4A7C15ULL)
+            : rate_(rate), mode_(mode), counter_(0), state_(seed != 0 ? seed : 1) {
+        }
+
+        /**
+        @brief Rozhodnutie pre ďalší paket
+        @return true ak sa má paket spracovať
+         */
+        bool take() {
+            if (rate_ <= 1) {
+                return true;
+            }
+            if (mode_ == SAMPLE_COUNT) {
+                if (++counter_ < rate_) {
+                    return false;
+                }
+                counter_ = 0;
+                return true;
+            }
+            // xorshift64, rovnomerné číslo < rate bez delenia (násobenie a posun)
+            state_ ^= state_ << 13;
+            state_ ^= state_ >> 7;
+            state_ ^= state_ << 17;
+            return ((state_ >> 32) * rate_) >> 32 == 0;
+        }
+
+        uint32_t rate() const {
+            return rate_;
+        }
+
+    private:
+        uint32_t rate_;
+        SampleMode mode_;
+        uint32_t counter_;
+        uint64_t state_;
+};
+
+/**
+    @brief Pripojenie filtra BPF, ktorý v jadre prepustí každý paket s pravdepodobnosťou 1/rate
+    Používa rozšírenie jadra Linux SKF_AD_RANDOM; nevybrané pakety sa do programu vôbec nekopírujú.
+    @param fd soket (pri libpcap pcap_fileno)
+    @param rate N
+    @return true ak sa filter podarilo pripojiť
+ */
+bool attach_kernel_sampler(int fd, uint32_t rate);
+
+/**
+    @brief Polovičná šírka 95 % intervalu spoľahlivosti odhadu s daným rozptylom
+ */
+inline double confidence_95(double variance) {
+    return 1.96 * std::sqrt(variance);
+}
+
+#endif
+//====END OF sampler.h ======
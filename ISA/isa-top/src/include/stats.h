@@ -9,6 +9,12 @@
 #include <string>
 #include <unordered_map>
 #include <mutex>
+#include <memory>
+#include <vector>
+#include "flowtable.h"
+#include "networks.h"
+#include "filter.h"
+#include "watch.h"
 
 using namespace std;
 
@@ -45,13 +51,45 @@ struct ConnectionStats {
     double tx_bytes;
     double rx_packets;
     double tx_packets;
+    // rozptyly odhadov pri vzorkovaní (0 ak sa nevzorkuje), pri zlúčení tokov sa sčítajú
+    double rx_bytes_var = 0;
+    double tx_bytes_var = 0;
+    double rx_packets_var = 0;
+    double tx_packets_var = 0;
 };
 
+/**
+    @brief Prevod kľúča pripojenia (textové koncové body) na binárny kľúč toku
+    @return false ak koncový bod nie je platná adresa
+*/
+bool parse_connection_key(const ConnectionKey& key, FlowKey& flow);
+
+/**
+    @brief Pripočítanie histogramov jedného smeru toku
+*/
+void add_histograms(const FlowRecord& record, FlowHistograms& out);
+
+/**
+    @brief Pripočítanie TCP stavu jedného smeru toku (RTT meria iba smer, ktorý poslal SYN)
+*/
+void add_tcp_summary(const FlowRecord& record, TcpSummary& out);
+
 /**
     @brief Trieda zodpovedná za spracovanie štatistík
 */
 class Stats {
 public:
+    /**
+    @brief Štatistiky v tabuľke tokov v anonymnej pamäti
+    @param capacity počet slotov tabuľky tokov
+    */
+    explicit Stats(size_t capacity = FLOW_TABLE_DEFAULT_CAPACITY);
+    /**
+    @brief Štatistiky v tabuľke tokov namapovanej zo súboru (po reštarte sa pokračuje v nazbieraných hodnotách)
+    @param table_path cesta k súboru tabuľky
+    @param capacity počet slotov pri vytváraní nového súboru
+    */
+    Stats(const string& table_path, size_t capacity = FLOW_TABLE_DEFAULT_CAPACITY);
     /**
     @brief Metóda na aktualizáciu štatistík
     @param src zdrojová adresa
@@ -63,15 +101,154 @@ public:
     */
     void update(const string& src, const string& dst, const string& proto, int bytes, int packets, bool is_tx);
     /**
+    @brief Aktualizácia štatistík podľa binárneho kľúča toku (bez formátovania reťazcov)
+    @param key kľúč toku z parsera
+    @param bytes veľkosť paketu
+    @param is_tx true ak je paket odoslaný, false ak je prijatý
+    @param ts_usec čas zachytenia paketu (unix mikrosekundy)
+    @return príznaky záznamu toku (FlowFlags), 0 ak sa tok nezmestil do tabuľky
+    */
+    uint8_t update(const FlowKey& key, uint32_t bytes, bool is_tx, int64_t ts_usec);
+    /**
+    @brief Aktualizácia štatistík podľa výsledku parsovania paketu, pri TCP sa sleduje aj handshake a postup sekvencií
+    @param info výsledok parsovania
+    @param bytes veľkosť paketu
+    @param is_tx true ak je paket odoslaný, false ak je prijatý
+    @param ts_usec čas zachytenia paketu (unix mikrosekundy)
+    @return príznaky záznamu toku (FlowFlags), 0 ak sa tok nezmestil do tabuľky
+    */
+    uint8_t update(const PacketInfo& info, uint32_t bytes, bool is_tx, int64_t ts_usec);
+    /**
     @brief Získanie snímky(snapshot) aktuálnych štatistík spôsobom bezpečným pre vlákna.
+    Pri vzorkovaní obsahuje odhady (vynásobené N) a ich rozptyly.
     @return snapshot štatistík
     */
     unordered_map<ConnectionKey, ConnectionStats> get_stats_snapshot();
+    /**
+    @brief Snapshot štatistík agregovaných podľa dvojíc pomenovaných sietí (src = sieť zdroja, dst = sieť cieľa, proto prázdny)
+    @return snapshot štatistík, prázdny ak nie je nastavený zoznam sietí
+    */
+    unordered_map<ConnectionKey, ConnectionStats> get_network_snapshot();
+    /**
+    @brief Nastavenie zoznamu pomenovaných sietí; sieť koncových bodov sa vyhľadá raz pre každý tok a uloží do záznamu
+    @param networks zoznam sietí (nullptr vypne klasifikáciu)
+    */
+    void set_networks(shared_ptr<const NetworkMap> networks);
+    /**
+    @brief Nastavenie filtra tokov; snapshoty a výber najväčších tokov obsahujú iba vyhovujúce smery tokov
+    @param filter preložený filter (nullptr zruší filtrovanie)
+    */
+    void set_filter(shared_ptr<const FlowFilter> filter);
+    /**
+    @brief Aktuálny filter tokov (nullptr ak sa nefiltruje)
+    */
+    shared_ptr<const FlowFilter> filter();
+    /**
+    @brief Označenie najväčších tokov príznakom FLOW_DUMP (oba smery), ostatným sa príznak zruší
+    @param count počet tokov, 0 zruší označenie všetkých
+    @param sort_option 'b' podľa bajtov, 'p' podľa paketov
+    */
+    void mark_top_flows(size_t count, char sort_option);
+    /**
+    @brief Histogramy veľkostí paketov a medzipaketových časov toku sčítané z oboch smerov
+    @param key kľúč pripojenia (ako v snapshote, na poradí koncových bodov nezáleží)
+    @param out výsledné histogramy
+    @return true ak bol nájdený aspoň jeden smer toku
+    */
+    bool get_histograms(const ConnectionKey& key, FlowHistograms& out);
+    /**
+    @brief Súhrn TCP stavu toku z oboch smerov (RTT handshaku, retransmisie, segmenty mimo poradia)
+    @param key kľúč pripojenia (na poradí koncových bodov nezáleží)
+    @param out výsledný súhrn
+    @return true ak ide o TCP tok a bol nájdený aspoň jeden jeho smer
+    */
+    bool get_tcp_stats(const ConnectionKey& key, TcpSummary& out);
+    /**
+    @brief Zapnutie podrobného sledovania toku (oba smery, aj smer, ktorý ešte nemá záznam)
+    Podrobnosti sa ukladajú do vedľajšej tabuľky podľa kľúča toku, nesledované toky platia iba test príznaku FLOW_WATCH.
+    Sledované záznamy sa z plnej tabuľky neodstraňujú.
+    @param key kľúč pripojenia (na poradí koncových bodov nezáleží)
+    @return false ak kľúč nie je platný alebo je sledovaných už WATCH_MAX smerov
+    */
+    bool watch(const ConnectionKey& key);
+    /**
+    @brief Vypnutie sledovania toku, podrobnosti sa zahodia
+    @param key kľúč pripojenia
+    */
+    void unwatch(const ConnectionKey& key);
+    /**
+    @brief Podrobnosti sledovaného toku sčítané z oboch smerov (pri vzorkovaní vynásobené N)
+    @param key kľúč pripojenia
+    @param out výsledné podrobnosti (first_seen a last_seen z tabuľky tokov)
+    @return true ak je tok sledovaný
+    */
+    bool get_flow_detail(const ConnectionKey& key, FlowDetail& out);
+    /**
+    @brief Kópia obsadených záznamov tabuľky (pre publikovaný pohľad, mimo zámku sa s nimi pracuje bez blokovania zachytávania)
+    Záznamy sa v tabuľke môžu presúvať, stav k nim sa preto vedie podľa kľúča toku, nie podľa poradia.
+    @param out kópie záznamov
+    */
+    void copy_records(vector<FlowRecord>& out);
+    /**
+    @brief Kópia podrobností sledovaných smerov tokov, smery bez záznamu majú prázdne podrobnosti
+    @param out kópie podrobností (nevynásobené N)
+    */
+    void copy_watched(vector<FlowDetail>& out);
+    /**
+    @brief Nastavenie vzorkovania 1 z N; počítadlá sa ďalej zbierajú iba z vybraných paketov a snapshot ich vynásobí N
+    Hodnota sa uloží do hlavičky tabuľky tokov, aby ju poznal aj --inspect.
+    */
+    void set_sample_rate(uint32_t rate);
+    /**
+    @brief Vzorkovanie 1 z N (1 bez vzorkovania)
+    */
+    uint32_t sample_rate();
+    /**
+    @brief Počet tokov v tabuľke
+    */
+    size_t flow_count();
+    /**
+    @brief Počet nových tokov, ktoré sa do plnej tabuľky nezmestili ani po odstránení nečinných
+    */
+    uint64_t dropped_flows();
+    /**
+    @brief true ak boli štatistiky obnovené z existujúceho súboru tabuľky
+    */
+    bool restored();
 private:
     /**
-    @brief Mapa obsahujúca štatistiky pre jednotlivé pripojenia
+    @brief Pripočítanie paketu do záznamu toku (volá sa pod zámkom)
+     */
+    void account(FlowRecord& record, uint32_t bytes, uint32_t packets, bool is_tx, int64_t ts_usec);
+    /**
+    @brief true ak je slot obsadený a vyhovuje filtru (volá sa pod zámkom)
+     */
+    bool selected(const FlowRecord& record) const;
+    /**
+    @brief Pripojenie sledovania k novému záznamu a započítanie paketu sledovaného smeru (volá sa pod zámkom)
+    @param created true ak bol záznam práve vložený
+     */
+    void watch_packet(FlowRecord& record, bool created, uint32_t bytes, uint8_t tcp_flags, int64_t ts_usec);
+    /**
+    @brief Tabuľka tokov obsahujúca štatistiky pre jednotlivé pripojenia
+     */
+    unique_ptr<FlowTable> table_;
+    /**
+    @brief Zoznam pomenovaných sietí (nullptr ak nie je zadaný)
+     */
+    shared_ptr<const NetworkMap> networks_;
+    /**
+    @brief Filter tokov (nullptr ak sa nefiltruje)
+     */
+    shared_ptr<const FlowFilter> filter_;
+    /**
+    @brief Podrobnosti sledovaných smerov tokov podľa kľúča (záznamy sa v plnej tabuľke presúvajú, index slotu nie je stabilný)
+     */
+    unordered_map<FlowKey, FlowDetail, FlowKeyHash, FlowKeyEqual> watched_;
+    /**
+    @brief Sledované smery, ktoré ešte nemajú záznam (pripoja sa pri vložení)
      */
-    unordered_map<ConnectionKey, ConnectionStats> stats_map_;
+    vector<FlowKey> watch_pending_;
     /**
     @brief Mutex zámok pre synchronizáciu prístupu k štatistikám
      */
@@ -0,0 +1,143 @@
+/**
+    @file statsview.h
+    @brief Publikované nemenné pohľady na štatistiky pre viacerých čitateľov (zobrazenie, export, ...)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef STATSVIEW_H
+#define STATSVIEW_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include "stats.h"
+
+using namespace std;
+
+/**
+    @brief Riadok pohľadu (kľúč pripojenia a jeho štatistiky)
+ */
+typedef pair<ConnectionKey, ConnectionStats> ViewRow;
+
+/**
+    @brief Nemenný pohľad na štatistiky v jednom okamihu
+    Oba smery toku sú zlúčené do jedného riadku (src < dst), riadky sú už zoradené podľa bajtov aj podľa paketov,
+    čitateľ ich teda iba prechádza. Pohľad nesie aj kópie záznamov tabuľky (export, archív, histogramy a TCP stav riadkov),
+    podrobnosti sledovaných tokov a počítadlá tabuľky. Po publikovaní sa pohľad nemení, preto sa dá čítať z ľubovoľného
+    počtu vlákien bez zámku.
+ */
+struct StatsView {
+    uint64_t sequence = 0;          // poradové číslo publikovania (0 = prázdny pohľad pred prvým publikovaním)
+    int64_t published_usec = 0;     // čas publikovania (unix mikrosekundy)
+    uint32_t sample_rate = 1;       // vzorkovanie 1 z N, s ktorým boli hodnoty vypočítané
+    size_t flow_count = 0;          // počet tokov v tabuľke
+    uint64_t dropped_flows = 0;     // nové toky, ktoré sa nezmestili do plnej tabuľky
+    shared_ptr<const FlowFilter> filter;    // filter, s ktorým boli riadky vybrané (nullptr bez filtra)
+    vector<ViewRow> by_bytes;       // toky zoradené zostupne podľa bajtov
+    vector<ViewRow> by_packets;     // tie isté toky zoradené zostupne podľa paketov
+    vector<ViewRow> networks_by_bytes;      // dvojice pomenovaných sietí podľa bajtov
+    vector<ViewRow> networks_by_packets;    // dvojice pomenovaných sietí podľa paketov
+    vector<FlowRecord> records;     // kópie všetkých obsadených záznamov tabuľky (bez filtra, nevynásobené N)
+    unordered_map<FlowKey, size_t, FlowKeyHash, FlowKeyEqual> index;   // poloha záznamu v records podľa kľúča smeru
+    vector<FlowDetail> watched;     // podrobnosti sledovaných smerov tokov (nevynásobené N)
+
+    /**
+    @brief Toky zoradené podľa zvolenej možnosti ('b' bajty, 'p' pakety)
+     */
+    const vector<ViewRow>& flows(char sort_option) const;
+    /**
+    @brief Dvojice sietí zoradené podľa zvolenej možnosti
+     */
+    const vector<ViewRow>& networks(char sort_option) const;
+    /**
+    @brief Záznam smeru toku v pohľade
+    @return nullptr ak smer v tabuľke nebol
+     */
+    const FlowRecord* find(const FlowKey& key) const;
+    /**
+    @brief Histogramy toku sčítané z oboch smerov (ako Stats::get_histograms)
+    @return true ak bol nájdený aspoň jeden smer toku
+     */
+    bool histograms(const ConnectionKey& key, FlowHistograms& out) const;
+    /**
+    @brief Súhrn TCP stavu toku z oboch smerov (ako Stats::get_tcp_stats)
+    @return true ak ide o TCP tok a bol nájdený aspoň jeden jeho smer
+     */
+    bool tcp_stats(const ConnectionKey& key, TcpSummary& out) const;
+    /**
+    @brief Podrobnosti sledovaného toku sčítané z oboch smerov a vynásobené N (ako Stats::get_flow_detail)
+    @return true ak bol tok pri publikovaní sledovaný
+     */
+    bool flow_detail(const ConnectionKey& key, FlowDetail& out) const;
+};
+
+/**
+    @brief Zostavenie pohľadu zo snapshotov štatistík (zámok Stats sa drží iba počas snapshotov a kopírovania záznamov)
+    @param stats štatistiky
+    @param sequence poradové číslo pohľadu
+    @return nový pohľad
+ */
+shared_ptr<const StatsView> build_view(Stats& stats, uint64_t sequence);
+
+/**
+    @brief Periodické publikovanie pohľadov na štatistiky vo vlákne na pozadí
+    Agregátor raz za interval zostaví nový pohľad a vymení ukazovateľ na posledný pohľad (RCU).
+    Čitatelia (zobrazenie, export, archív) si vezmú referenciu na posledný pohľad bez zámku Stats a bez kopírovania, starý pohľad
+    sa uvoľní, keď ho pustí posledný čitateľ. Zachytávanie sa tak blokuje iba jedným snapshotom za interval bez ohľadu na počet
+    čitateľov. Samotná výmena ukazovateľa nie je bez zámku (atomic_load / atomic_store nad shared_ptr používajú v libstdc++
+    krátky spinlock z poolu), drží sa však iba počas zvýšenia počítadla referencií.
+ */
+class ViewPublisher {
+    public:
+        /**
+        @brief Konštruktor, pred prvým publikovaním je k dispozícii prázdny pohľad
+        @param stats štatistiky
+        @param interval interval publikovania
+         */
+        ViewPublisher(Stats& stats, chrono::milliseconds interval);
+        ~ViewPublisher();
+
+        ViewPublisher(const ViewPublisher&) = delete;
+        ViewPublisher& operator=(const ViewPublisher&) = delete;
+
+        /**
+        @brief Publikovanie prvého pohľadu a spustenie vlákna agregátora
+         */
+        void start();
+        /**
+        @brief Zastavenie vlákna agregátora, posledný pohľad zostáva dostupný
+         */
+        void stop();
+        /**
+        @brief Okamžité zostavenie a publikovanie nového pohľadu (napr. po zmene filtra), volať sa dá z ľubovoľného vlákna
+        @return poradové číslo publikovaného pohľadu
+         */
+        uint64_t publish();
+        /**
+        @brief Posledný publikovaný pohľad (bez zámku Stats, pohľad zostane platný, kým ho čitateľ drží)
+         */
+        shared_ptr<const StatsView> latest() const;
+
+    private:
+        /**
+        @brief Slučka vlákna agregátora
+         */
+        void run_loop();
+
+        Stats& stats_;
+        chrono::milliseconds interval_;
+        shared_ptr<const StatsView> view_;  // číta a zapisuje sa iba cez atomic_load / atomic_store (nie sú lock-free)
+        uint64_t sequence_;
+        mutex publish_mtx_;                 // poradie publikovaní (iba medzi zapisovateľmi)
+
+        thread thread_;
+        mutex run_mtx_;
+        condition_variable cv_;
+        bool running_;
+};
+
+#endif
+//====END OF statsview.h ======
@@ -0,0 +1,74 @@
+/**
+    @file tcpstate.h
+    @brief Kompaktný stav TCP jedného smeru toku (RTT handshaku, retransmisie a segmenty mimo poradia)
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef TCPSTATE_H
+#define TCPSTATE_H
+
+#include <cstdint>
+
+/**
+    @brief Príznaky TCP hlavičky
+ */
+enum TcpHeaderFlags : uint8_t {
+    TCPF_FIN = 0x01,
+    TCPF_SYN = 0x02,
+    TCPF_RST = 0x04,
+    TCPF_PSH = 0x08,
+    TCPF_ACK = 0x10,
+    TCPF_URG = 0x20,
+    TCPF_ECE = 0x40,
+    TCPF_CWR = 0x80
+};
+
+/**
+    @brief Príznaky stavu TcpState
+ */
+enum TcpStateFlags : uint8_t {
+    TCP_SEQ_VALID = 0x01,   // next_seq je platné
+    TCP_SYN_SENT = 0x02,    // smer poslal SYN a čaká sa na jeho ACK (meranie RTT)
+    TCP_HOLE = 0x04         // hole_start..hole_end je chýbajúci úsek sekvencií
+};
+
+/**
+    @brief Stav TCP jedného smeru toku, uložený v zázname tabuľky tokov (40 bajtov)
+    RTT handshaku je čas od SYN po prvé ACK toho istého smeru (klient), takže zahŕňa celú cestu tam a späť
+    bez ohľadu na to, či sa zachytáva na strane klienta alebo servera.
+    Segment so sekvenciami pred next_seq je mimo poradia, ak vypĺňa poslednú zaznamenanú medzeru, inak je to retransmisia.
+ */
+struct TcpState {
+    int64_t syn_time;           // čas posledného SYN tohto smeru (unix mikrosekundy)
+    uint32_t rtt_usec;          // RTT handshaku, 0 ak nebolo zmerané
+    uint32_t next_seq;          // sekvenčné číslo za najvyšším videným bajtom
+    uint32_t hole_start;        // začiatok poslednej medzery v sekvenciách
+    uint32_t hole_end;          // koniec poslednej medzery (nezahrnutý)
+    uint32_t retransmissions;
+    uint32_t out_of_order;
+    uint8_t state;              // TcpStateFlags
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(TcpState) == 40, "TcpState is part of FlowRecord layout");
+
+/**
+    @brief Spracovanie TCP segmentu jedného smeru toku
+    @param tcp stav smeru toku
+    @param flags príznaky TCP hlavičky
+    @param seq sekvenčné číslo
+    @param payload dĺžka dát segmentu
+    @param ts_usec čas zachytenia (unix mikrosekundy)
+ */
+void tcp_track(TcpState& tcp, uint8_t flags, uint32_t seq, uint32_t payload, int64_t ts_usec);
+
+/**
+    @brief Súhrn TCP stavu toku z oboch smerov (pre zobrazenie)
+ */
+struct TcpSummary {
+    uint32_t rtt_usec;          // RTT handshaku (0 ak nebolo zmerané)
+    uint64_t retransmissions;
+    uint64_t out_of_order;
+};
+
+#endif
+//====END OF tcpstate.h ======
@@ -8,6 +8,30 @@ struct Config{
     string interface;
     char sort_option = 'b'; //default to bytes
     int interval = 1;
+    bool resolve = false; // preklad adries na mená (reverse DNS)
+    string table_path;    // súbor tabuľky tokov (--table), prázdny = tabuľka v pamäti
+    size_t table_size = 0;    // počet slotov tabuľky tokov (--table-size), 0 = FLOW_TABLE_DEFAULT_CAPACITY
+    string inspect_path;  // súbor tabuľky tokov na výpis bez zachytávania (--inspect)
+    string dump_prefix;   // predpona pcap súborov s paketmi najväčších tokov (--dump)
+    int dump_top = 5;     // počet najväčších tokov, ktorých pakety sa zapisujú (--dump-top)
+    string export_collector;      // kolektor "host:port" pre export tokov (--export)
+    bool export_v9 = false;       // NetFlow v9 namiesto IPFIX (--export-proto v9)
+    int active_timeout = 60;      // aktívny časový limit exportu v sekundách (--active-timeout)
+    int inactive_timeout = 15;    // neaktívny časový limit exportu v sekundách (--inactive-timeout)
+    int sample_rate = 1;          // vzorkovanie 1 z N (--sample), 1 = všetky pakety
+    bool sample_count = false;    // každý N-tý paket namiesto náhodného výberu (--sample-mode count)
+    string filter;                // filtrovací výraz tokov (--filter), prázdny = všetky toky
+    string archive_path;          // archív najväčších tokov za intervaly (--archive)
+    int archive_interval = 60;    // dĺžka intervalu archívu v sekundách (--archive-interval)
+    int archive_top = 100;        // počet archivovaných tokov za interval (--archive-top)
+    uint64_t archive_min_bytes = 0;   // archivovať všetky toky s aspoň toľkými bajtmi za interval (--archive-min-bytes)
+    string query_path;            // archív na dotaz bez zachytávania (--query)
+    string query_from;            // začiatok rozsahu dotazu (--from), prázdny = začiatok archívu
+    string query_to;              // koniec rozsahu dotazu (--to), prázdny = koniec archívu
+    string networks_path;         // zoznam pomenovaných sietí (--networks), prázdny = bez klasifikácie
+    string read_path;             // súbor pcap namiesto rozhrania (--read)
+    vector<string> local_addresses;   // lokálne adresy prehrávaného súboru (--local, opakovateľná), určujú smer paketov
+    string synthetic;             // scenár syntetickej prevádzky namiesto rozhrania (--synthetic)
 };
 
 /**
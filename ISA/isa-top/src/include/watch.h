@@ -0,0 +1,93 @@
+/**
+    @file watch.h
+    @brief Podrobné údaje sledovaných tokov (história rýchlosti, príznaky TCP), ukladajú sa mimo tabuľky tokov
+    @author Peter Stahl (xstahl01)
+*/
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "tcpstate.h"
+
+using namespace std;
+
+/**
+    @brief Dĺžka histórie rýchlosti v sekundách
+ */
+const size_t WATCH_HISTORY = 60;
+/**
+    @brief Najväčší počet súčasne sledovaných smerov tokov
+ */
+const size_t WATCH_MAX = 64;
+
+/**
+    @brief Počítadlá jednej sekundy histórie
+ */
+struct WatchSecond {
+    int64_t second;     // unix sekunda, ku ktorej počítadlá patria (0 ak je bucket prázdny)
+    uint64_t packets;
+    uint64_t bytes;
+};
+
+/**
+    @brief Podrobnosti sledovaného toku
+    Záznam existuje iba pre toky s príznakom FLOW_WATCH (v Stats ako vedľajšia tabuľka podľa indexu slotu),
+    ostatné toky kvôli nemu nenesú v tabuľke žiadne pole navyše.
+ */
+struct FlowDetail {
+    FlowKey key;            // kľúč smeru toku (overenie, že slot stále patrí toku)
+    int64_t first_seen;     // prvý paket toku (z tabuľky tokov, vyplní sa pri čítaní)
+    int64_t last_seen;      // posledný paket toku
+    uint64_t packets;       // pakety od začiatku sledovania
+    uint64_t bytes;         // bajty od začiatku sledovania
+    uint8_t tcp_flags;      // zjednotenie všetkých videných príznakov TCP
+    uint32_t syn;           // počet segmentov so SYN
+    uint32_t fin;           // počet segmentov s FIN
+    uint32_t rst;           // počet segmentov s RST
+    WatchSecond history[WATCH_HISTORY];   // kruhový buffer podľa second % WATCH_HISTORY
+};
+
+/**
+    @brief Prázdne podrobnosti toku
+ */
+FlowDetail detail_init(const FlowKey& key);
+
+/**
+    @brief Započítanie paketu sledovaného smeru
+    @param detail podrobnosti toku
+    @param bytes veľkosť paketu
+    @param tcp_flags príznaky TCP (0 pre iné protokoly)
+    @param ts_usec čas paketu (unix mikrosekundy)
+ */
+void detail_record(FlowDetail& detail, uint32_t bytes, uint8_t tcp_flags, int64_t ts_usec);
+
+/**
+    @brief Pripočítanie druhého smeru toku (buckety rovnakej sekundy sa sčítajú, staršie sa nahradia novšími)
+ */
+void detail_merge(FlowDetail& into, const FlowDetail& from);
+
+/**
+    @brief Vynásobenie počítadiel pri vzorkovaní 1 z N
+ */
+void detail_scale(FlowDetail& detail, uint32_t rate);
+
+/**
+    @brief Pakety za jednotlivé sekundy končiace sekundou end_second (od najstaršej)
+    @param detail podrobnosti toku
+    @param end_second posledná sekunda histórie
+    @param seconds počet sekúnd (najviac WATCH_HISTORY)
+    @param bytes true pre bajty namiesto paketov
+ */
+vector<uint64_t> detail_rates(const FlowDetail& detail, int64_t end_second, size_t seconds, bool bytes = false);
+
+/**
+    @brief Textový zoznam príznakov TCP, napr. "SYN ACK FIN"
+ */
+string tcp_flags_text(uint8_t flags);
+
+#endif
+//====END OF watch.h ======
@@ -5,9 +5,14 @@
 */
 #include <iostream>
 #include "include/packetcapture.h"
+#include "include/pcapsource.h"
 #include "include/stats.h"
 #include "include/display.h"
 #include "include/utils.h"
+#include "include/flowtable.h"
+#include "include/exporter.h"
+#include "include/archive.h"
+#include <memory>
 
 using namespace std;
 
@@ -15,15 +20,92 @@ int main(int argc, char* argv[]){
     try{
         // Analyzujte argumenty príkazového riadka na konfiguráciu aplikácie
         Config config = parse_arguments(argc, argv);
+        // Filter sa preloží raz, chyba vo výraze ukončí program
+        shared_ptr<const FlowFilter> filter;
+        if (!config.filter.empty()) {
+            filter = make_shared<const FlowFilter>(config.filter);
+        }
+        // Výpis uloženej tabuľky tokov bez zachytávania
+        if (!config.inspect_path.empty()) {
+            FlowTable table(config.inspect_path, 0, true);
+            print_top_flows(table, config.sort_option, 20, cout, filter.get());
+            return 0;
+        }
+        // Dotaz na archív bez zachytávania
+        if (!config.query_path.empty()) {
+            int64_t now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+            int64_t from = config.query_from.empty() ? 0 : parse_archive_time(config.query_from, now);
+            int64_t to = config.query_to.empty() ? INT64_MAX : parse_archive_time(config.query_to, now);
+            query_archive(config.query_path, from, to, config.sort_option, 20, cout, filter.get());
+            return 0;
+        }
         // Vytvorte inštanciu triedy Stats, ktorá bude obsahovať štatistiky o zachytených paketoch
-        Stats stats;
+        // (pri --table v namapovanom súbore, ku ktorému sa program po reštarte znova pripojí)
+        size_t table_size = config.table_size != 0 ? config.table_size : FLOW_TABLE_DEFAULT_CAPACITY;
+        unique_ptr<Stats> stats_ptr(config.table_path.empty() ? new Stats(table_size) : new Stats(config.table_path, table_size));
+        Stats& stats = *stats_ptr;
         // flag na controlovanie behu programu
         bool running = true;
 
+        // Zdroj paketov: rozhranie, súbor pcap alebo syntetický generátor
+        unique_ptr<PacketSource> source;
+        if (!config.read_path.empty()) {
+            source.reset(new PcapFileSource(config.read_path, config.local_addresses));
+        }
+        else if (!config.synthetic.empty()) {
+            source.reset(new SyntheticSource(parse_synthetic(config.synthetic)));
+        }
+        else {
+            source.reset(new LivePcapSource(config.interface));
+        }
         // Vytvorte inštanciu triedy PacketCapture, ktorá bude zodpovedná za zachytávanie paketov
-        PacketCapture capture(config.interface, stats);
+        PacketCapture capture(move(source), stats);
+        // Vzorkovanie 1 z N, počítadlá sa pri zobrazení a exporte vynásobia N
+        if (config.sample_rate > 1) {
+            capture.set_sampling(config.sample_rate, config.sample_count ? SAMPLE_COUNT : SAMPLE_RANDOM);
+        }
+        stats.set_sample_rate(config.sample_rate);
+        stats.set_filter(filter);
+        // Klasifikácia koncových bodov do pomenovaných sietí (chyba v súbore ukončí program)
+        if (!config.networks_path.empty()) {
+            auto networks = make_shared<NetworkMap>();
+            networks->load(config.networks_path);
+            stats.set_networks(networks);
+        }
+        // Zapisovač paketov najväčších tokov do rotujúcich pcap súborov
+        unique_ptr<PcapDumper> dumper;
+        if (!config.dump_prefix.empty()) {
+            dumper.reset(new PcapDumper(config.dump_prefix, capture.datalink(), capture.snaplen()));
+            capture.set_dumper(dumper.get());
+        }
+        // Zoradené pohľady na štatistiky sa publikujú raz za interval, zobrazenie, export aj archív ich zdieľajú bez zámku štatistík
+        // (prvý pohľad sa publikuje hneď, archív z neho berie východiskový stav obnovenej tabuľky)
+        ViewPublisher views(stats, chrono::seconds(config.interval));
+        views.start();
+        // Export tokov ku kolektoru beží vo vlastnom vlákne
+        unique_ptr<FlowExporter> exporter;
+        if (!config.export_collector.empty()) {
+            ExportConfig export_config;
+            export_config.collector = config.export_collector;
+            export_config.protocol = config.export_v9 ? EXPORT_NETFLOW_V9 : EXPORT_IPFIX;
+            export_config.active_timeout = chrono::seconds(config.active_timeout);
+            export_config.inactive_timeout = chrono::seconds(config.inactive_timeout);
+            exporter.reset(new FlowExporter(views, export_config));
+            exporter->start();
+        }
+        // Archivácia najväčších tokov za intervaly beží vo vlastnom vlákne
+        unique_ptr<FlowArchiver> archiver;
+        if (!config.archive_path.empty()) {
+            ArchiveConfig archive_config;
+            archive_config.path = config.archive_path;
+            archive_config.interval = chrono::seconds(config.archive_interval);
+            archive_config.top = static_cast<size_t>(config.archive_top);
+            archive_config.min_bytes = config.archive_min_bytes;
+            archiver.reset(new FlowArchiver(views, archive_config));
+            archiver->start();
+        }
         // Vytvorte inštanciu triedy Display, ktorá bude zodpovedná za zobrazovanie štatistík
-        Display display(stats, config.sort_option, config.interval, running);
+        Display display(stats, views, config.sort_option, config.interval, running, config.resolve, dumper.get(), config.dump_top);
 
         // Vytvorte vlákno, ktoré bude zodpovedné za zachytávanie paketov
         thread capture_thread([&](){
@@ -34,11 +116,20 @@ int main(int argc, char* argv[]){
         display.run();
         // po skončení zobrazovania štatistík zastavenie programu
         display.stop();
+        views.stop();
         capture.stop_capture();
         // čakanie na ukončenie vlákna
         if(capture_thread.joinable()){
             capture_thread.join();
         }
+        // posledné pakety sa do exportu a archívu dostanú cez záverečný pohľad
+        views.publish();
+        if (exporter) {
+            exporter->stop();
+        }
+        if (archiver) {
+            archiver->stop();
+        }
     }
     catch(const exception& e){
         cerr << e.what() << endl;
@@ -0,0 +1,164 @@
+/**
+    @file networks.cpp
+    @brief Implementácia triedy NetworkMap (viacbitový trie s krokom 8 bitov)
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/networks.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+#include <arpa/inet.h>
+
+NetworkMap::NetworkMap() : nodes_(2), names_{"(unknown)"}, default_id_{NETWORK_UNKNOWN, NETWORK_UNKNOWN}, prefixes_(0) {
+    // uzly sa inicializujú nulami (value-initialization), položky bez potomka aj siete
+}
+
+/**
+    @brief Načítanie zoznamu zo súboru
+ */
+void NetworkMap::load(const string& path) {
+    ifstream in(path);
+    if (!in) {
+        throw runtime_error("Cannot open networks file '" + path + "'.");
+    }
+    load(in, path);
+}
+
+/**
+    @brief Načítanie zoznamu z prúdu
+ */
+void NetworkMap::load(istream& in, const string& source) {
+    string line;
+    size_t line_no = 0;
+    while (getline(in, line)) {
+        line_no++;
+        size_t comment = line.find('#');
+        if (comment != string::npos) {
+            line.erase(comment);
+        }
+        istringstream fields(line);
+        string prefix, name;
+        if (!(fields >> prefix)) {
+            continue; // prázdny riadok
+        }
+        fields >> name;
+        string error = source + ":" + to_string(line_no) + ": ";
+
+        size_t slash = prefix.find('/');
+        if (name.empty() || slash == string::npos) {
+            throw runtime_error(error + "expected '<prefix>/<length> <name>'.");
+        }
+        string address = prefix.substr(0, slash);
+        string length_text = prefix.substr(slash + 1);
+        uint8_t addr[16];
+        uint8_t family;
+        if (inet_pton(AF_INET, address.c_str(), addr) == 1) {
+            family = 4;
+        }
+        else if (inet_pton(AF_INET6, address.c_str(), addr) == 1) {
+            family = 6;
+        }
+        else {
+            throw runtime_error(error + "invalid address '" + address + "'.");
+        }
+        unsigned max_length = family == 4 ? 32 : 128;
+        if (length_text.empty() || length_text.size() > 3 || length_text.find_first_not_of("0123456789") != string::npos
+            || static_cast<unsigned>(stoi(length_text)) > max_length) {
+            throw runtime_error(error + "invalid prefix length '" + length_text + "'.");
+        }
+        add(family, addr, static_cast<unsigned>(stoi(length_text)), name);
+    }
+}
+
+/**
+    @brief Identifikátor siete podľa názvu (vytvorí nový)
+ */
+uint16_t NetworkMap::name_id(const string& name) {
+    for (size_t i = 1; i < names_.size(); i++) {
+        if (names_[i] == name) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    if (names_.size() > UINT16_MAX) {
+        throw runtime_error("Too many network names.");
+    }
+    names_.push_back(name);
+    return static_cast<uint16_t>(names_.size() - 1);
+}
+
+/**
+    @brief Pridanie prefixu
+ */
+void NetworkMap::add(uint8_t family, const uint8_t* addr, unsigned length, const string& name) {
+    uint16_t id = name_id(name);
+    prefixes_++;
+    size_t root = family == 6 ? 1 : 0;
+    if (length == 0) {
+        default_id_[root] = id;
+        return;
+    }
+
+    // prechod celými bajtmi prefixu, chýbajúce uzly sa vytvoria
+    size_t node = root;
+    unsigned level = (length - 1) / 8;
+    for (unsigned i = 0; i < level; i++) {
+        uint32_t child = nodes_[node].entries[addr[i]].child;
+        if (child == 0) {
+            // emplace_back môže presunúť pole, index sa zapíše až potom
+            nodes_.emplace_back();
+            child = static_cast<uint32_t>(nodes_.size() - 1);
+            nodes_[node].entries[addr[i]].child = child;
+        }
+        node = child;
+    }
+
+    // posledný bajt: prefix pokrýva 2^(8 - bits) po sebe idúcich položiek
+    unsigned bits = length - level * 8;
+    unsigned first = addr[level] & (0xFF00u >> bits) & 0xFF;
+    unsigned count = 1u << (8 - bits);
+    for (unsigned i = first; i < first + count; i++) {
+        Entry& entry = nodes_[node].entries[i];
+        // kratší prefix neprepíše dlhší, ktorý už položku pokrýva
+        if (entry.id == NETWORK_UNKNOWN || entry.length <= length) {
+            entry.id = id;
+            entry.length = static_cast<uint8_t>(length);
+        }
+    }
+}
+
+/**
+    @brief Vyhľadanie siete s najdlhším prefixom obsahujúcim adresu
+ */
+uint16_t NetworkMap::lookup(uint8_t family, const uint8_t* addr) const {
+    size_t root = family == 6 ? 1 : 0;
+    unsigned bytes = family == 6 ? 16 : 4;
+    uint16_t best = default_id_[root];
+    size_t node = root;
+    for (unsigned i = 0; i < bytes; i++) {
+        const Entry& entry = nodes_[node].entries[addr[i]];
+        if (entry.id != NETWORK_UNKNOWN) {
+            best = entry.id;
+        }
+        if (entry.child == 0) {
+            break;
+        }
+        node = entry.child;
+    }
+    return best;
+}
+
+/**
+    @brief Názov siete podľa identifikátora
+ */
+const string& NetworkMap::name(uint16_t id) const {
+    return id < names_.size() ? names_[id] : names_[NETWORK_UNKNOWN];
+}
+
+/**
+    @brief Počet pridaných prefixov
+ */
+size_t NetworkMap::prefixes() const {
+    return prefixes_;
+}
+//====END OF networks.cpp ======
@@ -1,86 +1,29 @@
 /**
     @file packetcapture.cpp
-    @brief Implementácia triedy PacketCapture, ktorá je zodpovedná za zachytávanie paketov zo sieťového rozhrania
+    @brief Implementácia triedy PacketCapture, ktorá je zodpovedná za spracovanie paketov zo zdroja paketov
     @author Peter Stahl (xstahl01)
 */
 #include "include/packetcapture.h"
-#include <netinet/ip.h>
-#include <netinet/tcp.h>
-#include <netinet/udp.h>
-#include <netinet/ip_icmp.h>
-#include <arpa/inet.h>
-#include <iostream>
-
-#include <netdb.h>
-#include <unistd.h>
-#include <ifaddrs.h>
-#include <net/if.h>
-
-string global_interface; // globalna premenna pre rozhranie 
-
-
-/**
-    @brief Funkcia na získanie IP adresy zadaného rozhrania
-    @param interface názov rozhrania
-    @return IP adresa rozhrania
-    inspiration: https://dev.to/fmtweisszwerg/cc-how-to-get-all-interface-addresses-on-the-local-device-3pki
-    @author Fomalhaut Weisszwerg 
-*/
-string getInterfaceIPAddress(const string& interface = global_interface) {
-    struct ifaddrs* ifaddr;
-    struct ifaddrs* ifa;
-    char ip[INET6_ADDRSTRLEN];
-
-    if (getifaddrs(&ifaddr) == -1) {
-        perror("getifaddrs"); // chyba pri získavaní informácií o rozhraniach
-        return "";
-    }
-
-    string local_ip;
-
-    // iterovanie cez zoznam rozhraní
-    for (ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-        if (ifa->ifa_addr == nullptr) {
-            continue; // preskočiť, ak rozhranie nemá priradenú IP adresu
-        }
-
-        // Porovnajte názov rozhrania
-        if (interface == ifa->ifa_name) {
-            // IPv4 adresa
-            if (ifa->ifa_addr->sa_family == AF_INET) {
-                struct sockaddr_in* sa = (struct sockaddr_in*)ifa->ifa_addr;
-                inet_ntop(AF_INET, &(sa->sin_addr), ip, INET_ADDRSTRLEN);
-                local_ip = ip;
-                break;
-            }
-        }
-    }
-
-    // uvoľnenie pamäte alokovanej z getifaddrs
-    freeifaddrs(ifaddr);
-
-    if (local_ip.empty()) {
-        throw invalid_argument("Interface " + interface + " not found or has no IP address.");
-    }
-
-    return local_ip;
-}
+#include <cstring>
+#include <stdexcept>
+#include <chrono>
 
 
 /**
     @brief Konštruktor triedy PacketCapture
-    @param interface názov sieťového rozhrania
+    @param source zdroj paketov
     @param stats referencia na objekt triedy Stats
 */
-PacketCapture::PacketCapture(const string& interface, Stats& stats)
-    : interface_(interface), stats_(stats), handle_(nullptr) {
-        char errbuf[PCAP_ERRBUF_SIZE];
-        global_interface = interface; // nastavenie globálnej premennej
-        handle_ = pcap_open_live(interface_.c_str(), BUFSIZ, 1, 1000, errbuf); // otvorenie zariadenia pre zachytávanie paketov
-        
-        if (handle_ == nullptr) { 
-            cerr << "Error opening device " << interface_ << ": " << errbuf << endl;
-            exit(1); // chyba pri otváraní zariadenia
+PacketCapture::PacketCapture(unique_ptr<PacketSource> source, Stats& stats)
+    : source_(move(source)), stats_(stats), decoder_(nullptr), dumper_(nullptr) {
+        // lokálne adresy sa zo zdroja prevezmú raz, nie pri každom pakete
+        local_addresses_ = source_->local_addresses();
+
+        // výber dekódovacej funkcie podľa typu linkovej vrstvy
+        int datalink = source_->datalink();
+        decoder_ = select_decoder(datalink);
+        if (decoder_ == nullptr) {
+            throw runtime_error("Unsupported link type " + to_string(datalink) + ".");
         }
     }
 
@@ -89,9 +32,6 @@ PacketCapture::PacketCapture(const string& interface, Stats& stats)
     @brief Destruktor triedy PacketCapture
  */
 PacketCapture::~PacketCapture() {
-    if (handle_ != nullptr) {
-        pcap_breakloop(handle_); 
-    }
 }
 
 
@@ -99,77 +39,122 @@ PacketCapture::~PacketCapture() {
     @brief Metóda na spustenie zachytávania paketov
  */
 void PacketCapture::start_capture() {
-    pcap_loop(handle_, 0, PacketCapture::packet_handler, reinterpret_cast<u_char*>(&stats_));
+    source_->run(PacketCapture::packet_handler, this);
 }
 
 
 /**
-    @brief Metóda na spracovanie zachyteného paketu
-    @param user pointer na objekt triedy Stats
-    @param header pointer na hlavičku paketu
-    @param packet pointer na zachytený paket
+    @brief Overenie, či adresa patrí lokálnemu rozhraniu
+    @param family 4 alebo 6
+    @param addr adresa v sieťovom poradí bajtov
+    @return true ak je adresa lokálna
  */
-void PacketCapture::packet_handler(u_char *user, const struct pcap_pkthdr *header, const u_char *packet) {
-    Stats* stats = reinterpret_cast<Stats*>(user); // Prenesenie používateľských údajov späť do ukazovateľa štatistiky
+bool PacketCapture::is_local(uint8_t family, const uint8_t* addr) const {
+    size_t len = family == 6 ? 16 : 4;
+    for (const auto& local : local_addresses_) {
+        if (local.family == family && memcmp(local.addr, addr, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    ether_header *eth_header;
 
-    eth_header = (struct ether_header *) packet;
+/**
+    @brief Metóda na spracovanie zachyteného paketu
+    @param user pointer na objekt triedy PacketCapture
+    @param header hlavička paketu
+    @param packet pointer na zachytený paket
+ */
+void PacketCapture::packet_handler(void* user, const PacketHeader& header, const u_char* packet) {
+    PacketCapture* self = static_cast<PacketCapture*>(user); // Prenesenie používateľských údajov späť do ukazovateľa na objekt
 
-    if (ntohs(eth_header->ether_type) != 0x0800) { // IPv4 check
+    // nevybrané pakety sa pri vzorkovaní v programe ani neparsujú
+    if (!self->sampler_.take()) {
         return;
     }
 
-    // IP hlavička z packatu, zdrojová a cieľová IP adresa
-    struct ip* ip_header = (struct ip*)(packet + sizeof(struct ether_header));
-    string src_ip = inet_ntoa(ip_header->ip_src);
-    string dst_up = inet_ntoa(ip_header->ip_dst);
-    int ip_header_len = ip_header->ip_hl * 4;
-
-    string protocol;
-    string scr_port = "-";
-    string dst_port = "-";
-
-    // TCP, UDP, ICMP alebo iný protokol
-    if (ip_header->ip_p == IPPROTO_TCP){
-        protocol = "tcp";
-        struct tcphdr* tcp_header = (struct tcphdr*)(packet + sizeof(struct ether_header) + ip_header_len);
-        scr_port = to_string(ntohs(tcp_header->th_sport));
-        dst_port = to_string(ntohs(tcp_header->th_dport));
-    } 
-    else if (ip_header->ip_p == IPPROTO_UDP) {
-        protocol = "udp";
-        struct udphdr* udp_header = (struct udphdr*)(packet + sizeof(struct ether_header) + ip_header_len);
-        scr_port = to_string(ntohs(udp_header->uh_sport));
-        dst_port = to_string(ntohs(udp_header->uh_dport));
-    } 
-    else if (ip_header->ip_p == IPPROTO_ICMP) {
-        protocol = "icmp";
-    } 
-    else {
-        protocol = "other";
+    // parsovanie hlavičiek priamo nad zachyteným bufferom
+    PacketInfo info;
+    if (!self->decoder_(packet, header.caplen, info)) {
+        return; // nejde o IPv4/IPv6 paket
     }
+    const FlowKey& key = info.key;
 
-    string src = src_ip + ":" + scr_port;
-    string dst = dst_up + ":" + dst_port;
+    // určenie smeru paketu, cooked capture smer pozná priamo
+    bool is_tx;
+    if (info.direction == DIR_OUTGOING || self->local_addresses_.empty()) {
+        is_tx = true; // bez lokálnych adries (súbor pcap) paket odoslala jeho zdrojová adresa
+    }
+    else if (self->is_local(key.family, key.src)) {
+        is_tx = true;
+    }
+    else if (self->is_local(key.family, key.dst)) {
+        is_tx = false;
+    }
+    else {
+        return; // paket nepatrí sledovanému rozhraniu
+    }
 
-    string local_ip = getInterfaceIPAddress();
+    // Transmitted (Tx) alebo Received (Rx), packetsize = header.len
+    uint8_t flags = self->stats_.update(info, header.len, is_tx, header.ts_usec);
 
-    if (src_ip == local_ip){
-        // Transmitted (Tx)
-        stats->update(src, dst, protocol, header->len, 1, true); 
+    // príslušnosť toku k zapisovaným tokom je jeden bit v zázname toku
+    if ((flags & FLOW_DUMP) && self->dumper_ != nullptr) {
+        self->dumper_->enqueue(static_cast<uint32_t>(header.ts_usec / 1000000), static_cast<uint32_t>(header.ts_usec % 1000000),
+                               header.caplen, header.len, packet);
     }
-    else if (dst_up == local_ip){
-        // Received (Rx)
-        stats->update(src, dst, protocol, header->len, 1, false); //packetsize = header->len
+}
+
+/**
+    @brief Nastavenie zapisovača paketov označených tokov (nullptr vypne zapisovanie)
+ */
+void PacketCapture::set_dumper(PcapDumper* dumper) {
+    dumper_ = dumper;
+}
+
+/**
+    @brief Zapnutie vzorkovania 1 z N
+    @param rate N
+    @param mode spôsob vzorkovania
+    @return true ak vzorkovanie prebieha v jadre
+ */
+bool PacketCapture::set_sampling(uint32_t rate, SampleMode mode) {
+    if (mode == SAMPLE_RANDOM && source_->fd() >= 0 && attach_kernel_sampler(source_->fd(), rate)) {
+        sampler_ = Sampler(1);
+        return true;
     }
+    // deterministické vzorkovanie potrebuje stav, ktorý klasický BPF nemá, beží preto v programe
+    uint64_t seed = static_cast<uint64_t>(chrono::steady_clock::now().time_since_epoch().count());
+    sampler_ = Sampler(rate, mode, seed);
+    return false;
+}
+
+/**
+    @brief Typ linkovej vrstvy zdroja (hodnota DLT_*)
+ */
+int PacketCapture::datalink() const {
+    return source_->datalink();
+}
+
+/**
+    @brief Maximálna dĺžka zachyteného paketu
+ */
+uint32_t PacketCapture::snaplen() const {
+    return source_->snaplen();
+}
+
+/**
+    @brief Počítadlá zdroja (prijaté a zahodené pakety)
+ */
+SourceStats PacketCapture::source_stats() const {
+    return source_->stats();
 }
 
 /**
     @brief Metóda na zastavenie zachytávania paketov
  */
 void PacketCapture::stop_capture() {
-    if (handle_ != nullptr) {
-        pcap_breakloop(handle_);
-    }}
+    source_->stop();
+}
 //====END OF packetcapture.cpp ======
\ No newline at end of file
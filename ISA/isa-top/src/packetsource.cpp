@@ -0,0 +1,344 @@
+/**
+    @file packetsource.cpp
+    @brief Implementácia syntetického zdroja paketov a spracovania jeho nastavení
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/packetsource.h"
+#include "include/parser.h"
+#include <stdexcept>
+#include <cstring>
+#include <netinet/in.h>
+
+/**
+    @brief Čas prvého syntetického paketu (14.11.2023, unix mikrosekundy)
+ */
+static const int64_t SYNTHETIC_START_USEC = 1700000000LL * 1000000;
+
+/**
+    @brief Dĺžky hlavičiek skladaných rámcov
+ */
+static const uint32_t ETH_LEN = 14;
+static const uint32_t IPV4_LEN = 20;
+static const uint32_t IPV6_LEN = 40;
+static const uint32_t TCP_LEN = 20;
+static const uint32_t UDP_LEN = 8;
+static const uint32_t ICMP_LEN = 8;
+
+/**
+    @brief Číslo bez znamienka pre parse_synthetic
+ */
+static bool parse_count(const string& text, uint64_t& out) {
+    if (text.empty() || text.size() > 19 || text.find_first_not_of("0123456789") != string::npos) {
+        return false;
+    }
+    out = stoull(text);
+    return true;
+}
+
+/**
+    @brief Nastavenia generátora z textu "<scenár>[,packets=<n>][,flows=<n>][,seed=<n>]"
+ */
+SyntheticConfig parse_synthetic(const string& text) {
+    SyntheticConfig config;
+    vector<string> parts;
+    size_t start = 0;
+    while (true) {
+        size_t comma = text.find(',', start);
+        parts.push_back(text.substr(start, comma == string::npos ? string::npos : comma - start));
+        if (comma == string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+
+    const string& name = parts[0];
+    if (name == "small") {
+        config.scenario = SCENARIO_SMALL;
+    }
+    else if (name == "elephants") {
+        config.scenario = SCENARIO_ELEPHANTS;
+    }
+    else if (name == "churn") {
+        config.scenario = SCENARIO_CHURN;
+    }
+    else if (name == "mixed") {
+        config.scenario = SCENARIO_MIXED;
+    }
+    else {
+        throw invalid_argument("Unknown synthetic scenario '" + name + "' (expected small, elephants, churn or mixed).");
+    }
+
+    for (size_t i = 1; i < parts.size(); i++) {
+        size_t eq = parts[i].find('=');
+        string key = parts[i].substr(0, eq);
+        uint64_t value = 0;
+        if (eq == string::npos || !parse_count(parts[i].substr(eq + 1), value)) {
+            throw invalid_argument("Invalid synthetic option '" + parts[i] + "'.");
+        }
+        if (key == "packets") {
+            config.packets = value;
+        }
+        else if (key == "flows" && value > 0 && value <= UINT32_MAX) {
+            config.flows = static_cast<uint32_t>(value);
+        }
+        else if (key == "seed") {
+            config.seed = value;
+        }
+        else {
+            throw invalid_argument("Invalid synthetic option '" + parts[i] + "'.");
+        }
+    }
+    return config;
+}
+
+/**
+    @brief Zápis 16-bitového čísla v sieťovom poradí bajtov
+ */
+static inline void put16(u_char* p, uint32_t value) {
+    p[0] = static_cast<u_char>(value >> 8);
+    p[1] = static_cast<u_char>(value);
+}
+
+/**
+    @brief Zápis 32-bitového čísla v sieťovom poradí bajtov
+ */
+static inline void put32(u_char* p, uint32_t value) {
+    put16(p, value >> 16);
+    put16(p + 2, value);
+}
+
+/**
+    @brief Konštruktor, počet tokov sa doplní podľa scenára
+ */
+SyntheticSource::SyntheticSource(const SyntheticConfig& config)
+    : config_(config), flows_(config.flows), state_(config.seed != 0 ? config.seed : 1), generated_(0), seq_(0),
+      ts_usec_(SYNTHETIC_START_USEC), stopping_(false), received_(0) {
+    if (flows_ == 0) {
+        switch (config_.scenario) {
+            case SCENARIO_SMALL: flows_ = 100000; break;
+            case SCENARIO_ELEPHANTS: flows_ = 8; break;
+            case SCENARIO_CHURN: flows_ = 1; break;    // každý paket je nový tok
+            case SCENARIO_MIXED: flows_ = 10000; break;
+        }
+    }
+    LocalAddress v4{};
+    v4.family = 4;
+    const uint8_t v4_addr[] = {192, 0, 2, 1};
+    memcpy(v4.addr, v4_addr, sizeof(v4_addr));
+    LocalAddress v6{};
+    v6.family = 6;
+    v6.addr[0] = 0x20;
+    v6.addr[1] = 0x01;
+    v6.addr[3] = 0x02;
+    v6.addr[15] = 1;
+    local_ = {v4, v6};
+
+    memset(buffer_, 0, sizeof(buffer_));
+    // MAC adresy sa nemenia (lokálne spravované)
+    const u_char macs[] = {0x02, 0, 0, 0, 0, 0x01, 0x02, 0, 0, 0, 0, 0x02};
+    memcpy(buffer_, macs, sizeof(macs));
+}
+
+/**
+    @brief Ďalšie pseudonáhodné číslo (xorshift64)
+ */
+uint64_t SyntheticSource::random() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+}
+
+/**
+    @brief Zápis rámca toku flow do bufferu
+ */
+uint32_t SyntheticSource::build(uint64_t flow, uint8_t proto, uint8_t family, uint32_t size, bool tx, uint8_t tcp_flags) {
+    // vzdialený koncový bod: adresa z 2^17 adries rozsahu, zvyšok identifikátora v porte
+    uint32_t remote_port = 1024 + static_cast<uint32_t>((flow >> 17) % 64512);
+    uint32_t local_port = proto == IPPROTO_UDP ? 53 : 443;
+    uint32_t l3_len = family == 4 ? IPV4_LEN : IPV6_LEN;
+    uint32_t l4_len = proto == IPPROTO_TCP ? TCP_LEN : proto == IPPROTO_UDP ? UDP_LEN : ICMP_LEN;
+    uint32_t caplen = ETH_LEN + l3_len + l4_len;
+    if (size < caplen) {
+        size = caplen;
+    }
+
+    u_char* ip = buffer_ + ETH_LEN;
+    u_char* local_addr;
+    u_char* remote_addr;
+    if (family == 4) {
+        put16(buffer_ + 12, 0x0800);
+        ip[0] = 0x45;
+        ip[1] = 0;
+        put16(ip + 2, size - ETH_LEN);
+        put16(ip + 4, static_cast<uint32_t>(generated_));
+        put16(ip + 6, 0x4000);     // DF, bez fragmentácie
+        ip[8] = 64;
+        ip[9] = proto;
+        put16(ip + 10, 0);
+        local_addr = tx ? ip + 12 : ip + 16;
+        remote_addr = tx ? ip + 16 : ip + 12;
+        memcpy(local_addr, local_[0].addr, 4);
+        remote_addr[0] = 198;
+        remote_addr[1] = static_cast<u_char>(18 | ((flow >> 16) & 1));
+        remote_addr[2] = static_cast<u_char>(flow >> 8);
+        remote_addr[3] = static_cast<u_char>(flow);
+    }
+    else {
+        put16(buffer_ + 12, 0x86DD);
+        put32(ip, 0x60000000);
+        put16(ip + 4, size - ETH_LEN - IPV6_LEN);
+        ip[6] = proto;
+        ip[7] = 64;
+        local_addr = tx ? ip + 8 : ip + 24;
+        remote_addr = tx ? ip + 24 : ip + 8;
+        memcpy(local_addr, local_[1].addr, 16);
+        memcpy(remote_addr, local_[1].addr, 8);
+        remote_addr[7] = 1;
+        for (int i = 0; i < 8; i++) {
+            remote_addr[8 + i] = static_cast<u_char>(flow >> (56 - 8 * i));
+        }
+    }
+
+    u_char* l4 = ip + l3_len;
+    if (proto == IPPROTO_TCP || proto == IPPROTO_UDP) {
+        put16(l4, tx ? local_port : remote_port);
+        put16(l4 + 2, tx ? remote_port : local_port);
+    }
+    if (proto == IPPROTO_TCP) {
+        // globálne rastúce sekvenčné číslo rastie aj v rámci každého toku, sledovanie TCP nehlási retransmisie
+        uint32_t payload = size - ETH_LEN - l3_len - TCP_LEN;
+        put32(l4 + 4, seq_);
+        put32(l4 + 8, 0);
+        l4[12] = 0x50;
+        l4[13] = tcp_flags;
+        put16(l4 + 14, 65535);
+        put32(l4 + 16, 0);
+        seq_ += payload + ((tcp_flags & 0x02) ? 1 : 0);
+    }
+    else if (proto == IPPROTO_UDP) {
+        put16(l4 + 4, size - ETH_LEN - l3_len);
+        put16(l4 + 6, 0);
+    }
+    else {
+        // echo request / ICMPv6 echo request
+        l4[0] = family == 4 ? 8 : 128;
+        l4[1] = 0;
+        put16(l4 + 2, 0);
+        put16(l4 + 4, static_cast<uint32_t>(flow));
+        put16(l4 + 6, static_cast<uint32_t>(generated_));
+    }
+    return caplen;
+}
+
+/**
+    @brief Zostavenie ďalšieho paketu podľa scenára
+ */
+const u_char* SyntheticSource::next(PacketHeader& header) {
+    uint64_t r = random();
+    bool tx = (r & 1) != 0;
+    uint64_t flow;
+    uint8_t family = 4;
+    uint8_t proto = IPPROTO_TCP;
+    uint8_t tcp_flags = 0x18;  // PSH, ACK
+    uint32_t size;
+
+    switch (config_.scenario) {
+        case SCENARIO_SMALL:
+            flow = (r >> 8) % flows_;
+            proto = flow % 4 == 0 ? IPPROTO_UDP : IPPROTO_TCP;
+            size = 64 + static_cast<uint32_t>((r >> 40) % 136);
+            break;
+        case SCENARIO_ELEPHANTS:
+            flow = (r >> 8) % flows_;
+            // prenos dát k lokálnej adrese, každý ôsmy paket je potvrdenie
+            tx = (r >> 40) % 8 == 0;
+            size = tx ? 66 : 1514;
+            tcp_flags = tx ? 0x10 : 0x18;
+            break;
+        case SCENARIO_CHURN:
+            // iný seed dá iné toky, do 2^32 paketov sa tok nezopakuje
+            flow = (config_.seed << 32) + generated_;
+            tx = false;
+            tcp_flags = 0x02;  // SYN
+            size = 60;
+            break;
+        default: {
+            // 1 % tokov prenáša 80 % paketov plnej veľkosti
+            uint32_t heavy = flows_ / 100 > 0 ? flows_ / 100 : 1;
+            if ((r >> 8) % 10 < 8 || flows_ <= heavy) {
+                flow = (r >> 16) % heavy;
+                size = 1514;
+            }
+            else {
+                flow = heavy + (r >> 16) % (flows_ - heavy);
+                size = 64 + static_cast<uint32_t>((r >> 40) % 200);
+            }
+            family = flow % 2 == 0 ? 4 : 6;
+            if (flow % 10 == 9 && family == 4) {
+                proto = IPPROTO_ICMP;
+            }
+            else if (flow % 10 == 9) {
+                proto = IPPROTO_ICMPV6;
+            }
+            else {
+                proto = flow % 3 == 0 ? IPPROTO_UDP : IPPROTO_TCP;
+            }
+            break;
+        }
+    }
+
+    header.caplen = build(flow, proto, family, size, tx, tcp_flags);
+    header.len = size > header.caplen ? size : header.caplen;
+    header.ts_usec = ts_usec_++;
+    generated_++;
+    return buffer_;
+}
+
+/**
+    @brief Odovzdávanie paketov maximálnou rýchlosťou do limitu alebo do stop()
+ */
+void SyntheticSource::run(PacketCallback callback, void* user) {
+    PacketHeader header;
+    while (!stopping_.load(memory_order_relaxed) && (config_.packets == 0 || generated_ < config_.packets)) {
+        const u_char* data = next(header);
+        callback(user, header, data);
+        received_.store(generated_, memory_order_relaxed);
+    }
+}
+
+/**
+    @brief Ukončenie run()
+ */
+void SyntheticSource::stop() {
+    stopping_.store(true);
+}
+
+/**
+    @brief Generátor skladá ethernetové rámce
+ */
+int SyntheticSource::datalink() const {
+    return LINK_EN10MB;
+}
+
+/**
+    @brief Zachytávajú sa iba hlavičky
+ */
+uint32_t SyntheticSource::snaplen() const {
+    return sizeof(buffer_);
+}
+
+/**
+    @brief Lokálne adresy 192.0.2.1 a 2001:2::1
+ */
+const vector<LocalAddress>& SyntheticSource::local_addresses() const {
+    return local_;
+}
+
+/**
+    @brief Počet vygenerovaných paketov, generátor nič nezahadzuje
+ */
+SourceStats SyntheticSource::stats() const {
+    return SourceStats{received_.load(memory_order_relaxed), 0};
+}
+//====END OF packetsource.cpp ======
@@ -0,0 +1,423 @@
+/**
+    @file parser.cpp
+    @brief Implementácia parsera hlavičiek zachytených paketov
+    Každá funkcia kontroluje dĺžku voči caplen a číta polia priamo zo zachyteného bufferu.
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/parser.h"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// EtherType hodnoty
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ETHERTYPE_IPV6 = 0x86DD;
+constexpr uint16_t ETHERTYPE_VLAN = 0x8100;   // 802.1Q
+constexpr uint16_t ETHERTYPE_QINQ = 0x88A8;   // 802.1ad
+constexpr uint16_t ETHERTYPE_QINQ_OLD = 0x9100;
+
+// maximálny počet VLAN tagov, ktoré parser preskočí
+constexpr int MAX_VLAN_TAGS = 4;
+// maximálny počet rozširujúcich hlavičiek IPv6, ktoré parser preskočí
+constexpr int MAX_IPV6_EXT_HEADERS = 8;
+
+// typ paketu v Linux cooked capture hlavičke
+constexpr uint16_t SLL_OUTGOING = 4;
+
+/**
+    @brief Načítanie 16-bitovej hodnoty v sieťovom poradí bajtov (bez požiadavky na zarovnanie)
+ */
+static inline uint16_t rd16(const u_char* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+/**
+    @brief Načítanie 32-bitovej hodnoty v sieťovom poradí bajtov
+ */
+static inline uint32_t rd32(const u_char* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+/**
+    @brief Načítanie 32-bitovej hodnoty v poradí bajtov hostiteľa (bez požiadavky na zarovnanie)
+ */
+static inline uint32_t rd32_host(const u_char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+    @brief Spracovanie transportnej hlavičky (porty, príznaky a sekvenčné čísla TCP)
+    @param p začiatok transportnej hlavičky
+    @param caplen zachytené bajty od začiatku transportnej hlavičky
+    @param out výsledok parsovania
+ */
+static void decode_l4(const u_char* p, uint32_t caplen, PacketInfo& out) {
+    out.l4 = p;
+    out.l4_caplen = caplen;
+    switch (out.key.proto) {
+        case IPPROTO_TCP:
+            if (caplen >= 4) {
+                out.key.src_port = rd16(p);
+                out.key.dst_port = rd16(p + 2);
+            }
+            if (caplen >= 14) {
+                out.tcp_flags = p[13];
+            }
+            if (caplen >= 20) {
+                out.tcp_seq = rd32(p + 4);
+                out.tcp_ack = rd32(p + 8);
+                uint32_t data_offset = (p[12] >> 4) * 4u;
+                out.tcp_payload = out.l4_len > data_offset ? out.l4_len - data_offset : 0;
+            }
+            break;
+        case IPPROTO_UDP:
+        case IPPROTO_UDPLITE:
+        case IPPROTO_SCTP:
+            if (caplen >= 4) {
+                out.key.src_port = rd16(p);
+                out.key.dst_port = rd16(p + 2);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+    @brief Dekódovanie IPv4 hlavičky
+ */
+static bool decode_ipv4(const u_char* p, uint32_t caplen, PacketInfo& out) {
+    if (caplen < 20 || (p[0] >> 4) != 4) {
+        return false;
+    }
+    uint32_t ihl = (p[0] & 0x0F) * 4;
+    if (ihl < 20 || ihl > caplen) {
+        return false;
+    }
+    out.l3 = p;
+    out.key.family = 4;
+    out.key.proto = p[9];
+    memcpy(out.key.src, p + 12, 4);
+    memcpy(out.key.dst, p + 16, 4);
+
+    uint32_t total_len = rd16(p + 2);
+    out.l4_len = total_len > ihl ? total_len - ihl : 0;
+
+    // fragmenty okrem prvého neobsahujú transportnú hlavičku
+    if ((rd16(p + 6) & 0x1FFF) != 0) {
+        return true;
+    }
+    decode_l4(p + ihl, caplen - ihl, out);
+    return true;
+}
+
+/**
+    @brief Dekódovanie IPv6 hlavičky vrátane preskočenia rozširujúcich hlavičiek
+ */
+static bool decode_ipv6(const u_char* p, uint32_t caplen, PacketInfo& out) {
+    if (caplen < 40 || (p[0] >> 4) != 6) {
+        return false;
+    }
+    out.l3 = p;
+    out.key.family = 6;
+    memcpy(out.key.src, p + 8, 16);
+    memcpy(out.key.dst, p + 24, 16);
+
+    uint32_t payload_len = rd16(p + 4);
+    uint8_t next = p[6];
+    uint32_t off = 40;
+
+    for (int i = 0; i < MAX_IPV6_EXT_HEADERS; i++) {
+        uint32_t ext_len;
+        if (next == IPPROTO_HOPOPTS || next == IPPROTO_ROUTING || next == IPPROTO_DSTOPTS) {
+            if (off + 2 > caplen) {
+                break;
+            }
+            ext_len = (p[off + 1] + 1) * 8;
+        } else if (next == IPPROTO_AH) {
+            if (off + 2 > caplen) {
+                break;
+            }
+            ext_len = (p[off + 1] + 2) * 4;
+        } else if (next == IPPROTO_FRAGMENT) {
+            if (off + 8 > caplen) {
+                break;
+            }
+            // nenulový offset fragmentu, transportná hlavička nie je v tomto pakete
+            if ((rd16(p + off + 2) & 0xFFF8) != 0) {
+                out.key.proto = p[off];
+                return true;
+            }
+            ext_len = 8;
+        } else {
+            break;
+        }
+        next = p[off];
+        off += ext_len;
+        if (off > caplen) {
+            out.key.proto = next;
+            return true;
+        }
+    }
+
+    out.key.proto = next;
+    out.l4_len = payload_len + 40 > off ? payload_len + 40 - off : 0;
+    decode_l4(p + off, caplen - off, out);
+    return true;
+}
+
+/**
+    @brief Dekódovanie podľa EtherType s preskočením VLAN tagov
+    @param type EtherType za hlavičkou linkovej vrstvy
+    @param p ukazovateľ za EtherType
+    @param caplen zostávajúce zachytené bajty
+    @param out výsledok parsovania
+ */
+static bool decode_ethertype(uint16_t type, const u_char* p, uint32_t caplen, PacketInfo& out) {
+    for (int i = 0; i < MAX_VLAN_TAGS; i++) {
+        if (type != ETHERTYPE_VLAN && type != ETHERTYPE_QINQ && type != ETHERTYPE_QINQ_OLD) {
+            break;
+        }
+        if (caplen < 4) {
+            return false;
+        }
+        if (out.vlan_depth == 0) {
+            out.vlan_id = rd16(p) & 0x0FFF;
+        }
+        out.vlan_depth++;
+        type = rd16(p + 2);
+        p += 4;
+        caplen -= 4;
+    }
+
+    if (type == ETHERTYPE_IPV4) {
+        return decode_ipv4(p, caplen, out);
+    }
+    if (type == ETHERTYPE_IPV6) {
+        return decode_ipv6(p, caplen, out);
+    }
+    return false;
+}
+
+/**
+    @brief Vynulovanie výsledku pred parsovaním
+ */
+static inline void reset(PacketInfo& out) {
+    memset(&out, 0, sizeof(out));
+    out.direction = DIR_UNKNOWN;
+}
+
+bool decode_ethernet(const u_char* data, uint32_t caplen, PacketInfo& out) {
+    reset(out);
+    if (caplen < 14) {
+        return false;
+    }
+    return decode_ethertype(rd16(data + 12), data + 14, caplen - 14, out);
+}
+
+bool decode_linux_sll(const u_char* data, uint32_t caplen, PacketInfo& out) {
+    reset(out);
+    if (caplen < 16) {
+        return false;
+    }
+    out.direction = rd16(data) == SLL_OUTGOING ? DIR_OUTGOING : DIR_INCOMING;
+    return decode_ethertype(rd16(data + 14), data + 16, caplen - 16, out);
+}
+
+bool decode_linux_sll2(const u_char* data, uint32_t caplen, PacketInfo& out) {
+    reset(out);
+    if (caplen < 20) {
+        return false;
+    }
+    out.direction = data[10] == SLL_OUTGOING ? DIR_OUTGOING : DIR_INCOMING;
+    return decode_ethertype(rd16(data), data + 20, caplen - 20, out);
+}
+
+/**
+    @brief Dekódovanie IP paketu podľa hodnoty rodiny adries z loopback hlavičky
+    Hodnota AF_INET6 sa medzi systémami líši (10 Linux, 24 NetBSD/OpenBSD, 28 FreeBSD, 30 macOS).
+ */
+static bool decode_af(uint32_t af, const u_char* p, uint32_t caplen, PacketInfo& out) {
+    if (af == 2) {
+        return decode_ipv4(p, caplen, out);
+    }
+    if (af == 10 || af == 24 || af == 28 || af == 30) {
+        return decode_ipv6(p, caplen, out);
+    }
+    return false;
+}
+
+bool decode_null(const u_char* data, uint32_t caplen, PacketInfo& out) {
+    reset(out);
+    if (caplen < 4) {
+        return false;
+    }
+    uint32_t af = rd32_host(data);
+    // súbor mohol vzniknúť na stroji s opačným poradím bajtov
+    if (af > 0xFFFF) {
+        af = __builtin_bswap32(af);
+    }
+    return decode_af(af, data + 4, caplen - 4, out);
+}
+
+bool decode_loop(const u_char* data, uint32_t caplen, PacketInfo& out) {
+    reset(out);
+    if (caplen < 4) {
+        return false;
+    }
+    return decode_af(ntohl(rd32_host(data)), data + 4, caplen - 4, out);
+}
+
+bool decode_raw(const u_char* data, uint32_t caplen, PacketInfo& out) {
+    reset(out);
+    if (caplen < 1) {
+        return false;
+    }
+    switch (data[0] >> 4) {
+        case 4:
+            return decode_ipv4(data, caplen, out);
+        case 6:
+            return decode_ipv6(data, caplen, out);
+        default:
+            return false;
+    }
+}
+
+DecodeFn select_decoder(int datalink) {
+    switch (datalink) {
+        case LINK_EN10MB:
+            return decode_ethernet;
+        case LINK_LINUX_SLL:
+            return decode_linux_sll;
+        case LINK_LINUX_SLL2:
+            return decode_linux_sll2;
+        case LINK_NULL:
+            return decode_null;
+        case LINK_LOOP:
+            return decode_loop;
+        case LINK_RAW:
+        case LINK_RAW_ALT:
+        case LINK_RAW_LINKTYPE:
+        case LINK_IPV4:
+        case LINK_IPV6:
+            return decode_raw;
+        default:
+            return nullptr;
+    }
+}
+
+bool has_ports(uint8_t proto) {
+    return proto == IPPROTO_TCP || proto == IPPROTO_UDP || proto == IPPROTO_UDPLITE || proto == IPPROTO_SCTP;
+}
+
+string proto_name(uint8_t proto) {
+    switch (proto) {
+        case IPPROTO_TCP:
+            return "tcp";
+        case IPPROTO_UDP:
+            return "udp";
+        case IPPROTO_ICMP:
+            return "icmp";
+        case IPPROTO_ICMPV6:
+            return "icmpv6";
+        case IPPROTO_SCTP:
+            return "sctp";
+        case IPPROTO_UDPLITE:
+            return "udplite";
+        default:
+            return "other";
+    }
+}
+
+uint8_t proto_number(const string& name) {
+    if (name == "tcp") {
+        return IPPROTO_TCP;
+    }
+    if (name == "udp") {
+        return IPPROTO_UDP;
+    }
+    if (name == "icmp") {
+        return IPPROTO_ICMP;
+    }
+    if (name == "icmpv6") {
+        return IPPROTO_ICMPV6;
+    }
+    if (name == "sctp") {
+        return IPPROTO_SCTP;
+    }
+    if (name == "udplite") {
+        return IPPROTO_UDPLITE;
+    }
+    return IPPROTO_RAW;
+}
+
+string format_address(uint8_t family, const uint8_t* addr) {
+    char buf[INET6_ADDRSTRLEN];
+    if (inet_ntop(family == 6 ? AF_INET6 : AF_INET, addr, buf, sizeof(buf)) == nullptr) {
+        return "?";
+    }
+    return buf;
+}
+
+string format_endpoint(uint8_t family, uint8_t proto, const uint8_t* addr, uint16_t port) {
+    string ip = format_address(family, addr);
+    if (family == 6) {
+        ip = "[" + ip + "]";
+    }
+    if (has_ports(proto)) {
+        return ip + ":" + to_string(port);
+    }
+    return ip + ":-";
+}
+bool parse_endpoint(const string& endpoint, uint8_t& family, uint8_t* addr, uint16_t& port) {
+    string ip = endpoint;
+    string port_str;
+
+    if (!ip.empty() && ip.front() == '[') {
+        // IPv6 s portom v tvare "[adresa]:port"
+        size_t close = ip.find(']');
+        if (close == string::npos) {
+            return false;
+        }
+        if (close + 1 < ip.size()) {
+            if (ip[close + 1] != ':') {
+                return false;
+            }
+            port_str = ip.substr(close + 2);
+        }
+        ip = ip.substr(1, close - 1);
+    }
+    else if (count(ip.begin(), ip.end(), ':') == 1) {
+        // IPv4 s portom
+        size_t colon = ip.find(':');
+        port_str = ip.substr(colon + 1);
+        ip = ip.substr(0, colon);
+    }
+
+    memset(addr, 0, 16);
+    if (inet_pton(AF_INET, ip.c_str(), addr) == 1) {
+        family = 4;
+    }
+    else if (inet_pton(AF_INET6, ip.c_str(), addr) == 1) {
+        family = 6;
+    }
+    else {
+        return false;
+    }
+
+    port = 0;
+    if (!port_str.empty() && port_str != "-") {
+        char* end;
+        unsigned long value = strtoul(port_str.c_str(), &end, 10);
+        if (*end != '\0' || value > 65535) {
+            return false;
+        }
+        port = static_cast<uint16_t>(value);
+    }
+    return true;
+}
+//====END OF parser.cpp ======
@@ -0,0 +1,203 @@
+/**
+    @file pcapsource.cpp
+    @brief Implementácia zdrojov paketov nad libpcap (živé rozhranie a súbor pcap)
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/pcapsource.h"
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <unistd.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+
+/**
+    @brief Funkcia na získanie IP adries zadaného rozhrania
+    @param interface názov rozhrania ("any" pre všetky rozhrania)
+    @return IPv4 a IPv6 adresy rozhrania v binárnom tvare
+    inspiration: https://dev.to/fmtweisszwerg/cc-how-to-get-all-interface-addresses-on-the-local-device-3pki
+    @author Fomalhaut Weisszwerg
+*/
+vector<LocalAddress> get_local_addresses(const string& interface) {
+    struct ifaddrs* ifaddr;
+    struct ifaddrs* ifa;
+    vector<LocalAddress> addresses;
+
+    if (getifaddrs(&ifaddr) == -1) {
+        perror("getifaddrs"); // chyba pri získavaní informácií o rozhraniach
+        return addresses;
+    }
+
+    bool any = interface == "any";
+
+    // iterovanie cez zoznam rozhraní
+    for (ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr == nullptr) {
+            continue; // preskočiť, ak rozhranie nemá priradenú IP adresu
+        }
+
+        // Porovnajte názov rozhrania
+        if (!any && interface != ifa->ifa_name) {
+            continue;
+        }
+
+        LocalAddress local{};
+        // IPv4 adresa
+        if (ifa->ifa_addr->sa_family == AF_INET) {
+            struct sockaddr_in* sa = (struct sockaddr_in*)ifa->ifa_addr;
+            local.family = 4;
+            memcpy(local.addr, &sa->sin_addr, 4);
+            addresses.push_back(local);
+        }
+        // IPv6 adresa
+        else if (ifa->ifa_addr->sa_family == AF_INET6) {
+            struct sockaddr_in6* sa = (struct sockaddr_in6*)ifa->ifa_addr;
+            local.family = 6;
+            memcpy(local.addr, &sa->sin6_addr, 16);
+            addresses.push_back(local);
+        }
+    }
+
+    // uvoľnenie pamäte alokovanej z getifaddrs
+    freeifaddrs(ifaddr);
+
+    if (addresses.empty()) {
+        throw invalid_argument("Interface " + interface + " not found or has no IP address.");
+    }
+
+    return addresses;
+}
+
+
+/**
+    @brief Konštruktor, handler otvára odvodená trieda
+ */
+PcapSource::PcapSource() : handle_(nullptr), callback_(nullptr), user_(nullptr), received_(0) {
+}
+
+/**
+    @brief Zatvorenie handlera (slučka už musí byť ukončená)
+ */
+PcapSource::~PcapSource() {
+    if (handle_ != nullptr) {
+        pcap_close(handle_);
+    }
+}
+
+/**
+    @brief Prevod hlavičky libpcap a volanie callbacku zdroja
+ */
+void PcapSource::pcap_handler_fn(u_char* user, const struct pcap_pkthdr* header, const u_char* packet) {
+    PcapSource* self = reinterpret_cast<PcapSource*>(user);
+    PacketHeader converted;
+    converted.ts_usec = static_cast<int64_t>(header->ts.tv_sec) * 1000000 + header->ts.tv_usec;
+    converted.caplen = header->caplen;
+    converted.len = header->len;
+    self->received_.store(self->received_.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    self->callback_(self->user_, converted, packet);
+}
+
+/**
+    @brief Slučka pcap_loop do pcap_breakloop alebo konca súboru
+ */
+void PcapSource::run(PacketCallback callback, void* user) {
+    callback_ = callback;
+    user_ = user;
+    pcap_loop(handle_, 0, PcapSource::pcap_handler_fn, reinterpret_cast<u_char*>(this));
+}
+
+/**
+    @brief Ukončenie slučky
+ */
+void PcapSource::stop() {
+    pcap_breakloop(handle_);
+}
+
+/**
+    @brief Typ linkovej vrstvy otvoreného zariadenia (hodnota pcap_datalink)
+ */
+int PcapSource::datalink() const {
+    return pcap_datalink(handle_);
+}
+
+/**
+    @brief Maximálna dĺžka zachyteného paketu
+ */
+uint32_t PcapSource::snaplen() const {
+    return static_cast<uint32_t>(pcap_snapshot(handle_));
+}
+
+/**
+    @brief Soket zachytávania (pri súbore deskriptor súboru, PcapFileSource ho preto neposkytuje)
+ */
+int PcapSource::fd() const {
+    return pcap_fileno(handle_);
+}
+
+/**
+    @brief Adresy sledovaného rozhrania
+ */
+const vector<LocalAddress>& PcapSource::local_addresses() const {
+    return local_addresses_;
+}
+
+/**
+    @brief Prijaté pakety a zahodené pakety podľa pcap_stats (pri súbore iba prijaté)
+ */
+SourceStats PcapSource::stats() const {
+    SourceStats result{received_.load(memory_order_relaxed), 0};
+    struct pcap_stat ps;
+    if (pcap_stats(handle_, &ps) == 0) {
+        result.dropped = static_cast<uint64_t>(ps.ps_drop) + ps.ps_ifdrop;
+    }
+    return result;
+}
+
+
+/**
+    @brief Otvorenie rozhrania, jeho adresy určujú smer paketov
+ */
+LivePcapSource::LivePcapSource(const string& interface) {
+    char errbuf[PCAP_ERRBUF_SIZE];
+    // adresy rozhrania sa zistia raz, nie pri každom pakete
+    local_addresses_ = get_local_addresses(interface);
+    handle_ = pcap_open_live(interface.c_str(), BUFSIZ, 1, 1000, errbuf); // otvorenie zariadenia pre zachytávanie paketov
+    if (handle_ == nullptr) {
+        throw runtime_error("Error opening device " + interface + ": " + errbuf);
+    }
+}
+
+/**
+    @brief Otvorenie súboru pcap
+ */
+PcapFileSource::PcapFileSource(const string& path, const vector<string>& local) {
+    for (const auto& text : local) {
+        LocalAddress address{};
+        if (inet_pton(AF_INET, text.c_str(), address.addr) == 1) {
+            address.family = 4;
+        }
+        else if (inet_pton(AF_INET6, text.c_str(), address.addr) == 1) {
+            address.family = 6;
+        }
+        else {
+            throw invalid_argument("Invalid local address '" + text + "'");
+        }
+        local_addresses_.push_back(address);
+    }
+    char errbuf[PCAP_ERRBUF_SIZE];
+    handle_ = pcap_open_offline(path.c_str(), errbuf);
+    if (handle_ == nullptr) {
+        throw runtime_error("Error opening capture file " + path + ": " + errbuf);
+    }
+}
+
+/**
+    @brief Súbor nemá soket na pripojenie filtra BPF
+ */
+int PcapFileSource::fd() const {
+    return -1;
+}
+//====END OF pcapsource.cpp ======
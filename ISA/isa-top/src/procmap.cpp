@@ -0,0 +1,347 @@
+/**
+    @file procmap.cpp
+    @brief Implementácia triedy ProcessMap, ktorá priraďuje sieťové sokety procesom podľa /proc
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/procmap.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+#include <netinet/in.h>
+
+bool SocketKey::operator==(const SocketKey& other) const {
+    return family == other.family && proto == other.proto && port == other.port && memcmp(addr, other.addr, 16) == 0;
+}
+
+size_t hash<SocketKey>::operator()(const SocketKey& k) const {
+    // FNV-1a cez všetky polia kľúča
+    size_t h = 14695981039346656037ULL;
+    auto mix = [&h](uint8_t byte) {
+        h ^= byte;
+        h *= 1099511628211ULL;
+    };
+    mix(k.family);
+    mix(k.proto);
+    mix(k.port >> 8);
+    mix(k.port & 0xFF);
+    for (int i = 0; i < 16; i++) {
+        mix(k.addr[i]);
+    }
+    return h;
+}
+
+/**
+    @brief Spracovanie jedného riadku z /proc/net/{tcp,udp,tcp6,udp6}
+    Adresa je zapísaná ako 32-bitové slová v hexadecimálnom tvare v poradí bajtov jadra.
+ */
+bool parse_proc_net_line(const string& line, uint8_t family, uint8_t proto, SocketKey& key, unsigned long& inode) {
+    istringstream iss(line);
+    vector<string> fields;
+    string field;
+    while (iss >> field && fields.size() < 10) {
+        fields.push_back(field);
+    }
+    // sl local_address rem_address st tx:rx tr:when retrnsmt uid timeout inode
+    if (fields.size() < 10 || fields[0].back() != ':') {
+        return false;
+    }
+
+    const string& local = fields[1];
+    size_t colon = local.find(':');
+    size_t words = family == 6 ? 4 : 1;
+    if (colon != words * 8) {
+        return false;
+    }
+
+    memset(&key, 0, sizeof(key));
+    key.family = family;
+    key.proto = proto;
+    for (size_t i = 0; i < words; i++) {
+        uint32_t word = static_cast<uint32_t>(strtoul(local.substr(i * 8, 8).c_str(), nullptr, 16));
+        memcpy(key.addr + i * 4, &word, 4);
+    }
+    key.port = static_cast<uint16_t>(strtoul(local.c_str() + colon + 1, nullptr, 16));
+    inode = strtoul(fields[9].c_str(), nullptr, 10);
+    return true;
+}
+
+/**
+    @brief Konštruktor triedy ProcessMap
+ */
+ProcessMap::ProcessMap(const string& proc_root, chrono::milliseconds interval)
+    : proc_root_(proc_root), interval_(interval), scanned_pids_(0), running_(false) {
+}
+
+/**
+    @brief Deštruktor triedy ProcessMap, zastaví vlákno na pozadí
+ */
+ProcessMap::~ProcessMap() {
+    stop();
+}
+
+/**
+    @brief Spustenie obnovovania na pozadí
+ */
+void ProcessMap::start() {
+    lock_guard<mutex> lock(run_mtx_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = thread(&ProcessMap::run_loop, this);
+}
+
+/**
+    @brief Zastavenie obnovovania na pozadí
+ */
+void ProcessMap::stop() {
+    {
+        lock_guard<mutex> lock(run_mtx_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+/**
+    @brief Slučka vlákna na pozadí
+ */
+void ProcessMap::run_loop() {
+    unique_lock<mutex> lock(run_mtx_);
+    while (running_) {
+        lock.unlock();
+        refresh();
+        lock.lock();
+        cv_.wait_for(lock, interval_, [this] { return !running_; });
+    }
+}
+
+/**
+    @brief Načítanie tabuliek soketov z /proc/net
+    @return mapa lokálny koncový bod -> inode
+ */
+unordered_map<SocketKey, unsigned long> ProcessMap::read_socket_tables() {
+    struct Table {
+        const char* name;
+        uint8_t family;
+        uint8_t proto;
+    };
+    static const Table tables[] = {
+        {"tcp", 4, IPPROTO_TCP}, {"udp", 4, IPPROTO_UDP},
+        {"tcp6", 6, IPPROTO_TCP}, {"udp6", 6, IPPROTO_UDP},
+    };
+
+    unordered_map<SocketKey, unsigned long> sockets;
+    for (const auto& table : tables) {
+        ifstream file(proc_root_ + "/net/" + table.name);
+        string line;
+        while (getline(file, line)) {
+            SocketKey key;
+            unsigned long inode;
+            // inode 0 majú sokety bez vlastníka (napr. TIME_WAIT)
+            if (parse_proc_net_line(line, table.family, table.proto, key, inode) && inode != 0) {
+                sockets[key] = inode;
+            }
+        }
+    }
+    return sockets;
+}
+
+/**
+    @brief Prehľadanie deskriptorov procesu a zápis jeho soketov do inode_owner_
+    @param pid identifikátor procesu
+    @param wanted hľadané sokety, nájdené sa z množiny odstránia (nullptr ak sa nič nehľadá)
+    @return false ak proces už neexistuje
+ */
+bool ProcessMap::scan_pid(int pid, unordered_set<unsigned long>* wanted) {
+    string base = proc_root_ + "/" + to_string(pid);
+    if (access(base.c_str(), F_OK) != 0) {
+        return false; // proces skončil
+    }
+
+    if (known_pids_[pid].empty()) {
+        ifstream comm(base + "/comm");
+        string name;
+        getline(comm, name);
+        known_pids_[pid] = name.empty() ? "?" : name;
+    }
+
+    DIR* dir = opendir((base + "/fd").c_str());
+    if (dir == nullptr) {
+        return true; // nemáme oprávnenie čítať deskriptory procesu
+    }
+    scanned_pids_++;
+
+    struct dirent* entry;
+    char target[64];
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        string link = base + "/fd/" + entry->d_name;
+        ssize_t len = readlink(link.c_str(), target, sizeof(target) - 1);
+        if (len <= 0) {
+            continue;
+        }
+        target[len] = '\0';
+        // cieľ odkazu soketu má tvar "socket:[inode]"
+        if (strncmp(target, "socket:[", 8) == 0) {
+            unsigned long inode = strtoul(target + 8, nullptr, 10);
+            inode_owner_[inode] = pid;
+            socket_owners_.insert(pid);
+            if (wanted != nullptr) {
+                wanted->erase(inode);
+            }
+        }
+    }
+    closedir(dir);
+    return true;
+}
+
+/**
+    @brief Jeden inkrementálny prechod obnovenia
+ */
+void ProcessMap::refresh() {
+    unordered_map<SocketKey, unsigned long> sockets = read_socket_tables();
+    unordered_set<unsigned long> inodes;
+    for (const auto& [key, inode] : sockets) {
+        // inode 0 majú sokety bez vlastníka (napr. TCP v stave TIME_WAIT)
+        if (inode != 0) {
+            inodes.insert(inode);
+        }
+    }
+
+    // zoznam bežiacich procesov
+    unordered_set<int> pids;
+    DIR* proc = opendir(proc_root_.c_str());
+    if (proc != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(proc)) != nullptr) {
+            char* end;
+            long pid = strtol(entry->d_name, &end, 10);
+            if (*end == '\0' && pid > 0) {
+                pids.insert(static_cast<int>(pid));
+            }
+        }
+        closedir(proc);
+    }
+
+    // odstránenie ukončených procesov
+    for (auto it = known_pids_.begin(); it != known_pids_.end();) {
+        it = pids.count(it->first) ? next(it) : known_pids_.erase(it);
+    }
+    for (auto it = socket_owners_.begin(); it != socket_owners_.end();) {
+        it = known_pids_.count(*it) ? next(it) : socket_owners_.erase(it);
+    }
+
+    // nové procesy sa prehľadajú vždy
+    unordered_set<int> fresh;
+    for (int pid : pids) {
+        if (known_pids_.count(pid) == 0) {
+            fresh.insert(pid);
+            if (!scan_pid(pid)) {
+                known_pids_.erase(pid);
+            }
+        }
+    }
+
+    // odstránenie zatvorených soketov a soketov ukončených procesov
+    for (auto it = inode_owner_.begin(); it != inode_owner_.end();) {
+        bool alive = inodes.count(it->first) && known_pids_.count(it->second);
+        it = alive ? next(it) : inode_owner_.erase(it);
+    }
+
+    // sokety bez vlastníka; hľadajú sa iba tie, ktoré neboli nevyriešené už v minulom prechode
+    unordered_set<unsigned long> unknown;
+    unordered_set<unsigned long> wanted;
+    for (unsigned long inode : inodes) {
+        if (inode_owner_.count(inode) == 0) {
+            unknown.insert(inode);
+            if (unresolved_.count(inode) == 0) {
+                wanted.insert(inode);
+            }
+        }
+    }
+
+    // známe procesy sa prehľadajú znova iba pri nových soketoch bez vlastníka: najprv procesy, ktoré už
+    // sokety mali (nové spojenia vznikajú väčšinou v nich), ostatné až keď niečo zostane nenájdené.
+    // Prechod končí, keď sa nájdu všetky hľadané sokety (množina wanted sa pri hľadaní zmenšuje).
+    if (!wanted.empty()) {
+        vector<int> owners, others;
+        for (const auto& [pid, comm] : known_pids_) {
+            if (fresh.count(pid) == 0) {
+                (socket_owners_.count(pid) ? owners : others).push_back(pid);
+            }
+        }
+        for (const vector<int>* group : {&owners, &others}) {
+            for (int pid : *group) {
+                if (wanted.empty()) {
+                    break;
+                }
+                scan_pid(pid, &wanted);
+            }
+        }
+    }
+
+    unresolved_.clear();
+    for (unsigned long inode : unknown) {
+        if (inode_owner_.count(inode) == 0) {
+            unresolved_.insert(inode);
+        }
+    }
+
+    // zostavenie mapy pre vyhľadávanie a jej zverejnenie
+    unordered_map<SocketKey, ProcessInfo> published;
+    for (const auto& [key, inode] : sockets) {
+        auto owner = inode_owner_.find(inode);
+        if (owner != inode_owner_.end()) {
+            published[key] = ProcessInfo{owner->second, known_pids_[owner->second]};
+        }
+    }
+    lock_guard<mutex> lock(mtx_);
+    sockets_.swap(published);
+}
+
+/**
+    @brief Vyhľadanie procesu podľa lokálneho koncového bodu (presná adresa, potom wildcard adresa)
+ */
+bool ProcessMap::lookup(uint8_t family, uint8_t proto, const uint8_t* addr, uint16_t port, ProcessInfo& out) {
+    SocketKey key;
+    memset(&key, 0, sizeof(key));
+    key.family = family;
+    key.proto = proto;
+    key.port = port;
+    memcpy(key.addr, addr, family == 6 ? 16 : 4);
+
+    lock_guard<mutex> lock(mtx_);
+    auto it = sockets_.find(key);
+    if (it == sockets_.end()) {
+        // soket počúvajúci na všetkých adresách (0.0.0.0 alebo ::)
+        memset(key.addr, 0, sizeof(key.addr));
+        it = sockets_.find(key);
+    }
+    if (it == sockets_.end() && family == 4) {
+        // IPv4 prevádzka na duálnom sokete "::"
+        key.family = 6;
+        it = sockets_.find(key);
+    }
+    if (it == sockets_.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
+/**
+    @brief Počet prehľadaných adresárov /proc/<pid>/fd od spustenia
+ */
+size_t ProcessMap::scanned_pids() {
+    return scanned_pids_;
+}
+//====END OF procmap.cpp ======
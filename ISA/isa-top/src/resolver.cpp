@@ -0,0 +1,182 @@
+/**
+    @file resolver.cpp
+    @brief Implementácia triedy Resolver, ktorá asynchrónne prekladá IP adresy na mená (reverse DNS)
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/resolver.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <cstring>
+
+/**
+    @brief Reverzný preklad adresy pomocou getnameinfo (rešpektuje /etc/hosts aj lokálny resolver)
+    @param ip IPv4 alebo IPv6 adresa v textovom tvare
+    @return meno hostiteľa alebo prázdny reťazec, ak preklad zlyhal
+ */
+string reverse_lookup(const string& ip) {
+    struct sockaddr_storage addr;
+    socklen_t len;
+    memset(&addr, 0, sizeof(addr));
+
+    struct sockaddr_in* sin = reinterpret_cast<struct sockaddr_in*>(&addr);
+    struct sockaddr_in6* sin6 = reinterpret_cast<struct sockaddr_in6*>(&addr);
+    if (inet_pton(AF_INET, ip.c_str(), &sin->sin_addr) == 1) {
+        sin->sin_family = AF_INET;
+        len = sizeof(*sin);
+    }
+    else if (inet_pton(AF_INET6, ip.c_str(), &sin6->sin6_addr) == 1) {
+        sin6->sin6_family = AF_INET6;
+        len = sizeof(*sin6);
+    }
+    else {
+        return "";
+    }
+
+    char host[NI_MAXHOST];
+    // NI_NAMEREQD: ak meno neexistuje, vráti chybu namiesto číselnej adresy
+    if (getnameinfo(reinterpret_cast<struct sockaddr*>(&addr), len, host, sizeof(host), nullptr, 0, NI_NAMEREQD) != 0) {
+        return "";
+    }
+    return host;
+}
+
+/**
+    @brief Konštruktor triedy Resolver, spustí pracovné vlákna
+ */
+Resolver::Resolver(size_t capacity, int workers, chrono::seconds positive_ttl, chrono::seconds negative_ttl, ResolveFn resolve)
+    : capacity_(capacity), positive_ttl_(positive_ttl), negative_ttl_(negative_ttl), resolve_(resolve),
+      stopping_(false), enabled_(false) {
+    for (int i = 0; i < workers; i++) {
+        workers_.emplace_back(&Resolver::worker_loop, this);
+    }
+}
+
+/**
+    @brief Deštruktor triedy Resolver, zastaví a počká na pracovné vlákna
+ */
+Resolver::~Resolver() {
+    {
+        lock_guard<mutex> lock(mtx_);
+        stopping_ = true;
+        queue_.clear();
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+/**
+    @brief Získanie mena pre adresu bez blokovania
+    @param ip adresa v textovom tvare
+    @return meno hostiteľa, alebo prázdny reťazec ak ešte nie je preložené, preklad zlyhal alebo je preklad vypnutý
+ */
+string Resolver::lookup(const string& ip) {
+    if (!enabled_) {
+        return "";
+    }
+
+    auto now = chrono::steady_clock::now();
+    lock_guard<mutex> lock(mtx_);
+
+    auto it = cache_.find(ip);
+    if (it != cache_.end()) {
+        Entry& entry = it->second;
+        // presun na začiatok LRU zoznamu
+        lru_.splice(lru_.begin(), lru_, entry.lru_it);
+        if (entry.pending || now < entry.expires) {
+            return entry.name;
+        }
+        // platnosť vypršala, adresa sa preloží znova (staré meno sa zobrazuje ďalej)
+        entry.pending = true;
+        queue_.push_back(ip);
+        cv_.notify_one();
+        return entry.name;
+    }
+
+    // fronta je plná, adresa sa skúsi pri ďalšom vykreslení
+    if (queue_.size() >= capacity_) {
+        return "";
+    }
+
+    lru_.push_front(ip);
+    cache_[ip] = Entry{"", now, true, lru_.begin()};
+    queue_.push_back(ip);
+    evict();
+    cv_.notify_one();
+    return "";
+}
+
+/**
+    @brief Slučka pracovného vlákna
+ */
+void Resolver::worker_loop() {
+    while (true) {
+        string ip;
+        {
+            unique_lock<mutex> lock(mtx_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            ip = queue_.front();
+            queue_.pop_front();
+        }
+
+        // samotný preklad prebieha bez zámku
+        string name = resolve_(ip);
+
+        lock_guard<mutex> lock(mtx_);
+        auto it = cache_.find(ip);
+        if (it == cache_.end()) {
+            // záznam bol medzičasom vyradený z cache
+            continue;
+        }
+        it->second.name = name;
+        it->second.pending = false;
+        it->second.expires = chrono::steady_clock::now() + (name.empty() ? negative_ttl_ : positive_ttl_);
+    }
+}
+
+/**
+    @brief Odstránenie najdlhšie nepoužitých záznamov nad kapacitu (volá sa pod zámkom)
+ */
+void Resolver::evict() {
+    while (cache_.size() > capacity_) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+/**
+    @brief Zapnutie alebo vypnutie prekladu
+ */
+void Resolver::set_enabled(bool enabled) {
+    enabled_ = enabled;
+}
+
+/**
+    @brief Prepnutie prekladu (zapnutý/vypnutý)
+ */
+void Resolver::toggle() {
+    enabled_ = !enabled_;
+}
+
+/**
+    @brief Stav prekladu
+    @return true ak je preklad zapnutý
+ */
+bool Resolver::enabled() const {
+    return enabled_;
+}
+
+/**
+    @brief Počet záznamov v cache (vrátane čakajúcich na preklad)
+ */
+size_t Resolver::size() {
+    lock_guard<mutex> lock(mtx_);
+    return cache_.size();
+}
+//====END OF resolver.cpp ======
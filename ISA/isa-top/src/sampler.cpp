@@ -0,0 +1,30 @@
+/**
+    @file sampler.cpp
+    @brief Náhodné vzorkovanie paketov filtrom BPF v jadre
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/sampler.h"
+#include <sys/socket.h>
+#include <linux/filter.h>
+
+/**
+    @brief Pripojenie filtra BPF, ktorý v jadre prepustí každý paket s pravdepodobnosťou 1/rate
+ */
+bool attach_kernel_sampler(int fd, uint32_t rate) {
+    if (fd < 0 || rate <= 1) {
+        return false;
+    }
+    // A = náhodné 32-bitové číslo; A %= rate; ak A == 0, prijať celý paket, inak zahodiť
+    struct sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_RANDOM)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, rate},
+        {BPF_JMP | BPF_JEQ | BPF_K, 0, 1, 0},
+        {BPF_RET | BPF_K, 0, 0, 0xFFFFFFFF},
+        {BPF_RET | BPF_K, 0, 0, 0},
+    };
+    struct sock_fprog program;
+    program.len = sizeof(code) / sizeof(code[0]);
+    program.filter = code;
+    return setsockopt(fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program)) == 0;
+}
+//====END OF sampler.cpp ======
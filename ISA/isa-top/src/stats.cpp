@@ -5,9 +5,83 @@
 */
 #include "include/stats.h"
 #include <mutex>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <arpa/inet.h>
 
 using namespace std;
 
+/**
+    @brief Overenie, či je koncový bod zadaný iba ako adresa bez portu
+ */
+static bool is_bare_address(const string& endpoint) {
+    uint8_t addr[16];
+    return inet_pton(AF_INET, endpoint.c_str(), addr) == 1 || inet_pton(AF_INET6, endpoint.c_str(), addr) == 1;
+}
+
+/**
+    @brief Prevod kľúča pripojenia (textové koncové body) na binárny kľúč toku
+    @return false ak koncový bod nie je platná adresa
+ */
+bool parse_connection_key(const ConnectionKey& key, FlowKey& flow) {
+    memset(&flow, 0, sizeof(flow));
+    uint8_t dst_family;
+    if (!parse_endpoint(key.src, flow.family, flow.src, flow.src_port) || !parse_endpoint(key.dst, dst_family, flow.dst, flow.dst_port)) {
+        return false;
+    }
+    flow.proto = proto_number(key.proto);
+    return true;
+}
+
+/**
+    @brief Štatistiky v tabuľke tokov v anonymnej pamäti
+    @param capacity počet slotov tabuľky tokov
+ */
+Stats::Stats(size_t capacity) : table_(new FlowTable(capacity)) {
+}
+
+/**
+    @brief Štatistiky v tabuľke tokov namapovanej zo súboru
+    @param table_path cesta k súboru tabuľky
+    @param capacity počet slotov pri vytváraní nového súboru
+ */
+Stats::Stats(const string& table_path, size_t capacity) : table_(new FlowTable(table_path, capacity)) {
+}
+
+/**
+    @brief Pripočítanie paketu do záznamu toku (volá sa pod zámkom)
+ */
+void Stats::account(FlowRecord& record, uint32_t bytes, uint32_t packets, bool is_tx, int64_t ts_usec) {
+    if (is_tx) {
+        // aktualizácia štatistík pre odoslaný paket
+        record.tx_bytes += bytes;
+        record.tx_packets += packets;
+    }
+    else {
+        // aktualizácia štatistík pre prijatý paket
+        record.rx_bytes += bytes;
+        record.rx_packets += packets;
+    }
+    // siete koncových bodov sa vyhľadajú raz pre nový tok (alebo po zmene zoznamu sietí)
+    if (networks_ && !(record.flags & FLOW_NETS)) {
+        record.src_net = networks_->lookup(record.key.family, record.key.src);
+        record.dst_net = networks_->lookup(record.key.family, record.key.dst);
+        record.flags |= FLOW_NETS;
+    }
+    if (record.first_seen == 0) {
+        record.first_seen = ts_usec;
+    }
+    else if (ts_usec >= record.last_seen) {
+        // medzipaketový čas v rámci jedného smeru toku
+        histogram_record(record.iat_hist, IAT_BUCKETS, static_cast<uint64_t>(ts_usec - record.last_seen));
+    }
+    // pri agregovanej aktualizácii (packets > 1) sa započíta priemerná veľkosť paketu
+    histogram_record(record.size_hist, SIZE_BUCKETS, packets > 1 ? bytes / packets : bytes);
+    record.last_seen = ts_usec;
+}
+
 /**
     @brief Metóda na aktualizáciu štatistík
     @param src zdrojová adresa
@@ -18,23 +92,277 @@ using namespace std;
     @param is_tx true ak je paket odoslaný, false ak je prijatý
  */
 void Stats::update(const string& src, const string& dst, const string& proto, int bytes, int packets, bool is_tx) {
+    // prevod koncových bodov na binárny kľúč toku
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    uint8_t dst_family;
+    if (!parse_endpoint(src, key.family, key.src, key.src_port) || !parse_endpoint(dst, dst_family, key.dst, key.dst_port)) {
+        return; // neplatná adresa
+    }
+    key.proto = proto_number(proto);
+    bool has_ports = !is_bare_address(src);
+
+    int64_t now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+
     // zámok na synchronizáciu pre bezpečný prístup k štatistikám
-    lock_guard<mutex> lock(mtx_); 
-    // vytvorenie jedinečného kľúča pre mapu štatistík
-    ConnectionKey key = {src, dst, proto};
-    // prístup k štatistikám pre daný kľúč
-    auto& conn = stats_map_[key];
+    lock_guard<mutex> lock(mtx_);
+    FlowRecord* record = table_->find_or_insert(key, now);
+    if (record == nullptr) {
+        return; // tabuľka je plná
+    }
+    if (!has_ports) {
+        record->flags |= FLOW_NO_PORTS;
+    }
+    account(*record, bytes, packets, is_tx, now);
+}
 
-    if (is_tx) {
-        // aktualizácia štatistík pre odoslaný paket
-        conn.tx_bytes += bytes;
-        conn.tx_packets += packets;
+/**
+    @brief Aktualizácia štatistík podľa binárneho kľúča toku (bez formátovania reťazcov)
+    @param key kľúč toku z parsera
+    @param bytes veľkosť paketu
+    @param is_tx true ak je paket odoslaný, false ak je prijatý
+    @param ts_usec čas zachytenia paketu (unix mikrosekundy)
+ */
+uint8_t Stats::update(const FlowKey& key, uint32_t bytes, bool is_tx, int64_t ts_usec) {
+    lock_guard<mutex> lock(mtx_);
+    FlowRecord* record = table_->find_or_insert(key, ts_usec);
+    if (record == nullptr) {
+        return 0;
+    }
+    bool created = record->first_seen == 0;
+    account(*record, bytes, 1, is_tx, ts_usec);
+    if ((record->flags & FLOW_WATCH) || (created && !watch_pending_.empty())) {
+        watch_packet(*record, created, bytes, 0, ts_usec);
+    }
+    return record->flags;
+}
+
+/**
+    @brief Aktualizácia štatistík podľa výsledku parsovania paketu (vrátane sledovania TCP)
+    @param info výsledok parsovania
+    @param bytes veľkosť paketu
+    @param is_tx true ak je paket odoslaný, false ak je prijatý
+    @param ts_usec čas zachytenia paketu (unix mikrosekundy)
+ */
+uint8_t Stats::update(const PacketInfo& info, uint32_t bytes, bool is_tx, int64_t ts_usec) {
+    lock_guard<mutex> lock(mtx_);
+    FlowRecord* record = table_->find_or_insert(info.key, ts_usec);
+    if (record == nullptr) {
+        return 0;
+    }
+    bool created = record->first_seen == 0;
+    account(*record, bytes, 1, is_tx, ts_usec);
+    // sekvenčné čísla sú iba v celej TCP hlavičke (nie vo fragmentoch)
+    if (info.key.proto == IPPROTO_TCP && info.l4 != nullptr && info.l4_caplen >= 20) {
+        tcp_track(record->tcp, info.tcp_flags, info.tcp_seq, info.tcp_payload, ts_usec);
+    }
+    // nesledované toky platia iba test príznaku (a nové toky test prázdneho zoznamu čakajúcich)
+    if ((record->flags & FLOW_WATCH) || (created && !watch_pending_.empty())) {
+        watch_packet(*record, created, bytes, info.tcp_flags, ts_usec);
+    }
+    return record->flags;
+}
+
+/**
+    @brief Pripojenie sledovania k novému záznamu a započítanie paketu sledovaného smeru
+    @param record záznam toku
+    @param created true ak bol záznam práve vložený
+    @param bytes veľkosť paketu
+    @param tcp_flags príznaky TCP (0 pre iné protokoly)
+    @param ts_usec čas paketu
+ */
+void Stats::watch_packet(FlowRecord& record, bool created, uint32_t bytes, uint8_t tcp_flags, int64_t ts_usec) {
+    if (created) {
+        auto pending = find_if(watch_pending_.begin(), watch_pending_.end(), [&](const FlowKey& key) {
+            return memcmp(&key, &record.key, sizeof(FlowKey)) == 0;
+        });
+        if (pending != watch_pending_.end()) {
+            watch_pending_.erase(pending);
+            watched_[record.key] = detail_init(record.key);
+            record.flags |= FLOW_WATCH;
+        }
+    }
+    if (!(record.flags & FLOW_WATCH)) {
         return;
     }
-    else{
-        // aktualizácia štatistík pre prijatý paket
-        conn.rx_bytes += bytes;
-        conn.rx_packets += packets;
+    auto it = watched_.find(record.key);
+    if (it == watched_.end()) {
+        record.flags &= ~FLOW_WATCH; // príznak z predchádzajúceho behu (tabuľka v súbore), podrobnosti sa nezachovali
+        return;
+    }
+    detail_record(it->second, bytes, tcp_flags, ts_usec);
+}
+
+/**
+    @brief Zapnutie podrobného sledovania toku
+    @param key kľúč pripojenia (na poradí koncových bodov nezáleží)
+    @return false ak kľúč nie je platný alebo je sledovaných už WATCH_MAX smerov
+ */
+bool Stats::watch(const ConnectionKey& key) {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow)) {
+        return false;
+    }
+    lock_guard<mutex> lock(mtx_);
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        FlowRecord* record = table_->find(k);
+        bool pending = any_of(watch_pending_.begin(), watch_pending_.end(), [&](const FlowKey& p) {
+            return memcmp(&p, &k, sizeof(FlowKey)) == 0;
+        });
+        if ((record != nullptr && (record->flags & FLOW_WATCH)) || pending) {
+            continue; // už sa sleduje
+        }
+        if (watched_.size() + watch_pending_.size() >= WATCH_MAX) {
+            return false;
+        }
+        if (record != nullptr) {
+            watched_[k] = detail_init(k);
+            record->flags |= FLOW_WATCH;
+        }
+        else {
+            watch_pending_.push_back(k);
+        }
+    }
+    return true;
+}
+
+/**
+    @brief Vypnutie sledovania toku
+    @param key kľúč pripojenia
+ */
+void Stats::unwatch(const ConnectionKey& key) {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow)) {
+        return;
+    }
+    lock_guard<mutex> lock(mtx_);
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        FlowRecord* record = table_->find(k);
+        if (record != nullptr) {
+            record->flags &= ~FLOW_WATCH;
+            watched_.erase(k);
+        }
+        watch_pending_.erase(remove_if(watch_pending_.begin(), watch_pending_.end(), [&](const FlowKey& p) {
+            return memcmp(&p, &k, sizeof(FlowKey)) == 0;
+        }), watch_pending_.end());
+    }
+}
+
+/**
+    @brief Podrobnosti sledovaného toku sčítané z oboch smerov
+    @param key kľúč pripojenia
+    @param out výsledné podrobnosti
+    @return true ak je tok sledovaný
+ */
+bool Stats::get_flow_detail(const ConnectionKey& key, FlowDetail& out) {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow)) {
+        return false;
+    }
+    out = detail_init(flow);
+
+    lock_guard<mutex> lock(mtx_);
+    bool watched = false;
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        watched = watched || any_of(watch_pending_.begin(), watch_pending_.end(), [&](const FlowKey& p) {
+            return memcmp(&p, &k, sizeof(FlowKey)) == 0;
+        });
+        const FlowRecord* record = table_->find(k);
+        if (record == nullptr) {
+            continue;
+        }
+        if (out.first_seen == 0 || (record->first_seen != 0 && record->first_seen < out.first_seen)) {
+            out.first_seen = record->first_seen;
+        }
+        out.last_seen = max(out.last_seen, record->last_seen);
+        auto it = watched_.find(k);
+        if ((record->flags & FLOW_WATCH) && it != watched_.end()) {
+            detail_merge(out, it->second);
+            watched = true;
+        }
+    }
+    detail_scale(out, table_->sample_rate());
+    return watched;
+}
+
+/**
+    @brief Označenie najväčších tokov príznakom FLOW_DUMP (oba smery), ostatným sa príznak zruší
+    @param count počet tokov, 0 zruší označenie všetkých
+    @param sort_option 'b' podľa bajtov, 'p' podľa paketov
+ */
+void Stats::mark_top_flows(size_t count, char sort_option) {
+    lock_guard<mutex> lock(mtx_);
+    vector<FlowRecord*> records;
+    for (size_t i = 0; i < table_->capacity(); i++) {
+        FlowRecord& record = table_->slot(i);
+        if (record.used) {
+            record.flags &= ~FLOW_DUMP;
+        }
+        if (selected(record)) {
+            records.push_back(&record);
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+
+    // smer s väčšou prevádzkou reprezentuje tok, opačný smer sa označí spolu s ním
+    bool by_bytes = sort_option != 'p';
+    auto metric = [by_bytes](const FlowRecord* r) {
+        return by_bytes ? r->rx_bytes + r->tx_bytes : r->rx_packets + r->tx_packets;
+    };
+    sort(records.begin(), records.end(), [&metric](const FlowRecord* a, const FlowRecord* b) {
+        return metric(a) > metric(b);
+    });
+
+    size_t marked = 0;
+    for (FlowRecord* record : records) {
+        if (marked == count) {
+            break;
+        }
+        if (record->flags & FLOW_DUMP) {
+            continue; // opačný smer už označeného toku
+        }
+        record->flags |= FLOW_DUMP;
+        // opačný smer, ktorý ešte neexistuje, sa označí pri ďalšom volaní
+        FlowRecord* reverse = table_->find(reverse_key(record->key));
+        if (reverse != nullptr) {
+            reverse->flags |= FLOW_DUMP;
+        }
+        marked++;
+    }
+}
+
+/**
+    @brief Pripočítanie rozptylu odhadov záznamu pri vzorkovaní 1 z N
+    Každý paket je vybraný s pravdepodobnosťou p = 1/N, odhad súčtu je N * (súčet vybraných).
+    Rozptyl odhadu je (N - 1) * súčet štvorcov všetkých hodnôt, súčet štvorcov sa odhadne ako
+    N * (počet vybraných paketov) * (priemerný štvorec veľkosti z histogramu veľkostí).
+ */
+static void add_sampling_variance(const FlowRecord& record, double scale, ConnectionStats& conn) {
+    double factor = scale * (scale - 1);
+    uint64_t packets = record.rx_packets + record.tx_packets;
+    double mean_square = histogram_mean_square(record.size_hist, SIZE_BUCKETS);
+    if (mean_square == 0 && packets > 0) {
+        double mean = static_cast<double>(record.rx_bytes + record.tx_bytes) / packets;
+        mean_square = mean * mean;
+    }
+    conn.rx_packets_var += factor * record.rx_packets;
+    conn.tx_packets_var += factor * record.tx_packets;
+    conn.rx_bytes_var += factor * record.rx_packets * mean_square;
+    conn.tx_bytes_var += factor * record.tx_packets * mean_square;
+}
+
+/**
+    @brief Pripočítanie počítadiel záznamu (vynásobených N pri vzorkovaní) do štatistík pripojenia
+ */
+static void add_record_stats(const FlowRecord& record, double scale, ConnectionStats& conn) {
+    conn.rx_bytes += record.rx_bytes * scale;
+    conn.tx_bytes += record.tx_bytes * scale;
+    conn.rx_packets += record.rx_packets * scale;
+    conn.tx_packets += record.tx_packets * scale;
+    if (scale > 1) {
+        add_sampling_variance(record, scale, conn);
     }
 }
 
@@ -45,6 +373,234 @@ void Stats::update(const string& src, const string& dst, const string& proto, in
 unordered_map<ConnectionKey, ConnectionStats> Stats::get_stats_snapshot() {
     // zámok na synchronizáciu pre bezpečný prístup k štatistikám
     lock_guard<mutex> lock(mtx_);
-    return stats_map_;
+    unordered_map<ConnectionKey, ConnectionStats> snapshot;
+    double scale = table_->sample_rate();
+    for (size_t i = 0; i < table_->capacity(); i++) {
+        const FlowRecord& record = table_->slot(i);
+        if (!selected(record)) {
+            continue;
+        }
+        const FlowKey& k = record.key;
+        ConnectionKey key;
+        if (record.flags & FLOW_NO_PORTS) {
+            key = {format_address(k.family, k.src), format_address(k.family, k.dst), proto_name(k.proto)};
+        }
+        else {
+            key = {format_endpoint(k.family, k.proto, k.src, k.src_port), format_endpoint(k.family, k.proto, k.dst, k.dst_port), proto_name(k.proto)};
+        }
+        // rôzne čísla protokolov s názvom "other" sa zlúčia
+        add_record_stats(record, scale, snapshot[key]);
+    }
+    return snapshot;
+}
+
+/**
+    @brief Snapshot štatistík agregovaných podľa dvojíc pomenovaných sietí (src = sieť zdroja, dst = sieť cieľa, proto prázdny)
+    @return snapshot štatistík, prázdny ak nie je nastavený zoznam sietí
+ */
+unordered_map<ConnectionKey, ConnectionStats> Stats::get_network_snapshot() {
+    lock_guard<mutex> lock(mtx_);
+    unordered_map<ConnectionKey, ConnectionStats> snapshot;
+    if (!networks_) {
+        return snapshot;
+    }
+    double scale = table_->sample_rate();
+    for (size_t i = 0; i < table_->capacity(); i++) {
+        const FlowRecord& record = table_->slot(i);
+        if (!selected(record) || !(record.flags & FLOW_NETS)) {
+            continue;
+        }
+        ConnectionKey key{networks_->name(record.src_net), networks_->name(record.dst_net), ""};
+        add_record_stats(record, scale, snapshot[key]);
+    }
+    return snapshot;
+}
+
+/**
+    @brief Pripočítanie histogramov jedného smeru toku
+ */
+void add_histograms(const FlowRecord& record, FlowHistograms& out) {
+    for (size_t i = 0; i < SIZE_BUCKETS; i++) {
+        out.size[i] += record.size_hist[i];
+    }
+    for (size_t i = 0; i < IAT_BUCKETS; i++) {
+        out.iat[i] += record.iat_hist[i];
+    }
+}
+
+/**
+    @brief Pripočítanie TCP stavu jedného smeru toku
+ */
+void add_tcp_summary(const FlowRecord& record, TcpSummary& out) {
+    // RTT meria iba smer, ktorý poslal SYN
+    if (record.tcp.rtt_usec != 0) {
+        out.rtt_usec = record.tcp.rtt_usec;
+    }
+    out.retransmissions += record.tcp.retransmissions;
+    out.out_of_order += record.tcp.out_of_order;
+}
+
+/**
+    @brief Histogramy toku sčítané z oboch smerov
+    @param key kľúč pripojenia (ako v snapshote, na poradí koncových bodov nezáleží)
+    @param out výsledné histogramy
+    @return true ak bol nájdený aspoň jeden smer toku
+ */
+bool Stats::get_histograms(const ConnectionKey& key, FlowHistograms& out) {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow)) {
+        return false;
+    }
+    memset(&out, 0, sizeof(out));
+
+    lock_guard<mutex> lock(mtx_);
+    bool found = false;
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        const FlowRecord* record = table_->find(k);
+        if (record == nullptr) {
+            continue;
+        }
+        add_histograms(*record, out);
+        found = true;
+    }
+    return found;
+}
+
+/**
+    @brief Súhrn TCP stavu toku z oboch smerov
+    @param key kľúč pripojenia (na poradí koncových bodov nezáleží)
+    @param out výsledný súhrn
+    @return true ak bol nájdený aspoň jeden smer toku
+ */
+bool Stats::get_tcp_stats(const ConnectionKey& key, TcpSummary& out) {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow) || flow.proto != IPPROTO_TCP) {
+        return false;
+    }
+    out = TcpSummary{0, 0, 0};
+
+    lock_guard<mutex> lock(mtx_);
+    bool found = false;
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        const FlowRecord* record = table_->find(k);
+        if (record == nullptr) {
+            continue;
+        }
+        add_tcp_summary(*record, out);
+        found = true;
+    }
+    return found;
+}
+
+/**
+    @brief Kópia obsadených záznamov tabuľky
+    @param out kópie záznamov
+ */
+void Stats::copy_records(vector<FlowRecord>& out) {
+    out.clear();
+    lock_guard<mutex> lock(mtx_);
+    for (size_t i = 0; i < table_->capacity(); i++) {
+        const FlowRecord& record = table_->slot(i);
+        if (record.used) {
+            out.push_back(record);
+        }
+    }
+}
+
+/**
+    @brief Kópia podrobností sledovaných smerov tokov
+    @param out kópie podrobností
+ */
+void Stats::copy_watched(vector<FlowDetail>& out) {
+    out.clear();
+    lock_guard<mutex> lock(mtx_);
+    for (const auto& [key, detail] : watched_) {
+        const FlowRecord* record = table_->find(key);
+        if (record != nullptr && (record->flags & FLOW_WATCH)) {
+            out.push_back(detail);
+        }
+    }
+    for (const FlowKey& key : watch_pending_) {
+        out.push_back(detail_init(key));
+    }
+}
+
+/**
+    @brief true ak je slot obsadený a vyhovuje filtru (volá sa pod zámkom)
+ */
+bool Stats::selected(const FlowRecord& record) const {
+    return record.used && (!filter_ || filter_->matches(record, table_->sample_rate()));
+}
+
+/**
+    @brief Nastavenie filtra tokov
+    @param filter preložený filter (nullptr zruší filtrovanie)
+ */
+void Stats::set_filter(shared_ptr<const FlowFilter> filter) {
+    lock_guard<mutex> lock(mtx_);
+    filter_ = filter;
+}
+
+/**
+    @brief Aktuálny filter tokov (nullptr ak sa nefiltruje)
+ */
+shared_ptr<const FlowFilter> Stats::filter() {
+    lock_guard<mutex> lock(mtx_);
+    return filter_;
+}
+
+/**
+    @brief Nastavenie zoznamu pomenovaných sietí, toky sa preklasifikujú pri najbližšom pakete
+    @param networks zoznam sietí (nullptr vypne klasifikáciu)
+ */
+void Stats::set_networks(shared_ptr<const NetworkMap> networks) {
+    lock_guard<mutex> lock(mtx_);
+    networks_ = networks;
+    // identifikátory sietí z predchádzajúceho zoznamu (aj z obnovenej tabuľky) nie sú platné
+    for (size_t i = 0; i < table_->capacity(); i++) {
+        FlowRecord& record = table_->slot(i);
+        if (record.used) {
+            record.flags &= ~FLOW_NETS;
+        }
+    }
+}
+
+/**
+    @brief Nastavenie vzorkovania 1 z N (uloží sa do hlavičky tabuľky tokov)
+ */
+void Stats::set_sample_rate(uint32_t rate) {
+    lock_guard<mutex> lock(mtx_);
+    table_->set_sample_rate(rate);
+}
+
+/**
+    @brief Vzorkovanie 1 z N (1 bez vzorkovania)
+ */
+uint32_t Stats::sample_rate() {
+    lock_guard<mutex> lock(mtx_);
+    return table_->sample_rate();
+}
+
+/**
+    @brief Počet tokov v tabuľke
+ */
+size_t Stats::flow_count() {
+    lock_guard<mutex> lock(mtx_);
+    return table_->size();
+}
+
+/**
+    @brief Počet nových tokov, ktoré sa do plnej tabuľky nezmestili ani po odstránení nečinných
+ */
+uint64_t Stats::dropped_flows() {
+    lock_guard<mutex> lock(mtx_);
+    return table_->dropped();
+}
+
+/**
+    @brief true ak boli štatistiky obnovené z existujúceho súboru tabuľky
+ */
+bool Stats::restored() {
+    return table_->reattached();
 }
 //====END OF stats.cpp ======
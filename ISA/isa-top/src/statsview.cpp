@@ -0,0 +1,264 @@
+/**
+    @file statsview.cpp
+    @brief Implementácia publikovaných pohľadov na štatistiky
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/statsview.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <netinet/in.h>
+
+/**
+    @brief Aktuálny čas (unix mikrosekundy)
+ */
+static int64_t now_usec() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+    @brief Zoradenie riadkov zostupne podľa bajtov alebo paketov (pri zhode podľa kľúča, aby bolo poradie stabilné)
+ */
+static void sort_rows(vector<ViewRow>& rows, bool by_bytes) {
+    sort(rows.begin(), rows.end(), [by_bytes](const ViewRow& a, const ViewRow& b) {
+        double va = by_bytes ? a.second.rx_bytes + a.second.tx_bytes : a.second.rx_packets + a.second.tx_packets;
+        double vb = by_bytes ? b.second.rx_bytes + b.second.tx_bytes : b.second.rx_packets + b.second.tx_packets;
+        if (va != vb) {
+            return va > vb;
+        }
+        if (a.first.src != b.first.src) {
+            return a.first.src < b.first.src;
+        }
+        if (a.first.dst != b.first.dst) {
+            return a.first.dst < b.first.dst;
+        }
+        return a.first.proto < b.first.proto;
+    });
+}
+
+/**
+    @brief Pripočítanie štatistík jedného smeru do zlúčeného riadku
+ */
+static void add_stats(ConnectionStats& into, const ConnectionStats& from) {
+    into.rx_bytes += from.rx_bytes;
+    into.tx_bytes += from.tx_bytes;
+    into.rx_packets += from.rx_packets;
+    into.tx_packets += from.tx_packets;
+    into.rx_bytes_var += from.rx_bytes_var;
+    into.tx_bytes_var += from.tx_bytes_var;
+    into.rx_packets_var += from.rx_packets_var;
+    into.tx_packets_var += from.tx_packets_var;
+}
+
+/**
+    @brief Toky zoradené podľa zvolenej možnosti
+ */
+const vector<ViewRow>& StatsView::flows(char sort_option) const {
+    return sort_option == 'p' ? by_packets : by_bytes;
+}
+
+/**
+    @brief Dvojice sietí zoradené podľa zvolenej možnosti
+ */
+const vector<ViewRow>& StatsView::networks(char sort_option) const {
+    return sort_option == 'p' ? networks_by_packets : networks_by_bytes;
+}
+
+/**
+    @brief Záznam smeru toku v pohľade
+ */
+const FlowRecord* StatsView::find(const FlowKey& key) const {
+    auto it = index.find(key);
+    return it == index.end() ? nullptr : &records[it->second];
+}
+
+/**
+    @brief Histogramy toku sčítané z oboch smerov
+ */
+bool StatsView::histograms(const ConnectionKey& key, FlowHistograms& out) const {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow)) {
+        return false;
+    }
+    memset(&out, 0, sizeof(out));
+    bool found = false;
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        const FlowRecord* record = find(k);
+        if (record != nullptr) {
+            add_histograms(*record, out);
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**
+    @brief Súhrn TCP stavu toku z oboch smerov
+ */
+bool StatsView::tcp_stats(const ConnectionKey& key, TcpSummary& out) const {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow) || flow.proto != IPPROTO_TCP) {
+        return false;
+    }
+    out = TcpSummary{0, 0, 0};
+    bool found = false;
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        const FlowRecord* record = find(k);
+        if (record != nullptr) {
+            add_tcp_summary(*record, out);
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**
+    @brief Podrobnosti sledovaného toku sčítané z oboch smerov
+ */
+bool StatsView::flow_detail(const ConnectionKey& key, FlowDetail& out) const {
+    FlowKey flow;
+    if (!parse_connection_key(key, flow)) {
+        return false;
+    }
+    out = detail_init(flow);
+    bool found = false;
+    for (const FlowKey& k : {flow, reverse_key(flow)}) {
+        const FlowRecord* record = find(k);
+        if (record != nullptr) {
+            if (out.first_seen == 0 || (record->first_seen != 0 && record->first_seen < out.first_seen)) {
+                out.first_seen = record->first_seen;
+            }
+            out.last_seen = max(out.last_seen, record->last_seen);
+        }
+        for (const FlowDetail& detail : watched) {
+            if (memcmp(&detail.key, &k, sizeof(FlowKey)) == 0) {
+                detail_merge(out, detail);
+                found = true;
+            }
+        }
+    }
+    detail_scale(out, sample_rate);
+    return found;
+}
+
+/**
+    @brief Zostavenie pohľadu zo snapshotov štatistík
+ */
+shared_ptr<const StatsView> build_view(Stats& stats, uint64_t sequence) {
+    auto view = make_shared<StatsView>();
+    view->sequence = sequence;
+    view->published_usec = now_usec();
+    view->sample_rate = stats.sample_rate();
+    view->flow_count = stats.flow_count();
+    view->dropped_flows = stats.dropped_flows();
+    view->filter = stats.filter();
+
+    // zlúčenie oboch smerov toku (nezávisle od smeru)
+    unordered_map<ConnectionKey, ConnectionStats> merged;
+    for (const auto& [key, conn] : stats.get_stats_snapshot()) {
+        ConnectionKey combined = key.src < key.dst ? key : ConnectionKey{key.dst, key.src, key.proto};
+        add_stats(merged[combined], conn);
+    }
+    view->by_bytes.assign(merged.begin(), merged.end());
+    sort_rows(view->by_bytes, true);
+    view->by_packets = view->by_bytes;
+    sort_rows(view->by_packets, false);
+
+    auto networks = stats.get_network_snapshot();
+    view->networks_by_bytes.assign(networks.begin(), networks.end());
+    sort_rows(view->networks_by_bytes, true);
+    view->networks_by_packets = view->networks_by_bytes;
+    sort_rows(view->networks_by_packets, false);
+
+    // záznamy pre export, archív a podrobnosti riadkov (zámok Stats sa drží iba počas kopírovania)
+    stats.copy_records(view->records);
+    view->index.reserve(view->records.size());
+    for (size_t i = 0; i < view->records.size(); i++) {
+        view->index.emplace(view->records[i].key, i);
+    }
+    stats.copy_watched(view->watched);
+    return view;
+}
+
+
+/**
+    @brief Konštruktor, pred prvým publikovaním je k dispozícii prázdny pohľad
+ */
+ViewPublisher::ViewPublisher(Stats& stats, chrono::milliseconds interval)
+    : stats_(stats), interval_(interval), view_(make_shared<const StatsView>()),
+      sequence_(0), running_(false) {
+}
+
+/**
+    @brief Deštruktor, zastaví vlákno agregátora
+ */
+ViewPublisher::~ViewPublisher() {
+    stop();
+}
+
+/**
+    @brief Publikovanie prvého pohľadu a spustenie vlákna agregátora
+ */
+void ViewPublisher::start() {
+    lock_guard<mutex> lock(run_mtx_);
+    if (running_) {
+        return;
+    }
+    publish();
+    running_ = true;
+    thread_ = thread(&ViewPublisher::run_loop, this);
+}
+
+/**
+    @brief Zastavenie vlákna agregátora
+ */
+void ViewPublisher::stop() {
+    {
+        lock_guard<mutex> lock(run_mtx_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+/**
+    @brief Zostavenie a publikovanie nového pohľadu
+ */
+uint64_t ViewPublisher::publish() {
+    // zapisovatelia sa striedajú, aby sa poradové čísla publikovaných pohľadov nevracali
+    lock_guard<mutex> lock(publish_mtx_);
+    shared_ptr<const StatsView> view = build_view(stats_, ++sequence_);
+    // výmena ukazovateľa; predchádzajúci pohľad sa uvoľní, keď ho pustí posledný čitateľ
+    atomic_store(&view_, view);
+    return sequence_;
+}
+
+/**
+    @brief Posledný publikovaný pohľad
+ */
+shared_ptr<const StatsView> ViewPublisher::latest() const {
+    return atomic_load(&view_);
+}
+
+/**
+    @brief Slučka vlákna agregátora
+ */
+void ViewPublisher::run_loop() {
+    unique_lock<mutex> lock(run_mtx_);
+    auto deadline = chrono::steady_clock::now() + interval_;
+    while (running_) {
+        if (cv_.wait_until(lock, deadline, [this] { return !running_; })) {
+            break;
+        }
+        deadline += interval_;
+        lock.unlock();
+        publish();
+        lock.lock();
+    }
+}
+//====END OF statsview.cpp ======
@@ -0,0 +1,78 @@
+/**
+    @file tcpstate.cpp
+    @brief Sledovanie handshaku a postupu sekvenčných čísel TCP v zázname toku
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/tcpstate.h"
+
+/**
+    @brief Porovnanie sekvenčných čísel s pretečením (RFC 793), true ak a < b
+ */
+static inline bool seq_before(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+/**
+    @brief Spracovanie TCP segmentu jedného smeru toku
+ */
+void tcp_track(TcpState& tcp, uint8_t flags, uint32_t seq, uint32_t payload, int64_t ts_usec) {
+    if (flags & TCPF_RST) {
+        return;
+    }
+
+    // handshake: SYN (bez ACK) spustí meranie, prvé ACK bez SYN z toho istého smeru ho ukončí
+    if ((flags & TCPF_SYN) && !(flags & TCPF_ACK)) {
+        // opakovaný SYN sa započíta ako retransmisia nižšie a meria sa od neho (Karnova nejednoznačnosť)
+        tcp.syn_time = ts_usec;
+        tcp.state |= TCP_SYN_SENT;
+    }
+    else if ((flags & TCPF_ACK) && !(flags & TCPF_SYN) && (tcp.state & TCP_SYN_SENT)) {
+        if (ts_usec >= tcp.syn_time) {
+            tcp.rtt_usec = static_cast<uint32_t>(ts_usec - tcp.syn_time);
+        }
+        tcp.state &= ~TCP_SYN_SENT;
+    }
+
+    // SYN a FIN zaberajú jedno sekvenčné číslo, čisté ACK sa do postupu nezapočítava
+    uint32_t len = payload + ((flags & TCPF_SYN) ? 1 : 0) + ((flags & TCPF_FIN) ? 1 : 0);
+    if (len == 0) {
+        return;
+    }
+    uint32_t end = seq + len;
+
+    if (!(tcp.state & TCP_SEQ_VALID)) {
+        tcp.next_seq = end;
+        tcp.state |= TCP_SEQ_VALID;
+        return;
+    }
+    if (!seq_before(seq, tcp.next_seq)) {
+        // segment za doteraz videnými dátami, preskočený úsek je nová medzera
+        if (seq != tcp.next_seq) {
+            tcp.hole_start = tcp.next_seq;
+            tcp.hole_end = seq;
+            tcp.state |= TCP_HOLE;
+        }
+        tcp.next_seq = end;
+        return;
+    }
+
+    // segment pred next_seq: vyplnenie medzery je mimo poradia, inak retransmisia
+    if ((tcp.state & TCP_HOLE) && !seq_before(seq, tcp.hole_start) && !seq_before(tcp.hole_end, end)) {
+        tcp.out_of_order++;
+        if (seq == tcp.hole_start) {
+            tcp.hole_start = end;
+        }
+        else if (end == tcp.hole_end) {
+            tcp.hole_end = seq;
+        }
+        if (!seq_before(tcp.hole_start, tcp.hole_end)) {
+            tcp.state &= ~TCP_HOLE;
+        }
+        return;
+    }
+    tcp.retransmissions++;
+    if (seq_before(tcp.next_seq, end)) {
+        tcp.next_seq = end; // retransmisia s novými dátami na konci
+    }
+}
+//====END OF tcpstate.cpp ======
@@ -1,7 +1,9 @@
 #include "include/utils.h"
+#include "include/flowtable.h"
 #include <cstring>
 #include <getopt.h>
 #include <ifaddrs.h>
+#include <arpa/inet.h>
 #include <algorithm>
 #include <sstream>
 
@@ -10,10 +12,45 @@
     @brief Vypíše nápovedu na použitie programu
  */
 void print_usage() {
-    cout << "Usage: isa-top -i <interface> [-s b|p] [-t <interval>]\n";
-    cout << "  -i <interface> : Specify the network interface to monitor.\n";
+    cout << "Usage: isa-top -i <interface> [-s b|p] [-t <interval>] [-r] [--table <file>] [--table-size <n>]\n";
+    cout << "               [--dump <prefix> [--dump-top <n>]]\n";
+    cout << "               [--export <host:port> [--export-proto ipfix|v9] [--active-timeout <s>] [--inactive-timeout <s>]]\n";
+    cout << "               [--sample <n> [--sample-mode random|count]] [--networks <file>]\n";
+    cout << "               [--filter <expr>] [--archive <file> [--archive-interval <s>] [--archive-top <n> | --archive-min-bytes <n>]]\n";
+    cout << "       isa-top --read <file.pcap> | --synthetic <scenario>[,packets=<n>][,flows=<n>][,seed=<n>] [--local <addr>]... [options]\n";
+    cout << "       isa-top --inspect <file> [-s b|p] [--filter <expr>]\n";
+    cout << "       isa-top --query <archive> [--from <time>] [--to <time>] [-s b|p] [--filter <expr>]\n";
+    cout << "  -i <interface> : Specify the network interface to monitor ('any' for all interfaces).\n";
+    cout << "  --read <file.pcap>: Replay a capture file at full speed instead of capturing from an interface.\n";
+    cout << "  --local <addr> : Local IPv4/IPv6 address of the replayed capture (repeatable), splits its traffic into Rx and Tx.\n";
+    cout << "                   Without it every replayed packet is counted as sent by its source address.\n";
+    cout << "  --synthetic <scenario>: Generate traffic instead of capturing (small, elephants, churn, mixed), for load tests.\n";
     cout << "  -s b|p         : Sort by bytes ('b') or packets ('p'). Default is 'b'.\n";
     cout << "  -t <interval>  : Set the interval in seconds for monitoring. Default is 1.\n";
+    cout << "  -r             : Resolve displayed addresses to host names (toggle at runtime with 'r').\n";
+    cout << "  --table <file> : Keep the flow table in a memory-mapped file and reattach to it on restart.\n";
+    cout << "  --table-size <n>: Flow table slots, rounded up to a power of 2 (at most 3/4 are used). Default is 65536.\n";
+    cout << "                   An existing --table file keeps its own size. A full table drops flows idle for over 120 s,\n";
+    cout << "                   new flows that still do not fit are counted as dropped.\n";
+    cout << "  --inspect <file>: Print top flows from a saved flow table and exit.\n";
+    cout << "  --dump <prefix>: Write packets of the top flows to rotating files <prefix>.N.pcap (toggle with 'd').\n";
+    cout << "  --dump-top <n> : Number of top flows whose packets are written. Default is 5.\n";
+    cout << "  --export <host:port>   : Export flows over UDP to an IPFIX / NetFlow v9 collector.\n";
+    cout << "  --export-proto ipfix|v9: Export format. Default is 'ipfix'.\n";
+    cout << "  --active-timeout <s>   : Export long-lived flows every <s> seconds. Default is 60.\n";
+    cout << "  --inactive-timeout <s> : Export a flow as ended after <s> idle seconds. Default is 15.\n";
+    cout << "  --sample <n>   : Process 1 in <n> packets and scale counters up (values shown as estimates).\n";
+    cout << "  --sample-mode random|count: Random sampling (in-kernel BPF when possible) or every n-th packet. Default is 'random'.\n";
+    cout << "  --networks <file>: Classify endpoints into named networks ('<prefix>/<len> <name>' per line, toggle view with 'n').\n";
+    cout << "  --filter <expr>: Show only flows matching <expr>, e.g. 'proto=tcp and port 443 and host 10.0.0.0/8'\n";
+    cout << "                   (host|net, src|dst, port <n>[-<m>], proto, ip, ip6, bytes|packets <op> <n>, and/or/not, ()).\n";
+    cout << "                   Change at runtime with '/'.\n";
+    cout << "  --archive <file>       : Append the top flows of every interval to a compressed archive (index in <file>.idx).\n";
+    cout << "  --archive-interval <s> : Archive interval in seconds. Default is 60.\n";
+    cout << "  --archive-top <n>      : Number of flows archived per interval. Default is 100.\n";
+    cout << "  --archive-min-bytes <n>: Archive all flows with at least <n> bytes per interval instead of the top flows.\n";
+    cout << "  --query <archive>      : Print top flows of an archive summed over a time range and exit.\n";
+    cout << "  --from/--to <time>     : Time range for --query: unix seconds, 'YYYY-MM-DD HH:MM[:SS]' or relative '-<n>s|m|h|d'.\n";
 }
 
 /**
@@ -53,7 +90,39 @@ Config parse_arguments(int argc, char* argv[]) {
     if (argc <= 1 || argv == nullptr || argv[0] == nullptr) {
     throw invalid_argument("Invalid arguments passed to parse_arguments.");
 }
-    while ((opt = getopt(argc, argv, "i:s:t:")) != -1) {
+    // dlhé prepínače nemajú krátku podobu, getopt_long pre ne vracia hodnoty mimo rozsahu znakov
+    enum { OPT_TABLE = 256, OPT_TABLE_SIZE, OPT_INSPECT, OPT_DUMP, OPT_DUMP_TOP, OPT_EXPORT, OPT_EXPORT_PROTO, OPT_ACTIVE_TIMEOUT, OPT_INACTIVE_TIMEOUT,
+           OPT_SAMPLE, OPT_SAMPLE_MODE, OPT_NETWORKS, OPT_FILTER,
+           OPT_ARCHIVE, OPT_ARCHIVE_INTERVAL, OPT_ARCHIVE_TOP, OPT_ARCHIVE_MIN_BYTES, OPT_QUERY, OPT_FROM, OPT_TO,
+           OPT_READ, OPT_LOCAL, OPT_SYNTHETIC };
+    static const struct option long_options[] = {
+        {"table", required_argument, nullptr, OPT_TABLE},
+        {"table-size", required_argument, nullptr, OPT_TABLE_SIZE},
+        {"inspect", required_argument, nullptr, OPT_INSPECT},
+        {"dump", required_argument, nullptr, OPT_DUMP},
+        {"dump-top", required_argument, nullptr, OPT_DUMP_TOP},
+        {"export", required_argument, nullptr, OPT_EXPORT},
+        {"export-proto", required_argument, nullptr, OPT_EXPORT_PROTO},
+        {"active-timeout", required_argument, nullptr, OPT_ACTIVE_TIMEOUT},
+        {"inactive-timeout", required_argument, nullptr, OPT_INACTIVE_TIMEOUT},
+        {"sample", required_argument, nullptr, OPT_SAMPLE},
+        {"sample-mode", required_argument, nullptr, OPT_SAMPLE_MODE},
+        {"networks", required_argument, nullptr, OPT_NETWORKS},
+        {"filter", required_argument, nullptr, OPT_FILTER},
+        {"archive", required_argument, nullptr, OPT_ARCHIVE},
+        {"archive-interval", required_argument, nullptr, OPT_ARCHIVE_INTERVAL},
+        {"archive-top", required_argument, nullptr, OPT_ARCHIVE_TOP},
+        {"archive-min-bytes", required_argument, nullptr, OPT_ARCHIVE_MIN_BYTES},
+        {"query", required_argument, nullptr, OPT_QUERY},
+        {"from", required_argument, nullptr, OPT_FROM},
+        {"to", required_argument, nullptr, OPT_TO},
+        {"read", required_argument, nullptr, OPT_READ},
+        {"local", required_argument, nullptr, OPT_LOCAL},
+        {"synthetic", required_argument, nullptr, OPT_SYNTHETIC},
+        {nullptr, 0, nullptr, 0}
+    };
+    optind = 0; // úplná reinicializácia getopt, funkcia sa dá volať opakovane
+    while ((opt = getopt_long(argc, argv, "i:s:t:r", long_options, nullptr)) != -1) {
         switch (opt) {
             case 'i':
                 config.interface = optarg;
@@ -73,10 +142,141 @@ Config parse_arguments(int argc, char* argv[]) {
                     throw invalid_argument("Invalid interval value.");
                 }
                 break;
+            case 'r':
+                config.resolve = true;
+                break;
+            case OPT_TABLE:
+                config.table_path = optarg;
+                break;
+            case OPT_TABLE_SIZE:
+                try {
+                    if (optarg[0] == '-') throw invalid_argument("Value must be positive.");
+                    config.table_size = stoull(optarg);
+                    if (config.table_size == 0 || config.table_size > FLOW_TABLE_MAX_CAPACITY) throw invalid_argument("Value out of range.");
+                } catch (const logic_error& e) {
+                    throw invalid_argument("Invalid --table-size value (1 to " + to_string(FLOW_TABLE_MAX_CAPACITY) + ").");
+                }
+                break;
+            case OPT_INSPECT:
+                config.inspect_path = optarg;
+                break;
+            case OPT_DUMP:
+                config.dump_prefix = optarg;
+                break;
+            case OPT_DUMP_TOP:
+                try {
+                    config.dump_top = stoi(optarg);
+                    if (config.dump_top <= 0) throw invalid_argument("Dump count must be positive.");
+                } catch (const invalid_argument& e) {
+                    throw invalid_argument("Invalid --dump-top value.");
+                }
+                break;
+            case OPT_EXPORT:
+                config.export_collector = optarg;
+                break;
+            case OPT_EXPORT_PROTO:
+                if (string(optarg) == "ipfix" || string(optarg) == "v9") {
+                    config.export_v9 = string(optarg) == "v9";
+                } else {
+                    throw invalid_argument("Invalid export protocol. Use 'ipfix' or 'v9'.");
+                }
+                break;
+            case OPT_ACTIVE_TIMEOUT:
+            case OPT_INACTIVE_TIMEOUT:
+                try {
+                    int timeout = stoi(optarg);
+                    if (timeout <= 0) throw invalid_argument("Timeout must be positive.");
+                    (opt == OPT_ACTIVE_TIMEOUT ? config.active_timeout : config.inactive_timeout) = timeout;
+                } catch (const invalid_argument& e) {
+                    throw invalid_argument("Invalid timeout value.");
+                }
+                break;
+            case OPT_SAMPLE:
+                try {
+                    config.sample_rate = stoi(optarg);
+                    if (config.sample_rate <= 0) throw invalid_argument("Sample rate must be positive.");
+                } catch (const invalid_argument& e) {
+                    throw invalid_argument("Invalid --sample value.");
+                }
+                break;
+            case OPT_SAMPLE_MODE:
+                if (string(optarg) == "random" || string(optarg) == "count") {
+                    config.sample_count = string(optarg) == "count";
+                } else {
+                    throw invalid_argument("Invalid sample mode. Use 'random' or 'count'.");
+                }
+                break;
+            case OPT_NETWORKS:
+                config.networks_path = optarg;
+                break;
+            case OPT_FILTER:
+                config.filter = optarg;
+                break;
+            case OPT_ARCHIVE:
+                config.archive_path = optarg;
+                break;
+            case OPT_ARCHIVE_INTERVAL:
+            case OPT_ARCHIVE_TOP:
+                try {
+                    int value = stoi(optarg);
+                    if (value <= 0) throw invalid_argument("Value must be positive.");
+                    (opt == OPT_ARCHIVE_INTERVAL ? config.archive_interval : config.archive_top) = value;
+                } catch (const invalid_argument& e) {
+                    throw invalid_argument(opt == OPT_ARCHIVE_INTERVAL ? "Invalid --archive-interval value." : "Invalid --archive-top value.");
+                }
+                break;
+            case OPT_ARCHIVE_MIN_BYTES:
+                try {
+                    if (optarg[0] == '-') throw invalid_argument("Value must be positive.");
+                    config.archive_min_bytes = stoull(optarg);
+                    if (config.archive_min_bytes == 0) throw invalid_argument("Value must be positive.");
+                } catch (const invalid_argument& e) {
+                    throw invalid_argument("Invalid --archive-min-bytes value.");
+                }
+                break;
+            case OPT_QUERY:
+                config.query_path = optarg;
+                break;
+            case OPT_FROM:
+                config.query_from = optarg;
+                break;
+            case OPT_TO:
+                config.query_to = optarg;
+                break;
+            case OPT_READ:
+                config.read_path = optarg;
+                break;
+            case OPT_LOCAL: {
+                uint8_t addr[16];
+                if (inet_pton(AF_INET, optarg, addr) != 1 && inet_pton(AF_INET6, optarg, addr) != 1) {
+                    throw invalid_argument("Invalid --local address '" + string(optarg) + "'.");
+                }
+                config.local_addresses.push_back(optarg);
+                break;
+            }
+            case OPT_SYNTHETIC:
+                config.synthetic = optarg;
+                break;
             default:
                 throw invalid_argument("Invalid argument.");
         }
     }
+    if (!config.inspect_path.empty() || !config.query_path.empty()) {
+        // výpis uloženej tabuľky alebo archívu nepotrebuje rozhranie
+        return config;
+    }
+    int sources = !config.interface.empty() + !config.read_path.empty() + !config.synthetic.empty();
+    if (sources > 1) {
+        throw invalid_argument("Options -i, --read and --synthetic are mutually exclusive.");
+    }
+    if (!config.local_addresses.empty() && config.read_path.empty()) {
+        // živé rozhranie aj generátor poznajú svoje adresy
+        throw invalid_argument("Option --local requires --read.");
+    }
+    if (!config.read_path.empty() || !config.synthetic.empty()) {
+        // pakety zo súboru alebo z generátora
+        return config;
+    }
     if (config.interface.empty()) {
         cerr << "Error: No interface specified.\n";
         cerr << "Available interfaces:\n";
@@ -90,7 +290,7 @@ Config parse_arguments(int argc, char* argv[]) {
         }
         throw invalid_argument("Interface is required.");
     }
-    else{
+    else if (config.interface != "any") {
         //overenie či vstupné rozhranie existuje v zozname dostupných rozhraní
         vector<string> interfaces = list_interfaces();
         if (find(interfaces.begin(), interfaces.end(), config.interface) == interfaces.end()) {
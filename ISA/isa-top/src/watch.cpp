@@ -0,0 +1,117 @@
+/**
+    @file watch.cpp
+    @brief Implementácia podrobných údajov sledovaných tokov
+    @author Peter Stahl (xstahl01)
+*/
+#include "include/watch.h"
+#include <cstring>
+
+/**
+    @brief Prázdne podrobnosti toku
+ */
+FlowDetail detail_init(const FlowKey& key) {
+    FlowDetail detail;
+    memset(&detail, 0, sizeof(detail));
+    detail.key = key;
+    return detail;
+}
+
+/**
+    @brief Započítanie paketu sledovaného smeru
+ */
+void detail_record(FlowDetail& detail, uint32_t bytes, uint8_t tcp_flags, int64_t ts_usec) {
+    detail.packets++;
+    detail.bytes += bytes;
+    detail.tcp_flags |= tcp_flags;
+    detail.syn += (tcp_flags & TCPF_SYN) != 0;
+    detail.fin += (tcp_flags & TCPF_FIN) != 0;
+    detail.rst += (tcp_flags & TCPF_RST) != 0;
+
+    // bucket sa pri prvom pakete novej sekundy vynuluje
+    int64_t second = ts_usec / 1000000;
+    WatchSecond& bucket = detail.history[static_cast<size_t>(second) % WATCH_HISTORY];
+    if (bucket.second != second) {
+        bucket = WatchSecond{second, 0, 0};
+    }
+    bucket.packets++;
+    bucket.bytes += bytes;
+}
+
+/**
+    @brief Pripočítanie druhého smeru toku
+ */
+void detail_merge(FlowDetail& into, const FlowDetail& from) {
+    into.packets += from.packets;
+    into.bytes += from.bytes;
+    into.tcp_flags |= from.tcp_flags;
+    into.syn += from.syn;
+    into.fin += from.fin;
+    into.rst += from.rst;
+    for (size_t i = 0; i < WATCH_HISTORY; i++) {
+        WatchSecond& bucket = into.history[i];
+        const WatchSecond& other = from.history[i];
+        if (other.second == bucket.second) {
+            bucket.packets += other.packets;
+            bucket.bytes += other.bytes;
+        }
+        else if (other.second > bucket.second) {
+            bucket = other;
+        }
+    }
+}
+
+/**
+    @brief Vynásobenie počítadiel pri vzorkovaní 1 z N
+ */
+void detail_scale(FlowDetail& detail, uint32_t rate) {
+    if (rate <= 1) {
+        return;
+    }
+    detail.packets *= rate;
+    detail.bytes *= rate;
+    for (WatchSecond& bucket : detail.history) {
+        bucket.packets *= rate;
+        bucket.bytes *= rate;
+    }
+}
+
+/**
+    @brief Pakety (alebo bajty) za jednotlivé sekundy končiace sekundou end_second
+ */
+vector<uint64_t> detail_rates(const FlowDetail& detail, int64_t end_second, size_t seconds, bool bytes) {
+    if (seconds > WATCH_HISTORY) {
+        seconds = WATCH_HISTORY;
+    }
+    vector<uint64_t> rates(seconds, 0);
+    for (size_t i = 0; i < seconds; i++) {
+        int64_t second = end_second - static_cast<int64_t>(seconds - 1 - i);
+        if (second < 0) {
+            continue;
+        }
+        // bucket inej sekundy patrí starším dátam, ktoré sa už prepísali
+        const WatchSecond& bucket = detail.history[static_cast<size_t>(second) % WATCH_HISTORY];
+        if (bucket.second == second) {
+            rates[i] = bytes ? bucket.bytes : bucket.packets;
+        }
+    }
+    return rates;
+}
+
+/**
+    @brief Textový zoznam príznakov TCP
+ */
+string tcp_flags_text(uint8_t flags) {
+    // poradie podľa bitov TcpHeaderFlags
+    static const char* names[] = {"FIN", "SYN", "RST", "PSH", "ACK", "URG", "ECE", "CWR"};
+    string text;
+    for (int bit = 0; bit < 8; bit++) {
+        if (flags & (1 << bit)) {
+            if (!text.empty()) {
+                text += ' ';
+            }
+            text += names[bit];
+        }
+    }
+    return text.empty() ? "-" : text;
+}
+//====END OF watch.cpp ======
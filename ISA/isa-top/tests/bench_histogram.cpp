@@ -0,0 +1,60 @@
+#include "../src/include/stats.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Benchmark histogramov: cena dvoch zápisov do histogramov na paket v porovnaní s celou aktualizáciou toku.
+
+static const int ITERATIONS = 20000000;
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    // pseudonáhodné veľkosti a medzipaketové časy, aby sa striedali buckety
+    std::vector<uint32_t> sizes(4096), gaps(4096);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        sizes[i] = 40 + (seed >> 8) % 1461;
+        seed = seed * 1103515245 + 12345;
+        gaps[i] = (seed >> 8) % 100000;
+    }
+
+    FlowRecord record;
+    memset(&record, 0, sizeof(record));
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        histogram_record(record.size_hist, SIZE_BUCKETS, sizes[i & 4095]);
+        histogram_record(record.iat_hist, IAT_BUCKETS, gaps[i & 4095]);
+    }
+    double hist_ns = elapsed_ns(start) / ITERATIONS;
+    uint64_t checksum = histogram_percentile(record.size_hist, SIZE_BUCKETS, 99)
+                        + histogram_percentile(record.iat_hist, IAT_BUCKETS, 99);
+    printf("histograms     %6.2f ns/packet  (checksum %llu)\n", hist_ns, static_cast<unsigned long long>(checksum));
+
+    // celá aktualizácia toku (zámok, vyhľadanie v tabuľke, počítadlá a histogramy) pre 1024 tokov
+    Stats stats(4096);
+    std::vector<FlowKey> keys(1024);
+    for (size_t i = 0; i < keys.size(); i++) {
+        memset(&keys[i], 0, sizeof(FlowKey));
+        keys[i].family = 4;
+        keys[i].proto = 6;
+        keys[i].src_port = static_cast<uint16_t>(1024 + i);
+        keys[i].dst_port = 443;
+        keys[i].src[0] = 10;
+        keys[i].dst[0] = 10;
+        keys[i].dst[3] = 1;
+    }
+    int64_t ts = 1700000000LL * 1000000;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        ts += gaps[i & 4095] / 1024;
+        stats.update(keys[i & 1023], sizes[i & 4095], i & 1, ts);
+    }
+    double update_ns = elapsed_ns(start) / ITERATIONS;
+    printf("Stats::update  %6.2f ns/packet  (histograms %.0f %%)\n", update_ns, hist_ns / update_ns * 100);
+    return 0;
+}
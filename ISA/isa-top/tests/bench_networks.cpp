@@ -0,0 +1,82 @@
+#include "../src/include/networks.h"
+#include "../src/include/stats.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Benchmark vyhľadania sietí: rýchlosť vyhľadania najdlhšieho prefixu v porovnaní s rýchlosťou aktualizácie toku.
+// Sieť sa vyhľadáva iba raz pre nový tok, takže stačí, aby vyhľadanie bolo rádovo rýchlejšie ako spracovanie paketu.
+
+static const int ITERATIONS = 20000000;
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    uint64_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(seed >> 33);
+    };
+
+    // 5000 IPv4 prefixov /8 až /32 a 1000 IPv6 prefixov /16 až /64
+    NetworkMap map;
+    for (int i = 0; i < 6000; i++) {
+        uint8_t addr[16];
+        for (uint8_t& b : addr) {
+            b = static_cast<uint8_t>(next());
+        }
+        bool v6 = i >= 5000;
+        unsigned length = v6 ? 16 + next() % 49 : 8 + next() % 25;
+        map.add(v6 ? 6 : 4, addr, length, "net" + std::to_string(i % 500));
+    }
+
+    std::vector<uint32_t> addrs(65536);
+    for (uint32_t& a : addrs) {
+        a = next();
+    }
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        checksum += map.lookup(4, reinterpret_cast<const uint8_t*>(&addrs[i & 65535]));
+    }
+    double v4_ns = elapsed_ns(start) / ITERATIONS;
+    printf("lookup IPv4    %6.2f ns  (%.1f M lookups/s, checksum %llu)\n", v4_ns, 1000 / v4_ns,
+           static_cast<unsigned long long>(checksum));
+
+    std::vector<uint8_t> addrs6(4096 * 16);
+    for (uint8_t& b : addrs6) {
+        b = static_cast<uint8_t>(next());
+    }
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        checksum += map.lookup(6, &addrs6[(i & 4095) * 16]);
+    }
+    double v6_ns = elapsed_ns(start) / ITERATIONS;
+    printf("lookup IPv6    %6.2f ns  (%.1f M lookups/s)\n", v6_ns, 1000 / v6_ns);
+
+    // aktualizácia toku s klasifikáciou (iba pri prvom pakete toku)
+    Stats stats(4096);
+    stats.set_networks(std::make_shared<NetworkMap>(map));
+    std::vector<FlowKey> keys(1024);
+    for (size_t i = 0; i < keys.size(); i++) {
+        memset(&keys[i], 0, sizeof(FlowKey));
+        keys[i].family = 4;
+        keys[i].proto = 6;
+        keys[i].src_port = static_cast<uint16_t>(1024 + i);
+        keys[i].dst_port = 443;
+        memcpy(keys[i].src, &addrs[i], 4);
+        memcpy(keys[i].dst, &addrs[i + 1024], 4);
+    }
+    int64_t ts = 1700000000LL * 1000000;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        stats.update(keys[i & 1023], 1000, i & 1, ts++);
+    }
+    double update_ns = elapsed_ns(start) / ITERATIONS;
+    printf("Stats::update  %6.2f ns/packet  (%.1f M packets/s, lookup is %.0fx faster)\n", update_ns, 1000 / update_ns,
+           update_ns / v4_ns);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "../src/include/parser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Jednoduchý benchmark parsera: priemerný čas dekódovania jedného paketu pre každý typ linkovej vrstvy.
+
+using Bytes = std::vector<u_char>;
+
+static Bytes ipv4_tcp() {
+    return {0x45, 0x00, 0x00, 0x28, 0x00, 0x01, 0x00, 0x00, 64, 6, 0x00, 0x00,
+            10, 0, 0, 1, 10, 0, 0, 2,
+            0x30, 0x39, 0x01, 0xBB, 0, 0, 0, 1, 0, 0, 0, 0, 0x50, 0x10, 0xFF, 0xFF, 0, 0, 0, 0};
+}
+
+static Bytes with_prefix(const Bytes& prefix, const Bytes& payload) {
+    Bytes out = prefix;
+    out.insert(out.end(), payload.begin(), payload.end());
+    return out;
+}
+
+static void run(const char* name, int datalink, const Bytes& pkt) {
+    const int iterations = 20000000;
+    DecodeFn decode = select_decoder(datalink);
+    PacketInfo info;
+    uint64_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        if (decode(pkt.data(), pkt.size(), info)) {
+            checksum += info.key.dst_port;
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-10s %6.2f ns/packet  %7.1f Mpps  (checksum %llu)\n", name, elapsed / iterations,
+           iterations / elapsed * 1000.0, static_cast<unsigned long long>(checksum));
+}
+
+int main() {
+    Bytes eth = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0x08, 0x00};
+    Bytes qinq = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 0x88, 0xA8, 0x00, 0x0A, 0x81, 0x00, 0x00, 0x14, 0x08, 0x00};
+    Bytes sll = {0x00, 0x00, 0x00, 0x01, 0x00, 0x06, 1, 2, 3, 4, 5, 6, 0, 0, 0x08, 0x00};
+    Bytes sll2 = {0x08, 0x00, 0, 0, 0, 0, 0, 2, 0x00, 0x01, 0x00, 0x06, 1, 2, 3, 4, 5, 6, 0, 0};
+    Bytes null_hdr = {0, 0, 0, 0};
+    uint32_t inet = 2;
+    memcpy(null_hdr.data(), &inet, 4);
+
+    run("EN10MB", LINK_EN10MB, with_prefix(eth, ipv4_tcp()));
+    run("QinQ", LINK_EN10MB, with_prefix(qinq, ipv4_tcp()));
+    run("SLL", LINK_LINUX_SLL, with_prefix(sll, ipv4_tcp()));
+    run("SLL2", LINK_LINUX_SLL2, with_prefix(sll2, ipv4_tcp()));
+    run("NULL", LINK_NULL, with_prefix(null_hdr, ipv4_tcp()));
+    run("RAW", LINK_RAW, ipv4_tcp());
+    return 0;
+}
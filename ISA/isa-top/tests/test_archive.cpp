@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+#include "../src/include/archive.h"
+#include "../src/include/filter.h"
+#include <cstring>
+#include <sstream>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+
+// Dočasný súbor archívu (aj s indexom), zmaže sa po teste
+class ArchiveTest : public ::testing::Test {
+protected:
+    string path;
+
+    void SetUp() override {
+        char tmpl[] = "/tmp/isa-top-archiveXXXXXX";
+        int fd = mkstemp(tmpl);
+        close(fd);
+        path = tmpl;
+        unlink(path.c_str()); // archív si súbor vytvorí sám
+    }
+
+    void TearDown() override {
+        unlink(path.c_str());
+        unlink((path + ".idx").c_str());
+    }
+
+    off_t file_size(const string& file) {
+        struct stat st;
+        return stat(file.c_str(), &st) == 0 ? st.st_size : -1;
+    }
+};
+
+static ArchiveRow make_row(uint8_t family, uint32_t n, uint64_t bytes) {
+    ArchiveRow row;
+    memset(&row, 0, sizeof(row));
+    row.key.family = family;
+    row.key.proto = n % 3 == 0 ? IPPROTO_ICMP : IPPROTO_TCP;
+    row.flags = row.key.proto == IPPROTO_ICMP ? FLOW_NO_PORTS : 0;
+    row.key.src_port = row.flags ? 0 : static_cast<uint16_t>(40000 + n);
+    row.key.dst_port = row.flags ? 0 : 443;
+    if (family == 4) {
+        row.key.src[0] = 10;
+        row.key.src[2] = static_cast<uint8_t>(n >> 8);
+        row.key.src[3] = static_cast<uint8_t>(n);
+        row.key.dst[0] = 192;
+        row.key.dst[3] = static_cast<uint8_t>(n % 7);
+    }
+    else {
+        row.key.src[0] = 0x20;
+        row.key.src[1] = 0x01;
+        row.key.src[15] = static_cast<uint8_t>(n);
+        row.key.dst[0] = 0xfe;
+        row.key.dst[15] = 1;
+    }
+    row.tx_bytes = bytes;
+    row.rx_bytes = bytes / 3;
+    row.tx_packets = bytes / 1000 + 1;
+    row.rx_packets = bytes / 3000;
+    return row;
+}
+
+static bool same_row(const ArchiveRow& a, const ArchiveRow& b) {
+    return memcmp(&a.key, &b.key, sizeof(FlowKey)) == 0 && a.flags == b.flags && a.rx_bytes == b.rx_bytes
+           && a.tx_bytes == b.tx_bytes && a.rx_packets == b.rx_packets && a.tx_packets == b.tx_packets;
+}
+
+TEST_F(ArchiveTest, RoundTripAndCompression) {
+    ArchiveBlock block{1000000, 61000000, {}};
+    for (uint32_t i = 0; i < 200; i++) {
+        block.rows.push_back(make_row(i % 10 == 0 ? 6 : 4, i, 5000000 / (i + 1)));
+    }
+    std::vector<ArchiveRow> expected = block.rows;
+    {
+        ArchiveWriter writer(path);
+        ASSERT_TRUE(writer.append(block));
+        ArchiveBlock empty{61000000, 121000000, {}};
+        ASSERT_TRUE(writer.append(empty));
+        EXPECT_EQ(writer.blocks(), 2u);
+        // nekomprimovaný riadok má 38 bajtov kľúča a 4 x 8 bajtov počítadiel
+        EXPECT_LT(writer.size(), 200u * 70 / 3);
+    }
+
+    ArchiveReader reader(path);
+    EXPECT_EQ(reader.blocks(), 2u);
+    std::vector<ArchiveBlock> blocks;
+    EXPECT_EQ(reader.scan(0, INT64_MAX, [&](const ArchiveBlock& b) { blocks.push_back(b); }), 2u);
+    ASSERT_EQ(blocks.size(), 2u);
+    EXPECT_EQ(blocks[0].start_usec, 1000000);
+    EXPECT_EQ(blocks[0].end_usec, 61000000);
+    EXPECT_TRUE(blocks[1].rows.empty());
+    ASSERT_EQ(blocks[0].rows.size(), expected.size());
+    for (const ArchiveRow& row : expected) {
+        bool found = false;
+        for (const ArchiveRow& read : blocks[0].rows) {
+            found = found || same_row(row, read);
+        }
+        EXPECT_TRUE(found);
+    }
+}
+
+TEST_F(ArchiveTest, ScanSeeksViaIndex) {
+    const int64_t minute = 60000000;
+    {
+        ArchiveWriter writer(path);
+        for (int i = 0; i < 2000; i++) {
+            ArchiveBlock block{i * minute, (i + 1) * minute, {make_row(4, static_cast<uint32_t>(i), 1000)}};
+            ASSERT_TRUE(writer.append(block));
+        }
+    }
+    ArchiveReader reader(path);
+    std::vector<int64_t> starts;
+    // rozsah začína v polovici bloku 1500, predchádzajúci blok sa prečíta, ale nevráti
+    size_t read = reader.scan(1500 * minute + minute / 2, 1510 * minute, [&](const ArchiveBlock& b) { starts.push_back(b.start_usec); });
+    EXPECT_LE(read, 11u);
+    ASSERT_EQ(starts.size(), 10u);
+    EXPECT_EQ(starts.front(), 1500 * minute);
+    EXPECT_EQ(starts.back(), 1509 * minute);
+    EXPECT_EQ(reader.scan(5000 * minute, 6000 * minute, [](const ArchiveBlock&) {}), 1u);
+}
+
+TEST_F(ArchiveTest, RecoversTornWrite) {
+    {
+        ArchiveWriter writer(path);
+        for (int i = 0; i < 5; i++) {
+            ArchiveBlock block{i * 1000000LL, (i + 1) * 1000000LL, {make_row(4, static_cast<uint32_t>(i), 1000)}};
+            ASSERT_TRUE(writer.append(block));
+        }
+    }
+    // pád počas zápisu posledného bloku a pred zápisom indexu
+    ASSERT_EQ(truncate(path.c_str(), file_size(path) - 3), 0);
+    ASSERT_EQ(truncate((path + ".idx").c_str(), 2 * sizeof(ArchiveIndexEntry)), 0);
+    {
+        ArchiveReader reader(path);
+        EXPECT_EQ(reader.blocks(), 4u);
+    }
+    {
+        ArchiveWriter writer(path);
+        EXPECT_EQ(writer.blocks(), 4u);
+        EXPECT_EQ(file_size(path + ".idx"), static_cast<off_t>(4 * sizeof(ArchiveIndexEntry)));
+        ArchiveBlock block{10000000, 11000000, {make_row(4, 9, 1000)}};
+        ASSERT_TRUE(writer.append(block));
+    }
+    ArchiveReader reader(path);
+    EXPECT_EQ(reader.blocks(), 5u);
+    EXPECT_EQ(reader.scan(0, INT64_MAX, [](const ArchiveBlock&) {}), 5u);
+}
+
+TEST_F(ArchiveTest, ArchiverWritesIntervalDeltas) {
+    Stats stats(64);
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 100, 1, true);
+    ViewPublisher views(stats, std::chrono::seconds(60));
+    views.publish();
+    ArchiveConfig config;
+    config.path = path;
+    config.top = 2;
+    FlowArchiver archiver(views, config);
+
+    // tok pred spustením archivácie sa počíta iba prírastkami
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 500, 1, true);
+    stats.update("10.0.0.1:1001", "10.0.0.2:80", "tcp", 300, 1, true);
+    stats.update("10.0.0.1:1002", "10.0.0.2:80", "tcp", 200, 1, true);
+    views.publish();
+    EXPECT_EQ(archiver.archive_once(2000000), 2u);
+    // v druhom intervale iba jeden tok
+    stats.update("10.0.0.1:1002", "10.0.0.2:80", "tcp", 50, 1, true);
+    views.publish();
+    EXPECT_EQ(archiver.archive_once(3000000), 1u);
+    EXPECT_EQ(archiver.archive_once(4000000), 0u);
+    EXPECT_EQ(archiver.blocks(), 3u);
+
+    ArchiveReader reader(path);
+    std::vector<ArchiveBlock> blocks;
+    reader.scan(0, INT64_MAX, [&](const ArchiveBlock& b) { blocks.push_back(b); });
+    ASSERT_EQ(blocks.size(), 3u);
+    ASSERT_EQ(blocks[0].rows.size(), 2u);
+    EXPECT_EQ(blocks[0].rows[0].key.src_port, 1000);
+    EXPECT_EQ(blocks[0].rows[0].tx_bytes, 500u);
+    EXPECT_EQ(blocks[0].rows[1].key.src_port, 1001);
+    ASSERT_EQ(blocks[1].rows.size(), 1u);
+    EXPECT_EQ(blocks[1].rows[0].tx_bytes, 50u);
+    EXPECT_EQ(blocks[1].start_usec, 2000000);
+    EXPECT_TRUE(blocks[2].rows.empty());
+}
+
+TEST_F(ArchiveTest, ArchiverThreshold) {
+    Stats stats(64);
+    ViewPublisher views(stats, std::chrono::seconds(60));
+    ArchiveConfig config;
+    config.path = path;
+    config.min_bytes = 250;
+    FlowArchiver archiver(views, config);
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 500, 1, true);
+    stats.update("10.0.0.1:1001", "10.0.0.2:80", "tcp", 300, 1, true);
+    stats.update("10.0.0.1:1002", "10.0.0.2:80", "tcp", 200, 1, true);
+    views.publish();
+    EXPECT_EQ(archiver.archive_once(2000000), 2u);
+}
+
+TEST_F(ArchiveTest, QuerySumsIntervals) {
+    // prvý interval začína pri vytvorení archivátora
+    const int64_t base = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    {
+        Stats stats(64);
+        ViewPublisher views(stats, std::chrono::seconds(60));
+        ArchiveConfig config;
+        config.path = path;
+        FlowArchiver archiver(views, config);
+        for (int i = 1; i <= 10; i++) {
+            stats.update("10.0.0.1:1000", "10.0.0.2:443", "tcp", 1000, 1, true);
+            stats.update("10.0.0.1:1001", "10.0.0.2:53", "udp", 100, 1, true);
+            views.publish();
+            archiver.archive_once(base + i * 60000000LL);
+        }
+    }
+    std::ostringstream out;
+    // intervaly 3 až 5 (koniec 180 s až 300 s)
+    query_archive(path, base + 120000000, base + 300000000, 'b', 10, out);
+    std::string text = out.str();
+    EXPECT_NE(text.find("10.0.0.1:1000"), std::string::npos) << text;
+    EXPECT_NE(text.find("3000"), std::string::npos) << text;
+    EXPECT_NE(text.find("10.0.0.1:1001"), std::string::npos) << text;
+
+    std::ostringstream filtered;
+    FlowFilter filter("udp");
+    query_archive(path, 0, INT64_MAX, 'b', 10, filtered, &filter);
+    text = filtered.str();
+    EXPECT_EQ(text.find("10.0.0.1:1000"), std::string::npos) << text;
+    EXPECT_NE(text.find("10.0.0.1:1001"), std::string::npos) << text;
+    EXPECT_NE(text.find("1000 "), std::string::npos) << text;
+}
+
+TEST(ArchiveTimeTest, ParseTime) {
+    const int64_t now = 1700000000LL * 1000000;
+    EXPECT_EQ(parse_archive_time("1699999000", now), 1699999000LL * 1000000);
+    EXPECT_EQ(parse_archive_time("-90s", now), now - 90000000);
+    EXPECT_EQ(parse_archive_time("-8h", now), now - 8 * 3600LL * 1000000);
+    EXPECT_EQ(parse_archive_time("-2d", now), now - 2 * 86400LL * 1000000);
+    int64_t t = parse_archive_time("2024-03-10 03:00", now);
+    EXPECT_EQ(parse_archive_time("2024-03-10T03:00:00", now), t);
+    EXPECT_EQ(parse_archive_time("2024-03-10 03:00:30", now), t + 30000000);
+    EXPECT_EQ(parse_archive_time("2024-03-11", now) - parse_archive_time("2024-03-10", now) > 0, true);
+    EXPECT_THROW(parse_archive_time("yesterday", now), std::invalid_argument);
+    EXPECT_THROW(parse_archive_time("-5w", now), std::invalid_argument);
+    EXPECT_THROW(parse_archive_time("2024-03-10 03:00 x", now), std::invalid_argument);
+}
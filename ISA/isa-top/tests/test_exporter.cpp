@@ -0,0 +1,416 @@
+#include <gtest/gtest.h>
+#include "../src/include/exporter.h"
+#include <cstring>
+#include <map>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static const int64_t NOW = 1700000000LL * 1000000;
+static const int64_t SEC = 1000000;
+
+/**
+    Dekódovaný dátový záznam
+ */
+struct DecodedFlow {
+    uint16_t template_id = 0;
+    string src, dst;
+    uint16_t src_port = 0, dst_port = 0;
+    uint8_t proto = 0;
+    uint64_t bytes = 0, packets = 0;
+    uint64_t start = 0, end = 0;
+    uint8_t reason = 0;
+    uint64_t size_p50 = 0, size_p99 = 0, iat_p50 = 0, iat_p99 = 0;
+};
+
+/**
+    Náhrada kolektora: prijíma datagramy na lokálnom porte a dekóduje IPFIX aj NetFlow v9 podľa prijatých šablón
+ */
+class TestCollector {
+public:
+    TestCollector() {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+    }
+    ~TestCollector() {
+        close(fd);
+    }
+
+    string address() const {
+        return "127.0.0.1:" + to_string(port);
+    }
+
+    // prijatie všetkých čakajúcich datagramov
+    size_t receive(vector<DecodedFlow>& flows) {
+        size_t datagrams = 0;
+        struct pollfd pfd = {fd, POLLIN, 0};
+        while (poll(&pfd, 1, 200) > 0) {
+            uint8_t buf[65536];
+            ssize_t len = recv(fd, buf, sizeof(buf), 0);
+            if (len <= 0) {
+                break;
+            }
+            sizes.push_back(static_cast<size_t>(len));
+            EXPECT_TRUE(decode(buf, static_cast<size_t>(len), flows));
+            datagrams++;
+        }
+        return datagrams;
+    }
+
+    int fd;
+    uint16_t port;
+    map<uint16_t, vector<pair<uint16_t, uint16_t>>> templates;
+    vector<uint32_t> sequences;
+    vector<uint16_t> v9_counts;
+    vector<size_t> sizes;
+
+private:
+    static uint64_t rd(const uint8_t* p, size_t len) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < len; i++) {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+
+    bool decode(const uint8_t* p, size_t len, vector<DecodedFlow>& flows) {
+        uint16_t version = static_cast<uint16_t>(rd(p, 2));
+        size_t offset;
+        uint16_t template_set;
+        if (version == 10) {
+            if (rd(p + 2, 2) != len) {
+                return false;
+            }
+            sequences.push_back(static_cast<uint32_t>(rd(p + 8, 4)));
+            offset = 16;
+            template_set = 2;
+        }
+        else if (version == 9) {
+            v9_counts.push_back(static_cast<uint16_t>(rd(p + 2, 2)));
+            sequences.push_back(static_cast<uint32_t>(rd(p + 12, 4)));
+            offset = 20;
+            template_set = 0;
+        }
+        else {
+            return false;
+        }
+
+        while (offset + 4 <= len) {
+            uint16_t set_id = static_cast<uint16_t>(rd(p + offset, 2));
+            uint16_t set_len = static_cast<uint16_t>(rd(p + offset + 2, 2));
+            if (set_len < 4 || offset + set_len > len || (version == 9 && set_len % 4 != 0)) {
+                return false;
+            }
+            const uint8_t* s = p + offset + 4;
+            const uint8_t* end = p + offset + set_len;
+            if (set_id == template_set) {
+                while (s + 4 <= end) {
+                    uint16_t id = static_cast<uint16_t>(rd(s, 2));
+                    uint16_t count = static_cast<uint16_t>(rd(s + 2, 2));
+                    s += 4;
+                    auto& fields = templates[id];
+                    fields.clear();
+                    for (uint16_t i = 0; i < count; i++, s += 4) {
+                        // podnikové prvky majú nastavený najvyšší bit a za dĺžkou číslo podniku
+                        uint16_t field = static_cast<uint16_t>(rd(s, 2));
+                        fields.emplace_back(field, static_cast<uint16_t>(rd(s + 2, 2)));
+                        if (field & 0x8000) {
+                            EXPECT_EQ(rd(s + 4, 4), EXPORT_ENTERPRISE);
+                            s += 4;
+                        }
+                    }
+                }
+            }
+            else if (set_id >= 256) {
+                auto it = templates.find(set_id);
+                if (it == templates.end()) {
+                    return false; // dáta bez šablóny
+                }
+                size_t record_len = 0;
+                for (auto& f : it->second) {
+                    record_len += f.second;
+                }
+                while (static_cast<size_t>(end - s) >= record_len) {
+                    DecodedFlow flow;
+                    flow.template_id = set_id;
+                    for (auto& [id, flen] : it->second) {
+                        char text[INET6_ADDRSTRLEN];
+                        switch (id) {
+                            case 8: inet_ntop(AF_INET, s, text, sizeof(text)); flow.src = text; break;
+                            case 12: inet_ntop(AF_INET, s, text, sizeof(text)); flow.dst = text; break;
+                            case 27: inet_ntop(AF_INET6, s, text, sizeof(text)); flow.src = text; break;
+                            case 28: inet_ntop(AF_INET6, s, text, sizeof(text)); flow.dst = text; break;
+                            case 7: flow.src_port = static_cast<uint16_t>(rd(s, flen)); break;
+                            case 11: flow.dst_port = static_cast<uint16_t>(rd(s, flen)); break;
+                            case 4: flow.proto = static_cast<uint8_t>(rd(s, flen)); break;
+                            case 1: flow.bytes = rd(s, flen); break;
+                            case 2: flow.packets = rd(s, flen); break;
+                            case 152: case 22: flow.start = rd(s, flen); break;
+                            case 153: case 21: flow.end = rd(s, flen); break;
+                            case 136: flow.reason = static_cast<uint8_t>(rd(s, flen)); break;
+                            case 0x8000 | FIELD_SIZE_P50: flow.size_p50 = rd(s, flen); break;
+                            case 0x8000 | FIELD_SIZE_P99: flow.size_p99 = rd(s, flen); break;
+                            case 0x8000 | FIELD_IAT_P50: flow.iat_p50 = rd(s, flen); break;
+                            case 0x8000 | FIELD_IAT_P99: flow.iat_p99 = rd(s, flen); break;
+                        }
+                        s += flen;
+                    }
+                    flows.push_back(flow);
+                }
+            }
+            offset += set_len;
+        }
+        return offset == len;
+    }
+};
+
+static FlowKey v4_key(uint8_t host, uint16_t src_port) {
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    key.family = 4;
+    key.proto = IPPROTO_TCP;
+    key.src_port = src_port;
+    key.dst_port = 80;
+    inet_pton(AF_INET, "10.0.0.1", key.src);
+    inet_pton(AF_INET, "10.0.0.2", key.dst);
+    key.src[3] = host;
+    return key;
+}
+
+static FlowKey v6_key() {
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    key.family = 6;
+    key.proto = IPPROTO_UDP;
+    key.src_port = 53;
+    key.dst_port = 40000;
+    inet_pton(AF_INET6, "2001:db8::1", key.src);
+    inet_pton(AF_INET6, "2001:db8::2", key.dst);
+    return key;
+}
+
+TEST(ExporterTest, SplitHostPort) {
+    string host, port;
+    EXPECT_TRUE(split_host_port("127.0.0.1:4739", host, port));
+    EXPECT_EQ(host, "127.0.0.1");
+    EXPECT_EQ(port, "4739");
+    EXPECT_TRUE(split_host_port("[::1]:2055", host, port));
+    EXPECT_EQ(host, "::1");
+    EXPECT_TRUE(split_host_port("collector.example:2055", host, port));
+    EXPECT_FALSE(split_host_port("::1:2055", host, port));
+    EXPECT_FALSE(split_host_port("127.0.0.1", host, port));
+    EXPECT_FALSE(split_host_port("127.0.0.1:ipfix", host, port));
+}
+
+TEST(ExporterTest, IpfixRecordsRoundTrip) {
+    TestCollector collector;
+    Stats stats(64);
+    stats.update(v4_key(1, 1000), 1500, true, NOW - 30 * SEC);
+    stats.update(v4_key(1, 1000), 500, true, NOW - 20 * SEC);
+    stats.update(v6_key(), 100, false, NOW - 25 * SEC);
+
+    ViewPublisher views(stats, chrono::seconds(60));
+    views.publish();
+    ExportConfig config;
+    config.collector = collector.address();
+    FlowExporter exporter(views, config);
+    exporter.export_once(NOW);
+
+    vector<DecodedFlow> flows;
+    EXPECT_EQ(collector.receive(flows), 1u);
+    ASSERT_EQ(flows.size(), 2u);
+    EXPECT_EQ(exporter.exported_records(), 2u);
+
+    const DecodedFlow& v4 = flows[0].template_id == TEMPLATE_IPV4 ? flows[0] : flows[1];
+    const DecodedFlow& v6 = flows[0].template_id == TEMPLATE_IPV6 ? flows[0] : flows[1];
+    EXPECT_EQ(v4.src, "10.0.0.1");
+    EXPECT_EQ(v4.dst, "10.0.0.2");
+    EXPECT_EQ(v4.src_port, 1000);
+    EXPECT_EQ(v4.dst_port, 80);
+    EXPECT_EQ(v4.proto, IPPROTO_TCP);
+    EXPECT_EQ(v4.bytes, 2000u);
+    EXPECT_EQ(v4.packets, 2u);
+    EXPECT_EQ(v4.start, static_cast<uint64_t>((NOW - 30 * SEC) / 1000));
+    EXPECT_EQ(v4.end, static_cast<uint64_t>((NOW - 20 * SEC) / 1000));
+    EXPECT_EQ(v4.reason, END_IDLE_TIMEOUT);
+    EXPECT_EQ(v6.src, "2001:db8::1");
+    EXPECT_EQ(v6.dst_port, 40000);
+    EXPECT_EQ(v6.bytes, 100u);
+}
+
+TEST(ExporterTest, IpfixHistogramPercentiles) {
+    TestCollector collector;
+    Stats stats(64);
+    // 98 malých paketov po 1 ms a 2 veľké po 1 s
+    int64_t ts = NOW - 60 * SEC;
+    for (int i = 0; i < 98; i++) {
+        stats.update(v4_key(1, 1000), 100, true, ts);
+        ts += 1000;
+    }
+    for (int i = 0; i < 2; i++) {
+        ts += SEC;
+        stats.update(v4_key(1, 1000), 1500, true, ts);
+    }
+
+    ViewPublisher views(stats, chrono::seconds(60));
+    views.publish();
+    ExportConfig config;
+    config.collector = collector.address();
+    FlowExporter exporter(views, config);
+    exporter.export_once(NOW);
+
+    vector<DecodedFlow> flows;
+    collector.receive(flows);
+    ASSERT_EQ(flows.size(), 1u);
+    // hodnoty bucketov majú relatívnu chybu najviac 12.5 %
+    EXPECT_NEAR(static_cast<double>(flows[0].size_p50), 100, 12.5);
+    EXPECT_NEAR(static_cast<double>(flows[0].size_p99), 1500, 187.5);
+    EXPECT_NEAR(static_cast<double>(flows[0].iat_p50), 1000, 125);
+    EXPECT_NEAR(static_cast<double>(flows[0].iat_p99), 1000000, 125000);
+}
+
+TEST(ExporterTest, ActiveAndInactiveTimeouts) {
+    TestCollector collector;
+    Stats stats(64);
+    // dlhotrvajúci aktívny tok
+    stats.update(v4_key(1, 1000), 100, true, NOW - 70 * SEC);
+    stats.update(v4_key(1, 1000), 100, true, NOW);
+    // krátky aktívny tok, ešte sa neexportuje
+    stats.update(v4_key(2, 2000), 100, true, NOW - 5 * SEC);
+    stats.update(v4_key(2, 2000), 100, true, NOW);
+
+    ViewPublisher views(stats, chrono::seconds(60));
+    views.publish();
+    ExportConfig config;
+    config.collector = collector.address();
+    FlowExporter exporter(views, config);
+    exporter.export_once(NOW);
+
+    vector<DecodedFlow> flows;
+    collector.receive(flows);
+    ASSERT_EQ(flows.size(), 1u);
+    EXPECT_EQ(flows[0].src, "10.0.0.1");
+    EXPECT_EQ(flows[0].reason, END_ACTIVE_TIMEOUT);
+    EXPECT_EQ(flows[0].packets, 2u);
+
+    // po exporte sa posiela iba prírastok
+    stats.update(v4_key(1, 1000), 300, true, NOW + SEC);
+    views.publish();
+    exporter.export_once(NOW + 2 * SEC);
+    flows.clear();
+    collector.receive(flows);
+    EXPECT_TRUE(flows.empty()); // aktívny limit od posledného exportu ešte neuplynul
+
+    exporter.export_once(NOW + 30 * SEC);
+    collector.receive(flows);
+    ASSERT_EQ(flows.size(), 2u);
+    for (const auto& flow : flows) {
+        EXPECT_EQ(flow.reason, END_IDLE_TIMEOUT);
+        if (flow.src == "10.0.0.1") {
+            EXPECT_EQ(flow.bytes, 300u);
+            EXPECT_EQ(flow.packets, 1u);
+        }
+    }
+
+    // bez nových paketov sa nič neposiela
+    flows.clear();
+    exporter.export_once(NOW + 200 * SEC);
+    EXPECT_EQ(collector.receive(flows), 0u);
+}
+
+TEST(ExporterTest, PacksRecordsIntoDatagrams) {
+    TestCollector collector;
+    Stats stats(1024);
+    for (int i = 0; i < 100; i++) {
+        stats.update(v4_key(static_cast<uint8_t>(i), static_cast<uint16_t>(1000 + i)), 100, true, NOW - 60 * SEC);
+    }
+
+    ViewPublisher views(stats, chrono::seconds(60));
+    views.publish();
+    ExportConfig config;
+    config.collector = collector.address();
+    config.max_datagram = 1400;
+    FlowExporter exporter(views, config);
+    exporter.export_once(NOW);
+
+    vector<DecodedFlow> flows;
+    size_t datagrams = collector.receive(flows);
+    EXPECT_EQ(flows.size(), 100u);
+    // 58 bajtov na záznam, do 1400 bajtov sa zmestí najviac 23 záznamov (v prvom 21 kvôli šablónam)
+    EXPECT_EQ(datagrams, 5u);
+    for (size_t size : collector.sizes) {
+        EXPECT_LE(size, 1400u);
+    }
+    // poradové číslo IPFIX je počet predtým odoslaných dátových záznamov
+    ASSERT_EQ(collector.sequences.size(), datagrams);
+    EXPECT_EQ(collector.sequences[0], 0u);
+    EXPECT_GT(collector.sequences[1], 0u);
+    EXPECT_LT(collector.sequences.back(), 100u);
+}
+
+TEST(ExporterTest, NetflowV9) {
+    TestCollector collector;
+    Stats stats(64);
+    stats.update(v4_key(1, 1000), 1000, true, NOW - 60 * SEC);
+    stats.update(v6_key(), 200, false, NOW - 60 * SEC);
+
+    ViewPublisher views(stats, chrono::seconds(60));
+    views.publish();
+    ExportConfig config;
+    config.collector = collector.address();
+    config.protocol = EXPORT_NETFLOW_V9;
+    FlowExporter exporter(views, config);
+    exporter.export_once(NOW);
+    exporter.export_once(NOW); // bez nových dát sa nič neodošle
+
+    vector<DecodedFlow> flows;
+    EXPECT_EQ(collector.receive(flows), 1u);
+    ASSERT_EQ(flows.size(), 2u);
+    // počet záznamov v hlavičke zahŕňa 2 šablóny a 2 dátové záznamy
+    ASSERT_EQ(collector.v9_counts.size(), 1u);
+    EXPECT_EQ(collector.v9_counts[0], 4);
+    EXPECT_EQ(collector.sequences[0], 0u);
+    for (const auto& flow : flows) {
+        EXPECT_TRUE(flow.bytes == 1000 || flow.bytes == 200);
+        EXPECT_EQ(flow.packets, 1u);
+    }
+}
+
+TEST(ExporterTest, StopFlushesPendingDeltas) {
+    TestCollector collector;
+    Stats stats(64);
+    int64_t now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    stats.update(v4_key(1, 1000), 100, true, now);
+
+    ViewPublisher views(stats, chrono::seconds(60));
+    views.publish();
+    ExportConfig config;
+    config.collector = collector.address();
+    {
+        FlowExporter exporter(views, config);
+        exporter.start();
+        this_thread::sleep_for(chrono::milliseconds(50));
+        exporter.stop();
+    }
+    vector<DecodedFlow> flows;
+    collector.receive(flows);
+    ASSERT_EQ(flows.size(), 1u);
+    EXPECT_EQ(flows[0].reason, END_FORCED);
+}
+
+TEST(ExporterTest, InvalidCollector) {
+    Stats stats(64);
+    ViewPublisher views(stats, chrono::seconds(60));
+    ExportConfig config;
+    config.collector = "no-port";
+    EXPECT_THROW(FlowExporter(views, config), invalid_argument);
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include "../src/include/filter.h"
+#include "../src/include/stats.h"
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+/**
+    Záznam toku s danými koncovými bodmi a počítadlami
+ */
+static FlowRecord make_record(const char* src, uint16_t src_port, const char* dst, uint16_t dst_port, uint8_t proto,
+                              uint64_t bytes = 1000, uint64_t packets = 10) {
+    FlowRecord record;
+    memset(&record, 0, sizeof(record));
+    record.used = 1;
+    FlowKey& key = record.key;
+    key.family = strchr(src, ':') != nullptr ? 6 : 4;
+    int af = key.family == 6 ? AF_INET6 : AF_INET;
+    inet_pton(af, src, key.src);
+    inet_pton(af, dst, key.dst);
+    key.proto = proto;
+    key.src_port = src_port;
+    key.dst_port = dst_port;
+    if (proto != IPPROTO_TCP && proto != IPPROTO_UDP) {
+        record.flags |= FLOW_NO_PORTS;
+    }
+    record.tx_bytes = bytes;
+    record.tx_packets = packets;
+    return record;
+}
+
+static bool matches(const std::string& expression, const FlowRecord& record) {
+    return FlowFilter(expression).matches(record);
+}
+
+TEST(FlowFilterTest, RequestExample) {
+    FlowRecord https = make_record("10.1.2.3", 50000, "93.184.216.34", 443, IPPROTO_TCP);
+    FlowRecord dns = make_record("10.1.2.3", 50001, "8.8.8.8", 53, IPPROTO_UDP);
+    FlowRecord outside = make_record("192.168.1.2", 50000, "93.184.216.34", 443, IPPROTO_TCP);
+    const char* expression = "proto=tcp and port 443 and host 10.0.0.0/8";
+    EXPECT_TRUE(matches(expression, https));
+    EXPECT_FALSE(matches(expression, dns));
+    EXPECT_FALSE(matches(expression, outside));
+    EXPECT_EQ(FlowFilter(expression).text(), expression);
+}
+
+TEST(FlowFilterTest, EmptyMatchesAll) {
+    FlowRecord record = make_record("10.0.0.1", 1, "10.0.0.2", 2, IPPROTO_UDP);
+    EXPECT_TRUE(matches("", record));
+    EXPECT_TRUE(matches("   ", record));
+}
+
+TEST(FlowFilterTest, PrecedenceAndShortCircuit) {
+    FlowRecord tcp = make_record("10.0.0.1", 1000, "10.0.0.2", 80, IPPROTO_TCP);
+    FlowRecord udp = make_record("10.0.0.1", 1000, "10.0.0.2", 53, IPPROTO_UDP);
+    // "and" má vyššiu prioritu ako "or"
+    EXPECT_TRUE(matches("udp or tcp and port 80", tcp));
+    EXPECT_TRUE(matches("udp or tcp and port 80", udp));
+    EXPECT_FALSE(matches("(udp or tcp) and port 80", udp));
+    EXPECT_TRUE(matches("tcp and port 81 or port 80", tcp));
+    EXPECT_FALSE(matches("tcp and (port 81 or port 82)", tcp));
+    // implicitné "and" a skratky
+    EXPECT_TRUE(matches("tcp port 80", tcp));
+    EXPECT_FALSE(matches("tcp port 80", udp));
+    EXPECT_TRUE(matches("tcp && !port 53 || udp", tcp));
+    EXPECT_TRUE(matches("not not tcp", tcp));
+    EXPECT_FALSE(matches("not (tcp or udp)", udp));
+    EXPECT_TRUE(matches("udp or udp or udp or tcp", tcp));
+    EXPECT_FALSE(matches("tcp and tcp and tcp and udp", tcp));
+}
+
+TEST(FlowFilterTest, Fields) {
+    FlowRecord record = make_record("10.1.2.3", 50000, "172.16.5.1", 443, IPPROTO_TCP, 1500000, 1200);
+    EXPECT_TRUE(matches("src host 10.1.2.3", record));
+    EXPECT_FALSE(matches("dst host 10.1.2.3", record));
+    EXPECT_TRUE(matches("dst net 172.16.0.0/12", record));
+    EXPECT_FALSE(matches("dst net 172.32.0.0/12", record));
+    EXPECT_TRUE(matches("net 0.0.0.0/0", record));
+    EXPECT_TRUE(matches("host 10.1.2.0/23", record));
+    EXPECT_FALSE(matches("host 10.1.4.0/23", record));
+    EXPECT_TRUE(matches("src port 50000 and dst port=443", record));
+    EXPECT_TRUE(matches("port 400-500", record));
+    EXPECT_FALSE(matches("src port 400-500", record));
+    EXPECT_TRUE(matches("proto 6", record));
+    EXPECT_TRUE(matches("proto=tcp", record));
+    EXPECT_TRUE(matches("ip and not ip6", record));
+    EXPECT_TRUE(matches("bytes > 1M and bytes <= 1500000", record));
+    EXPECT_FALSE(matches("bytes > 1500000", record));
+    EXPECT_TRUE(matches("packets >= 1200 and packets != 5 and packets < 2k", record));
+    EXPECT_TRUE(matches("packets = 1200", record));
+    // pri vzorkovaní sa porovnávajú odhady
+    EXPECT_TRUE(FlowFilter("packets > 10k").matches(record, 10));
+
+    FlowRecord v6 = make_record("2001:db8::1", 1, "fe80::2", 2, IPPROTO_UDP);
+    EXPECT_TRUE(matches("ip6 and src net 2001:db8::/32", v6));
+    EXPECT_FALSE(matches("host 10.0.0.0/8", v6));
+    EXPECT_TRUE(matches("host fe80::2", v6));
+    EXPECT_FALSE(matches("host fe80::3", v6));
+
+    // toky bez portov nevyhovujú testom portov
+    FlowRecord icmp = make_record("10.0.0.1", 0, "10.0.0.2", 0, IPPROTO_ICMP);
+    EXPECT_FALSE(matches("port 0", icmp));
+    EXPECT_TRUE(matches("icmp", icmp));
+
+    // protokoly s portami mimo TCP a UDP (parser.cpp) majú rovnaké kľúčové slová ako tcp a udp
+    FlowRecord sctp = make_record("10.0.0.1", 0, "10.0.0.2", 0, IPPROTO_SCTP);
+    EXPECT_TRUE(matches("sctp", sctp));
+    EXPECT_TRUE(matches("proto sctp", sctp));
+    EXPECT_TRUE(matches("proto=132", sctp));
+    EXPECT_FALSE(matches("udplite or tcp", sctp));
+    FlowRecord udplite = make_record("10.0.0.1", 0, "10.0.0.2", 0, IPPROTO_UDPLITE);
+    EXPECT_TRUE(matches("udplite and not sctp", udplite));
+    EXPECT_TRUE(matches("proto udplite", udplite));
+}
+
+TEST(FlowFilterTest, Errors) {
+    struct Case {
+        const char* expression;
+        const char* position;
+    };
+    const Case cases[] = {
+        {"tcp and", "position 8"},
+        {"port", "position 5"},
+        {"port 70000", "position 6"},
+        {"port 90-80", "position 6"},
+        {"host 10.0.0.300", "position 6"},
+        {"net 10.0.0.0/33", "position 5"},
+        {"proto ftp", "position 7"},
+        {"(tcp or udp", "position 12"},
+        {"tcp)", "position 4"},
+        {"src tcp", "position 5"},
+        {"bytes 10", "position 7"},
+        {"packets > many", "position 11"},
+        {"color red", "position 1"},
+        {"tcp & udp", "position 5"},
+    };
+    for (const Case& c : cases) {
+        try {
+            FlowFilter filter(c.expression);
+            ADD_FAILURE() << c.expression;
+        } catch (const std::invalid_argument& e) {
+            EXPECT_NE(std::string(e.what()).find(c.position), std::string::npos) << c.expression << ": " << e.what();
+        }
+    }
+}
+
+TEST(FlowFilterTest, StatsSnapshotIsFiltered) {
+    Stats stats(64);
+    stats.update("10.0.0.1:1000", "10.0.0.2:443", "tcp", 100, 1, true);
+    stats.update("10.0.0.1:1001", "10.0.0.2:53", "udp", 100, 1, true);
+    stats.update("192.168.0.1:1002", "10.0.0.2:443", "tcp", 100, 1, true);
+    EXPECT_EQ(stats.get_stats_snapshot().size(), 3u);
+
+    stats.set_filter(std::make_shared<const FlowFilter>("port 443 and src net 10.0.0.0/8"));
+    auto snapshot = stats.get_stats_snapshot();
+    ASSERT_EQ(snapshot.size(), 1u);
+    EXPECT_EQ(snapshot.begin()->first.src, "10.0.0.1:1000");
+    EXPECT_EQ(stats.filter()->text(), "port 443 and src net 10.0.0.0/8");
+
+    stats.set_filter(nullptr);
+    EXPECT_EQ(stats.get_stats_snapshot().size(), 3u);
+}
@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include "../src/include/flowtable.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+
+// Dočasný súbor tabuľky, zmaže sa po teste
+class FlowTableFileTest : public ::testing::Test {
+protected:
+    string path;
+
+    void SetUp() override {
+        char tmpl[] = "/tmp/isa-top-flowsXXXXXX";
+        int fd = mkstemp(tmpl);
+        close(fd);
+        path = tmpl;
+        unlink(path.c_str()); // tabuľka si súbor vytvorí sama
+    }
+
+    void TearDown() override {
+        unlink(path.c_str());
+    }
+};
+
+static FlowKey make_key(uint8_t last_octet, uint16_t src_port) {
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    key.family = 4;
+    key.proto = IPPROTO_TCP;
+    key.src_port = src_port;
+    key.dst_port = 443;
+    const uint8_t src[4] = {10, 0, 0, last_octet};
+    const uint8_t dst[4] = {192, 0, 2, 1};
+    memcpy(key.src, src, 4);
+    memcpy(key.dst, dst, 4);
+    return key;
+}
+
+TEST(FlowTableTest, InsertAndFind) {
+    FlowTable table(64);
+    EXPECT_EQ(table.capacity(), 64u);
+    EXPECT_EQ(table.find(make_key(1, 1000)), nullptr);
+
+    FlowRecord* record = table.find_or_insert(make_key(1, 1000));
+    ASSERT_NE(record, nullptr);
+    record->rx_bytes = 100;
+    EXPECT_EQ(table.find_or_insert(make_key(1, 1000)), record);
+    EXPECT_EQ(table.size(), 1u);
+
+    const FlowRecord* found = table.find(make_key(1, 1000));
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->rx_bytes, 100u);
+    EXPECT_EQ(table.find(make_key(1, 1001)), nullptr);
+}
+
+TEST(FlowTableTest, FullTableDropsNewFlows) {
+    FlowTable table(16);
+    size_t inserted = 0;
+    for (int i = 0; i < 16; i++) {
+        if (table.find_or_insert(make_key(static_cast<uint8_t>(i), 1000)) != nullptr) {
+            inserted++;
+        }
+    }
+    EXPECT_EQ(inserted, 12u); // naplnenie najviac na 3/4
+    EXPECT_EQ(table.dropped(), 4u);
+    // existujúce toky sa dajú aktualizovať aj v plnej tabuľke
+    EXPECT_NE(table.find_or_insert(make_key(0, 1000)), nullptr);
+}
+
+TEST(FlowTableTest, FullTableExpiresIdleFlows) {
+    const int64_t now = 10 * FLOW_IDLE_TIMEOUT_USEC;
+    FlowTable table(16);
+    for (int i = 0; i < 12; i++) {
+        FlowRecord* record = table.find_or_insert(make_key(static_cast<uint8_t>(i), 1000), now);
+        ASSERT_NE(record, nullptr);
+        // párne toky sú nečinné, nepárne aktívne
+        record->last_seen = i % 2 == 0 ? now - FLOW_IDLE_TIMEOUT_USEC - 1 : now;
+    }
+    // sledovaný nečinný tok sa neodstráni
+    table.find(make_key(0, 1000))->flags |= FLOW_WATCH;
+
+    ASSERT_NE(table.find_or_insert(make_key(100, 1000), now), nullptr);
+    EXPECT_EQ(table.size(), 8u);
+    EXPECT_EQ(table.dropped(), 0u);
+    for (int i = 0; i < 12; i++) {
+        bool kept = i % 2 == 1 || i == 0;
+        EXPECT_EQ(table.find(make_key(static_cast<uint8_t>(i), 1000)) != nullptr, kept) << i;
+    }
+}
+
+TEST(FlowTableTest, FullTableWithoutIdleFlowsDrops) {
+    const int64_t now = 10 * FLOW_IDLE_TIMEOUT_USEC;
+    FlowTable table(16);
+    for (int i = 0; i < 12; i++) {
+        table.find_or_insert(make_key(static_cast<uint8_t>(i), 1000), now)->last_seen = now;
+    }
+    EXPECT_EQ(table.find_or_insert(make_key(100, 1000), now), nullptr);
+    EXPECT_EQ(table.dropped(), 1u);
+
+    table.find(make_key(3, 1000))->last_seen = 0;
+    EXPECT_NE(table.find_or_insert(make_key(100, 1000), now + 1), nullptr);
+    EXPECT_EQ(table.find(make_key(3, 1000)), nullptr);
+    EXPECT_EQ(table.size(), 12u);
+}
+
+TEST(FlowTableTest, FullTableExpiresIncrementally) {
+    // jedno vloženie prejde iba FLOW_EXPIRE_BATCH slotov, nečinný tok sa nájde až po obídení tabuľky kurzorom
+    const int64_t now = 10 * FLOW_IDLE_TIMEOUT_USEC;
+    const size_t capacity = 4096;
+    FlowTable table(capacity);
+    vector<FlowKey> keys;
+    for (size_t i = 0; i < capacity / 4 * 3; i++) {
+        FlowKey key = make_key(static_cast<uint8_t>(i % 256), static_cast<uint16_t>(1000 + i / 256));
+        table.find_or_insert(key, now)->last_seen = now;
+        keys.push_back(key);
+    }
+    // posledný slot tabuľky, ku ktorému sa kurzor dostane ako k poslednému
+    FlowRecord* idle = nullptr;
+    for (size_t i = capacity; i-- > 0 && idle == nullptr;) {
+        if (table.slot(i).used) {
+            idle = &table.slot(i);
+        }
+    }
+    ASSERT_NE(idle, nullptr);
+    idle->last_seen = 0;
+
+    size_t attempts = 0;
+    while (table.find_or_insert(make_key(255, 9999), now) == nullptr) {
+        attempts++;
+        ASSERT_LE(attempts, capacity / FLOW_EXPIRE_BATCH);
+    }
+    EXPECT_GT(attempts, capacity / FLOW_EXPIRE_BATCH / 2);
+    EXPECT_EQ(table.dropped(), attempts);
+    EXPECT_EQ(table.size(), keys.size());
+}
+
+TEST(FlowTableTest, ExpireKeepsChainsReachable) {
+    // posun záznamov po odstránení nesmie prerušiť reťazec skúšania žiadneho zostávajúceho kľúča
+    FlowTable table(1024);
+    vector<FlowKey> keys;
+    for (int i = 0; i < 768; i++) {
+        FlowKey key = make_key(static_cast<uint8_t>(i % 256), static_cast<uint16_t>(1000 + i / 256));
+        FlowRecord* record = table.find_or_insert(key);
+        ASSERT_NE(record, nullptr);
+        record->last_seen = (i * 7919) % 1000;
+        record->rx_packets = i;
+        keys.push_back(key);
+    }
+    size_t removed = table.expire(500);
+    EXPECT_EQ(table.size(), 768u - removed);
+    for (int i = 0; i < 768; i++) {
+        const FlowRecord* record = table.find(keys[i]);
+        if ((i * 7919) % 1000 < 500) {
+            EXPECT_EQ(record, nullptr) << i;
+        }
+        else {
+            ASSERT_NE(record, nullptr) << i;
+            EXPECT_EQ(record->rx_packets, static_cast<uint64_t>(i));
+        }
+    }
+    size_t used = 0;
+    for (size_t i = 0; i < table.capacity(); i++) {
+        used += table.slot(i).used;
+    }
+    EXPECT_EQ(used, table.size());
+}
+
+TEST_F(FlowTableFileTest, ReattachKeepsRecords) {
+    {
+        FlowTable table(path, 128);
+        EXPECT_FALSE(table.reattached());
+        FlowRecord* record = table.find_or_insert(make_key(7, 5555));
+        record->tx_bytes = 1234;
+        record->tx_packets = 3;
+    }
+    // požadovaná kapacita sa pri pripojení ignoruje
+    FlowTable table(path, 4096);
+    EXPECT_TRUE(table.reattached());
+    EXPECT_TRUE(table.was_clean());
+    EXPECT_EQ(table.capacity(), 128u);
+    EXPECT_EQ(table.size(), 1u);
+    const FlowRecord* record = table.find(make_key(7, 5555));
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->tx_bytes, 1234u);
+    EXPECT_EQ(record->tx_packets, 3u);
+}
+
+TEST_F(FlowTableFileTest, SurvivesCrash) {
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // proces skončí bez deštruktora, ako pri páde
+        FlowTable* table = new FlowTable(path, 64);
+        table->find_or_insert(make_key(9, 9999))->rx_packets = 42;
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+
+    FlowTable table(path, 64);
+    EXPECT_TRUE(table.reattached());
+    EXPECT_FALSE(table.was_clean());
+    const FlowRecord* record = table.find(make_key(9, 9999));
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->rx_packets, 42u);
+}
+
+TEST_F(FlowTableFileTest, RejectsForeignFile) {
+    ofstream(path) << "this is not a flow table, just some text that is long enough for a header";
+    EXPECT_THROW(FlowTable(path, 64), runtime_error);
+}
+
+TEST_F(FlowTableFileTest, RejectsOtherVersion) {
+    {
+        FlowTable table(path, 64);
+    }
+    // prepísanie verzie v hlavičke
+    fstream file(path, ios::in | ios::out | ios::binary);
+    file.seekp(offsetof(FlowTableHeader, version));
+    uint32_t version = FLOW_TABLE_VERSION + 1;
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    file.close();
+    EXPECT_THROW(FlowTable(path, 64), runtime_error);
+}
+
+TEST_F(FlowTableFileTest, SingleWriter) {
+    FlowTable writer(path, 64);
+    EXPECT_THROW(FlowTable(path, 64), runtime_error);
+    // čítanie počas behu je povolené
+    FlowTable reader(path, 0, true);
+    EXPECT_TRUE(reader.reattached());
+}
+
+TEST_F(FlowTableFileTest, ReadOnlyMissingFileFails) {
+    EXPECT_THROW(FlowTable(path, 0, true), runtime_error);
+}
+
+TEST_F(FlowTableFileTest, InspectPrintsTopFlows) {
+    {
+        FlowTable table(path, 64);
+        table.find_or_insert(make_key(1, 1000))->rx_bytes = 10;
+        table.find_or_insert(make_key(2, 2000))->rx_bytes = 5000;
+    }
+    FlowTable table(path, 0, true);
+    ostringstream out;
+    print_top_flows(table, 'b', 1, out);
+    string text = out.str();
+    EXPECT_NE(text.find("Flows: 2/64"), string::npos);
+    EXPECT_NE(text.find("10.0.0.2:2000"), string::npos);
+    EXPECT_EQ(text.find("10.0.0.1:1000"), string::npos); // vypíše sa iba najväčší tok
+}
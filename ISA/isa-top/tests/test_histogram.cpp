@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "../src/include/histogram.h"
+#include "../src/include/stats.h"
+#include <cstring>
+
+TEST(HistogramTest, BucketsAreContiguous) {
+    // hodnoty 0..3 majú vlastné buckety, ďalej 4 buckety na mocninu 2
+    EXPECT_EQ(histogram_bucket(0), 0u);
+    EXPECT_EQ(histogram_bucket(3), 3u);
+    EXPECT_EQ(histogram_bucket(4), 4u);
+    EXPECT_EQ(histogram_bucket(7), 7u);
+    EXPECT_EQ(histogram_bucket(8), 8u);
+    EXPECT_EQ(histogram_bucket(9), 8u);
+    EXPECT_EQ(histogram_bucket(10), 9u);
+    EXPECT_EQ(histogram_bucket(65535), SIZE_BUCKETS - 1);
+    EXPECT_EQ(histogram_bucket((1u << 24) - 1), IAT_BUCKETS - 1);
+
+    // hranice bucketov nadväzujú a každá hodnota patrí do bucketu so zodpovedajúcou dolnou hranicou
+    for (size_t i = 1; i < IAT_BUCKETS; i++) {
+        EXPECT_GT(histogram_bucket_low(i), histogram_bucket_low(i - 1));
+        EXPECT_EQ(histogram_bucket(histogram_bucket_low(i)), i);
+        EXPECT_EQ(histogram_bucket(histogram_bucket_low(i) - 1), i - 1);
+    }
+}
+
+TEST(HistogramTest, RelativeErrorIsBounded) {
+    for (uint64_t value = 1; value < (1u << 24); value = value * 3 / 2 + 1) {
+        double rep = static_cast<double>(histogram_bucket_value(histogram_bucket(value)));
+        EXPECT_LE(std::abs(rep - static_cast<double>(value)) / static_cast<double>(value), 0.125) << value;
+    }
+}
+
+TEST(HistogramTest, Percentiles) {
+    uint16_t counts[SIZE_BUCKETS];
+    memset(counts, 0, sizeof(counts));
+    EXPECT_EQ(histogram_percentile(counts, SIZE_BUCKETS, 50), 0u);
+
+    for (int i = 0; i < 90; i++) {
+        histogram_record(counts, SIZE_BUCKETS, 64);
+    }
+    for (int i = 0; i < 10; i++) {
+        histogram_record(counts, SIZE_BUCKETS, 1500);
+    }
+    EXPECT_EQ(histogram_percentile(counts, SIZE_BUCKETS, 50), histogram_bucket_value(histogram_bucket(64)));
+    EXPECT_EQ(histogram_percentile(counts, SIZE_BUCKETS, 90), histogram_bucket_value(histogram_bucket(64)));
+    EXPECT_EQ(histogram_percentile(counts, SIZE_BUCKETS, 91), histogram_bucket_value(histogram_bucket(1500)));
+    EXPECT_EQ(histogram_percentile(counts, SIZE_BUCKETS, 100), histogram_bucket_value(histogram_bucket(1500)));
+}
+
+TEST(HistogramTest, SaturationKeepsShape) {
+    uint16_t counts[IAT_BUCKETS];
+    memset(counts, 0, sizeof(counts));
+    // hodnoty za rozsahom sa započítajú do posledného bucketu
+    histogram_record(counts, IAT_BUCKETS, 1ULL << 40);
+    EXPECT_EQ(counts[IAT_BUCKETS - 1], 1u);
+    memset(counts, 0, sizeof(counts));
+
+    for (int i = 0; i < 200000; i++) {
+        histogram_record(counts, IAT_BUCKETS, i % 4 == 0 ? 10000 : 100);
+    }
+    uint32_t small = counts[histogram_bucket(100)];
+    uint32_t large = counts[histogram_bucket(10000)];
+    EXPECT_LT(small, UINT16_MAX);
+    EXPECT_NEAR(static_cast<double>(small) / large, 3.0, 0.01);
+    EXPECT_EQ(histogram_percentile(counts, IAT_BUCKETS, 50), histogram_bucket_value(histogram_bucket(100)));
+}
+
+TEST(HistogramTest, StatsRecordsBothDirections) {
+    Stats stats(64);
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    key.family = 4;
+    key.proto = 17;
+    key.src_port = 5000;
+    key.dst_port = 53;
+    key.src[0] = 10; key.src[3] = 1;
+    key.dst[0] = 10; key.dst[3] = 2;
+
+    int64_t ts = 1700000000LL * 1000000;
+    for (int i = 0; i < 10; i++) {
+        stats.update(key, 80, true, ts);
+        stats.update(reverse_key(key), 400, false, ts + 200);
+        ts += 10000;
+    }
+
+    FlowHistograms hist;
+    // kľúč pripojenia z pohľadu ľubovoľného smeru
+    ASSERT_TRUE(stats.get_histograms({"10.0.0.2:53", "10.0.0.1:5000", "udp"}, hist));
+    uint64_t packets = 0, gaps = 0;
+    for (size_t i = 0; i < SIZE_BUCKETS; i++) {
+        packets += hist.size[i];
+    }
+    for (size_t i = 0; i < IAT_BUCKETS; i++) {
+        gaps += hist.iat[i];
+    }
+    EXPECT_EQ(packets, 20u);
+    EXPECT_EQ(gaps, 18u); // prvý paket každého smeru nemá medzipaketový čas
+    EXPECT_EQ(histogram_percentile(hist.size, SIZE_BUCKETS, 25), histogram_bucket_value(histogram_bucket(80)));
+    EXPECT_EQ(histogram_percentile(hist.size, SIZE_BUCKETS, 75), histogram_bucket_value(histogram_bucket(400)));
+    EXPECT_EQ(histogram_percentile(hist.iat, IAT_BUCKETS, 50), histogram_bucket_value(histogram_bucket(10000)));
+
+    EXPECT_FALSE(stats.get_histograms({"10.0.0.3:53", "10.0.0.1:5000", "udp"}, hist));
+}
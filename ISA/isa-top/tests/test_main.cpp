@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../src/include/utils.h"
+#include <getopt.h>
 
 
 TEST(ParseArgumentsTest, ValidArguments) {
@@ -40,3 +41,113 @@ TEST(ParseArgumentsTest, NoArguments) {
     EXPECT_THROW(parse_arguments(argc, argv), std::invalid_argument);
 }
 
+
+TEST(ParseArgumentsTest, ResolveFlag) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("-r")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0; // reinicializácia getopt po predchádzajúcich testoch
+    Config config = parse_arguments(argc, argv);
+    EXPECT_TRUE(config.resolve);
+}
+
+TEST(ParseArgumentsTest, InspectWithoutInterface) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("--inspect"), const_cast<char*>("/tmp/flows.bin"), const_cast<char*>("-s"), const_cast<char*>("p")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0;
+    Config config = parse_arguments(argc, argv);
+    EXPECT_EQ(config.inspect_path, "/tmp/flows.bin");
+    EXPECT_EQ(config.sort_option, 'p');
+    EXPECT_TRUE(config.interface.empty());
+}
+
+TEST(ParseArgumentsTest, TableOption) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("--table"), const_cast<char*>("/tmp/flows.bin")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0;
+    Config config = parse_arguments(argc, argv);
+    EXPECT_EQ(config.table_path, "/tmp/flows.bin");
+}
+
+TEST(ParseArgumentsTest, ExportOptions) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("--export"), const_cast<char*>("127.0.0.1:4739"),
+                    const_cast<char*>("--export-proto"), const_cast<char*>("v9"), const_cast<char*>("--inactive-timeout"), const_cast<char*>("5")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0;
+    Config config = parse_arguments(argc, argv);
+    EXPECT_EQ(config.export_collector, "127.0.0.1:4739");
+    EXPECT_TRUE(config.export_v9);
+    EXPECT_EQ(config.inactive_timeout, 5);
+    EXPECT_EQ(config.active_timeout, 60);
+}
+
+TEST(ParseArgumentsTest, SampleOptions) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("--sample"), const_cast<char*>("100"),
+                    const_cast<char*>("--sample-mode"), const_cast<char*>("count")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0;
+    Config config = parse_arguments(argc, argv);
+    EXPECT_EQ(config.sample_rate, 100);
+    EXPECT_TRUE(config.sample_count);
+
+    char* bad[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("--sample"), const_cast<char*>("0")};
+    EXPECT_THROW(parse_arguments(sizeof(bad) / sizeof(char*), bad), invalid_argument);
+}
+
+TEST(ParseArgumentsTest, FilterOption) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("--inspect"), const_cast<char*>("/tmp/flows.bin"),
+                    const_cast<char*>("--filter"), const_cast<char*>("tcp and port 443")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0;
+    Config config = parse_arguments(argc, argv);
+    EXPECT_EQ(config.filter, "tcp and port 443");
+}
+
+TEST(ParseArgumentsTest, TableSize) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("--table-size"), const_cast<char*>("1000000")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0;
+    Config config = parse_arguments(argc, argv);
+    EXPECT_EQ(config.table_size, 1000000u);
+
+    for (const char* value : {"0", "-5", "abc", "99999999999"}) {
+        char* bad[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("--table-size"), const_cast<char*>(value)};
+        optind = 0;
+        EXPECT_THROW(parse_arguments(sizeof(bad) / sizeof(char*), bad), invalid_argument) << value;
+    }
+}
+
+TEST(ParseArgumentsTest, SourceOptions) {
+    char* argv[] = {const_cast<char*>("program"), const_cast<char*>("--synthetic"), const_cast<char*>("churn,packets=1000")};
+    int argc = sizeof(argv) / sizeof(char*);
+
+    optind = 0;
+    Config config = parse_arguments(argc, argv);
+    EXPECT_EQ(config.synthetic, "churn,packets=1000");
+    EXPECT_TRUE(config.interface.empty());
+
+    char* both[] = {const_cast<char*>("program"), const_cast<char*>("-i"), const_cast<char*>("lo"), const_cast<char*>("--read"), const_cast<char*>("/tmp/in.pcap")};
+    optind = 0;
+    EXPECT_THROW(parse_arguments(sizeof(both) / sizeof(char*), both), invalid_argument);
+
+    char* replay[] = {const_cast<char*>("program"), const_cast<char*>("--read"), const_cast<char*>("/tmp/in.pcap"),
+                      const_cast<char*>("--local"), const_cast<char*>("10.0.0.1"), const_cast<char*>("--local"), const_cast<char*>("fe80::1")};
+    optind = 0;
+    config = parse_arguments(sizeof(replay) / sizeof(char*), replay);
+    ASSERT_EQ(config.local_addresses.size(), 2u);
+    EXPECT_EQ(config.local_addresses[1], "fe80::1");
+
+    // --local iba so súborom a iba s platnou adresou
+    char* live[] = {const_cast<char*>("program"), const_cast<char*>("--synthetic"), const_cast<char*>("small"), const_cast<char*>("--local"), const_cast<char*>("10.0.0.1")};
+    optind = 0;
+    EXPECT_THROW(parse_arguments(sizeof(live) / sizeof(char*), live), invalid_argument);
+    char* bad[] = {const_cast<char*>("program"), const_cast<char*>("--read"), const_cast<char*>("/tmp/in.pcap"), const_cast<char*>("--local"), const_cast<char*>("host")};
+    optind = 0;
+    EXPECT_THROW(parse_arguments(sizeof(bad) / sizeof(char*), bad), invalid_argument);
+}
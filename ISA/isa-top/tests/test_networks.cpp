@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "../src/include/networks.h"
+#include "../src/include/stats.h"
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <arpa/inet.h>
+
+/**
+    Prefix pre porovnanie s vyhľadaním hrubou silou
+ */
+struct TestPrefix {
+    uint8_t addr[16];
+    unsigned length;
+    std::string name;
+};
+
+/**
+    Najdlhší prefix obsahujúci adresu (lineárny prechod všetkých prefixov)
+ */
+static std::string brute_force(const std::vector<TestPrefix>& prefixes, const uint8_t* addr) {
+    const TestPrefix* best = nullptr;
+    for (const TestPrefix& p : prefixes) {
+        bool match = true;
+        for (unsigned bit = 0; bit < p.length && match; bit++) {
+            uint8_t mask = static_cast<uint8_t>(0x80 >> (bit % 8));
+            match = (p.addr[bit / 8] & mask) == (addr[bit / 8] & mask);
+        }
+        // pri rovnakej dĺžke vyhráva neskôr pridaný prefix
+        if (match && (best == nullptr || p.length >= best->length)) {
+            best = &p;
+        }
+    }
+    return best != nullptr ? best->name : "(unknown)";
+}
+
+/**
+    Náhodné prefixy a adresy, polovica adries leží v niektorom z prefixov
+ */
+static void check_random(uint8_t family) {
+    unsigned bytes = family == 6 ? 16 : 4;
+    uint64_t seed = family;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(seed >> 33);
+    };
+    std::vector<TestPrefix> prefixes(2000);
+    NetworkMap map;
+    for (size_t i = 0; i < prefixes.size(); i++) {
+        TestPrefix& p = prefixes[i];
+        // krátke prefixy zdieľajú prvé bajty, aby sa prekrývali
+        for (unsigned b = 0; b < bytes; b++) {
+            p.addr[b] = static_cast<uint8_t>(b < 2 ? next() % 4 : next());
+        }
+        p.length = 1 + next() % (bytes * 8);
+        p.name = "net" + std::to_string(next() % 300);
+        map.add(family, p.addr, p.length, p.name);
+    }
+    EXPECT_EQ(map.prefixes(), prefixes.size());
+
+    for (int i = 0; i < 20000; i++) {
+        uint8_t addr[16];
+        for (unsigned b = 0; b < bytes; b++) {
+            addr[b] = static_cast<uint8_t>(next());
+        }
+        if (i % 2 == 0) {
+            // adresa z prefixu s náhodnými bitmi za ním
+            const TestPrefix& p = prefixes[next() % prefixes.size()];
+            memcpy(addr, p.addr, p.length / 8);
+            if (p.length % 8 != 0) {
+                uint8_t mask = static_cast<uint8_t>(0xFF00 >> (p.length % 8));
+                addr[p.length / 8] = static_cast<uint8_t>((p.addr[p.length / 8] & mask) | (addr[p.length / 8] & ~mask));
+            }
+        }
+        ASSERT_EQ(map.name(map.lookup(family, addr)), brute_force(prefixes, addr)) << i;
+    }
+}
+
+TEST(NetworkMapTest, RandomIPv4MatchesBruteForce) {
+    check_random(4);
+}
+
+TEST(NetworkMapTest, RandomIPv6MatchesBruteForce) {
+    check_random(6);
+}
+
+TEST(NetworkMapTest, LoadAndDefaultRoute) {
+    std::istringstream in(
+        "# pomenované siete\n"
+        "10.0.0.0/8      lan\n"
+        "10.1.2.0/24     servers   # dlhší prefix\n"
+        "\n"
+        "0.0.0.0/0       internet\n"
+        "2001:db8::/32   lan\n");
+    NetworkMap map;
+    map.load(in, "test");
+    EXPECT_EQ(map.prefixes(), 4u);
+
+    auto lookup4 = [&map](const char* text) {
+        uint8_t addr[4];
+        inet_pton(AF_INET, text, addr);
+        return map.name(map.lookup(4, addr));
+    };
+    EXPECT_EQ(lookup4("10.1.2.3"), "servers");
+    EXPECT_EQ(lookup4("10.1.3.3"), "lan");
+    EXPECT_EQ(lookup4("8.8.8.8"), "internet");
+
+    uint8_t addr6[16];
+    inet_pton(AF_INET6, "2001:db8::1", addr6);
+    EXPECT_EQ(map.name(map.lookup(6, addr6)), "lan");
+    inet_pton(AF_INET6, "2001:db9::1", addr6);
+    // predvolená cesta IPv4 neplatí pre IPv6
+    EXPECT_EQ(map.lookup(6, addr6), NETWORK_UNKNOWN);
+    EXPECT_EQ(map.lookup(4, addr6), map.lookup(4, reinterpret_cast<const uint8_t*>("\x08\x08\x08\x08")));
+}
+
+TEST(NetworkMapTest, InvalidLines) {
+    const char* bad[] = {"10.0.0.0 lan\n", "10.0.0.0/8\n", "10.0.0.0/33 lan\n", "10.0.0/8 lan\n", "::/129 lan\n", "10.0.0.0/x lan\n"};
+    for (const char* line : bad) {
+        std::istringstream in(std::string("# ok\n") + line);
+        NetworkMap map;
+        try {
+            map.load(in, "nets");
+            ADD_FAILURE() << line;
+        } catch (const std::runtime_error& e) {
+            EXPECT_EQ(std::string(e.what()).rfind("nets:2: ", 0), 0u) << e.what();
+        }
+    }
+    NetworkMap map;
+    EXPECT_THROW(map.load("/nonexistent/networks.txt"), std::runtime_error);
+}
+
+TEST(NetworkMapTest, StatsAggregatesNetworkPairs) {
+    std::istringstream in("10.0.0.0/8 lan\n192.168.0.0/16 office\n");
+    auto map = std::make_shared<NetworkMap>();
+    map->load(in, "test");
+
+    Stats stats(64);
+    // bez zoznamu sietí je pohľad prázdny
+    EXPECT_TRUE(stats.get_network_snapshot().empty());
+    stats.set_networks(map);
+    stats.update("10.0.0.1:1000", "192.168.1.1:80", "tcp", 100, 1, true);
+    stats.update("10.0.0.2:1001", "192.168.1.2:80", "tcp", 200, 1, true);
+    stats.update("192.168.1.1:80", "10.0.0.1:1000", "tcp", 50, 1, false);
+    stats.update("10.0.0.1:53", "8.8.8.8:53", "udp", 70, 1, true);
+
+    auto snapshot = stats.get_network_snapshot();
+    ASSERT_EQ(snapshot.size(), 3u);
+    ConnectionKey lan_office{"lan", "office", ""};
+    EXPECT_DOUBLE_EQ(snapshot[lan_office].tx_bytes, 300);
+    EXPECT_DOUBLE_EQ(snapshot[lan_office].tx_packets, 2);
+    ConnectionKey office_lan{"office", "lan", ""};
+    EXPECT_DOUBLE_EQ(snapshot[office_lan].rx_bytes, 50);
+    ConnectionKey lan_unknown{"lan", "(unknown)", ""};
+    EXPECT_DOUBLE_EQ(snapshot[lan_unknown].tx_bytes, 70);
+
+    // nový zoznam sietí preklasifikuje existujúce toky pri ďalšom pakete
+    std::istringstream other("0.0.0.0/0 any\n");
+    auto all = std::make_shared<NetworkMap>();
+    all->load(other, "test");
+    stats.set_networks(all);
+    EXPECT_TRUE(stats.get_network_snapshot().empty());
+    stats.update("10.0.0.1:53", "8.8.8.8:53", "udp", 30, 1, true);
+    snapshot = stats.get_network_snapshot();
+    ASSERT_EQ(snapshot.size(), 1u);
+    ConnectionKey any_any{"any", "any", ""};
+    EXPECT_DOUBLE_EQ(snapshot[any_any].tx_bytes, 100);
+}
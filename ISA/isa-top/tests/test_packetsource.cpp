@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include "../src/include/packetcapture.h"
+#include "../src/include/packetsource.h"
+#include "../src/include/pcapsource.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+// Odtlačok postupnosti paketov (FNV-1a cez hlavičky a zachytené bajty)
+static uint64_t fingerprint(SyntheticSource& source, size_t packets) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    PacketHeader header;
+    for (size_t i = 0; i < packets; i++) {
+        const u_char* data = source.next(header);
+        for (uint32_t j = 0; j < header.caplen; j++) {
+            hash = (hash ^ data[j]) * 0x100000001b3ULL;
+        }
+        hash = (hash ^ header.len) * 0x100000001b3ULL;
+        hash = (hash ^ static_cast<uint64_t>(header.ts_usec)) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Rezidentná pamäť procesu v bajtoch
+static uint64_t resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Spracovanie scenára celou cestou (dekódovanie, smer, tabuľka tokov)
+static void run_scenario(Stats& stats, const SyntheticConfig& config) {
+    PacketCapture capture(std::unique_ptr<PacketSource>(new SyntheticSource(config)), stats);
+    capture.start_capture();
+    EXPECT_EQ(capture.source_stats().received, config.packets);
+    EXPECT_EQ(capture.source_stats().dropped, 0u);
+}
+
+TEST(SyntheticSourceTest, ParseSpec) {
+    SyntheticConfig config = parse_synthetic("churn,packets=1000,flows=50,seed=7");
+    EXPECT_EQ(config.scenario, SCENARIO_CHURN);
+    EXPECT_EQ(config.packets, 1000u);
+    EXPECT_EQ(config.flows, 50u);
+    EXPECT_EQ(config.seed, 7u);
+    EXPECT_EQ(parse_synthetic("elephants").scenario, SCENARIO_ELEPHANTS);
+    EXPECT_EQ(parse_synthetic("small").packets, 0u);
+    EXPECT_THROW(parse_synthetic("flood"), std::invalid_argument);
+    EXPECT_THROW(parse_synthetic("mixed,packets"), std::invalid_argument);
+    EXPECT_THROW(parse_synthetic("mixed,flows=0"), std::invalid_argument);
+    EXPECT_THROW(parse_synthetic("mixed,rate=5"), std::invalid_argument);
+}
+
+TEST(SyntheticSourceTest, Deterministic) {
+    SyntheticConfig config = parse_synthetic("mixed,seed=42");
+    SyntheticSource a(config), b(config);
+    EXPECT_EQ(fingerprint(a, 10000), fingerprint(b, 10000));
+    config.seed = 43;
+    SyntheticSource c(config);
+    SyntheticSource d(parse_synthetic("mixed,seed=42"));
+    EXPECT_NE(fingerprint(c, 10000), fingerprint(d, 10000));
+}
+
+TEST(SyntheticSourceTest, PacketsDecode) {
+    // každý scenár dáva pakety, ktoré parser prijme a ktoré patria lokálnej adrese
+    for (const char* spec : {"small", "elephants", "churn", "mixed"}) {
+        SyntheticSource source(parse_synthetic(spec));
+        DecodeFn decode = select_decoder(source.datalink());
+        ASSERT_NE(decode, nullptr);
+        PacketHeader header;
+        for (int i = 0; i < 1000; i++) {
+            const u_char* data = source.next(header);
+            PacketInfo info;
+            ASSERT_TRUE(decode(data, header.caplen, info)) << spec;
+            EXPECT_LE(header.caplen, source.snaplen());
+            EXPECT_GE(header.len, header.caplen);
+            size_t len = info.key.family == 4 ? 4 : 16;
+            const LocalAddress& local = source.local_addresses()[info.key.family == 4 ? 0 : 1];
+            EXPECT_TRUE(memcmp(info.key.src, local.addr, len) == 0 || memcmp(info.key.dst, local.addr, len) == 0) << spec;
+        }
+    }
+}
+
+TEST(SyntheticSourceTest, Scenarios) {
+    {
+        // 8 tokov, oba smery
+        Stats stats(1024);
+        run_scenario(stats, parse_synthetic("elephants,packets=20000"));
+        EXPECT_EQ(stats.flow_count(), 16u);
+        uint64_t bytes = 0;
+        for (const auto& entry : stats.get_stats_snapshot()) {
+            bytes += entry.second.rx_bytes + entry.second.tx_bytes;
+        }
+        EXPECT_GT(bytes, 20000u * 1000);
+    }
+    {
+        Stats stats(65536);
+        run_scenario(stats, parse_synthetic("small,packets=100000,flows=1000"));
+        EXPECT_LE(stats.flow_count(), 2000u);
+        EXPECT_GT(stats.flow_count(), 1900u);
+        EXPECT_EQ(stats.dropped_flows(), 0u);
+    }
+    {
+        // každý paket je nový tok, plná tabuľka nové toky zahadzuje
+        Stats stats(1024);
+        run_scenario(stats, parse_synthetic("churn,packets=5000"));
+        EXPECT_LE(stats.flow_count(), 1024u);
+        EXPECT_EQ(stats.flow_count() + stats.dropped_flows(), 5000u);
+    }
+    {
+        Stats stats(65536);
+        run_scenario(stats, parse_synthetic("mixed,packets=50000,flows=500"));
+        bool v4 = false, v6 = false;
+        for (const auto& entry : stats.get_stats_snapshot()) {
+            std::string endpoints = entry.first.src + " " + entry.first.dst;
+            v4 = v4 || endpoints.find("198.18.") != std::string::npos;
+            v6 = v6 || endpoints.find("2001:2:0:1:") != std::string::npos;
+        }
+        EXPECT_TRUE(v4);
+        EXPECT_TRUE(v6);
+    }
+}
+
+// Súbor pcap iba s globálnou hlavičkou (Ethernet, snaplen 65535)
+static std::string write_empty_pcap() {
+    char path[] = "/tmp/isa-top-replayXXXXXX";
+    int fd = mkstemp(path);
+    const uint32_t header[6] = {0xa1b2c3d4, 0x00040002, 0, 0, 65535, 1};
+    EXPECT_EQ(write(fd, header, sizeof(header)), static_cast<ssize_t>(sizeof(header)));
+    close(fd);
+    return path;
+}
+
+TEST(PcapFileSourceTest, NoCaptureSocket) {
+    std::string path = write_empty_pcap();
+    PcapFileSource source(path);
+    unlink(path.c_str());
+    // pcap_fileno vracia deskriptor súboru, filter BPF sa naň pripájať nesmie
+    EXPECT_EQ(source.fd(), -1);
+    EXPECT_TRUE(source.local_addresses().empty());
+}
+
+TEST(PcapFileSourceTest, LocalAddresses) {
+    std::string path = write_empty_pcap();
+    PcapFileSource source(path, {"10.0.0.1", "2001:db8::1"});
+    EXPECT_THROW(PcapFileSource(path, {"10.0.0.256"}), std::invalid_argument);
+    unlink(path.c_str());
+
+    // adresy zadané --local určujú smer prehrávaných paketov ako adresy rozhrania
+    ASSERT_EQ(source.local_addresses().size(), 2u);
+    const LocalAddress& v4 = source.local_addresses()[0];
+    const LocalAddress& v6 = source.local_addresses()[1];
+    EXPECT_EQ(v4.family, 4);
+    EXPECT_EQ(memcmp(v4.addr, "\x0a\x00\x00\x01", 4), 0);
+    EXPECT_EQ(v6.family, 6);
+    EXPECT_EQ(v6.addr[0], 0x20);
+    EXPECT_EQ(v6.addr[15], 0x01);
+}
+
+TEST(SyntheticSourceTest, StopFromAnotherThread) {
+    Stats stats(1024);
+    PacketCapture capture(std::unique_ptr<PacketSource>(new SyntheticSource(parse_synthetic("small"))), stats);
+    std::thread worker([&]() { capture.start_capture(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    capture.stop_capture();
+    worker.join();
+    EXPECT_GT(capture.source_stats().received, 0u);
+}
+
+TEST(SyntheticSourceTest, SoakChurn) {
+    // tabuľka sa zaplní v prvej polovici, v druhej sa už nesmie alokovať pamäť
+    const uint64_t packets = 1000000;
+    Stats stats(65536);
+    SyntheticConfig config = parse_synthetic("churn");
+    config.packets = packets / 2;
+    run_scenario(stats, config);
+    uint64_t resident = resident_bytes();
+    size_t flows = stats.flow_count();
+
+    config.seed = 2;
+    auto start = std::chrono::steady_clock::now();
+    run_scenario(stats, config);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t after = resident_bytes();
+    uint64_t growth = after > resident ? after - resident : 0;
+
+    EXPECT_EQ(stats.flow_count(), flows);
+    EXPECT_EQ(stats.flow_count() + stats.dropped_flows(), packets);
+    EXPECT_LT(growth, 4u << 20);
+    std::cout << "churn: " << packets / 2 / seconds / 1e6 << " Mpps, RSS growth " << growth / 1024 << " KiB, dropped flows "
+              << stats.dropped_flows() << std::endl;
+}
+
+TEST(SyntheticSourceTest, SoakMixed) {
+    const uint64_t packets = 1000000;
+    Stats stats(65536);
+    SyntheticConfig config = parse_synthetic("mixed,flows=20000");
+    config.packets = packets / 2;
+    run_scenario(stats, config);
+    uint64_t resident = resident_bytes();
+
+    auto start = std::chrono::steady_clock::now();
+    run_scenario(stats, config);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t after = resident_bytes();
+    uint64_t growth = after > resident ? after - resident : 0;
+
+    EXPECT_EQ(stats.dropped_flows(), 0u);
+    EXPECT_LT(growth, 4u << 20);
+    std::cout << "mixed: " << packets / 2 / seconds / 1e6 << " Mpps, RSS growth " << growth / 1024 << " KiB, flows "
+              << stats.flow_count() << std::endl;
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include "../src/include/parser.h"
+#include <vector>
+#include <cstring>
+#include <netinet/in.h>
+
+using Bytes = std::vector<u_char>;
+
+// IPv4 hlavička 10.0.0.1 -> 10.0.0.2 s daným protokolom a dĺžkou transportnej časti
+static Bytes ipv4(uint8_t proto, uint16_t l4_len) {
+    uint16_t total = 20 + l4_len;
+    return {0x45, 0x00, static_cast<u_char>(total >> 8), static_cast<u_char>(total & 0xFF),
+            0x00, 0x01, 0x00, 0x00, 64, proto, 0x00, 0x00,
+            10, 0, 0, 1,
+            10, 0, 0, 2};
+}
+
+// IPv6 hlavička 2001:db8::1 -> 2001:db8::2
+static Bytes ipv6(uint8_t next, uint16_t payload_len) {
+    Bytes b = {0x60, 0, 0, 0, static_cast<u_char>(payload_len >> 8), static_cast<u_char>(payload_len & 0xFF), next, 64};
+    Bytes src = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    Bytes dst = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2};
+    b.insert(b.end(), src.begin(), src.end());
+    b.insert(b.end(), dst.begin(), dst.end());
+    return b;
+}
+
+// TCP hlavička 12345 -> 443 s príznakom SYN
+static Bytes tcp() {
+    return {0x30, 0x39, 0x01, 0xBB, 0, 0, 0, 1, 0, 0, 0, 0, 0x50, 0x02, 0xFF, 0xFF, 0, 0, 0, 0};
+}
+
+// UDP hlavička 5353 -> 53
+static Bytes udp() {
+    return {0x14, 0xE9, 0x00, 0x35, 0x00, 0x08, 0x00, 0x00};
+}
+
+static Bytes ethernet(uint16_t type) {
+    return {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, static_cast<u_char>(type >> 8), static_cast<u_char>(type & 0xFF)};
+}
+
+static Bytes concat(std::initializer_list<Bytes> parts) {
+    Bytes out;
+    for (const auto& p : parts) {
+        out.insert(out.end(), p.begin(), p.end());
+    }
+    return out;
+}
+
+static bool decode(DecodeFn fn, const Bytes& b, PacketInfo& info) {
+    return fn(b.data(), b.size(), info);
+}
+
+TEST(ParserTest, SelectDecoder) {
+    EXPECT_EQ(select_decoder(LINK_EN10MB), &decode_ethernet);
+    EXPECT_EQ(select_decoder(LINK_LINUX_SLL), &decode_linux_sll);
+    EXPECT_EQ(select_decoder(LINK_LINUX_SLL2), &decode_linux_sll2);
+    EXPECT_EQ(select_decoder(LINK_RAW), &decode_raw);
+    EXPECT_EQ(select_decoder(LINK_NULL), &decode_null);
+    EXPECT_EQ(select_decoder(9999), nullptr);
+}
+
+TEST(ParserTest, EthernetIPv4Tcp) {
+    Bytes pkt = concat({ethernet(0x0800), ipv4(IPPROTO_TCP, 20), tcp()});
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_ethernet, pkt, info));
+    EXPECT_EQ(info.key.family, 4);
+    EXPECT_EQ(info.key.proto, IPPROTO_TCP);
+    EXPECT_EQ(info.key.src_port, 12345);
+    EXPECT_EQ(info.key.dst_port, 443);
+    EXPECT_EQ(info.tcp_flags, 0x02);
+    EXPECT_EQ(info.l4_len, 20u);
+    EXPECT_EQ(info.vlan_depth, 0);
+    EXPECT_EQ(info.direction, DIR_UNKNOWN);
+    EXPECT_EQ(info.l3, pkt.data() + 14); // bez kopírovania
+    EXPECT_EQ(format_endpoint(4, info.key.proto, info.key.src, info.key.src_port), "10.0.0.1:12345");
+}
+
+TEST(ParserTest, TcpSequenceAndPayload) {
+    // seq 0x01020304, ack 0xA0B0C0D0, hlavička s 12 bajtmi volieb, 100 bajtov dát
+    Bytes hdr = {0x30, 0x39, 0x01, 0xBB, 0x01, 0x02, 0x03, 0x04, 0xA0, 0xB0, 0xC0, 0xD0, 0x80, 0x18, 0xFF, 0xFF,
+                 0, 0, 0, 0, 1, 1, 8, 10, 0, 0, 0, 0, 0, 0, 0, 0};
+    Bytes pkt = concat({ipv4(IPPROTO_TCP, 32 + 100), hdr, Bytes(100, 0xAA)});
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_raw, pkt, info));
+    EXPECT_EQ(info.tcp_seq, 0x01020304u);
+    EXPECT_EQ(info.tcp_ack, 0xA0B0C0D0u);
+    EXPECT_EQ(info.tcp_payload, 100u);
+    EXPECT_EQ(info.tcp_flags, 0x18);
+
+    // dĺžka dát sa berie z IP hlavičky, aj keď je paket orezaný na hlavičky
+    Bytes truncated(pkt.begin(), pkt.begin() + 20 + 32);
+    ASSERT_TRUE(decode(decode_raw, truncated, info));
+    EXPECT_EQ(info.tcp_payload, 100u);
+}
+
+TEST(ParserTest, EthernetVlan) {
+    Bytes tag = {0x00, 0x64, 0x08, 0x00}; // VLAN 100, vnútri IPv4
+    Bytes pkt = concat({ethernet(0x8100), tag, ipv4(IPPROTO_UDP, 8), udp()});
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_ethernet, pkt, info));
+    EXPECT_EQ(info.vlan_depth, 1);
+    EXPECT_EQ(info.vlan_id, 100);
+    EXPECT_EQ(info.key.proto, IPPROTO_UDP);
+    EXPECT_EQ(info.key.dst_port, 53);
+}
+
+TEST(ParserTest, EthernetQinQ) {
+    Bytes outer = {0x00, 0x0A, 0x81, 0x00}; // S-tag 10
+    Bytes inner = {0x00, 0x14, 0x86, 0xDD}; // C-tag 20, vnútri IPv6
+    Bytes pkt = concat({ethernet(0x88A8), outer, inner, ipv6(IPPROTO_UDP, 8), udp()});
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_ethernet, pkt, info));
+    EXPECT_EQ(info.vlan_depth, 2);
+    EXPECT_EQ(info.vlan_id, 10);
+    EXPECT_EQ(info.key.family, 6);
+    EXPECT_EQ(info.key.src_port, 5353);
+    EXPECT_EQ(format_address(6, info.key.dst), "2001:db8::2");
+}
+
+TEST(ParserTest, LinuxSllOutgoing) {
+    Bytes sll = {0x00, 0x04, 0x00, 0x01, 0x00, 0x06, 1, 2, 3, 4, 5, 6, 0, 0, 0x08, 0x00};
+    Bytes pkt = concat({sll, ipv4(IPPROTO_TCP, 20), tcp()});
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_linux_sll, pkt, info));
+    EXPECT_EQ(info.direction, DIR_OUTGOING);
+    EXPECT_EQ(info.key.dst_port, 443);
+}
+
+TEST(ParserTest, LinuxSll2Incoming) {
+    Bytes sll2 = {0x86, 0xDD, 0, 0, 0, 0, 0, 2, 0x00, 0x01, 0x00, 0x06, 1, 2, 3, 4, 5, 6, 0, 0};
+    Bytes pkt = concat({sll2, ipv6(IPPROTO_TCP, 20), tcp()});
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_linux_sll2, pkt, info));
+    EXPECT_EQ(info.direction, DIR_INCOMING);
+    EXPECT_EQ(info.key.family, 6);
+    EXPECT_EQ(info.key.src_port, 12345);
+}
+
+TEST(ParserTest, RawIPv4AndIPv6) {
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_raw, concat({ipv4(IPPROTO_ICMP, 8), Bytes(8, 0)}), info));
+    EXPECT_EQ(info.key.proto, IPPROTO_ICMP);
+    EXPECT_EQ(info.key.src_port, 0);
+    ASSERT_TRUE(decode(decode_raw, concat({ipv6(IPPROTO_UDP, 8), udp()}), info));
+    EXPECT_EQ(info.key.family, 6);
+    EXPECT_EQ(info.key.dst_port, 53);
+}
+
+TEST(ParserTest, NullLoopback) {
+    Bytes af = {0, 0, 0, 0};
+    uint32_t inet = 2;
+    memcpy(af.data(), &inet, 4);
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_null, concat({af, ipv4(IPPROTO_UDP, 8), udp()}), info));
+    EXPECT_EQ(info.key.family, 4);
+    EXPECT_EQ(info.key.src_port, 5353);
+}
+
+TEST(ParserTest, IPv6ExtensionHeaders) {
+    Bytes hop = {IPPROTO_TCP, 0, 0, 0, 0, 0, 0, 0}; // hop-by-hop, 8 bajtov
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_raw, concat({ipv6(IPPROTO_HOPOPTS, 28), hop, tcp()}), info));
+    EXPECT_EQ(info.key.proto, IPPROTO_TCP);
+    EXPECT_EQ(info.key.dst_port, 443);
+    EXPECT_EQ(info.l4_len, 20u);
+}
+
+TEST(ParserTest, Ipv4FragmentHasNoPorts) {
+    Bytes ip = ipv4(IPPROTO_UDP, 8);
+    ip[6] = 0x00;
+    ip[7] = 0x10; // offset fragmentu 16 * 8 bajtov
+    PacketInfo info;
+    ASSERT_TRUE(decode(decode_raw, concat({ip, udp()}), info));
+    EXPECT_EQ(info.key.proto, IPPROTO_UDP);
+    EXPECT_EQ(info.key.src_port, 0);
+    EXPECT_EQ(info.l4, nullptr);
+}
+
+TEST(ParserTest, TruncatedFramesAreRejected) {
+    Bytes pkt = concat({ethernet(0x0800), ipv4(IPPROTO_TCP, 20), tcp()});
+    PacketInfo info;
+    // rámec orezaný pred koncom IP hlavičky
+    EXPECT_FALSE(decode_ethernet(pkt.data(), 14 + 19, info));
+    EXPECT_FALSE(decode_ethernet(pkt.data(), 10, info));
+    // orezaný VLAN tag
+    Bytes vlan = concat({ethernet(0x8100), Bytes{0x00, 0x64}});
+    EXPECT_FALSE(decode(decode_ethernet, vlan, info));
+    // orezaná TCP hlavička: IP sa spracuje, porty nie
+    ASSERT_TRUE(decode_ethernet(pkt.data(), 14 + 20 + 2, info));
+    EXPECT_EQ(info.key.src_port, 0);
+    EXPECT_EQ(info.l4_caplen, 2u);
+}
+
+TEST(ParserTest, NonIpFramesAreIgnored) {
+    Bytes arp = concat({ethernet(0x0806), Bytes(28, 0)});
+    PacketInfo info;
+    EXPECT_FALSE(decode(decode_ethernet, arp, info));
+    EXPECT_FALSE(decode(decode_raw, Bytes{0x50, 0, 0, 0}, info));
+}
+
+TEST(ParserTest, ParseEndpointRoundTrip) {
+    uint8_t family, addr[16];
+    uint16_t port;
+    ASSERT_TRUE(parse_endpoint("10.0.0.1:443", family, addr, port));
+    EXPECT_EQ(family, 4);
+    EXPECT_EQ(port, 443);
+    EXPECT_EQ(format_endpoint(family, IPPROTO_TCP, addr, port), "10.0.0.1:443");
+
+    ASSERT_TRUE(parse_endpoint("[2001:db8::2]:53", family, addr, port));
+    EXPECT_EQ(family, 6);
+    EXPECT_EQ(port, 53);
+    EXPECT_EQ(format_endpoint(family, IPPROTO_UDP, addr, port), "[2001:db8::2]:53");
+
+    ASSERT_TRUE(parse_endpoint("10.0.0.1:-", family, addr, port));
+    EXPECT_EQ(port, 0);
+    ASSERT_TRUE(parse_endpoint("192.168.1.1", family, addr, port));
+    ASSERT_TRUE(parse_endpoint("fe80::1", family, addr, port));
+    EXPECT_EQ(family, 6);
+    EXPECT_FALSE(parse_endpoint("host:80", family, addr, port));
+    EXPECT_FALSE(parse_endpoint("10.0.0.1:99999", family, addr, port));
+}
+
+TEST(ParserTest, SctpAndUdpLiteEndpointsKeepPorts) {
+    uint8_t family, addr[16];
+    uint16_t port;
+    ASSERT_TRUE(parse_endpoint("10.0.0.1:2905", family, addr, port));
+    EXPECT_EQ(format_endpoint(family, IPPROTO_SCTP, addr, port), "10.0.0.1:2905");
+    EXPECT_EQ(format_endpoint(family, IPPROTO_UDPLITE, addr, port), "10.0.0.1:2905");
+    EXPECT_EQ(format_endpoint(family, IPPROTO_ICMP, addr, port), "10.0.0.1:-");
+
+    // názov protokolu sa dá previesť späť, inak by sa kľúč pripojenia nenašiel v tabuľke
+    EXPECT_EQ(proto_number(proto_name(IPPROTO_SCTP)), IPPROTO_SCTP);
+    EXPECT_EQ(proto_number(proto_name(IPPROTO_UDPLITE)), IPPROTO_UDPLITE);
+}
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+#include "../src/include/procmap.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static const char* TCP_HEADER = "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when retrnsmt   uid  timeout inode";
+
+// Náhradný adresár /proc s tabuľkou soketov a procesmi
+class FakeProc {
+    public:
+        FakeProc() {
+            char tmpl[] = "/tmp/isa-top-procXXXXXX";
+            root = mkdtemp(tmpl);
+            mkdir((root + "/net").c_str(), 0755);
+        }
+        ~FakeProc() {
+            string cmd = "rm -rf " + root;
+            (void)system(cmd.c_str());
+        }
+        void write_tcp(const vector<string>& lines) {
+            ofstream file(root + "/net/tcp");
+            file << TCP_HEADER << "\n";
+            for (const auto& line : lines) {
+                file << line << "\n";
+            }
+        }
+        void add_process(int pid, const string& comm, const vector<unsigned long>& inodes) {
+            string base = root + "/" + to_string(pid);
+            mkdir(base.c_str(), 0755);
+            mkdir((base + "/fd").c_str(), 0755);
+            ofstream(base + "/comm") << comm << "\n";
+            int fd = 3;
+            for (unsigned long inode : inodes) {
+                string target = "socket:[" + to_string(inode) + "]";
+                (void)symlink(target.c_str(), (base + "/fd/" + to_string(fd++)).c_str());
+            }
+        }
+        void remove_process(int pid) {
+            string cmd = "rm -rf " + root + "/" + to_string(pid);
+            (void)system(cmd.c_str());
+        }
+        string root;
+};
+
+// Riadok /proc/net/tcp pre soket počúvajúci na 127.0.0.1:port
+static string tcp_line(int slot, uint16_t port, unsigned long inode) {
+    char line[256];
+    snprintf(line, sizeof(line), "%4d: 0100007F:%04X 00000000:0000 0A 00000000:00000000 00:00000000 00000000  1000        0 %lu 1 0000000000000000 100 0 0 10 0",
+             slot, port, inode);
+    return line;
+}
+
+static bool lookup_v4(ProcessMap& map, const char* ip, uint16_t port, ProcessInfo& out) {
+    uint8_t addr[16] = {0};
+    inet_pton(AF_INET, ip, addr);
+    return map.lookup(4, IPPROTO_TCP, addr, port, out);
+}
+
+TEST(ProcMapTest, ParseIPv4Line) {
+    SocketKey key;
+    unsigned long inode = 0;
+    ASSERT_TRUE(parse_proc_net_line(tcp_line(0, 3306, 12345), 4, IPPROTO_TCP, key, inode));
+    EXPECT_EQ(key.family, 4);
+    EXPECT_EQ(key.proto, IPPROTO_TCP);
+    EXPECT_EQ(key.port, 3306);
+    EXPECT_EQ(inode, 12345u);
+    const uint8_t expected[4] = {127, 0, 0, 1};
+    EXPECT_EQ(memcmp(key.addr, expected, 4), 0);
+}
+
+TEST(ProcMapTest, ParseIPv6Line) {
+    SocketKey key;
+    unsigned long inode = 0;
+    string line = "   1: 00000000000000000000000001000000:0050 00000000000000000000000000000000:0000 0A 00000000:00000000 00:00000000 00000000     0        0 777 1 0000000000000000 100 0 0 10 0";
+    ASSERT_TRUE(parse_proc_net_line(line, 6, IPPROTO_TCP, key, inode));
+    uint8_t expected[16] = {0};
+    inet_pton(AF_INET6, "::1", expected);
+    EXPECT_EQ(memcmp(key.addr, expected, 16), 0);
+    EXPECT_EQ(key.port, 80);
+    EXPECT_EQ(inode, 777u);
+}
+
+TEST(ProcMapTest, RejectsHeaderAndGarbage) {
+    SocketKey key;
+    unsigned long inode;
+    EXPECT_FALSE(parse_proc_net_line(TCP_HEADER, 4, IPPROTO_TCP, key, inode));
+    EXPECT_FALSE(parse_proc_net_line("", 4, IPPROTO_TCP, key, inode));
+    // IPv4 riadok v súbore tcp6 má nesprávnu dĺžku adresy
+    EXPECT_FALSE(parse_proc_net_line(tcp_line(0, 80, 1), 6, IPPROTO_TCP, key, inode));
+}
+
+TEST(ProcMapTest, ResolvesSocketOwner) {
+    FakeProc proc;
+    proc.write_tcp({tcp_line(0, 8080, 1001)});
+    proc.add_process(42, "nginx", {1001});
+
+    ProcessMap map(proc.root);
+    map.refresh();
+
+    ProcessInfo info;
+    ASSERT_TRUE(lookup_v4(map, "127.0.0.1", 8080, info));
+    EXPECT_EQ(info.pid, 42);
+    EXPECT_EQ(info.comm, "nginx");
+    EXPECT_FALSE(lookup_v4(map, "127.0.0.1", 8081, info));
+}
+
+TEST(ProcMapTest, RefreshIsIncremental) {
+    FakeProc proc;
+    proc.write_tcp({tcp_line(0, 8080, 1001)});
+    proc.add_process(42, "nginx", {1001});
+    proc.add_process(43, "bash", {});
+
+    ProcessMap map(proc.root);
+    map.refresh();
+    EXPECT_EQ(map.scanned_pids(), 2u);
+
+    // nič nové, žiadny proces sa neprehľadáva znova
+    map.refresh();
+    EXPECT_EQ(map.scanned_pids(), 2u);
+
+    // nový proces s novým soketom sa prehľadá sám
+    proc.write_tcp({tcp_line(0, 8080, 1001), tcp_line(1, 5432, 1002)});
+    proc.add_process(50, "postgres", {1002});
+    map.refresh();
+    EXPECT_EQ(map.scanned_pids(), 3u);
+
+    ProcessInfo info;
+    ASSERT_TRUE(lookup_v4(map, "127.0.0.1", 5432, info));
+    EXPECT_EQ(info.comm, "postgres");
+}
+
+TEST(ProcMapTest, NewSocketRescansSocketOwnersFirst) {
+    FakeProc proc;
+    proc.write_tcp({tcp_line(0, 8080, 1001)});
+    proc.add_process(42, "nginx", {1001});
+    for (int pid = 100; pid < 110; pid++) {
+        proc.add_process(pid, "bash", {});
+    }
+
+    ProcessMap map(proc.root);
+    map.refresh();
+    EXPECT_EQ(map.scanned_pids(), 11u);
+
+    // nové spojenie existujúceho procesu: prehľadá sa iba proces, ktorý už sokety mal
+    proc.write_tcp({tcp_line(0, 8080, 1001), tcp_line(1, 8081, 1002)});
+    (void)symlink("socket:[1002]", (proc.root + "/42/fd/4").c_str());
+    map.refresh();
+    EXPECT_EQ(map.scanned_pids(), 12u);
+
+    ProcessInfo info;
+    ASSERT_TRUE(lookup_v4(map, "127.0.0.1", 8081, info));
+    EXPECT_EQ(info.pid, 42);
+
+    // soket procesu bez soketov sa nájde až v ostatných procesoch
+    proc.write_tcp({tcp_line(0, 8080, 1001), tcp_line(1, 8081, 1002), tcp_line(2, 9000, 1003)});
+    (void)symlink("socket:[1003]", (proc.root + "/105/fd/3").c_str());
+    map.refresh();
+    ASSERT_TRUE(lookup_v4(map, "127.0.0.1", 9000, info));
+    EXPECT_EQ(info.pid, 105);
+}
+
+TEST(ProcMapTest, DeadProcessIsForgotten) {
+    FakeProc proc;
+    proc.write_tcp({tcp_line(0, 8080, 1001)});
+    proc.add_process(42, "nginx", {1001});
+
+    ProcessMap map(proc.root);
+    map.refresh();
+    ProcessInfo info;
+    ASSERT_TRUE(lookup_v4(map, "127.0.0.1", 8080, info));
+
+    proc.remove_process(42);
+    map.refresh();
+    EXPECT_FALSE(lookup_v4(map, "127.0.0.1", 8080, info));
+}
+
+TEST(ProcMapTest, WildcardListenerMatchesAnyAddress) {
+    FakeProc proc;
+    proc.write_tcp({"   0: 00000000:0016 00000000:0000 0A 00000000:00000000 00:00000000 00000000     0        0 2001 1 0000000000000000 100 0 0 10 0"});
+    proc.add_process(1, "sshd", {2001});
+
+    ProcessMap map(proc.root);
+    map.refresh();
+    ProcessInfo info;
+    ASSERT_TRUE(lookup_v4(map, "192.168.1.10", 22, info));
+    EXPECT_EQ(info.comm, "sshd");
+}
+
+TEST(ProcMapTest, FindsOwnListeningSocket) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(fd, 1), 0);
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len);
+
+    ProcessMap map;
+    map.refresh();
+    ProcessInfo info;
+    bool found = lookup_v4(map, "127.0.0.1", ntohs(addr.sin_port), info);
+    close(fd);
+    ASSERT_TRUE(found);
+    EXPECT_EQ(info.pid, getpid());
+}
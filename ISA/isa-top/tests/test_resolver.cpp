@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "../src/include/resolver.h"
+#include <atomic>
+#include <thread>
+
+// Opakované volanie lookup, kým preklad na pozadí neskončí
+static string wait_lookup(Resolver& resolver, const string& ip) {
+    for (int i = 0; i < 200; i++) {
+        string name = resolver.lookup(ip);
+        if (!name.empty()) {
+            return name;
+        }
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    return "";
+}
+
+TEST(ResolverTest, DisabledDoesNotResolve) {
+    atomic<int> calls{0};
+    Resolver resolver(16, 1, chrono::seconds(60), chrono::seconds(60), [&](const string&) {
+        calls++;
+        return string("host");
+    });
+    EXPECT_EQ(resolver.lookup("10.0.0.1"), "");
+    this_thread::sleep_for(chrono::milliseconds(20));
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(resolver.size(), 0u);
+}
+
+TEST(ResolverTest, LookupIsAsynchronousAndCached) {
+    atomic<int> calls{0};
+    Resolver resolver(16, 2, chrono::seconds(60), chrono::seconds(60), [&](const string& ip) {
+        calls++;
+        this_thread::sleep_for(chrono::milliseconds(50)); // pomalý DNS server
+        return "host-" + ip;
+    });
+    resolver.set_enabled(true);
+
+    auto start = chrono::steady_clock::now();
+    EXPECT_EQ(resolver.lookup("10.0.0.1"), ""); // prvé volanie neblokuje
+    EXPECT_LT(chrono::steady_clock::now() - start, chrono::milliseconds(40));
+
+    EXPECT_EQ(wait_lookup(resolver, "10.0.0.1"), "host-10.0.0.1");
+    EXPECT_EQ(resolver.lookup("10.0.0.1"), "host-10.0.0.1");
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ResolverTest, NegativeResultsAreCached) {
+    atomic<int> calls{0};
+    Resolver resolver(16, 1, chrono::seconds(60), chrono::seconds(60), [&](const string&) {
+        calls++;
+        return string("");
+    });
+    resolver.set_enabled(true);
+    resolver.lookup("192.0.2.1");
+    this_thread::sleep_for(chrono::milliseconds(50));
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(resolver.lookup("192.0.2.1"), "");
+    }
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(ResolverTest, ExpiredEntriesAreRefreshed) {
+    atomic<int> calls{0};
+    Resolver resolver(16, 1, chrono::seconds(0), chrono::seconds(0), [&](const string&) {
+        calls++;
+        return "name" + to_string(calls.load());
+    });
+    resolver.set_enabled(true);
+    EXPECT_EQ(wait_lookup(resolver, "10.0.0.1"), "name1");
+    // TTL 0: každé ďalšie volanie vráti posledné známe meno a naplánuje nový preklad
+    string name;
+    for (int i = 0; i < 200 && (name.empty() || name == "name1"); i++) {
+        this_thread::sleep_for(chrono::milliseconds(5));
+        name = resolver.lookup("10.0.0.1");
+    }
+    EXPECT_NE(name, "name1");
+    EXPECT_FALSE(name.empty());
+    EXPECT_GE(calls, 2);
+}
+
+TEST(ResolverTest, CacheIsBounded) {
+    Resolver resolver(4, 1, chrono::seconds(60), chrono::seconds(60), [](const string& ip) { return ip; });
+    resolver.set_enabled(true);
+    for (int i = 0; i < 10; i++) {
+        wait_lookup(resolver, "10.0.0." + to_string(i));
+    }
+    EXPECT_LE(resolver.size(), 4u);
+    // naposledy použitá adresa zostáva v cache
+    EXPECT_EQ(resolver.lookup("10.0.0.9"), "10.0.0.9");
+}
+
+TEST(ResolverTest, ResolvesFromHostsFile) {
+    // 127.0.0.1 je v /etc/hosts, preklad funguje aj bez siete
+    EXPECT_FALSE(reverse_lookup("127.0.0.1").empty());
+    EXPECT_EQ(reverse_lookup("not-an-address"), "");
+}
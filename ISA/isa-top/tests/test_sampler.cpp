@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include "../src/include/sampler.h"
+#include "../src/include/stats.h"
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+/**
+    Paket vygenerovanej stopy
+ */
+struct TracePacket {
+    FlowKey key;
+    uint32_t bytes;
+    int64_t ts;
+};
+
+/**
+    Stopa s 40 tokmi s rozdelením veľkostí podobným reálnej prevádzke (veľa tokov málo paketov, pár veľkých tokov),
+    veľkosti paketov sú zmesou malých (ACK) a plných segmentov
+ */
+static std::vector<TracePacket> make_trace() {
+    std::vector<TracePacket> trace;
+    uint64_t seed = 42;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<uint32_t>(seed >> 33);
+    };
+    int64_t ts = 1700000000LL * 1000000;
+    for (int flow = 0; flow < 40; flow++) {
+        FlowKey key;
+        memset(&key, 0, sizeof(key));
+        key.family = 4;
+        key.proto = IPPROTO_TCP;
+        key.src_port = static_cast<uint16_t>(30000 + flow);
+        key.dst_port = 443;
+        key.src[0] = 10; key.src[3] = 1;
+        key.dst[0] = 10; key.dst[3] = 2;
+        int packets = 40000 / (flow + 1);
+        for (int i = 0; i < packets; i++) {
+            uint32_t bytes = next() % 3 == 0 ? 66 : 1000 + next() % 515;
+            trace.push_back({key, bytes, ts++});
+        }
+    }
+    // premiešanie tokov v čase
+    for (size_t i = trace.size() - 1; i > 0; i--) {
+        std::swap(trace[i], trace[next() % (i + 1)]);
+    }
+    return trace;
+}
+
+/**
+    Prehranie stopy so vzorkovaním a porovnanie odhadov s presnými hodnotami
+    @return podiel tokov, ktorých presná hodnota leží v 95 % intervale spoľahlivosti (bajty aj pakety)
+ */
+static double replay_coverage(SampleMode mode, uint32_t rate, double& total_error) {
+    std::vector<TracePacket> trace = make_trace();
+    Stats exact(256), sampled(256);
+    sampled.set_sample_rate(rate);
+    Sampler sampler(rate, mode, 12345);
+    for (const TracePacket& p : trace) {
+        exact.update(p.key, p.bytes, true, p.ts);
+        if (sampler.take()) {
+            sampled.update(p.key, p.bytes, true, p.ts);
+        }
+    }
+
+    auto truth = exact.get_stats_snapshot();
+    auto estimate = sampled.get_stats_snapshot();
+    int checked = 0, covered = 0;
+    double exact_total = 0, estimated_total = 0;
+    for (const auto& [key, stats] : truth) {
+        exact_total += stats.tx_bytes;
+        auto it = estimate.find(key);
+        double est_bytes = it != estimate.end() ? it->second.tx_bytes : 0;
+        estimated_total += est_bytes;
+        if (stats.tx_packets < 20 * rate || it == estimate.end()) {
+            continue; // pri pár vybraných paketoch normálna aproximácia neplatí
+        }
+        checked += 2;
+        covered += std::abs(est_bytes - stats.tx_bytes) <= confidence_95(it->second.tx_bytes_var);
+        covered += std::abs(it->second.tx_packets - stats.tx_packets) <= confidence_95(it->second.tx_packets_var);
+    }
+    EXPECT_GT(checked, 20);
+    total_error = std::abs(estimated_total - exact_total) / exact_total;
+    return static_cast<double>(covered) / checked;
+}
+
+TEST(SamplerTest, CountTakesEveryNth) {
+    Sampler sampler(4, SAMPLE_COUNT);
+    int taken = 0;
+    for (int i = 1; i <= 100; i++) {
+        bool take = sampler.take();
+        EXPECT_EQ(take, i % 4 == 0) << i;
+        taken += take;
+    }
+    EXPECT_EQ(taken, 25);
+
+    Sampler all(1, SAMPLE_RANDOM);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(all.take());
+    }
+}
+
+TEST(SamplerTest, RandomRate) {
+    Sampler sampler(10, SAMPLE_RANDOM, 7);
+    int taken = 0;
+    const int n = 1000000;
+    for (int i = 0; i < n; i++) {
+        taken += sampler.take();
+    }
+    // binomické rozdelenie, smerodajná odchýlka 300
+    EXPECT_NEAR(taken, n / 10, 1500);
+}
+
+TEST(SamplerTest, ReplayedTraceRandom) {
+    double total_error;
+    double coverage = replay_coverage(SAMPLE_RANDOM, 10, total_error);
+    // nominálne pokrytie je 95 %, tolerancia pre konečný počet tokov
+    EXPECT_GE(coverage, 0.85);
+    EXPECT_LT(total_error, 0.02);
+}
+
+TEST(SamplerTest, ReplayedTraceCount) {
+    double total_error;
+    // pri premiešanej stope sa každý N-tý paket správa ako náhodný výber, rozptyl je skôr nadhodnotený
+    double coverage = replay_coverage(SAMPLE_COUNT, 10, total_error);
+    EXPECT_GE(coverage, 0.85);
+    EXPECT_LT(total_error, 0.02);
+}
+
+TEST(SamplerTest, SnapshotIsScaled) {
+    Stats stats(64);
+    stats.set_sample_rate(5);
+    EXPECT_EQ(stats.sample_rate(), 5u);
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 100, 1, true);
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 100, 1, true);
+    auto snapshot = stats.get_stats_snapshot();
+    const ConnectionStats& conn = snapshot[{"10.0.0.1:1000", "10.0.0.2:80", "tcp"}];
+    EXPECT_DOUBLE_EQ(conn.tx_packets, 10);
+    EXPECT_DOUBLE_EQ(conn.tx_bytes, 1000);
+    EXPECT_DOUBLE_EQ(conn.tx_packets_var, 2 * 5 * 4);
+    EXPECT_GT(conn.tx_bytes_var, 0);
+    EXPECT_DOUBLE_EQ(conn.rx_bytes_var, 0);
+
+    // bez vzorkovania sú hodnoty presné
+    Stats exact(64);
+    EXPECT_EQ(exact.sample_rate(), 1u);
+    exact.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 100, 1, true);
+    ConnectionKey key{"10.0.0.1:1000", "10.0.0.2:80", "tcp"};
+    EXPECT_DOUBLE_EQ(exact.get_stats_snapshot()[key].tx_bytes_var, 0);
+}
+
+TEST(SamplerTest, KernelFilter) {
+    // filter sa dá pripojiť aj na obyčajný UDP soket, pakety prichádzajú cez loopback
+    int rx = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(rx, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(rx, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)), 0);
+    socklen_t len = sizeof(addr);
+    getsockname(rx, reinterpret_cast<struct sockaddr*>(&addr), &len);
+
+    EXPECT_FALSE(attach_kernel_sampler(rx, 1));
+    if (!attach_kernel_sampler(rx, 4)) {
+        close(rx);
+        close(tx);
+        GTEST_SKIP() << "SO_ATTACH_FILTER with SKF_AD_RANDOM not available";
+    }
+
+    int received = 0;
+    const int sent = 8000;
+    char buf[64] = {0};
+    for (int i = 0; i < sent; i++) {
+        sendto(tx, buf, sizeof(buf), 0, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        // priebežné čítanie, aby sa neprekročil prijímací buffer
+        if (i % 100 == 99) {
+            while (recv(rx, buf, sizeof(buf), 0) > 0) {
+                received++;
+            }
+        }
+    }
+    close(rx);
+    close(tx);
+    // binomické rozdelenie so strednou hodnotou 2000 a smerodajnou odchýlkou ~39
+    EXPECT_NEAR(received, sent / 4, 250);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "../src/include/stats.h"
+#include <cstring>
+#include <unistd.h>
+#include <netinet/in.h>
 class StatsTest : public ::testing::Test {
 protected:
     Stats stats;
@@ -28,4 +31,83 @@ TEST_F(StatsTest, UpdateAndRetrieveStats) {
 TEST_F(StatsTest, NoStatsInitially) {
     auto snapshot = stats.get_stats_snapshot();
     EXPECT_TRUE(snapshot.empty());
-}
\ No newline at end of file
+}
+TEST_F(StatsTest, EndpointsWithPortsRoundTrip) {
+    stats.update("[2001:db8::2]:5000", "[2001:db8::1]:443", "tcp", 100, 1, false);
+    stats.update("10.0.0.1:-", "10.0.0.2:-", "icmp", 64, 1, true);
+
+    auto snapshot = stats.get_stats_snapshot();
+    ConnectionKey tcp_key = {"[2001:db8::2]:5000", "[2001:db8::1]:443", "tcp"};
+    ConnectionKey icmp_key = {"10.0.0.1:-", "10.0.0.2:-", "icmp"};
+    ASSERT_TRUE(snapshot.find(tcp_key) != snapshot.end());
+    ASSERT_TRUE(snapshot.find(icmp_key) != snapshot.end());
+    EXPECT_EQ(snapshot[tcp_key].rx_bytes, 100);
+    EXPECT_EQ(snapshot[icmp_key].tx_packets, 1);
+}
+
+TEST_F(StatsTest, BinaryUpdateMatchesStringKey) {
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    key.family = 4;
+    key.proto = IPPROTO_UDP;
+    key.src_port = 53;
+    key.dst_port = 40000;
+    const uint8_t src[4] = {8, 8, 8, 8};
+    const uint8_t dst[4] = {192, 168, 1, 10};
+    memcpy(key.src, src, 4);
+    memcpy(key.dst, dst, 4);
+
+    stats.update(key, 120, false, 1000000);
+    stats.update(key, 80, false, 2000000);
+    stats.update("8.8.8.8:53", "192.168.1.10:40000", "udp", 50, 1, false);
+
+    EXPECT_EQ(stats.flow_count(), 1u);
+    auto snapshot = stats.get_stats_snapshot();
+    ConnectionKey conn = {"8.8.8.8:53", "192.168.1.10:40000", "udp"};
+    EXPECT_EQ(snapshot[conn].rx_bytes, 250);
+    EXPECT_EQ(snapshot[conn].rx_packets, 3);
+}
+
+TEST(StatsFileTest, RestartContinuesFromTable) {
+    char tmpl[] = "/tmp/isa-top-statsXXXXXX";
+    close(mkstemp(tmpl));
+    unlink(tmpl);
+    {
+        Stats stats(tmpl, 64);
+        EXPECT_FALSE(stats.restored());
+        stats.update("192.168.1.1:80", "192.168.1.2:5000", "tcp", 500, 1, true);
+    }
+    Stats stats(tmpl, 64);
+    EXPECT_TRUE(stats.restored());
+    stats.update("192.168.1.1:80", "192.168.1.2:5000", "tcp", 300, 1, true);
+    auto snapshot = stats.get_stats_snapshot();
+    ConnectionKey key = {"192.168.1.1:80", "192.168.1.2:5000", "tcp"};
+    EXPECT_EQ(snapshot[key].tx_bytes, 800);
+    EXPECT_EQ(snapshot[key].tx_packets, 2);
+    unlink(tmpl);
+}
+
+TEST_F(StatsTest, MarkTopFlowsFlagsBothDirections) {
+    FlowKey big;
+    memset(&big, 0, sizeof(big));
+    big.family = 4;
+    big.proto = IPPROTO_TCP;
+    big.src_port = 443;
+    big.dst_port = 50000;
+    big.src[0] = 1;
+    big.dst[0] = 2;
+    FlowKey small = big;
+    small.src_port = 80;
+
+    stats.update(big, 1500, false, 1);
+    stats.update(reverse_key(big), 60, true, 2);
+    stats.update(small, 100, false, 3);
+
+    stats.mark_top_flows(1, 'b');
+    EXPECT_TRUE(stats.update(big, 1500, false, 4) & FLOW_DUMP);
+    EXPECT_TRUE(stats.update(reverse_key(big), 60, true, 5) & FLOW_DUMP);
+    EXPECT_FALSE(stats.update(small, 100, false, 6) & FLOW_DUMP);
+
+    stats.mark_top_flows(0, 'b');
+    EXPECT_FALSE(stats.update(big, 1500, false, 7) & FLOW_DUMP);
+}
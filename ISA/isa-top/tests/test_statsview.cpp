@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include "../src/include/statsview.h"
+#include <atomic>
+#include <thread>
+
+static const int64_t T0 = 1700000000LL * 1000000;
+
+// Overenie zoradenia riadkov zostupne podľa bajtov alebo paketov
+static bool sorted_desc(const std::vector<ViewRow>& rows, bool by_bytes) {
+    for (size_t i = 1; i < rows.size(); i++) {
+        const ConnectionStats& a = rows[i - 1].second;
+        const ConnectionStats& b = rows[i].second;
+        double va = by_bytes ? a.rx_bytes + a.tx_bytes : a.rx_packets + a.tx_packets;
+        double vb = by_bytes ? b.rx_bytes + b.tx_bytes : b.rx_packets + b.tx_packets;
+        if (va < vb) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(StatsViewTest, MergedAndSorted) {
+    Stats stats(1024);
+    // jeden veľký paket proti mnohým malým
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 9000, 1, true);
+    for (int i = 0; i < 10; i++) {
+        stats.update("10.0.0.3:2000", "10.0.0.4:53", "udp", 60, 1, true);
+        stats.update("10.0.0.4:53", "10.0.0.3:2000", "udp", 100, 1, false);
+    }
+
+    auto view = build_view(stats, 7);
+    EXPECT_EQ(view->sequence, 7u);
+    ASSERT_EQ(view->by_bytes.size(), 2u);
+    ASSERT_EQ(view->by_packets.size(), 2u);
+    // oba smery udp toku v jednom riadku
+    EXPECT_EQ(view->by_packets[0].first, (ConnectionKey{"10.0.0.3:2000", "10.0.0.4:53", "udp"}));
+    EXPECT_DOUBLE_EQ(view->by_packets[0].second.tx_packets + view->by_packets[0].second.rx_packets, 20);
+    EXPECT_DOUBLE_EQ(view->by_packets[0].second.tx_bytes + view->by_packets[0].second.rx_bytes, 1600);
+    EXPECT_EQ(view->flows('b')[0].first.proto, "tcp");
+    EXPECT_EQ(view->flows('p')[0].first.proto, "udp");
+    EXPECT_TRUE(view->networks('b').empty());
+}
+
+TEST(StatsViewTest, CarriesRecordsAndDetails) {
+    Stats stats(1024);
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 100, 1, true);
+    stats.update("10.0.0.2:80", "10.0.0.1:1000", "tcp", 1500, 1, false);
+    stats.update("10.0.0.3:2000", "10.0.0.4:53", "udp", 60, 1, true);
+    ConnectionKey tcp{"10.0.0.1:1000", "10.0.0.2:80", "tcp"};
+    ASSERT_TRUE(stats.watch(tcp));
+    stats.set_filter(std::make_shared<const FlowFilter>("tcp"));
+
+    auto view = build_view(stats, 1);
+    // záznamy a počítadlá tabuľky sú bez filtra, riadky s filtrom
+    EXPECT_EQ(view->records.size(), 3u);
+    EXPECT_EQ(view->flow_count, 3u);
+    EXPECT_EQ(view->dropped_flows, 0u);
+    ASSERT_NE(view->filter, nullptr);
+    EXPECT_EQ(view->by_bytes.size(), 1u);
+
+    // hodnoty sa čítajú z pohľadu aj po zmene štatistík
+    FlowKey key;
+    ASSERT_TRUE(parse_connection_key(tcp, key));
+    stats.update(key, 100, true, T0);
+    FlowHistograms hist;
+    ASSERT_TRUE(view->histograms({"10.0.0.2:80", "10.0.0.1:1000", "tcp"}, hist));
+    uint32_t packets = 0;
+    for (size_t i = 0; i < SIZE_BUCKETS; i++) {
+        packets += hist.size[i];
+    }
+    EXPECT_EQ(packets, 2u);
+    TcpSummary summary;
+    EXPECT_TRUE(view->tcp_stats(tcp, summary));
+    EXPECT_FALSE(view->tcp_stats({"10.0.0.3:2000", "10.0.0.4:53", "udp"}, summary));
+    FlowDetail detail;
+    EXPECT_TRUE(view->flow_detail(tcp, detail));
+    EXPECT_EQ(detail.packets, 0u);
+    EXPECT_NE(detail.first_seen, 0);
+    EXPECT_FALSE(view->flow_detail({"10.0.0.3:2000", "10.0.0.4:53", "udp"}, detail));
+
+    auto next = build_view(stats, 2);
+    ASSERT_TRUE(next->flow_detail(tcp, detail));
+    EXPECT_EQ(detail.packets, 1u);
+    EXPECT_EQ(detail.bytes, 100u);
+}
+
+TEST(StatsViewTest, PublishKeepsOldViewAlive) {
+    Stats stats(1024);
+    ViewPublisher views(stats, std::chrono::seconds(60));
+    EXPECT_EQ(views.latest()->sequence, 0u);
+    EXPECT_TRUE(views.latest()->by_bytes.empty());
+
+    stats.update("10.0.0.1:1000", "10.0.0.2:80", "tcp", 100, 1, true);
+    views.start();
+    std::shared_ptr<const StatsView> old = views.latest();
+    EXPECT_EQ(old->sequence, 1u);
+    std::weak_ptr<const StatsView> weak = old;
+
+    stats.update("10.0.0.1:1001", "10.0.0.2:80", "tcp", 100, 1, true);
+    EXPECT_EQ(views.publish(), 2u);
+    // čitateľ, ktorý drží starý pohľad, ho vidí nezmenený
+    EXPECT_EQ(old->by_bytes.size(), 1u);
+    EXPECT_EQ(views.latest()->by_bytes.size(), 2u);
+    old.reset();
+    EXPECT_TRUE(weak.expired());
+    views.stop();
+    EXPECT_EQ(views.latest()->sequence, 2u);
+}
+
+TEST(StatsViewTest, ConcurrentReaders) {
+    // zachytávanie, agregátor, ručné publikovanie a čitatelia naraz (spúšťa sa aj pod ThreadSanitizerom, make tsan)
+    Stats stats(4096);
+    ViewPublisher views(stats, std::chrono::milliseconds(1));
+    views.start();
+    std::weak_ptr<const StatsView> first = views.latest();
+    std::atomic<bool> done(false);
+
+    std::thread writer([&]() {
+        FlowKey key;
+        memset(&key, 0, sizeof(key));
+        key.family = 4;
+        key.proto = 17;
+        key.src[0] = 10;
+        key.dst[0] = 10;
+        key.dst[3] = 1;
+        key.dst_port = 53;
+        for (uint32_t i = 0; !done.load(); i++) {
+            key.src_port = static_cast<uint16_t>(1000 + i % 500);
+            stats.update(key, 100 + i % 1400, (i & 1) != 0, T0 + i);
+        }
+    });
+    std::thread republisher([&]() {
+        while (!done.load()) {
+            views.publish();
+            std::this_thread::sleep_for(std::chrono::microseconds(300));
+        }
+    });
+
+    std::atomic<uint64_t> reads(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&]() {
+            uint64_t last = 0;
+            while (!done.load()) {
+                std::shared_ptr<const StatsView> view = views.latest();
+                // poradové čísla sa pre čitateľa nevracajú a pohľad je vnútorne konzistentný
+                EXPECT_GE(view->sequence, last);
+                last = view->sequence;
+                EXPECT_EQ(view->by_bytes.size(), view->by_packets.size());
+                EXPECT_TRUE(sorted_desc(view->by_bytes, true));
+                EXPECT_TRUE(sorted_desc(view->by_packets, false));
+                reads++;
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    done = true;
+    writer.join();
+    republisher.join();
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    views.stop();
+
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_GT(views.latest()->sequence, 2u);
+    EXPECT_FALSE(views.latest()->by_bytes.empty());
+    // staré pohľady sa uvoľnili, keď ich pustil posledný čitateľ
+    EXPECT_TRUE(first.expired());
+}
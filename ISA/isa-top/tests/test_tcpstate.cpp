@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "../src/include/stats.h"
+#include <vector>
+#include <netinet/in.h>
+
+using Bytes = std::vector<u_char>;
+
+static const int64_t T0 = 1700000000LL * 1000000;
+
+// IPv4/TCP paket medzi 10.0.0.1:40000 (klient) a 10.0.0.2:443 (server) s daným smerom, príznakmi a dátami
+static Bytes segment(bool from_client, uint8_t flags, uint32_t seq, uint32_t ack, uint16_t payload) {
+    uint16_t total = static_cast<uint16_t>(20 + 20 + payload);
+    u_char a = from_client ? 1 : 2, b = from_client ? 2 : 1;
+    uint16_t sport = from_client ? 40000 : 443, dport = from_client ? 443 : 40000;
+    Bytes pkt = {0x45, 0x00, static_cast<u_char>(total >> 8), static_cast<u_char>(total & 0xFF),
+                 0x00, 0x01, 0x00, 0x00, 64, IPPROTO_TCP, 0x00, 0x00,
+                 10, 0, 0, a,
+                 10, 0, 0, b,
+                 static_cast<u_char>(sport >> 8), static_cast<u_char>(sport & 0xFF),
+                 static_cast<u_char>(dport >> 8), static_cast<u_char>(dport & 0xFF),
+                 static_cast<u_char>(seq >> 24), static_cast<u_char>(seq >> 16), static_cast<u_char>(seq >> 8), static_cast<u_char>(seq),
+                 static_cast<u_char>(ack >> 24), static_cast<u_char>(ack >> 16), static_cast<u_char>(ack >> 8), static_cast<u_char>(ack),
+                 0x50, flags, 0xFF, 0xFF, 0, 0, 0, 0};
+    pkt.insert(pkt.end(), payload, 0);
+    return pkt;
+}
+
+/**
+    Prehranie vytvorenej sekvencie paketov cez parser a Stats tak, ako to robí packet_handler
+ */
+class TcpReplay {
+public:
+    void send(bool from_client, uint8_t flags, uint32_t seq, uint32_t ack, uint16_t payload, int64_t ts) {
+        Bytes pkt = segment(from_client, flags, seq, ack, payload);
+        PacketInfo info;
+        ASSERT_TRUE(decode_raw(pkt.data(), static_cast<uint32_t>(pkt.size()), info));
+        stats.update(info, static_cast<uint32_t>(pkt.size()), from_client, ts);
+    }
+
+    TcpSummary summary() {
+        TcpSummary out{0, 0, 0};
+        EXPECT_TRUE(stats.get_tcp_stats({"10.0.0.2:443", "10.0.0.1:40000", "tcp"}, out));
+        return out;
+    }
+
+    Stats stats{64};
+};
+
+static const uint8_t SYN = TCPF_SYN, ACK = TCPF_ACK, SYNACK = TCPF_SYN | TCPF_ACK, FIN = TCPF_FIN | TCPF_ACK;
+
+TEST(TcpStateTest, HandshakeRtt) {
+    TcpReplay r;
+    r.send(true, SYN, 1000, 0, 0, T0);
+    r.send(false, SYNACK, 5000, 1001, 0, T0 + 12000);
+    r.send(true, ACK, 1001, 5001, 0, T0 + 12300);
+    // ďalšie ACK už meranie nemení
+    r.send(true, ACK, 1001, 5001, 0, T0 + 50000);
+
+    TcpSummary s = r.summary();
+    EXPECT_EQ(s.rtt_usec, 12300u);
+    EXPECT_EQ(s.retransmissions, 0u);
+    EXPECT_EQ(s.out_of_order, 0u);
+}
+
+TEST(TcpStateTest, RetransmittedSynRestartsMeasurement) {
+    TcpReplay r;
+    r.send(true, SYN, 1000, 0, 0, T0);
+    r.send(true, SYN, 1000, 0, 0, T0 + 1000000);
+    r.send(false, SYNACK, 5000, 1001, 0, T0 + 1020000);
+    r.send(true, ACK, 1001, 5001, 0, T0 + 1020100);
+
+    TcpSummary s = r.summary();
+    EXPECT_EQ(s.rtt_usec, 20100u);
+    EXPECT_EQ(s.retransmissions, 1u);
+}
+
+TEST(TcpStateTest, InOrderDataAndPureAcks) {
+    TcpReplay r;
+    r.send(true, SYN, 1000, 0, 0, T0);
+    r.send(false, SYNACK, 5000, 1001, 0, T0 + 100);
+    r.send(true, ACK, 1001, 5001, 0, T0 + 200);
+    uint32_t seq = 1001;
+    for (int i = 0; i < 20; i++) {
+        r.send(true, ACK, seq, 5001, 1000, T0 + 300 + i);
+        r.send(false, ACK, 5001, seq + 1000, 0, T0 + 400 + i);
+        seq += 1000;
+    }
+    r.send(true, FIN, seq, 5001, 0, T0 + 1000);
+    r.send(false, FIN, 5001, seq + 1, 0, T0 + 1100);
+    r.send(true, ACK, seq + 1, 5002, 0, T0 + 1200);
+
+    TcpSummary s = r.summary();
+    EXPECT_EQ(s.retransmissions, 0u);
+    EXPECT_EQ(s.out_of_order, 0u);
+}
+
+TEST(TcpStateTest, Retransmission) {
+    TcpReplay r;
+    r.send(true, ACK, 1000, 1, 100, T0);
+    r.send(true, ACK, 1100, 1, 100, T0 + 10);
+    r.send(true, ACK, 1000, 1, 100, T0 + 200000);   // celý segment znova
+    r.send(true, ACK, 1100, 1, 150, T0 + 200010);   // znova s novými dátami na konci
+    r.send(true, ACK, 1250, 1, 100, T0 + 200020);   // pokračuje v poradí
+
+    TcpSummary s = r.summary();
+    EXPECT_EQ(s.retransmissions, 2u);
+    EXPECT_EQ(s.out_of_order, 0u);
+}
+
+TEST(TcpStateTest, OutOfOrder) {
+    TcpReplay r;
+    r.send(true, ACK, 1000, 1, 100, T0);
+    r.send(true, ACK, 1200, 1, 100, T0 + 10);       // chýba 1100..1200
+    r.send(true, ACK, 1300, 1, 100, T0 + 20);
+    r.send(true, ACK, 1100, 1, 100, T0 + 30);       // vyplní medzeru
+    r.send(true, ACK, 1100, 1, 100, T0 + 40);       // ten istý segment znova je už retransmisia
+
+    TcpSummary s = r.summary();
+    EXPECT_EQ(s.out_of_order, 1u);
+    EXPECT_EQ(s.retransmissions, 1u);
+}
+
+TEST(TcpStateTest, SequenceWraparound) {
+    TcpReplay r;
+    uint32_t seq = 0xFFFFFF00u;
+    r.send(true, ACK, seq, 1, 200, T0);             // prekročí 2^32
+    r.send(true, ACK, seq + 200, 1, 100, T0 + 10);
+    r.send(true, ACK, seq + 200, 1, 100, T0 + 20);  // retransmisia za pretečením
+
+    TcpSummary s = r.summary();
+    EXPECT_EQ(s.retransmissions, 1u);
+    EXPECT_EQ(s.out_of_order, 0u);
+}
+
+TEST(TcpStateTest, NonTcpFlowHasNoSummary) {
+    Stats stats(64);
+    stats.update("10.0.0.1:5353", "10.0.0.2:53", "udp", 100, 1, true);
+    TcpSummary s;
+    EXPECT_FALSE(stats.get_tcp_stats({"10.0.0.1:5353", "10.0.0.2:53", "udp"}, s));
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "../src/include/stats.h"
+#include "../src/include/watch.h"
+#include <cstring>
+#include <netinet/in.h>
+
+static const int64_t T0 = 1700000000LL * 1000000;
+
+// Paket toku 10.0.0.1:40000 <-> 10.0.0.2:443 (iba kľúč a príznaky, bez bufferu)
+static PacketInfo tcp_packet(bool from_client, uint8_t flags, uint16_t client_port = 40000) {
+    PacketInfo info;
+    memset(&info, 0, sizeof(info));
+    info.key.family = 4;
+    info.key.proto = IPPROTO_TCP;
+    info.key.src_port = from_client ? client_port : 443;
+    info.key.dst_port = from_client ? 443 : client_port;
+    const uint8_t client[4] = {10, 0, 0, 1};
+    const uint8_t server[4] = {10, 0, 0, 2};
+    memcpy(info.key.src, from_client ? client : server, 4);
+    memcpy(info.key.dst, from_client ? server : client, 4);
+    info.tcp_flags = flags;
+    return info;
+}
+
+static const ConnectionKey FLOW = {"10.0.0.2:443", "10.0.0.1:40000", "tcp"};
+
+TEST(WatchTest, RecordAndRates) {
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    FlowDetail detail = detail_init(key);
+    for (int s = 0; s < 5; s++) {
+        for (int i = 0; i <= s; i++) {
+            detail_record(detail, 100, TCPF_ACK, T0 + s * 1000000LL + i);
+        }
+    }
+    detail_record(detail, 60, TCPF_FIN | TCPF_ACK, T0 + 7 * 1000000LL);
+    EXPECT_EQ(detail.packets, 16u);
+    EXPECT_EQ(detail.bytes, 1560u);
+    EXPECT_EQ(detail.fin, 1u);
+    EXPECT_EQ(tcp_flags_text(detail.tcp_flags), "FIN ACK");
+    EXPECT_EQ(tcp_flags_text(0), "-");
+
+    std::vector<uint64_t> rates = detail_rates(detail, T0 / 1000000 + 7, 8);
+    EXPECT_EQ(rates, (std::vector<uint64_t>{1, 2, 3, 4, 5, 0, 0, 1}));
+    EXPECT_EQ(detail_rates(detail, T0 / 1000000 + 4, 2, true), (std::vector<uint64_t>{400, 500}));
+
+    // po WATCH_HISTORY sekundách sa bucket prepíše a staré hodnoty sa nevrátia
+    detail_record(detail, 100, 0, T0 + static_cast<int64_t>(WATCH_HISTORY) * 1000000);
+    rates = detail_rates(detail, T0 / 1000000 + static_cast<int64_t>(WATCH_HISTORY), WATCH_HISTORY);
+    EXPECT_EQ(rates.back(), 1u);
+    EXPECT_EQ(rates.front(), 2u);  // sekunda 1 je stále v okne
+}
+
+TEST(WatchTest, MergeDirections) {
+    FlowKey key;
+    memset(&key, 0, sizeof(key));
+    FlowDetail a = detail_init(key), b = detail_init(key);
+    detail_record(a, 100, TCPF_SYN, T0);
+    detail_record(b, 60, TCPF_SYN | TCPF_ACK, T0 + 10);
+    detail_record(b, 60, TCPF_RST, T0 + 2000000);
+    detail_merge(a, b);
+    EXPECT_EQ(a.packets, 3u);
+    EXPECT_EQ(a.syn, 2u);
+    EXPECT_EQ(a.rst, 1u);
+    EXPECT_EQ(detail_rates(a, T0 / 1000000 + 2, 3), (std::vector<uint64_t>{2, 0, 1}));
+    detail_scale(a, 10);
+    EXPECT_EQ(a.bytes, 2200u);
+    EXPECT_EQ(detail_rates(a, T0 / 1000000 + 2, 3), (std::vector<uint64_t>{20, 0, 10}));
+}
+
+TEST(WatchTest, OnlyWatchedFlowsAreAccounted) {
+    Stats stats(64);
+    FlowDetail detail;
+    stats.update(tcp_packet(true, TCPF_SYN), 60, true, T0);
+    EXPECT_FALSE(stats.get_flow_detail(FLOW, detail));
+
+    // odpoveď servera ešte nemá záznam, sledovanie sa k nej pripojí pri vložení
+    ASSERT_TRUE(stats.watch(FLOW));
+    stats.update(tcp_packet(false, TCPF_SYN | TCPF_ACK), 60, false, T0 + 1000);
+    stats.update(tcp_packet(true, TCPF_ACK), 52, true, T0 + 2000);
+    // iný tok sa nesleduje
+    stats.update(tcp_packet(true, TCPF_SYN, 40001), 60, true, T0 + 3000);
+
+    ASSERT_TRUE(stats.get_flow_detail(FLOW, detail));
+    EXPECT_EQ(detail.packets, 2u);
+    EXPECT_EQ(detail.bytes, 112u);
+    EXPECT_EQ(detail.tcp_flags, TCPF_SYN | TCPF_ACK);
+    EXPECT_EQ(detail.first_seen, T0);
+    EXPECT_EQ(detail.last_seen, T0 + 2000);
+    EXPECT_FALSE(stats.get_flow_detail({"10.0.0.1:40001", "10.0.0.2:443", "tcp"}, detail));
+
+    stats.unwatch(FLOW);
+    EXPECT_FALSE(stats.get_flow_detail(FLOW, detail));
+    stats.update(tcp_packet(true, TCPF_FIN), 52, true, T0 + 4000);
+    ASSERT_TRUE(stats.watch(FLOW));
+    stats.update(tcp_packet(true, TCPF_ACK), 52, true, T0 + 5000);
+    ASSERT_TRUE(stats.get_flow_detail(FLOW, detail));
+    EXPECT_EQ(detail.packets, 1u);
+    EXPECT_EQ(detail.fin, 0u);
+}
+
+TEST(WatchTest, WatchLimit) {
+    Stats stats(1024);
+    // každý tok zaberie dva smery
+    for (size_t i = 0; i < WATCH_MAX / 2; i++) {
+        ConnectionKey key{"10.0.0.1:" + std::to_string(1000 + i), "10.0.0.2:80", "tcp"};
+        EXPECT_TRUE(stats.watch(key));
+    }
+    EXPECT_FALSE(stats.watch({"10.0.0.1:999", "10.0.0.2:80", "tcp"}));
+    EXPECT_FALSE(stats.watch({"not an address", "10.0.0.2:80", "tcp"}));
+    stats.unwatch({"10.0.0.1:1000", "10.0.0.2:80", "tcp"});
+    EXPECT_TRUE(stats.watch({"10.0.0.1:999", "10.0.0.2:80", "tcp"}));
+}